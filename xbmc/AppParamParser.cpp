@@ -26,6 +26,7 @@
 #include "utils/SystemInfo.h"
 #include "utils/StringUtils.h"
 #include "input/InputManager.h"
+#include "guilib/GUIBenchmark.h"
 #ifdef TARGET_WINDOWS
 #include "WIN32Util.h"
 #endif
@@ -107,6 +108,8 @@ void CAppParamParser::DisplayHelp()
   printf("  --test\t\tEnable test mode. [FILE] required.\n");
   printf("  --settings=<filename>\t\tLoads specified file after advancedsettings.xml replacing any settings specified\n");
   printf("  \t\t\t\tspecified file must exist in special://xbmc/system/\n");
+  printf("  --guibenchmark=<filename>\tRuns the gui navigation in the specified file, writes\n");
+  printf("  \t\t\t\tthe frame times of all controls to a report and quits\n");
   exit(0);
 }
 
@@ -137,6 +140,8 @@ void CAppParamParser::ParseArg(const std::string &arg)
     m_testmode = true;
   else if (arg.substr(0, 11) == "--settings=")
     g_advancedSettings.AddSettingsFile(arg.substr(11));
+  else if (arg.substr(0, 15) == "--guibenchmark=")
+    CGUIBenchmark::GetInstance().SetScript(arg.substr(15));
   else if (arg.length() != 0 && arg[0] != '-')
   {
     if (m_testmode)
@@ -44,6 +44,7 @@
 #include "video/Bookmark.h"
 #include "video/VideoLibraryQueue.h"
 #include "guilib/GUIControlProfiler.h"
+#include "guilib/GUIBenchmark.h"
 #include "utils/LangCodeExpander.h"
 #include "GUIInfoManager.h"
 #include "playlists/PlayListFactory.h"
@@ -69,6 +70,7 @@
 #include "GUIUserMessages.h"
 #include "filesystem/Directory.h"
 #include "filesystem/DirectoryCache.h"
+#include "filesystem/DirectoryChangeTracker.h"
 #include "filesystem/StackDirectory.h"
 #include "filesystem/SpecialProtocol.h"
 #include "filesystem/DllLibCurl.h"
@@ -1365,6 +1367,9 @@ void CApplication::StopServices()
   m_DetectDVDType.StopThread();
 #endif
 
+  CLog::Log(LOGNOTICE, "stop directory change tracker");
+  XFILE::CDirectoryChangeTracker::GetInstance().Stop();
+
   g_peripherals.Clear();
 }
 
@@ -1931,6 +1936,9 @@ void CApplication::Render()
     // execute post rendering actions (finalize window closing)
     g_windowManager.AfterRender();
 
+    // upload textures decoded in the background for the windows likely opened next
+    g_TextureManager.UploadPreloaded();
+
     m_lastRenderTime = XbmcThreads::SystemClockMillis();
   }
 
@@ -1942,7 +1950,7 @@ void CApplication::Render()
   // reset our info cache - we do this at the end of Render so that it is
   // fresh for the next process(), or after a windowclose animation (where process()
   // isn't called)
-  g_infoManager.ResetCache();
+  g_infoManager.ResetFrameCache();
 
   if (hasRendered)
   {
@@ -2767,7 +2775,10 @@ void CApplication::FrameMove(bool processEvents, bool processGUI)
     if (!m_bStop)
     {
       if (!m_skipGuiRender)
+      {
+        CGUIBenchmark::GetInstance().FrameMove();
         g_windowManager.Process(CTimeUtils::GetFrameTime());
+      }
     }
     g_windowManager.FrameMove();
   }
@@ -3546,6 +3557,8 @@ PlayBackRet CApplication::PlayFile(CFileItem item, const std::string& player, bo
 
 void CApplication::OnPlayBackEnded()
 {
+  g_infoManager.ResetCache(INFO::DEPENDS_PLAYER);
+
   CSingleLock lock(m_playStateMutex);
   CLog::LogF(LOGDEBUG,"play state was %d, starting %d", m_ePlayState, m_bPlaybackStarting);
   m_ePlayState = PLAY_STATE_ENDED;
@@ -3573,6 +3586,8 @@ void CApplication::OnPlayBackEnded()
 
 void CApplication::OnPlayBackStarted()
 {
+  g_infoManager.ResetCache(INFO::DEPENDS_PLAYER);
+
   CSingleLock lock(m_playStateMutex);
   CLog::LogF(LOGDEBUG,"play state was %d, starting %d", m_ePlayState, m_bPlaybackStarting);
   m_ePlayState = PLAY_STATE_PLAYING;
@@ -3613,6 +3628,8 @@ void CApplication::OnQueueNextItem()
 
 void CApplication::OnPlayBackStopped()
 {
+  g_infoManager.ResetCache(INFO::DEPENDS_PLAYER);
+
   CSingleLock lock(m_playStateMutex);
   CLog::LogF(LOGDEBUG, "play state was %d, starting %d", m_ePlayState, m_bPlaybackStarting);
   m_ePlayState = PLAY_STATE_STOPPED;
@@ -3640,6 +3657,8 @@ void CApplication::OnPlayBackStopped()
 
 void CApplication::OnPlayBackPaused()
 {
+  g_infoManager.ResetCache(INFO::DEPENDS_PLAYER);
+
 #ifdef HAS_PYTHON
   g_pythonParser.OnPlayBackPaused();
 #endif
@@ -3657,6 +3676,8 @@ void CApplication::OnPlayBackPaused()
 
 void CApplication::OnPlayBackResumed()
 {
+  g_infoManager.ResetCache(INFO::DEPENDS_PLAYER);
+
 #ifdef HAS_PYTHON
   g_pythonParser.OnPlayBackResumed();
 #endif
@@ -3675,6 +3696,8 @@ void CApplication::OnPlayBackResumed()
 
 void CApplication::OnPlayBackSpeedChanged(int iSpeed)
 {
+  g_infoManager.ResetCache(INFO::DEPENDS_PLAYER);
+
 #ifdef HAS_PYTHON
   g_pythonParser.OnPlayBackSpeedChanged(iSpeed);
 #endif
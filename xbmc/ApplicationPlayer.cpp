@@ -22,6 +22,7 @@
 #include "cores/IPlayer.h"
 #include "cores/playercorefactory/PlayerCoreFactory.h"
 #include "Application.h"
+#include "GUIInfoManager.h"
 #include "PlayListPlayer.h"
 #include "settings/MediaSettings.h"
 
@@ -43,8 +44,11 @@ void CApplicationPlayer::ClosePlayer()
   {
     CloseFile();
     // we need to do this directly on the member
-    CSingleLock lock(m_player_lock);
-    m_pPlayer.reset();
+    {
+      CSingleLock lock(m_player_lock);
+      m_pPlayer.reset();
+    }
+    g_infoManager.ResetCache(INFO::DEPENDS_PLAYER);
   }
 }
 
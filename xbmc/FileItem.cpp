@@ -21,6 +21,7 @@
 #include <cstdlib>
 
 #include "FileItem.h"
+#include "IFileItemListPager.h"
 #include "ServiceBroker.h"
 #include "guilib/LocalizeStrings.h"
 #include "utils/StringUtils.h"
@@ -1886,6 +1887,7 @@ void CFileItemList::Clear()
   m_sortDetails.clear();
   m_replaceListing = false;
   m_content.clear();
+  m_pager.reset();
 }
 
 void CFileItemList::ClearItems()
@@ -1992,6 +1994,14 @@ void CFileItemList::Assign(const CFileItemList& itemlist, bool append)
   m_content = itemlist.m_content;
   m_mapProperties = itemlist.m_mapProperties;
   m_cacheToDisc = itemlist.m_cacheToDisc;
+  m_pager = itemlist.m_pager;
+}
+
+void CFileItemList::LoadPaged()
+{
+  CSingleLock lock(m_lock);
+  if (m_pager)
+    m_pager->Load(m_items);
 }
 
 bool CFileItemList::Copy(const CFileItemList& items, bool copyItems /* = true */)
@@ -2007,6 +2017,7 @@ bool CFileItemList::Copy(const CFileItemList& items, bool copyItems /* = true */
   m_sortDetails     = items.m_sortDetails;
   m_sortDescription = items.m_sortDescription;
   m_sortIgnoreFolders = items.m_sortIgnoreFolders;
+  m_pager           = items.m_pager;
 
   if (copyItems)
   {
@@ -2153,6 +2164,15 @@ void CFileItemList::Sort(SortDescription sortDescription)
   if (m_sortIgnoreFolders)
     sortDescription.sortAttributes = (SortAttribute)((int)sortDescription.sortAttributes | SortAttributeIgnoreFolders);
 
+  if (m_pager)
+  {
+    // placeholders can't be compared, so either the pager orders them or they all have to be loaded
+    if (m_pager->Sort(m_items, sortDescription))
+      return;
+    m_pager->Load(m_items);
+    m_pager.reset();
+  }
+
   const Fields fields = SortUtils::GetFieldsForSorting(sortDescription.sortBy);
   SortItems sortItems((size_t)Size());
   for (int index = 0; index < Size(); index++)
@@ -2798,7 +2818,7 @@ bool CFileItemList::Load(int windowID)
 bool CFileItemList::Save(int windowID)
 {
   int iSize = Size();
-  if (iSize <= 0)
+  if (iSize <= 0 || m_pager)
     return false;
 
   CLog::Log(LOGDEBUG,"Saving fileitems [%s]", CURL::GetRedacted(GetPath()).c_str());
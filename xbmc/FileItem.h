@@ -68,6 +68,9 @@ typedef std::shared_ptr<CCueDocument> CCueDocumentPtr;
 class IEvent;
 typedef std::shared_ptr<const IEvent> EventPtr;
 
+class IFileItemListPager;
+typedef std::shared_ptr<IFileItemListPager> FileItemListPagerPtr;
+
 /* special startoffset used to indicate that we wish to resume */
 #define STARTOFFSET_RESUME (-1)
 
@@ -730,6 +733,18 @@ public:
   const std::string &GetContent() const { return m_content; };
 
   void ClearSortState();
+
+  /*! \brief Set the pager that loads the placeholder items of this list on demand
+   \sa IFileItemListPager
+   */
+  void SetPager(const FileItemListPagerPtr &pager) { m_pager = pager; }
+  const FileItemListPagerPtr &GetPager() const { return m_pager; }
+
+  /*! \brief Load every placeholder of a paged list, for consumers of the whole list.
+   The items stay shared with the containers showing the list, which turn them back into
+   placeholders, so consumers keeping them (playlists, party mode) must keep copies.
+   */
+  void LoadPaged();
 private:
   void Sort(FILEITEMLISTCOMPARISONFUNC func);
   void FillSortFields(FILEITEMFILLFUNC func);
@@ -756,6 +771,7 @@ private:
   CACHE_TYPE m_cacheToDisc;
   bool m_replaceListing;
   std::string m_content;
+  FileItemListPagerPtr m_pager;
 
   std::vector<GUIViewSortDetails> m_sortDetails;
 
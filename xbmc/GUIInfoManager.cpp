@@ -153,6 +153,7 @@ CGUIInfoManager::CGUIInfoManager(void) :
   m_playerShowTime = false;
   m_playerShowInfo = false;
   m_fps = 0.0f;
+  m_boolEvaluations = 0;
   ResetLibraryBools();
 }
 
@@ -6840,12 +6841,12 @@ bool CGUIInfoManager::GetInt(int &value, int info, int contextWindow, const CGUI
   return false;
 }
 
-// functor for comparison InfoPtr's
+// functor for comparison InfoPtr's, info bools can't be copied
 struct InfoBoolFinder
 {
-  InfoBoolFinder(const std::string &expression, int context) : m_bool(expression, context) {};
-  bool operator() (const InfoPtr &right) const { return m_bool == *right; };
-  InfoBool m_bool;
+  InfoBoolFinder(const std::string &expression, int context) : m_bool(std::make_shared<InfoBool>(expression, context)) {};
+  bool operator() (const InfoPtr &right) const { return *m_bool == *right; };
+  InfoPtr m_bool;
 };
 
 INFO::InfoPtr CGUIInfoManager::Register(const std::string &expression, int context)
@@ -10909,10 +10910,102 @@ void CGUIInfoManager::ResetCache()
 {
   // reset any animation triggers as well
   m_containerMoves.clear();
-  // mark our infobools as dirty
+  ResetCache(INFO::DEPENDS_ALL);
+}
+
+void CGUIInfoManager::ResetCache(unsigned int dependencies)
+{
+  // mark our infobools as dirty, constant ones only when everything is reset
   CSingleLock lock(m_critInfo);
   for (std::vector<InfoPtr>::iterator i = m_bools.begin(); i != m_bools.end(); ++i)
-    (*i)->SetDirty();
+  {
+    if (dependencies == INFO::DEPENDS_ALL || ((*i)->GetDependencies() & dependencies))
+      (*i)->SetDirty();
+  }
+}
+
+void CGUIInfoManager::ResetFrameCache()
+{
+  m_containerMoves.clear();
+  ResetCache(INFO::DEPENDS_FRAME);
+  m_boolEvaluations = InfoBool::ResetEvaluationCount();
+}
+
+void CGUIInfoManager::SetNextWindow(int windowID)
+{
+  m_nextWindowID = windowID;
+  ResetCache(INFO::DEPENDS_WINDOW);
+}
+
+void CGUIInfoManager::SetPreviousWindow(int windowID)
+{
+  m_prevWindowID = windowID;
+  ResetCache(INFO::DEPENDS_WINDOW);
+}
+
+unsigned int CGUIInfoManager::GetBoolCount()
+{
+  CSingleLock lock(m_critInfo);
+  return m_bools.size();
+}
+
+unsigned int CGUIInfoManager::GetDependencies(int condition) const
+{
+  condition = abs(condition);
+  if (condition >= MULTI_INFO_START && condition <= MULTI_INFO_END)
+    condition = m_multiInfo[condition - MULTI_INFO_START].m_info;
+
+  switch (condition)
+  {
+  case SYSTEM_ALWAYS_TRUE:
+  case SYSTEM_ALWAYS_FALSE:
+  case SYSTEM_ETHERNET_LINK_ACTIVE:
+  case SYSTEM_PLATFORM_LINUX:
+  case SYSTEM_PLATFORM_WINDOWS:
+  case SYSTEM_PLATFORM_DARWIN:
+  case SYSTEM_PLATFORM_DARWIN_OSX:
+  case SYSTEM_PLATFORM_DARWIN_IOS:
+  case SYSTEM_PLATFORM_ANDROID:
+  case SYSTEM_PLATFORM_LINUX_RASPBERRY_PI:
+    return INFO::DEPENDS_NONE;
+  case SKIN_BOOL:
+  case SKIN_STRING:
+    return INFO::DEPENDS_SKIN_SETTINGS;
+  case PLAYER_HAS_MEDIA:
+  case PLAYER_HAS_AUDIO:
+  case PLAYER_HAS_VIDEO:
+  case PLAYER_HAS_GAME:
+  case PLAYER_PLAYING:
+  case PLAYER_PAUSED:
+  case PLAYER_REWINDING:
+  case PLAYER_FORWARDING:
+  case PLAYER_REWINDING_2x:
+  case PLAYER_REWINDING_4x:
+  case PLAYER_REWINDING_8x:
+  case PLAYER_REWINDING_16x:
+  case PLAYER_REWINDING_32x:
+  case PLAYER_FORWARDING_2x:
+  case PLAYER_FORWARDING_4x:
+  case PLAYER_FORWARDING_8x:
+  case PLAYER_FORWARDING_16x:
+  case PLAYER_FORWARDING_32x:
+    return INFO::DEPENDS_PLAYER;
+  case WINDOW_IS_ACTIVE:
+  case WINDOW_IS_VISIBLE:
+  case WINDOW_IS_TOPMOST:
+  case WINDOW_IS_MEDIA:
+  case WINDOW_NEXT:
+  case WINDOW_PREVIOUS:
+  case SYSTEM_HAS_ACTIVE_MODAL_DIALOG:
+  case SYSTEM_HAS_VISIBLE_MODAL_DIALOG:
+    return INFO::DEPENDS_WINDOW;
+  case LIBRARY_HAS_ROLE:
+    return INFO::DEPENDS_LIBRARY;
+  default:
+    if (condition >= LIBRARY_HAS_MUSIC && condition <= LIBRARY_HAS_COMPILATIONS)
+      return INFO::DEPENDS_LIBRARY;
+    return INFO::DEPENDS_FRAME;
+  }
 }
 
 std::string CGUIInfoManager::GetPictureLabel(int info)
@@ -11082,6 +11175,7 @@ void CGUIInfoManager::SetLibraryBool(int condition, bool value)
     default:
       break;
   }
+  ResetCache(INFO::DEPENDS_LIBRARY);
 }
 
 void CGUIInfoManager::ResetLibraryBools()
@@ -11094,6 +11188,7 @@ void CGUIInfoManager::ResetLibraryBools()
   m_libraryHasSingles = -1;
   m_libraryHasCompilations = -1;
   m_libraryRoleCounts.clear();
+  ResetCache(INFO::DEPENDS_LIBRARY);
 }
 
 bool CGUIInfoManager::GetLibraryBool(int condition)
@@ -201,10 +201,33 @@ public:
   void UpdateAVInfo();
   inline float GetFPS() const { return m_fps; };
 
-  void SetNextWindow(int windowID) { m_nextWindowID = windowID; };
-  void SetPreviousWindow(int windowID) { m_prevWindowID = windowID; };
+  void SetNextWindow(int windowID);
+  void SetPreviousWindow(int windowID);
 
+  /*! \brief Mark all info bools dirty, e.g. when a window is initialized
+   */
   void ResetCache();
+
+  /*! \brief Mark the info bools whose inputs may have changed dirty
+   \param dependencies a combination of INFO::InfoDependency flags
+   */
+  void ResetCache(unsigned int dependencies);
+
+  /*! \brief Called after every frame, marks the info bools polled every frame dirty
+   and updates the evaluation counters
+   */
+  void ResetFrameCache();
+
+  /*! \brief Get the number of info bools that were evaluated during the last frame
+   */
+  unsigned int GetBoolEvaluations() const { return m_boolEvaluations; }
+  unsigned int GetBoolCount();
+
+  /*! \brief Get the inputs a condition depends on
+   \param condition the condition returned by TranslateSingleString()
+   \return a combination of INFO::InfoDependency flags
+   */
+  unsigned int GetDependencies(int condition) const;
   bool GetItemInt(int &value, const CGUIListItem *item, int info) const;
   std::string GetItemLabel(const CFileItem *item, int info, std::string *fallback = NULL);
   std::string GetItemImage(const CFileItem *item, int info, std::string *fallback = NULL);
@@ -320,7 +343,9 @@ protected:
 
   // FPS counters
   float m_fps;
+  unsigned int m_boolEvaluations;
   unsigned int m_frameCounter;
+
   unsigned int m_lastFPSTime;
 
   std::map<int, int> m_containerMoves;  // direction of list moving
@@ -0,0 +1,77 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "FileItem.h"
+
+struct LABEL_MASKS;
+
+/*!
+ \brief Loads the items of a large CFileItemList on demand.
+
+ A list with a pager starts out with lightweight placeholder items that only
+ carry their path and a preformatted label. Containers ask the pager to load
+ the rows around the visible range in the background and to evict rows that
+ scrolled far away, turning them back into placeholders. Placeholders keep
+ their identity, so every holder of the list sees the same items, copies of
+ the list share the pager with their own placeholders.
+
+ Consumers that need every item fully loaded keep working: sorting a list
+ whose pager can't order it loads all placeholders and drops the pager.
+ Consumers keeping items beyond the listing, like playlists, load them with
+ CFileItemList::LoadPaged() and keep copies, as the containers evict them.
+ */
+class IFileItemListPager
+{
+public:
+  virtual ~IFileItemListPager() { }
+
+  /*!
+   \brief Loads the given items, items that aren't placeholders of this pager are skipped.
+   */
+  virtual void Load(const VECFILEITEMS &items) = 0;
+
+  /*!
+   \brief Starts loading the given items in the background, they stay placeholders until Update() fills them in.
+   */
+  virtual void LoadAsync(const VECFILEITEMS &items) = 0;
+
+  /*!
+   \brief Fills in the items loaded in the background, called from the thread that owns the items.
+   \return true if any item changed.
+   */
+  virtual bool Update() = 0;
+
+  /*!
+   \brief Turns a loaded item back into a placeholder, an item still loading in the background stays one.
+   */
+  virtual void Evict(CFileItem &item) = 0;
+
+  /*!
+   \brief Orders the items without loading them.
+   \return false if the sort description can't be handled, items are unchanged then.
+   */
+  virtual bool Sort(VECFILEITEMS &items, const SortDescription &sortDescription) = 0;
+
+  /*!
+   \brief Sets the label masks used to format the labels of loaded items.
+   */
+  virtual void SetLabelMasks(const LABEL_MASKS &labelMasks) = 0;
+};
@@ -19,9 +19,12 @@
  */
 
 #include "InfoScanner.h"
+#include "FileItem.h"
 #include "URL.h"
 #include "Util.h"
+#include "filesystem/DirectoryChangeTracker.h"
 #include "filesystem/File.h"
+#include "filesystem/IDirectory.h"
 #include "utils/log.h"
 #include "utils/URIUtils.h"
 
@@ -45,3 +48,76 @@ bool CInfoScanner::IsExcluded(const std::string& strDirectory, const std::vector
   }
   return false;
 }
+
+bool CInfoScanner::GetFingerprint(const std::string& strDirectory, DirectoryFingerprint &fingerprint)
+{
+  struct __stat64 buffer;
+  if (XFILE::CFile::Stat(strDirectory, &buffer) != 0)
+    return false;
+
+  fingerprint.mtime = buffer.st_mtime ? buffer.st_mtime : buffer.st_ctime;
+  fingerprint.size = buffer.st_size;
+  return fingerprint.mtime != 0;
+}
+
+bool CInfoScanner::IsUnchanged(const std::string& strDirectory, const DirectoryFingerprints &known, DirectoryFingerprint &fingerprint)
+{
+  // files rewritten in place are only noticed in watched directories
+  XFILE::CDirectoryChangeTracker &tracker = XFILE::CDirectoryChangeTracker::GetInstance();
+  bool changed = tracker.TakeChanged(strDirectory);
+
+  if (!GetFingerprint(strDirectory, fingerprint))
+    return false;
+
+  // start watching before the directory is listed, so no change is missed
+  tracker.Watch(strDirectory);
+
+  DirectoryFingerprints::const_iterator it = known.find(strDirectory);
+  return !changed && it != known.end() && it->second == fingerprint;
+}
+
+bool CInfoScanner::IsTreeUnchanged(const std::string& strDirectory, const DirectoryFingerprints &known)
+{
+  DirectoryFingerprint fingerprint;
+  if (!IsUnchanged(strDirectory, known, fingerprint))
+    return false;
+
+  for (const auto &subDir : GetKnownSubDirs(strDirectory, known))
+  {
+    if (!IsTreeUnchanged(subDir, known))
+      return false;
+  }
+  return true;
+}
+
+void CInfoScanner::GetTreeFingerprints(const std::string& strDirectory, DirectoryFingerprints &fingerprints)
+{
+  CFileItemList items;
+  items.Add(CFileItemPtr(new CFileItem(strDirectory, true)));
+  CUtil::GetRecursiveDirsListing(strDirectory, items, XFILE::DIR_FLAG_NO_FILE_DIRS | XFILE::DIR_FLAG_NO_FILE_INFO);
+
+  for (int i = 0; i < items.Size(); ++i)
+  {
+    std::string path = items[i]->GetPath();
+    URIUtils::AddSlashAtEnd(path);
+    DirectoryFingerprint fingerprint;
+    if (GetFingerprint(path, fingerprint))
+    {
+      fingerprints[path] = fingerprint;
+      XFILE::CDirectoryChangeTracker::GetInstance().Watch(path);
+    }
+  }
+}
+
+std::vector<std::string> CInfoScanner::GetKnownSubDirs(const std::string& strDirectory, const DirectoryFingerprints &known)
+{
+  // the map is sorted, so everything below the directory follows it
+  std::vector<std::string> subDirs;
+  for (DirectoryFingerprints::const_iterator it = known.upper_bound(strDirectory);
+       it != known.end() && URIUtils::PathHasParent(it->first, strDirectory); ++it)
+  {
+    if (URIUtils::PathEquals(URIUtils::GetParentPath(it->first), strDirectory, true))
+      subDirs.push_back(it->first);
+  }
+  return subDirs;
+}
@@ -18,9 +18,27 @@
  *
  */
 #pragma once
+#include <map>
+#include <stdint.h>
 #include <string>
 #include <vector>
 
+/*!
+ \brief Modification time and size of a directory, as reported by a stat of the directory itself.
+ Adding, removing or renaming an entry changes the modification time, rewriting a file in place doesn't.
+ */
+struct DirectoryFingerprint
+{
+  DirectoryFingerprint() : mtime(0), size(0) {}
+  bool operator==(const DirectoryFingerprint &rhs) const { return mtime == rhs.mtime && size == rhs.size; }
+  bool operator!=(const DirectoryFingerprint &rhs) const { return !(*this == rhs); }
+
+  int64_t mtime;
+  int64_t size;
+};
+
+typedef std::map<std::string, DirectoryFingerprint> DirectoryFingerprints;
+
 class CInfoScanner
 {
 public:
@@ -32,6 +50,35 @@ public:
    \return true if there is a .nomedia file or one of the regexps is a match
    */
   bool IsExcluded(const std::string& strDirectory, const std::vector<std::string> &regexps);
+
+  /*! \brief Stat a directory for the incremental scan
+   \return false if the directory can't be stat'ed or doesn't report a modification time
+   */
+  static bool GetFingerprint(const std::string& strDirectory, DirectoryFingerprint &fingerprint);
+
+  /*! \brief Check whether the incremental scan can skip listing a directory
+   The directory is compared with the fingerprint stored by the last scan. If it has
+   been watched by CDirectoryChangeTracker since then, any recorded change also counts,
+   so files rewritten in place are noticed. The directory is watched from now on if possible.
+   \param strDirectory Directory to check
+   \param known the fingerprints stored by the last scan
+   \param fingerprint [out] the fingerprint to store once the directory has been scanned
+   \return true if the directory doesn't have to be listed
+   */
+  static bool IsUnchanged(const std::string& strDirectory, const DirectoryFingerprints &known, DirectoryFingerprint &fingerprint);
+
+  /*! \brief Check whether a directory and all the directories below it that were stored by the last scan are unchanged
+   \sa IsUnchanged
+   */
+  static bool IsTreeUnchanged(const std::string& strDirectory, const DirectoryFingerprints &known);
+
+  /*! \brief Get the fingerprints of a directory and all directories below it, this lists the whole tree
+   */
+  static void GetTreeFingerprints(const std::string& strDirectory, DirectoryFingerprints &fingerprints);
+
+  /*! \brief Get the subdirectories of a directory that were stored by the last scan
+   */
+  static std::vector<std::string> GetKnownSubDirs(const std::string& strDirectory, const DirectoryFingerprints &known);
 private:
   bool HasNoMedia(const std::string& strDirectory) const;
 };
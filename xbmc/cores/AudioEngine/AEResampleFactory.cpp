@@ -20,6 +20,8 @@
 
 #include "AEResampleFactory.h"
 #include "cores/AudioEngine/Engines/ActiveAE/ActiveAEResampleFFMPEG.h"
+#include "cores/AudioEngine/Engines/ActiveAE/ActiveAEResamplePolyphase.h"
+#include "settings/AdvancedSettings.h"
 #if defined(TARGET_RASPBERRY_PI)
   #include "ServiceBroker.h"
   #include "settings/Settings.h"
@@ -35,6 +37,9 @@ IAEResample *CAEResampleFactory::Create(uint32_t flags /* = 0 */)
   if (!(flags & AERESAMPLEFACTORY_QUICK_RESAMPLE) && CServiceBroker::GetSettings().GetInt(CSettings::SETTING_AUDIOOUTPUT_PROCESSQUALITY) == AE_QUALITY_GPU)
     return new CActiveAEResamplePi();
 #endif
+  // sounds are resampled in a single call, that stays with swresample
+  if (!(flags & AERESAMPLEFACTORY_QUICK_RESAMPLE) && g_advancedSettings.m_audioResampler == "polyphase")
+    return new CActiveAEResamplePolyphase();
   return new CActiveAEResampleFFMPEG();
 }
 
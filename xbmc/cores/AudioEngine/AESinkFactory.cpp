@@ -252,6 +252,8 @@ void CAESinkFactory::EnumerateEx(AESinkInfoList &list, bool force)
     if (envSink == "OSS")
       CAESinkOSS::EnumerateDevicesEx(info.m_deviceInfoList, force);
     #endif
+    if (envSink == "NULL")
+      CAESinkNULL::EnumerateDevicesEx(info.m_deviceInfoList, force);
 
     if(!info.m_deviceInfoList.empty())
     {
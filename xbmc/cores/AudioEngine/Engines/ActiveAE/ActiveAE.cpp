@@ -24,8 +24,10 @@ using namespace ActiveAE;
 #include "ActiveAESound.h"
 #include "ActiveAEStream.h"
 #include "ServiceBroker.h"
+#include "cores/DataCacheCore.h"
 #include "cores/AudioEngine/Engines/ActiveAE/AudioDSPAddons/ActiveAEDSP.h"
 #include "cores/AudioEngine/Engines/ActiveAE/AudioDSPAddons/ActiveAEDSPProcess.h"
+#include "cores/AudioEngine/Utils/AEKernels.h"
 #include "cores/AudioEngine/Utils/AEUtil.h"
 #include "cores/AudioEngine/Utils/AEStreamInfo.h"
 #include "cores/AudioEngine/AEResampleFactory.h"
@@ -34,6 +36,7 @@ using namespace ActiveAE;
 #include "settings/Settings.h"
 #include "windowing/WindowingFactory.h"
 #include "utils/log.h"
+#include "utils/TimeUtils.h"
 
 #define MAX_CACHE_LEVEL 0.4   // total cache time of stream in seconds
 #define MAX_WATER_LEVEL 0.2   // buffered time after stream stages in seconds
@@ -283,6 +286,7 @@ CActiveAE::CActiveAE() :
   m_encoder = NULL;
   m_vizInitialized = false;
   m_sinkHasVolume = false;
+  m_sinkBufferAccess = false;
   m_aeGUISoundForce = false;
   m_stats.Reset(44100, true);
   m_streamIdGen = 0;
@@ -716,21 +720,6 @@ void CActiveAE::StateMachine(int signal, Protocol *port, Message *msg)
           else
             msg->Reply(CActiveAEDataProtocol::ERR);
           return;
-        case CActiveAEDataProtocol::STREAMSAMPLE:
-          MsgStreamSample *msgData;
-          CSampleBuffer *samples;
-          msgData = (MsgStreamSample*)msg->data;
-          samples = msgData->stream->m_processingSamples.front();
-          msgData->stream->m_processingSamples.pop_front();
-          if (samples != msgData->buffer)
-            CLog::Log(LOGERROR, "CActiveAE - inconsistency in stream sample message");
-          if (msgData->buffer->pkt->nb_samples == 0)
-            msgData->buffer->Return();
-          else
-            msgData->stream->m_processingBuffers->m_inputSamples.push_back(msgData->buffer);
-          m_extTimeout = 0;
-          m_state = AE_TOP_CONFIGURED_PLAY;
-          return;
         case CActiveAEDataProtocol::FREESTREAM:
           stream = *(CActiveAEStream**)msg->data;
           DiscardStream(stream);
@@ -1016,6 +1005,10 @@ void CActiveAE::Process()
           }
         }
       }
+
+      // samples of streams don't go through messages
+      if (!gotMsg && ReceiveStreamSamples())
+        continue;
     }
 
     if (gotMsg)
@@ -1233,7 +1226,9 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
     else
     {
       outputFormat = m_sinkFormat;
-      outputFormat.m_dataFormat = AE_IS_PLANAR(outputFormat.m_dataFormat) ? AE_FMT_FLOATP : AE_FMT_FLOAT;
+      // sinks with buffer access convert planar float themselves
+      outputFormat.m_dataFormat = (AE_IS_PLANAR(outputFormat.m_dataFormat) || m_sinkBufferAccess) ?
+                                  AE_FMT_FLOATP : AE_FMT_FLOAT;
       outputFormat.m_frameSize = outputFormat.m_channelLayout.Count() *
                                  (CAEUtil::DataFormatToBits(outputFormat.m_dataFormat) >> 3);
 
@@ -1342,17 +1337,24 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
   }
 
   // resample buffers for sink
+  // if the sink converts into its own memory, the mix buffers are passed through
+  AEAudioFormat sinkOutputFormat = m_sinkFormat;
+  if (m_sinkBufferAccess && sinkInputFormat.m_dataFormat == AE_FMT_FLOATP)
+  {
+    sinkOutputFormat = sinkInputFormat;
+    sinkOutputFormat.m_frames = m_sinkFormat.m_frames;
+  }
   if (m_sinkBuffers && 
-     (!CompareFormat(m_sinkBuffers->m_format,m_sinkFormat) ||
+     (!CompareFormat(m_sinkBuffers->m_format, sinkOutputFormat) ||
       !CompareFormat(m_sinkBuffers->m_inputFormat, sinkInputFormat) ||
-      m_sinkBuffers->m_format.m_frames != m_sinkFormat.m_frames))
+      m_sinkBuffers->m_format.m_frames != sinkOutputFormat.m_frames))
   {
     m_discardBufferPools.push_back(m_sinkBuffers);
     m_sinkBuffers = NULL;
   }
   if (!m_sinkBuffers)
   {
-    m_sinkBuffers = new CActiveAEBufferPoolResample(sinkInputFormat, m_sinkFormat, m_settings.resampleQuality);
+    m_sinkBuffers = new CActiveAEBufferPoolResample(sinkInputFormat, sinkOutputFormat, m_settings.resampleQuality);
     m_sinkBuffers->Create(MAX_WATER_LEVEL*1000, true, false);
   }
 
@@ -1400,6 +1402,7 @@ CActiveAEStream* CActiveAE::CreateStream(MsgStreamNew *streamMsg)
   stream = new CActiveAEStream(&streamMsg->format, m_streamIdGen++, this);
   stream->m_streamPort = new CActiveAEDataProtocol("stream",
                              &stream->m_inMsgEvent, &m_outMsgEvent);
+  stream->m_engineEvent = &m_outMsgEvent;
 
   // create buffer pool
   stream->m_inputBuffers = NULL; // create in Configure when we know the sink format
@@ -1452,7 +1455,10 @@ void CActiveAE::DiscardStream(CActiveAEStream *stream)
         m_discardBufferPools.push_back((*it)->m_processingBuffers->GetAtempoBuffers());
       }
       delete (*it)->m_processingBuffers;
-      CLog::Log(LOGDEBUG, "CActiveAE::DiscardStream - audio stream deleted");
+      const CDataCacheCore::AudioQueueLatency &latency = (*it)->m_queueLatency;
+      CLog::Log(LOGDEBUG, "CActiveAE::DiscardStream - audio stream deleted, queue latency <1/2/4/8/16/32/64/more ms: %u/%u/%u/%u/%u/%u/%u/%u",
+                latency[0], latency[1], latency[2], latency[3], latency[4], latency[5], latency[6], latency[7]);
+      CServiceBroker::GetDataCacheCore().ResetAudioQueueLatency((*it)->m_id);
       m_stats.RemoveStream((*it)->m_id);
       delete (*it)->m_streamPort;
       delete (*it);
@@ -1465,6 +1471,52 @@ void CActiveAE::DiscardStream(CActiveAEStream *stream)
   ClearDiscardedBuffers();
 }
 
+bool CActiveAE::ReceiveStreamSamples()
+{
+  // samples are left queued in states that can't process them
+  if (m_state != AE_TOP_CONFIGURED_SUSPEND &&
+      m_state != AE_TOP_CONFIGURED_IDLE &&
+      m_state != AE_TOP_CONFIGURED_PLAY)
+    return false;
+
+  bool received = false;
+  int64_t now = CurrentHostCounter();
+  int64_t frequency = CurrentHostFrequency();
+
+  std::list<CActiveAEStream*>::iterator it;
+  for (it = m_streams.begin(); it != m_streams.end(); ++it)
+  {
+    CActiveAEStream *stream = *it;
+    CStreamSample sample;
+    while (stream->m_sampleQueue.Pop(sample))
+    {
+      CSampleBuffer *samples = stream->m_processingSamples.front();
+      stream->m_processingSamples.pop_front();
+      if (samples != sample.buffer)
+        CLog::Log(LOGERROR, "CActiveAE - inconsistency in stream sample queue");
+      if (sample.buffer->pkt->nb_samples == 0)
+        sample.buffer->Return();
+      else
+        stream->m_processingBuffers->m_inputSamples.push_back(sample.buffer);
+      stream->AddQueueLatency((now - sample.queued) * 1000 / frequency);
+      received = true;
+    }
+
+    if (stream->m_queueLatencyTimer.IsTimePast())
+    {
+      CServiceBroker::GetDataCacheCore().SetAudioQueueLatency(stream->m_id, stream->m_queueLatency);
+      stream->m_queueLatencyTimer.Set(1000);
+    }
+  }
+
+  if (received)
+  {
+    m_extTimeout = 0;
+    m_state = AE_TOP_CONFIGURED_PLAY;
+  }
+  return received;
+}
+
 void CActiveAE::SFlushStream(CActiveAEStream *stream)
 {
   while (!stream->m_processingSamples.empty())
@@ -1472,6 +1524,14 @@ void CActiveAE::SFlushStream(CActiveAEStream *stream)
     stream->m_processingSamples.front()->Return();
     stream->m_processingSamples.pop_front();
   }
+  // the stream waits for the flush to complete, the engine may
+  // consume both of its queues meanwhile
+  CSampleBuffer *buffer;
+  while (stream->m_freeQueue.Pop(buffer))
+    ;
+  CStreamSample sample;
+  while (stream->m_sampleQueue.Pop(sample))
+    ;
   stream->m_processingBuffers->Flush();
   stream->m_streamPort->Purge();
   stream->m_bufferedTime = 0.0;
@@ -1752,6 +1812,7 @@ bool CActiveAE::InitSink()
     {
       m_sinkFormat = data->format;
       m_sinkHasVolume = data->hasVolume;
+      m_sinkBufferAccess = data->bufferAccess;
       m_stats.SetSinkCacheTotal(data->cacheTotal);
       m_stats.SetSinkLatency(data->latency);
       m_stats.SetCurrentSinkFormat(m_sinkFormat);
@@ -1856,14 +1917,24 @@ bool CActiveAE::RunStages()
       float buftime = (float)(*it)->m_inputBuffers->m_format.m_frames / (*it)->m_inputBuffers->m_format.m_sampleRate;
       if ((*it)->m_inputBuffers->m_format.m_dataFormat == AE_FMT_RAW)
         buftime = (*it)->m_inputBuffers->m_format.m_streamInfo.GetDuration() / 1000;
+      bool provided = false;
       while ((time < MAX_CACHE_LEVEL || (*it)->m_streamIsBuffering) && !(*it)->m_inputBuffers->m_freeSamples.empty())
       {
         buffer = (*it)->m_inputBuffers->GetFreeBuffer();
-        (*it)->m_processingSamples.push_back(buffer);
-        (*it)->m_streamPort->SendInMessage(CActiveAEDataProtocol::STREAMBUFFER, &buffer, sizeof(CSampleBuffer*));
         (*it)->IncFreeBuffers();
+        if (!(*it)->m_freeQueue.Push(buffer))
+        {
+          (*it)->DecFreeBuffers();
+          buffer->Return();
+          break;
+        }
+        (*it)->m_processingSamples.push_back(buffer);
+        provided = true;
         time += buftime;
       }
+      // wake the stream once for all buffers
+      if (provided)
+        (*it)->m_inMsgEvent.Set();
     }
     else
     {
@@ -1952,6 +2023,7 @@ bool CActiveAE::RunStages()
           allStreamsReady = false;
       }
 
+      const AEKernels &kernels = CAEKernels::Get();
       bool needClamp = false;
       for (it = m_streams.begin(); it != m_streams.end() && allStreamsReady; ++it)
       {
@@ -2034,15 +2106,7 @@ bool CActiveAE::RunStages()
 
               for(int j=0; j<out->pkt->planes; j++)
               {
-#if defined(HAVE_SSE) && defined(__SSE__)
-                CAEUtil::SSEMulArray((float*)out->pkt->data[j]+i*nb_floats, volume, nb_floats);
-#else
-                float* fbuffer = (float*) out->pkt->data[j]+i*nb_floats;
-                for (int k = 0; k < nb_floats; ++k)
-                {
-                  fbuffer[k] *= volume;
-                }
-#endif
+                kernels.Gain((float*)out->pkt->data[j]+i*nb_floats, volume, nb_floats);
               }
             }
           }
@@ -2103,24 +2167,9 @@ bool CActiveAE::RunStages()
               {
                 float *dst = (float*)out->pkt->data[j]+i*nb_floats;
                 float *src = (float*)mix->pkt->data[j]+i*nb_floats;
-#if defined(HAVE_SSE) && defined(__SSE__)
-                CAEUtil::SSEMulAddArray(dst, src, volume, nb_floats);
-                for (int k = 0; k < nb_floats; ++k)
-                {
-                  if (fabs(dst[k]) > 1.0f)
-                  {
-                    needClamp = true;
-                    break;
-                  }
-                }
-#else
-                for (int k = 0; k < nb_floats; ++k)
-                {
-                  dst[k] += src[k] * volume;
-                  if (fabs(dst[k]) > 1.0f)
-                    needClamp = true;
-                }
-#endif
+                kernels.Mix(dst, src, volume, nb_floats);
+                if (!needClamp && kernels.PeakAbs(dst, nb_floats) > 1.0f)
+                  needClamp = true;
               }
             }
             mix->Return();
@@ -2135,7 +2184,7 @@ bool CActiveAE::RunStages()
         int nb_floats = out->pkt->nb_samples * out->pkt->config.channels / out->pkt->planes;
         for(int i=0; i<out->pkt->planes; i++)
         {
-          CAEUtil::ClampArray((float*)out->pkt->data[i], nb_floats);
+          kernels.Clamp((float*)out->pkt->data[i], nb_floats);
         }
       }
 
@@ -2495,12 +2544,7 @@ void CActiveAE::MixSounds(CSoundPacket &dstSample)
       out = (float*)dstSample.data[j];
       sample_buffer = (float*)(it->sound->GetSound(false)->data[j]+start);
       int nb_floats = mix_samples * dstSample.config.channels / dstSample.planes;
-#if defined(HAVE_SSE) && defined(__SSE__)
-      CAEUtil::SSEMulAddArray(out, sample_buffer, volume, nb_floats);
-#else
-      for (int k = 0; k < nb_floats; ++k)
-        *out++ += *sample_buffer++ * volume;
-#endif
+      CAEKernels::Get().Mix(out, sample_buffer, volume, nb_floats);
     }
 
     it->samples_played += mix_samples;
@@ -2526,13 +2570,7 @@ void CActiveAE::Deamplify(CSoundPacket &dstSample)
     for(int j=0; j<dstSample.planes; j++)
     {
       buffer = (float*)dstSample.data[j];
-#if defined(HAVE_SSE) && defined(__SSE__)
-      CAEUtil::SSEMulArray(buffer, volume, nb_floats);
-#else
-      float *fbuffer = buffer;
-      for (int i = 0; i < nb_floats; i++)
-        *fbuffer++ *= volume;
-#endif
+      CAEKernels::Get().Gain(buffer, volume, nb_floats);
     }
   }
 }
@@ -0,0 +1,416 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+#include "ActiveAEResamplePolyphase.h"
+#include "ActiveAEResampleFFMPEG.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+
+extern "C" {
+#include "libavutil/samplefmt.h"
+}
+
+// steps between two taps, the coefficients in between are interpolated
+#define FILTER_PHASES 256
+#define MAX_TAPS 1024
+#define KAISER_BETA 9.0
+
+namespace ActiveAE
+{
+
+struct PolyphaseFilter
+{
+  unsigned int taps;
+  double cutoff;
+  // FILTER_PHASES + 1 rows of taps, row p is for the output falling p / FILTER_PHASES
+  // past the middle tap. diff holds the step from one row to the next
+  std::vector<float> bank;
+  std::vector<float> diff;
+};
+
+}
+
+using namespace ActiveAE;
+
+static double BesselI0(double x)
+{
+  double sum = 1.0;
+  double term = 1.0;
+  for (int k = 1; k < 50; k++)
+  {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum += term;
+    if (term < sum * 1e-12)
+      break;
+  }
+  return sum;
+}
+
+static std::shared_ptr<const PolyphaseFilter> CreateFilter(unsigned int taps, double cutoff)
+{
+  std::shared_ptr<PolyphaseFilter> filter(new PolyphaseFilter);
+  filter->taps = taps;
+  filter->cutoff = cutoff;
+  filter->bank.resize((FILTER_PHASES + 1) * taps);
+  filter->diff.resize(FILTER_PHASES * taps);
+
+  const double half = taps / 2;
+  const double norm = BesselI0(KAISER_BETA);
+  std::vector<double> row(taps);
+  for (unsigned int p = 0; p <= FILTER_PHASES; p++)
+  {
+    double sum = 0.0;
+    for (unsigned int k = 0; k < taps; k++)
+    {
+      // distance of the tap to the output in input samples
+      double x = k - (half - 1) - static_cast<double>(p) / FILTER_PHASES;
+      double t = x / half;
+      double window = fabs(t) < 1.0 ? BesselI0(KAISER_BETA * sqrt(1.0 - t * t)) / norm : 0.0;
+      double arg = M_PI * cutoff * x;
+      double sinc = fabs(arg) < 1e-9 ? 1.0 : sin(arg) / arg;
+      row[k] = cutoff * sinc * window;
+      sum += row[k];
+    }
+
+    // unity gain for dc in every phase
+    for (unsigned int k = 0; k < taps; k++)
+      filter->bank[p * taps + k] = static_cast<float>(row[k] / sum);
+  }
+
+  for (unsigned int p = 0; p < FILTER_PHASES; p++)
+  {
+    for (unsigned int k = 0; k < taps; k++)
+      filter->diff[p * taps + k] = filter->bank[(p + 1) * taps + k] - filter->bank[p * taps + k];
+  }
+  return filter;
+}
+
+// resamplers are set up for every stream and often for the same rates,
+// the banks are shared as long as one of them is in use
+static std::shared_ptr<const PolyphaseFilter> GetFilter(unsigned int taps, double cutoff)
+{
+  static CCriticalSection section;
+  static std::vector<std::weak_ptr<const PolyphaseFilter> > filters;
+
+  CSingleLock lock(section);
+  std::shared_ptr<const PolyphaseFilter> filter;
+  for (std::vector<std::weak_ptr<const PolyphaseFilter> >::iterator it = filters.begin(); it != filters.end();)
+  {
+    std::shared_ptr<const PolyphaseFilter> cached = it->lock();
+    if (!cached)
+    {
+      it = filters.erase(it);
+      continue;
+    }
+    if (cached->taps == taps && cached->cutoff == cutoff)
+      filter = cached;
+    ++it;
+  }
+
+  if (!filter)
+  {
+    filter = CreateFilter(taps, cutoff);
+    filters.push_back(filter);
+  }
+  return filter;
+}
+
+CActiveAEResamplePolyphase::CActiveAEResamplePolyphase()
+  : m_src_rate(0),
+    m_dst_rate(0),
+    m_src_channels(0),
+    m_dst_channels(0),
+    m_src_fmt(AV_SAMPLE_FMT_NONE),
+    m_dst_fmt(AV_SAMPLE_FMT_NONE),
+    m_doesResample(false),
+    m_kernels(CAEKernels::Get()),
+    m_frames(0),
+    m_start(0),
+    m_frac(0.0),
+    m_flushed(false)
+{
+}
+
+CActiveAEResamplePolyphase::~CActiveAEResamplePolyphase()
+{
+}
+
+bool CActiveAEResamplePolyphase::Init(uint64_t dst_chan_layout, int dst_channels, int dst_rate, AVSampleFormat dst_fmt, int dst_bits, int dst_dither, uint64_t src_chan_layout, int src_channels, int src_rate, AVSampleFormat src_fmt, int src_bits, int src_dither, bool upmix, bool normalize, CAEChannelInfo *remapLayout, AEQuality quality, bool force_resample)
+{
+  m_src_rate = src_rate;
+  m_dst_rate = dst_rate;
+  m_src_channels = src_channels;
+  m_dst_channels = dst_channels;
+  m_src_fmt = src_fmt;
+  m_dst_fmt = dst_fmt;
+  m_doesResample = (src_rate != dst_rate) || force_resample;
+
+  // without a rate change swresample does the whole job
+  if (!m_doesResample)
+  {
+    m_convertIn.reset(new CActiveAEResampleFFMPEG());
+    return m_convertIn->Init(dst_chan_layout, dst_channels, dst_rate, dst_fmt, dst_bits, dst_dither,
+                             src_chan_layout, src_channels, src_rate, src_fmt, src_bits, src_dither,
+                             upmix, normalize, remapLayout, quality, force_resample);
+  }
+
+  // the rate is converted after mixing to the destination layout,
+  // on the fewer channels when downmixing
+  if (src_fmt != AV_SAMPLE_FMT_FLTP || src_chan_layout != dst_chan_layout ||
+      src_channels != dst_channels || remapLayout)
+  {
+    m_convertIn.reset(new CActiveAEResampleFFMPEG());
+    if (!m_convertIn->Init(dst_chan_layout, dst_channels, src_rate, AV_SAMPLE_FMT_FLTP, 32, 0,
+                           src_chan_layout, src_channels, src_rate, src_fmt, src_bits, src_dither,
+                           upmix, normalize, remapLayout, quality, false))
+      return false;
+  }
+
+  if (dst_fmt != AV_SAMPLE_FMT_FLTP)
+  {
+    m_convertOut.reset(new CActiveAEResampleFFMPEG());
+    if (!m_convertOut->Init(dst_chan_layout, dst_channels, dst_rate, dst_fmt, dst_bits, dst_dither,
+                            dst_chan_layout, dst_channels, dst_rate, AV_SAMPLE_FMT_FLTP, 32, 0,
+                            false, true, NULL, quality, false))
+      return false;
+  }
+
+  // same filter lengths and cutoffs as for swresample
+  unsigned int taps;
+  double cutoff;
+  if (quality == AE_QUALITY_HIGH)
+  {
+    taps = 256;
+    cutoff = 1.0;
+  }
+  else if (quality == AE_QUALITY_MID)
+  {
+    taps = 64;
+    cutoff = 0.985;
+  }
+  else
+  {
+    taps = 32;
+    cutoff = 0.97;
+  }
+
+  // when going down the filter has to cut at the new nyquist frequency,
+  // it gets longer to keep the transition band as steep
+  if (dst_rate < src_rate)
+  {
+    double factor = static_cast<double>(dst_rate) / src_rate;
+    cutoff *= factor;
+    taps = static_cast<unsigned int>(ceil(taps / factor));
+  }
+  taps = std::min((taps + 7) & ~7U, static_cast<unsigned int>(MAX_TAPS));
+
+  m_filter = GetFilter(taps, cutoff);
+  m_coeffs.resize(taps);
+
+  // history of silence, so that the first output lines up with the first input
+  m_frames = taps / 2 - 1;
+  m_start = 0;
+  m_frac = 0.0;
+  m_flushed = false;
+  m_input.assign(dst_channels, std::vector<float>(m_frames, 0.0f));
+  m_inputPlanes.resize(dst_channels);
+  m_output.assign(dst_channels, std::vector<float>());
+  m_outputPlanes.resize(dst_channels);
+
+  CLog::Log(LOGDEBUG, "CActiveAEResamplePolyphase::Init - %d -> %d Hz, %u taps, cutoff %f",
+            src_rate, dst_rate, taps, cutoff);
+  return true;
+}
+
+int CActiveAEResamplePolyphase::Resample(uint8_t **dst_buffer, int dst_samples, uint8_t **src_buffer, int src_samples, double ratio)
+{
+  if (!m_doesResample)
+    return m_convertIn->Resample(dst_buffer, dst_samples, src_buffer, src_samples, ratio);
+
+  if (src_buffer && src_samples > 0)
+  {
+    if (!AddInput(src_buffer, src_samples))
+      return -1;
+  }
+
+  float **dst = reinterpret_cast<float**>(dst_buffer);
+  if (m_convertOut)
+  {
+    for (int ch = 0; ch < m_dst_channels; ch++)
+    {
+      if (m_output[ch].size() < static_cast<size_t>(dst_samples))
+        m_output[ch].resize(dst_samples);
+      m_outputPlanes[ch] = m_output[ch].data();
+    }
+    dst = m_outputPlanes.data();
+  }
+
+  // a ratio only changes how far the filter moves per output sample
+  double step = static_cast<double>(m_src_rate) / (m_dst_rate * ratio);
+  int samples = Filter(dst, dst_samples, step);
+
+  // without input, once nothing is left to filter, push out what the
+  // filter still holds back by adding silence. WantsNewSamples keeps the
+  // engine from skipping input while the filter is short of it, so that
+  // only happens on a drain or when the resampler is replaced
+  if (!src_buffer && samples == 0 && dst_samples > 0 && !m_flushed)
+  {
+    unsigned int pad = m_filter->taps / 2;
+    for (int ch = 0; ch < m_dst_channels; ch++)
+      m_input[ch].resize(m_frames + pad, 0.0f);
+    m_frames += pad;
+    m_flushed = true;
+    samples = Filter(dst, dst_samples, step);
+  }
+
+  if (m_convertOut && samples > 0)
+    return m_convertOut->Resample(dst_buffer, dst_samples, reinterpret_cast<uint8_t**>(m_outputPlanes.data()), samples, 1.0);
+
+  return samples;
+}
+
+bool CActiveAEResamplePolyphase::AddInput(uint8_t **src_buffer, int src_samples)
+{
+  for (int ch = 0; ch < m_dst_channels; ch++)
+  {
+    m_input[ch].resize(m_frames + src_samples);
+    m_inputPlanes[ch] = m_input[ch].data() + m_frames;
+  }
+
+  int samples = src_samples;
+  if (m_convertIn)
+  {
+    samples = m_convertIn->Resample(reinterpret_cast<uint8_t**>(m_inputPlanes.data()), src_samples, src_buffer, src_samples, 1.0);
+    if (samples < 0)
+    {
+      CLog::Log(LOGERROR, "CActiveAEResamplePolyphase::AddInput - conversion failed");
+      return false;
+    }
+  }
+  else
+  {
+    for (int ch = 0; ch < m_dst_channels; ch++)
+      memcpy(m_inputPlanes[ch], src_buffer[ch], src_samples * sizeof(float));
+  }
+
+  m_frames += samples;
+  for (int ch = 0; ch < m_dst_channels; ch++)
+    m_input[ch].resize(m_frames);
+  m_flushed = false;
+  return true;
+}
+
+int CActiveAEResamplePolyphase::Filter(float **dst, int dst_samples, double step)
+{
+  const PolyphaseFilter &filter = *m_filter;
+  const unsigned int taps = filter.taps;
+  int samples = 0;
+  while (samples < dst_samples && m_start + taps <= m_frames)
+  {
+    double position = m_frac * FILTER_PHASES;
+    unsigned int phase = static_cast<unsigned int>(position);
+    float blend = static_cast<float>(position - phase);
+
+    const float *coeffs = &filter.bank[phase * taps];
+    if (blend > 0.0f)
+    {
+      memcpy(m_coeffs.data(), coeffs, taps * sizeof(float));
+      m_kernels.Mix(m_coeffs.data(), &filter.diff[phase * taps], blend, taps);
+      coeffs = m_coeffs.data();
+    }
+
+    for (int ch = 0; ch < m_dst_channels; ch++)
+      dst[ch][samples] = m_kernels.Dot(m_input[ch].data() + m_start, coeffs, taps);
+    samples++;
+
+    m_frac += step;
+    unsigned int advance = static_cast<unsigned int>(m_frac);
+    m_frac -= advance;
+    m_start += advance;
+  }
+
+  // drop the input the filter has passed
+  unsigned int used = std::min(m_start, m_frames);
+  if (used > 0)
+  {
+    for (int ch = 0; ch < m_dst_channels; ch++)
+      m_input[ch].erase(m_input[ch].begin(), m_input[ch].begin() + used);
+    m_frames -= used;
+    m_start -= used;
+  }
+  return samples;
+}
+
+double CActiveAEResamplePolyphase::GetPendingInput()
+{
+  // input up to the output position has been used, silence added on drain does not count
+  double pending = m_frames - (m_start + m_filter->taps / 2 - 1) - m_frac;
+  if (m_flushed)
+    pending -= m_filter->taps / 2;
+  return std::max(pending, 0.0);
+}
+
+bool CActiveAEResamplePolyphase::WantsNewSamples(int samples)
+{
+  if (!m_doesResample)
+    return m_convertIn->WantsNewSamples(samples);
+
+  // called without input the filter would take it for a drain
+  if (m_start + m_filter->taps > m_frames)
+    return true;
+
+  return GetBufferedSamples() <= samples * 2;
+}
+
+int64_t CActiveAEResamplePolyphase::GetDelay(int64_t base)
+{
+  if (!m_doesResample)
+    return m_convertIn->GetDelay(base);
+
+  return static_cast<int64_t>(GetPendingInput() * base / m_src_rate);
+}
+
+int CActiveAEResamplePolyphase::GetBufferedSamples()
+{
+  if (!m_doesResample)
+    return m_convertIn->GetBufferedSamples();
+
+  return static_cast<int>(ceil(GetPendingInput() * m_dst_rate / m_src_rate));
+}
+
+int CActiveAEResamplePolyphase::CalcDstSampleCount(int src_samples, int dst_rate, int src_rate)
+{
+  return static_cast<int>((static_cast<int64_t>(src_samples) * dst_rate + src_rate - 1) / src_rate);
+}
+
+int CActiveAEResamplePolyphase::GetSrcBufferSize(int samples)
+{
+  return av_samples_get_buffer_size(NULL, m_src_channels, samples, m_src_fmt, 1);
+}
+
+int CActiveAEResamplePolyphase::GetDstBufferSize(int samples)
+{
+  return av_samples_get_buffer_size(NULL, m_dst_channels, samples, m_dst_fmt, 1);
+}
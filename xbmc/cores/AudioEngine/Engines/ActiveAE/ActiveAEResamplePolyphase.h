@@ -0,0 +1,87 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <memory>
+#include <vector>
+
+#include "cores/AudioEngine/Interfaces/AEResample.h"
+#include "cores/AudioEngine/Utils/AEKernels.h"
+
+namespace ActiveAE
+{
+
+class CActiveAEResampleFFMPEG;
+struct PolyphaseFilter;
+
+/*!
+ \brief Sample rate conversion with a windowed sinc filter bank.
+
+ The rate is converted on planar float. Formats and channel layouts are
+ converted by swresample before and after, at a fixed rate so that it never
+ has to be set up again. The resample ratio only changes the step between
+ output samples, the filter stays the same.
+ */
+class CActiveAEResamplePolyphase : public IAEResample
+{
+public:
+  const char *GetName() { return "ActiveAEResamplePolyphase"; }
+  CActiveAEResamplePolyphase();
+  virtual ~CActiveAEResamplePolyphase();
+  bool Init(uint64_t dst_chan_layout, int dst_channels, int dst_rate, AVSampleFormat dst_fmt, int dst_bits, int dst_dither, uint64_t src_chan_layout, int src_channels, int src_rate, AVSampleFormat src_fmt, int src_bits, int src_dither, bool upmix, bool normalize, CAEChannelInfo *remapLayout, AEQuality quality, bool force_resample);
+  int Resample(uint8_t **dst_buffer, int dst_samples, uint8_t **src_buffer, int src_samples, double ratio);
+  int64_t GetDelay(int64_t base);
+  int GetBufferedSamples();
+  bool WantsNewSamples(int samples);
+  int CalcDstSampleCount(int src_samples, int dst_rate, int src_rate);
+  int GetSrcBufferSize(int samples);
+  int GetDstBufferSize(int samples);
+
+protected:
+  bool AddInput(uint8_t **src_buffer, int src_samples);
+  int Filter(float **dst, int dst_samples, double step);
+  double GetPendingInput();
+
+  int m_src_rate, m_dst_rate;
+  int m_src_channels, m_dst_channels;
+  AVSampleFormat m_src_fmt, m_dst_fmt;
+  bool m_doesResample;
+
+  // conversions before and after, not set if the data is planar float already
+  std::unique_ptr<CActiveAEResampleFFMPEG> m_convertIn;
+  std::unique_ptr<CActiveAEResampleFFMPEG> m_convertOut;
+
+  const AEKernels &m_kernels;
+  std::shared_ptr<const PolyphaseFilter> m_filter;
+  std::vector<float> m_coeffs;
+
+  // input per channel, the filter starts at m_start and is m_frac past it
+  std::vector<std::vector<float> > m_input;
+  std::vector<float*> m_inputPlanes;
+  unsigned int m_frames;
+  unsigned int m_start;
+  double m_frac;
+  bool m_flushed;
+
+  std::vector<std::vector<float> > m_output;
+  std::vector<float*> m_outputPlanes;
+};
+
+}
@@ -24,6 +24,7 @@
 #include "cores/AudioEngine/Utils/AEUtil.h"
 #include "cores/AudioEngine/Utils/AEStreamInfo.h"
 #include "cores/AudioEngine/Utils/AEBitstreamPacker.h"
+#include "cores/AudioEngine/Utils/AEKernels.h"
 #include "utils/EndianSwap.h"
 #include "ActiveAE.h"
 #include "cores/AudioEngine/AEResampleFactory.h"
@@ -49,6 +50,8 @@ CActiveAESink::CActiveAESink(CEvent *inMsgEvent) :
   m_volume = 0.0;
   m_packer = nullptr;
   m_streamNoise = true;
+  m_bufferAccess = false;
+  m_planeMapLayout = 0;
 }
 
 void CActiveAESink::Start()
@@ -281,6 +284,7 @@ void CActiveAESink::StateMachine(int signal, Protocol *port, Message *msg)
             reply.cacheTotal = m_sink->GetCacheTotal();
             reply.latency = m_sink->GetLatency();
             reply.hasVolume = m_sink->HasVolume();
+            reply.bufferAccess = m_bufferAccess;
             m_state = S_TOP_CONFIGURED_IDLE;
             m_extTimeout = 10000;
             m_sinkLatency = (int64_t)(reply.latency * 1000);
@@ -809,6 +813,7 @@ void CActiveAESink::OpenSink()
     delete m_sink;
     m_sink = nullptr;
   }
+  m_bufferAccess = false;
 
   // get the display name of the device
   GetDeviceFriendlyName(device);
@@ -875,6 +880,23 @@ void CActiveAESink::OpenSink()
   CLog::Log(LOGDEBUG, "  Frames        : %d", m_sinkFormat.m_frames);
   CLog::Log(LOGDEBUG, "  Frame Size    : %d", m_sinkFormat.m_frameSize);
 
+  // float samples are converted straight into the memory of the sink,
+  // for the formats the kernels can produce
+  m_bufferAccess = !passthrough && m_sink->HasBufferAccess() &&
+                   (m_sinkFormat.m_dataFormat == AE_FMT_FLOAT ||
+                    m_sinkFormat.m_dataFormat == AE_FMT_S16NE ||
+                    m_sinkFormat.m_dataFormat == AE_FMT_S32NE);
+  m_planeMapLayout = 0;
+  m_silentPlane.clear();
+  m_interleaveBuffer.clear();
+  if (m_bufferAccess)
+  {
+    m_silentPlane.resize(m_sinkFormat.m_frames, 0.0f);
+    if (m_sinkFormat.m_dataFormat != AE_FMT_FLOAT)
+      m_interleaveBuffer.resize(m_sinkFormat.m_frames * m_sinkFormat.m_channelLayout.Count());
+  }
+  CLog::Log(LOGDEBUG, "  Buffer Access : %s", m_bufferAccess ? "yes" : "no");
+
   // init sample of silence
   SampleConfig config;
   config.fmt = CAEUtil::GetAVSampleFormat(m_sinkFormat.m_dataFormat);
@@ -916,6 +938,11 @@ void CActiveAESink::ReturnBuffers()
 
 unsigned int CActiveAESink::OutputSamples(CSampleBuffer* samples)
 {
+  // the engine leaves conversion to us if the sink has buffer access,
+  // silence is prepared in the format of the sink though
+  if (m_bufferAccess && samples->pkt->config.fmt == AV_SAMPLE_FMT_FLTP)
+    return OutputSamplesToBuffer(samples);
+
   uint8_t **buffer = samples->pkt->data;
   uint8_t *packBuffer;
   unsigned int frames = samples->pkt->nb_samples;
@@ -1067,6 +1094,101 @@ unsigned int CActiveAESink::OutputSamples(CSampleBuffer* samples)
   return status.delay * 1000;
 }
 
+unsigned int CActiveAESink::OutputSamplesToBuffer(CSampleBuffer* samples)
+{
+  const AEKernels &kernels = CAEKernels::Get();
+  unsigned int channels = m_sinkFormat.m_channelLayout.Count();
+  unsigned int frames = samples->pkt->nb_samples;
+  unsigned int offset = 0;
+  int retry = 0;
+  AEDelayStatus status;
+  const float *planes[AE_CH_MAX];
+
+  UpdatePlaneMap(samples->pkt->config.channel_layout);
+
+  while (offset < frames)
+  {
+    uint8_t *buffer = nullptr;
+    unsigned int available = m_sink->GetBuffer(buffer, std::min(frames - offset, m_sinkFormat.m_frames));
+    if (available == 0 || buffer == nullptr)
+    {
+      Sleep(500*m_sinkFormat.m_frames/m_sinkFormat.m_sampleRate);
+      retry++;
+      if (retry > 4)
+      {
+        m_extError = true;
+        CLog::Log(LOGERROR, "CActiveAESink::OutputSamplesToBuffer - failed");
+        status.SetDelay(0);
+        m_stats->UpdateSinkDelay(status, samples->pool ? frames - offset : 0);
+        return 0;
+      }
+      continue;
+    }
+    // never interleave past the packet, whatever the sink offers
+    available = std::min(available, std::min(frames - offset, m_sinkFormat.m_frames));
+
+    // the planes are in ffmpeg order, the sink gets them in its own
+    for (unsigned int ch = 0; ch < channels; ch++)
+    {
+      if (m_planeMap[ch] < 0)
+        planes[ch] = m_silentPlane.data();
+      else
+        planes[ch] = (float*)samples->pkt->data[m_planeMap[ch]] + offset;
+    }
+
+    if (m_sinkFormat.m_dataFormat == AE_FMT_FLOAT)
+      kernels.Interleave((float*)buffer, planes, channels, available);
+    else
+    {
+      // one period of interleaved samples stays in cache for the conversion
+      kernels.Interleave(m_interleaveBuffer.data(), planes, channels, available);
+      if (m_sinkFormat.m_dataFormat == AE_FMT_S16NE)
+        kernels.FloatToS16((int16_t*)buffer, m_interleaveBuffer.data(), available * channels, nullptr);
+      else
+        kernels.FloatToS32((int32_t*)buffer, m_interleaveBuffer.data(), available * channels);
+    }
+
+    unsigned int written = m_sink->CommitBuffer(available);
+    if (written > available)
+    {
+      m_extError = true;
+      CLog::Log(LOGERROR, "CActiveAESink::OutputSamplesToBuffer - sink returned error");
+      status.SetDelay(0);
+      m_stats->UpdateSinkDelay(status, samples->pool ? frames - offset : 0);
+      return 0;
+    }
+    offset += written;
+
+    m_sink->GetDelay(status);
+    m_stats->UpdateSinkDelay(status, samples->pool ? written : 0);
+  }
+
+  return status.delay * 1000;
+}
+
+void CActiveAESink::UpdatePlaneMap(uint64_t channelLayout)
+{
+  if (channelLayout == m_planeMapLayout)
+    return;
+
+  // channels the engine does not provide, i.e. when a sink opened with more
+  // channels than requested, are silent
+  CAEChannelInfo layout = CAEUtil::GetAEChannelLayout(channelLayout);
+  for (unsigned int ch = 0; ch < m_sinkFormat.m_channelLayout.Count(); ch++)
+  {
+    m_planeMap[ch] = -1;
+    for (unsigned int i = 0; i < layout.Count(); i++)
+    {
+      if (layout[i] == m_sinkFormat.m_channelLayout[ch])
+      {
+        m_planeMap[ch] = i;
+        break;
+      }
+    }
+  }
+  m_planeMapLayout = channelLayout;
+}
+
 void CActiveAESink::SwapInit(CSampleBuffer* samples)
 {
   if ((m_requestedFormat.m_dataFormat == AE_FMT_RAW) && CAEUtil::S16NeedsByteSwap(AE_FMT_S16NE, m_sinkFormat.m_dataFormat))
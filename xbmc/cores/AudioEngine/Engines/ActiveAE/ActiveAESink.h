@@ -19,6 +19,8 @@
  *
  */
 
+#include <vector>
+
 #include "threads/Event.h"
 #include "threads/Thread.h"
 #include "utils/ActorProtocol.h"
@@ -48,6 +50,7 @@ struct SinkReply
   float cacheTotal;
   float latency;
   bool hasVolume;
+  bool bufferAccess;
 };
 
 class CSinkControlProtocol : public Protocol
@@ -116,6 +119,8 @@ protected:
   bool NeedIECPacking();
 
   unsigned int OutputSamples(CSampleBuffer* samples);
+  unsigned int OutputSamplesToBuffer(CSampleBuffer* samples);
+  void UpdatePlaneMap(uint64_t channelLayout);
   void SwapInit(CSampleBuffer* samples);
 
   void GenerateNoise();
@@ -152,6 +157,13 @@ protected:
   CAEBitstreamPacker *m_packer;
   bool m_needIecPack;
   bool m_streamNoise;
+
+  // direct output into the memory of sinks with buffer access
+  bool m_bufferAccess;
+  uint64_t m_planeMapLayout;
+  int m_planeMap[AE_CH_MAX];
+  std::vector<float> m_silentPlane;
+  std::vector<float> m_interleaveBuffer;
 };
 
 }
@@ -21,6 +21,10 @@
 #include "system.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
+#include "utils/TimeUtils.h"
+#if defined(TARGET_POSIX)
+#include "linux/XTimeUtils.h"
+#endif
 
 #include "cores/AudioEngine/Utils/AEUtil.h"
 #include "cores/AudioEngine/AEResampleFactory.h"
@@ -30,8 +34,13 @@
 
 using namespace ActiveAE;
 
+// more than a stream buffer pool holds
+#define STREAM_QUEUE_SIZE 512
+
 
 CActiveAEStream::CActiveAEStream(AEAudioFormat *format, unsigned int streamid, CActiveAE *ae)
+  : m_freeQueue(STREAM_QUEUE_SIZE),
+    m_sampleQueue(STREAM_QUEUE_SIZE)
 {
   m_activeAE = ae;
   m_format = *format;
@@ -68,6 +77,9 @@ CActiveAEStream::CActiveAEStream(AEAudioFormat *format, unsigned int streamid, C
   m_lastPtsJump = 0;
   m_errorInterval = 1000;
   m_clockSpeed = 1.0;
+  m_engineEvent = NULL;
+  m_queueLatency.fill(0);
+  m_queueLatencyTimer.Set(1000);
 }
 
 CActiveAEStream::~CActiveAEStream()
@@ -79,22 +91,41 @@ CActiveAEStream::~CActiveAEStream()
 
 void CActiveAEStream::IncFreeBuffers()
 {
-  CSingleLock lock(m_streamLock);
   m_streamFreeBuffers++;
 }
 
 void CActiveAEStream::DecFreeBuffers()
 {
-  CSingleLock lock(m_streamLock);
   m_streamFreeBuffers--;
 }
 
 void CActiveAEStream::ResetFreeBuffers()
 {
-  CSingleLock lock(m_streamLock);
   m_streamFreeBuffers = 0;
 }
 
+void CActiveAEStream::QueueSample(CSampleBuffer *buffer)
+{
+  CStreamSample sample;
+  sample.buffer = buffer;
+  sample.queued = CurrentHostCounter();
+
+  // can't be full as long as the pool has less buffers than the queue
+  while (!m_sampleQueue.Push(sample))
+    Sleep(1);
+
+  // the engine takes everything queued once woken, a buffer is a full period
+  m_engineEvent->Set();
+}
+
+void CActiveAEStream::AddQueueLatency(int64_t ms)
+{
+  unsigned int bucket = 0;
+  while (bucket < m_queueLatency.size() - 1 && ms >= (1 << bucket))
+    bucket++;
+  m_queueLatency[bucket]++;
+}
+
 void CActiveAEStream::InitRemapper()
 {
   // check if input format follows ffmpeg channel mask
@@ -226,7 +257,6 @@ double CActiveAEStream::CalcResampleRatio(double error)
 
 unsigned int CActiveAEStream::GetSpace()
 {
-  CSingleLock lock(m_streamLock);
   if (m_format.m_dataFormat == AE_FMT_RAW)
     return m_streamFreeBuffers;
   else
@@ -304,33 +334,25 @@ unsigned int CActiveAEStream::AddData(const uint8_t* const *data, unsigned int o
 
       if (m_currentBuffer->pkt->nb_samples == m_currentBuffer->pkt->max_nb_samples || rawPktComplete)
       {
-        MsgStreamSample msgData;
-        msgData.buffer = m_currentBuffer;
-        msgData.stream = this;
         RemapBuffer();
-        m_streamPort->SendOutMessage(CActiveAEDataProtocol::STREAMSAMPLE, &msgData, sizeof(MsgStreamSample));
+        QueueSample(m_currentBuffer);
         m_currentBuffer = NULL;
       }
       continue;
     }
+    else if (m_freeQueue.Pop(m_currentBuffer))
+    {
+      m_currentBuffer->timestamp = 0;
+      m_currentBuffer->pkt->nb_samples = 0;
+      m_currentBuffer->pkt->pause_burst_ms = 0;
+      DecFreeBuffers();
+      continue;
+    }
     else if (m_streamPort->ReceiveInMessage(&msg))
     {
-      if (msg->signal == CActiveAEDataProtocol::STREAMBUFFER)
-      {
-        m_currentBuffer = *((CSampleBuffer**)msg->data);
-        m_currentBuffer->timestamp = 0;
-        m_currentBuffer->pkt->nb_samples = 0;
-        m_currentBuffer->pkt->pause_burst_ms = 0;
-        msg->Release();
-        DecFreeBuffers();
-        continue;
-      }
-      else
-      {
-        CLog::Log(LOGERROR, "CActiveAEStream::AddData - unknown signal");
-        msg->Release();
-        break;
-      }
+      CLog::Log(LOGERROR, "CActiveAEStream::AddData - unknown signal");
+      msg->Release();
+      break;
     }
     if (!m_inMsgEvent.WaitMSec(200))
       break;
@@ -401,29 +423,26 @@ void CActiveAEStream::Drain(bool wait)
 
   if (m_currentBuffer)
   {
-    MsgStreamSample msgData;
-    msgData.buffer = m_currentBuffer;
-    msgData.stream = this;
     RemapBuffer();
-    m_streamPort->SendOutMessage(CActiveAEDataProtocol::STREAMSAMPLE, &msgData, sizeof(MsgStreamSample));
+    QueueSample(m_currentBuffer);
     m_currentBuffer = NULL;
   }
 
   XbmcThreads::EndTime timer(2000);
   while (!timer.IsTimePast())
   {
-    if (m_streamPort->ReceiveInMessage(&msg))
+    CSampleBuffer *buffer;
+    if (m_freeQueue.Pop(buffer))
     {
-      if (msg->signal == CActiveAEDataProtocol::STREAMBUFFER)
-      {
-        MsgStreamSample msgData;
-        msgData.stream = this;
-        msgData.buffer = *((CSampleBuffer**)msg->data);
-        msg->Reply(CActiveAEDataProtocol::STREAMSAMPLE, &msgData, sizeof(MsgStreamSample));
-        DecFreeBuffers();
-        continue;
-      }
-      else if (msg->signal == CActiveAEDataProtocol::STREAMDRAINED)
+      // hand back unused buffers empty
+      buffer->pkt->nb_samples = 0;
+      QueueSample(buffer);
+      DecFreeBuffers();
+      continue;
+    }
+    else if (m_streamPort->ReceiveInMessage(&msg))
+    {
+      if (msg->signal == CActiveAEDataProtocol::STREAMDRAINED)
       {
         msg->Release();
         return;
@@ -22,6 +22,9 @@
 #include "cores/AudioEngine/Interfaces/AEStream.h"
 #include "cores/AudioEngine/Utils/AEAudioFormat.h"
 #include "cores/AudioEngine/Utils/AELimiter.h"
+#include "cores/DataCacheCore.h"
+#include "threads/SPSCQueue.h"
+#include "threads/SystemClock.h"
 #include <atomic>
 
 namespace ActiveAE
@@ -123,6 +126,16 @@ protected:
   CActiveAEBufferPoolAtempo *m_atempoBuffers;
 };
 
+/**
+ * a filled buffer on its way from a stream to the engine, stamped
+ * with the time it was queued
+ */
+struct CStreamSample
+{
+  CSampleBuffer *buffer;
+  int64_t queued;
+};
+
 class CActiveAEStream : public IAEStream
 {
 protected:
@@ -137,6 +150,8 @@ protected:
   void InitRemapper();
   void RemapBuffer();
   double CalcResampleRatio(double error);
+  void QueueSample(CSampleBuffer *buffer);
+  void AddQueueLatency(int64_t ms);
 
 public:
   virtual unsigned int GetSpace();
@@ -192,7 +207,7 @@ protected:
   bool m_streamDraining;
   bool m_streamDrained;
   bool m_streamFading;
-  int m_streamFreeBuffers;
+  std::atomic_int m_streamFreeBuffers;
   bool m_streamIsBuffering;
   bool m_streamIsFlushed;
   bool m_bypassDSP;
@@ -214,6 +229,15 @@ protected:
   std::deque<CSampleBuffer*> m_processingSamples;
   CActiveAEDataProtocol *m_streamPort;
   CEvent m_inMsgEvent;
+
+  // lock-free exchange of buffers with the engine, free ones are handed
+  // to the stream, filled ones back to the engine. each side has a
+  // single producer and a single consumer
+  XbmcThreads::CSPSCQueue<CSampleBuffer*> m_freeQueue;
+  XbmcThreads::CSPSCQueue<CStreamSample> m_sampleQueue;
+  CEvent *m_engineEvent;
+  CDataCacheCore::AudioQueueLatency m_queueLatency;
+  XbmcThreads::EndTime m_queueLatencyTimer;
   bool m_drain;
   bool m_paused;
   bool m_started;
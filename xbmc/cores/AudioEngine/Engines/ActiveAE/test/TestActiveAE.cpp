@@ -0,0 +1,517 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#include "Application.h"
+#include "ServiceBroker.h"
+#include "ServiceManager.h"
+#include "cores/AudioEngine/Interfaces/AE.h"
+#include "cores/AudioEngine/Interfaces/AEStream.h"
+#include "cores/AudioEngine/Sinks/AESinkNULL.h"
+#include "cores/AudioEngine/Utils/AEPackIEC61937.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "settings/Settings.h"
+#include "test/TestUtils.h"
+#include "threads/SystemClock.h"
+#include "utils/URIUtils.h"
+#if defined(TARGET_POSIX)
+#include "linux/XTimeUtils.h"
+#endif
+
+#include "gtest/gtest.h"
+
+// the engine runs with the capture device of the NULL sink, which plays in
+// real time and hands out everything it got. outputs that do not go through
+// a resampler have to come out bit exact, the others are compared against
+// golden files recorded from the engine. set KODI_TEST_RECORD_GOLDEN to write
+// them again after a change of the output, or of ffmpeg, was checked
+
+#define GOLDEN_PATH "xbmc/cores/AudioEngine/Engines/ActiveAE/test/golden/"
+#define TEST_FREQ 1000.0
+
+namespace
+{
+std::vector<float> MakeTone(unsigned int sampleRate, unsigned int channels, unsigned int frames, float amplitude)
+{
+  std::vector<float> samples(frames * channels);
+  for (unsigned int i = 0; i < frames; i++)
+  {
+    for (unsigned int ch = 0; ch < channels; ch++)
+    {
+      // a phase per channel, so that swapped channels don't go unnoticed,
+      // and none of them starts with silence
+      double phase = 2.0 * M_PI * TEST_FREQ * i / sampleRate + 0.5 + 0.3 * ch;
+      samples[i * channels + ch] = static_cast<float>(amplitude * sin(phase));
+    }
+  }
+  return samples;
+}
+
+// frames with an ac3 sync word, the rest is never decoded
+std::vector<std::vector<uint8_t> > MakeAC3Frames(unsigned int count, unsigned int size)
+{
+  std::vector<std::vector<uint8_t> > frames(count);
+  uint32_t seed = 1;
+  for (unsigned int i = 0; i < count; i++)
+  {
+    frames[i].resize(size);
+    for (unsigned int j = 0; j < size; j++)
+    {
+      seed = seed * 1664525 + 1013904223;
+      frames[i][j] = seed >> 24;
+    }
+    frames[i][0] = 0x0B;
+    frames[i][1] = 0x77;
+  }
+  return frames;
+}
+
+std::vector<float> ToFloat(const std::vector<uint8_t> &data)
+{
+  std::vector<float> samples(data.size() / sizeof(float));
+  memcpy(samples.data(), data.data(), samples.size() * sizeof(float));
+  return samples;
+}
+
+// drops the silence the engine plays before and after the stream
+std::vector<float> TrimSilence(const std::vector<float> &samples, unsigned int channels)
+{
+  unsigned int frames = samples.size() / channels;
+  unsigned int first = 0;
+  unsigned int last = frames;
+  while (first < frames && std::all_of(&samples[first * channels], &samples[first * channels] + channels,
+                                       [](float v) { return v == 0.0f; }))
+    first++;
+  while (last > first && std::all_of(&samples[(last - 1) * channels], &samples[(last - 1) * channels] + channels,
+                                     [](float v) { return v == 0.0f; }))
+    last--;
+  return std::vector<float>(samples.begin() + first * channels, samples.begin() + last * channels);
+}
+
+// signal to noise and distortion of one channel against a fitted sine in dB,
+// leaves out the edges where resamplers settle
+double ToneSNR(const std::vector<float> &samples, unsigned int channels, unsigned int channel, unsigned int sampleRate)
+{
+  unsigned int frames = samples.size() / channels;
+  unsigned int period = sampleRate / 1000;
+  unsigned int start = frames / 10;
+  unsigned int count = (frames * 8 / 10) / period * period;
+  if (count == 0)
+    return 0.0;
+
+  double a = 0.0, b = 0.0;
+  for (unsigned int i = start; i < start + count; i++)
+  {
+    double w = 2.0 * M_PI * TEST_FREQ * i / sampleRate;
+    a += samples[i * channels + channel] * sin(w);
+    b += samples[i * channels + channel] * cos(w);
+  }
+  a *= 2.0 / count;
+  b *= 2.0 / count;
+
+  double signal = 0.0, noise = 0.0;
+  for (unsigned int i = start; i < start + count; i++)
+  {
+    double w = 2.0 * M_PI * TEST_FREQ * i / sampleRate;
+    double fit = a * sin(w) + b * cos(w);
+    double diff = samples[i * channels + channel] - fit;
+    signal += fit * fit;
+    noise += diff * diff;
+  }
+  if (noise == 0.0)
+    return 200.0;
+  return 10.0 * log10(signal / noise);
+}
+
+double RMS(const std::vector<float> &samples)
+{
+  double sum = 0.0;
+  for (float v : samples)
+    sum += v * v;
+  return samples.empty() ? 0.0 : sqrt(sum / samples.size());
+}
+
+void CompareGolden(const std::string &name, const std::vector<float> &samples)
+{
+  std::string path = XBMC_REF_FILE_PATH(std::string(GOLDEN_PATH) + name + ".f32");
+  XFILE::CFile file;
+  if (getenv("KODI_TEST_RECORD_GOLDEN"))
+  {
+    XFILE::CDirectory::Create(URIUtils::GetDirectory(path));
+    ASSERT_TRUE(file.OpenForWrite(path, true)) << path;
+    ASSERT_EQ(static_cast<ssize_t>(samples.size() * sizeof(float)), file.Write(samples.data(), samples.size() * sizeof(float)));
+    file.Close();
+    std::cout << "recorded golden output " << path << ", check and commit it" << std::endl;
+    return;
+  }
+
+  if (!file.Open(path))
+  {
+    ADD_FAILURE() << "missing golden output " << path;
+    return;
+  }
+  std::vector<float> golden(file.GetLength() / sizeof(float));
+  ASSERT_EQ(static_cast<ssize_t>(golden.size() * sizeof(float)), file.Read(golden.data(), golden.size() * sizeof(float)));
+  file.Close();
+
+  // drains may end on a different period, the start has to line up
+  EXPECT_GE(samples.size(), golden.size() * 9 / 10) << name;
+  size_t count = std::min(samples.size(), golden.size());
+  float maxDiff = 0.0f;
+  for (size_t i = 0; i < count; i++)
+    maxDiff = std::max(maxDiff, fabsf(samples[i] - golden[i]));
+
+  // swresample has cpu specific code paths
+  EXPECT_LE(maxDiff, 1e-4f) << name;
+}
+}
+
+class TestActiveAE : public testing::Test
+{
+protected:
+  TestActiveAE()
+  {
+    m_device = CServiceBroker::GetSettings().GetString(CSettings::SETTING_AUDIOOUTPUT_AUDIODEVICE);
+    m_passthroughDevice = CServiceBroker::GetSettings().GetString(CSettings::SETTING_AUDIOOUTPUT_PASSTHROUGHDEVICE);
+    m_config = CServiceBroker::GetSettings().GetInt(CSettings::SETTING_AUDIOOUTPUT_CONFIG);
+    m_channels = CServiceBroker::GetSettings().GetInt(CSettings::SETTING_AUDIOOUTPUT_CHANNELS);
+    m_sampleRate = CServiceBroker::GetSettings().GetInt(CSettings::SETTING_AUDIOOUTPUT_SAMPLERATE);
+    m_passthrough = CServiceBroker::GetSettings().GetBool(CSettings::SETTING_AUDIOOUTPUT_PASSTHROUGH);
+
+#if defined(TARGET_POSIX)
+    // lists the capture device, it has to be known for passthrough
+    setenv("AE_SINK", "NULL", 1);
+#endif
+    CServiceBroker::GetSettings().SetString(CSettings::SETTING_AUDIOOUTPUT_AUDIODEVICE, "NULL:capture");
+    CServiceBroker::GetSettings().SetString(CSettings::SETTING_AUDIOOUTPUT_PASSTHROUGHDEVICE, "NULL:capture");
+    CServiceBroker::GetSettings().SetBool(CSettings::SETTING_AUDIOOUTPUT_STREAMNOISE, false);
+    CServiceBroker::GetSettings().SetInt(CSettings::SETTING_AUDIOOUTPUT_STREAMSILENCE, 0);
+    CServiceBroker::GetSettings().SetInt(CSettings::SETTING_AUDIOOUTPUT_GUISOUNDMODE, AE_SOUND_OFF);
+    CServiceBroker::GetSettings().SetInt(CSettings::SETTING_AUDIOOUTPUT_PROCESSQUALITY, AE_QUALITY_MID);
+    CServiceBroker::GetSettings().SetBool(CSettings::SETTING_AUDIOOUTPUT_MAINTAINORIGINALVOLUME, true);
+    CServiceBroker::GetSettings().SetBool(CSettings::SETTING_AUDIOOUTPUT_AC3PASSTHROUGH, true);
+  }
+
+  ~TestActiveAE()
+  {
+    StopEngine();
+
+    CServiceBroker::GetSettings().SetString(CSettings::SETTING_AUDIOOUTPUT_AUDIODEVICE, m_device);
+    CServiceBroker::GetSettings().SetString(CSettings::SETTING_AUDIOOUTPUT_PASSTHROUGHDEVICE, m_passthroughDevice);
+    CServiceBroker::GetSettings().SetInt(CSettings::SETTING_AUDIOOUTPUT_CONFIG, m_config);
+    CServiceBroker::GetSettings().SetInt(CSettings::SETTING_AUDIOOUTPUT_CHANNELS, m_channels);
+    CServiceBroker::GetSettings().SetInt(CSettings::SETTING_AUDIOOUTPUT_SAMPLERATE, m_sampleRate);
+    CServiceBroker::GetSettings().SetBool(CSettings::SETTING_AUDIOOUTPUT_PASSTHROUGH, m_passthrough);
+#if defined(TARGET_POSIX)
+    unsetenv("AE_SINK");
+#endif
+  }
+
+  // the engine reads its settings on start, so every configuration gets its own
+  bool StartEngine(int config, enum AEStdChLayout channels, int sampleRate, bool passthrough = false)
+  {
+    CServiceBroker::GetSettings().SetInt(CSettings::SETTING_AUDIOOUTPUT_CONFIG, config);
+    CServiceBroker::GetSettings().SetInt(CSettings::SETTING_AUDIOOUTPUT_CHANNELS, channels);
+    CServiceBroker::GetSettings().SetInt(CSettings::SETTING_AUDIOOUTPUT_SAMPLERATE, sampleRate);
+    CServiceBroker::GetSettings().SetBool(CSettings::SETTING_AUDIOOUTPUT_PASSTHROUGH, passthrough);
+
+    m_started = g_application.m_ServiceManager->CreateAudioEngine() &&
+                g_application.m_ServiceManager->StartAudioEngine();
+    return m_started;
+  }
+
+  // shutting down flushes the sink, the capture holds everything after that
+  void StopEngine()
+  {
+    if (m_started)
+      g_application.m_ServiceManager->DestroyAudioEngine();
+    m_started = false;
+  }
+
+  IAEStream* MakeStream(enum AEDataFormat dataFormat, unsigned int sampleRate, enum AEStdChLayout layout)
+  {
+    AEAudioFormat format;
+    format.m_dataFormat = dataFormat;
+    format.m_sampleRate = sampleRate;
+    format.m_channelLayout = layout;
+    return CServiceBroker::GetActiveAE().MakeStream(format);
+  }
+
+  // adds all samples, faster than real time so that the engine never runs dry
+  static void Feed(const std::vector<IAEStream*> &streams, const std::vector<const std::vector<float>*> &samples)
+  {
+    std::vector<unsigned int> offsets(streams.size(), 0);
+    XbmcThreads::EndTime timeout(30000);
+    bool done = false;
+    while (!done && !timeout.IsTimePast())
+    {
+      done = true;
+      bool added = false;
+      for (size_t i = 0; i < streams.size(); i++)
+      {
+        unsigned int channels = streams[i]->GetChannelCount();
+        unsigned int frames = samples[i]->size() / channels;
+        if (offsets[i] >= frames)
+          continue;
+
+        const uint8_t *data = reinterpret_cast<const uint8_t*>(samples[i]->data());
+        unsigned int copied = streams[i]->AddData(&data, offsets[i], std::min(frames - offsets[i], 1024u));
+        offsets[i] += copied;
+        added |= copied > 0;
+        done &= offsets[i] >= frames;
+      }
+      if (!added && !done)
+        Sleep(1);
+    }
+    EXPECT_TRUE(done) << "timeout adding data";
+
+    for (IAEStream *stream : streams)
+      stream->Drain(true);
+  }
+
+  static void Feed(IAEStream *stream, const std::vector<float> &samples)
+  {
+    Feed(std::vector<IAEStream*>(1, stream), std::vector<const std::vector<float>*>(1, &samples));
+  }
+
+  static void FeedRaw(IAEStream *stream, const std::vector<std::vector<uint8_t> > &frames)
+  {
+    XbmcThreads::EndTime timeout(30000);
+    for (const std::vector<uint8_t> &frame : frames)
+    {
+      const uint8_t *data = frame.data();
+      while (!stream->AddData(&data, 0, frame.size()) && !timeout.IsTimePast())
+        Sleep(1);
+    }
+    EXPECT_FALSE(timeout.IsTimePast()) << "timeout adding data";
+    stream->Drain(true);
+  }
+
+  std::vector<float> GetCapture(AEAudioFormat &format)
+  {
+    std::vector<uint8_t> data;
+    CAESinkNULL::GetCapture(data, format);
+    return ToFloat(data);
+  }
+
+  bool m_started = false;
+  std::string m_device;
+  std::string m_passthroughDevice;
+  int m_config;
+  int m_channels;
+  int m_sampleRate;
+  bool m_passthrough;
+};
+
+TEST_F(TestActiveAE, PCMIdentity)
+{
+  ASSERT_TRUE(StartEngine(AE_CONFIG_FIXED, AE_CH_LAYOUT_2_0, 48000));
+
+  std::vector<float> input = MakeTone(48000, 2, 48000, 0.5f);
+  IAEStream *stream = MakeStream(AE_FMT_FLOAT, 48000, AE_CH_LAYOUT_2_0);
+  ASSERT_TRUE(stream != nullptr);
+  Feed(stream, input);
+  CServiceBroker::GetActiveAE().FreeStream(stream);
+  StopEngine();
+
+  AEAudioFormat format;
+  std::vector<float> output = TrimSilence(GetCapture(format), 2);
+  EXPECT_EQ(AE_FMT_FLOAT, format.m_dataFormat);
+  EXPECT_EQ(48000u, format.m_sampleRate);
+  EXPECT_EQ(2u, format.m_channelLayout.Count());
+
+  // nothing to convert, volume is at unity: every sample has to come through untouched
+  ASSERT_EQ(input.size(), output.size());
+  EXPECT_EQ(0, memcmp(input.data(), output.data(), input.size() * sizeof(float)));
+}
+
+TEST_F(TestActiveAE, PCMConversions)
+{
+  struct Conversion
+  {
+    const char *name;
+    unsigned int sampleRate;
+    enum AEStdChLayout layout;
+  };
+  const Conversion conversions[] =
+  {
+    { "resample_44100_2.0", 44100, AE_CH_LAYOUT_2_0 },
+    { "downmix_48000_5.1", 48000, AE_CH_LAYOUT_5_1 },
+    { "resample_96000_7.1", 96000, AE_CH_LAYOUT_7_1 },
+  };
+
+  for (const Conversion &conversion : conversions)
+  {
+    ASSERT_TRUE(StartEngine(AE_CONFIG_FIXED, AE_CH_LAYOUT_2_0, 48000));
+
+    CAEChannelInfo layout(conversion.layout);
+    std::vector<float> input = MakeTone(conversion.sampleRate, layout.Count(), conversion.sampleRate, 0.25f);
+    IAEStream *stream = MakeStream(AE_FMT_FLOAT, conversion.sampleRate, conversion.layout);
+    ASSERT_TRUE(stream != nullptr);
+    Feed(stream, input);
+    CServiceBroker::GetActiveAE().FreeStream(stream);
+    StopEngine();
+
+    AEAudioFormat format;
+    std::vector<float> output = TrimSilence(GetCapture(format), 2);
+    ASSERT_EQ(2u, format.m_channelLayout.Count());
+    EXPECT_EQ(48000u, format.m_sampleRate);
+
+    // about a second of audio has to come out, still a clean tone
+    EXPECT_NEAR(48000.0, output.size() / 2.0, 4800.0) << conversion.name;
+    for (unsigned int ch = 0; ch < 2; ch++)
+      EXPECT_GT(ToneSNR(output, 2, ch, 48000), 60.0) << conversion.name << " channel " << ch;
+
+    CompareGolden(conversion.name, output);
+  }
+}
+
+TEST_F(TestActiveAE, PCMMultiStream)
+{
+  ASSERT_TRUE(StartEngine(AE_CONFIG_FIXED, AE_CH_LAYOUT_2_0, 48000));
+
+  std::vector<float> music = MakeTone(44100, 2, 44100, 0.25f);
+  std::vector<float> effects = MakeTone(48000, 6, 48000, 0.25f);
+  std::vector<IAEStream*> streams;
+  streams.push_back(MakeStream(AE_FMT_FLOAT, 44100, AE_CH_LAYOUT_2_0));
+  streams.push_back(MakeStream(AE_FMT_FLOAT, 48000, AE_CH_LAYOUT_5_1));
+  ASSERT_TRUE(streams[0] != nullptr);
+  ASSERT_TRUE(streams[1] != nullptr);
+  Feed(streams, { &music, &effects });
+  for (IAEStream *stream : streams)
+    CServiceBroker::GetActiveAE().FreeStream(stream);
+  StopEngine();
+
+  // where the streams meet depends on timing, so only the level can be checked
+  AEAudioFormat format;
+  std::vector<float> output = TrimSilence(GetCapture(format), 2);
+  ASSERT_FALSE(output.empty());
+  EXPECT_GT(RMS(output), 0.1);
+  for (float v : output)
+    ASSERT_LE(fabsf(v), 1.0f);
+}
+
+#if defined(TARGET_LINUX) || defined(TARGET_FREEBSD)
+// only there the capture device is listed and can be used for passthrough
+TEST_F(TestActiveAE, AC3Passthrough)
+{
+  ASSERT_TRUE(StartEngine(AE_CONFIG_AUTO, AE_CH_LAYOUT_2_0, 48000, true));
+
+  AEAudioFormat format;
+  format.m_dataFormat = AE_FMT_RAW;
+  format.m_sampleRate = 48000;
+  format.m_channelLayout = CAEChannelInfo(AE_CH_LAYOUT_2_0);
+  format.m_streamInfo.m_type = CAEStreamInfo::STREAM_TYPE_AC3;
+  format.m_streamInfo.m_sampleRate = 48000;
+  format.m_streamInfo.m_channels = 2;
+  ASSERT_TRUE(CServiceBroker::GetActiveAE().SupportsRaw(format));
+
+  // a second of 32ms frames
+  std::vector<std::vector<uint8_t> > frames = MakeAC3Frames(32, 1536);
+  IAEStream *stream = CServiceBroker::GetActiveAE().MakeStream(format);
+  ASSERT_TRUE(stream != nullptr);
+  FeedRaw(stream, frames);
+  CServiceBroker::GetActiveAE().FreeStream(stream);
+  StopEngine();
+
+  std::vector<uint8_t> output;
+  CAESinkNULL::GetCapture(output, format);
+  EXPECT_EQ(AE_FMT_S16NE, format.m_dataFormat);
+
+  // pause bursts may go ahead, after that the packed frames have to follow in order
+  std::vector<uint8_t> packet(MAX_IEC61937_PACKET);
+  std::vector<uint8_t> expected;
+  for (std::vector<uint8_t> &frame : frames)
+  {
+    int size = CAEPackIEC61937::PackAC3(frame.data(), frame.size(), packet.data());
+    expected.insert(expected.end(), packet.begin(), packet.begin() + size);
+  }
+  std::vector<uint8_t>::iterator start = std::search(output.begin(), output.end(),
+                                                     expected.begin(), expected.begin() + 64);
+  ASSERT_TRUE(start != output.end());
+  ASSERT_GE(static_cast<size_t>(output.end() - start), expected.size());
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(), start));
+}
+#endif
+
+// cpu time of the whole process per second of audio, that is the engine and
+// sink threads plus the little the feeding costs
+TEST_F(TestActiveAE, Benchmark)
+{
+  struct Combination
+  {
+    const char *name;
+    int config;
+    unsigned int sampleRate;
+    enum AEStdChLayout layout;
+    unsigned int streams;
+  };
+  const Combination combinations[] =
+  {
+    { "44.1kHz 2.0 -> 48kHz 2.0", AE_CONFIG_FIXED, 44100, AE_CH_LAYOUT_2_0, 1 },
+    { "48kHz 5.1 -> 48kHz 2.0", AE_CONFIG_FIXED, 48000, AE_CH_LAYOUT_5_1, 1 },
+    { "96kHz 7.1 -> 48kHz 2.0", AE_CONFIG_FIXED, 96000, AE_CH_LAYOUT_7_1, 1 },
+    { "48kHz 5.1 -> auto", AE_CONFIG_AUTO, 48000, AE_CH_LAYOUT_5_1, 1 },
+    { "96kHz 7.1 -> auto", AE_CONFIG_AUTO, 96000, AE_CH_LAYOUT_7_1, 1 },
+    { "3 x 44.1kHz 2.0 -> 48kHz 2.0", AE_CONFIG_FIXED, 44100, AE_CH_LAYOUT_2_0, 3 },
+  };
+  const unsigned int seconds = 2;
+
+  for (const Combination &combination : combinations)
+  {
+    // auto follows the stream up to 7.1
+    enum AEStdChLayout channels = combination.config == AE_CONFIG_FIXED ? AE_CH_LAYOUT_2_0 : AE_CH_LAYOUT_7_1;
+    ASSERT_TRUE(StartEngine(combination.config, channels, 48000));
+
+    CAEChannelInfo layout(combination.layout);
+    std::vector<float> input = MakeTone(combination.sampleRate, layout.Count(),
+                                        combination.sampleRate * seconds, 0.1f);
+    std::vector<IAEStream*> streams;
+    std::vector<const std::vector<float>*> samples;
+    for (unsigned int i = 0; i < combination.streams; i++)
+    {
+      streams.push_back(MakeStream(AE_FMT_FLOAT, combination.sampleRate, combination.layout));
+      ASSERT_TRUE(streams.back() != nullptr);
+      samples.push_back(&input);
+    }
+
+    clock_t start = clock();
+    Feed(streams, samples);
+    clock_t end = clock();
+    for (IAEStream *stream : streams)
+      CServiceBroker::GetActiveAE().FreeStream(stream);
+    StopEngine();
+
+    AEAudioFormat format;
+    GetCapture(format);
+    double cpuMs = 1000.0 * (end - start) / CLOCKS_PER_SEC;
+    std::cout << combination.name << " (sink " << format.m_sampleRate << "Hz "
+              << format.m_channelLayout.Count() << "ch): "
+              << cpuMs / seconds << " ms cpu per second of audio" << std::endl;
+  }
+}
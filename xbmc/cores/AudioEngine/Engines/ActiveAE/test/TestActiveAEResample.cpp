@@ -0,0 +1,303 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <math.h>
+#include <memory>
+#include <time.h>
+#include <vector>
+
+#include "cores/AudioEngine/Engines/ActiveAE/ActiveAEResampleFFMPEG.h"
+#include "cores/AudioEngine/Engines/ActiveAE/ActiveAEResamplePolyphase.h"
+
+#include "gtest/gtest.h"
+
+using namespace ActiveAE;
+
+// both resamplers get the same stereo tone on planar float, in blocks as
+// the engine hands them out, and are drained at the end
+
+#define TEST_FREQ 1000.0
+#define TEST_CHANNELS 2
+#define TEST_LAYOUT 3
+#define TEST_BLOCK 1024
+
+namespace
+{
+struct Result
+{
+  std::vector<float> samples[TEST_CHANNELS];
+  double seconds;
+};
+
+bool Convert(IAEResample &resampler, int srcRate, int dstRate, AEQuality quality,
+             unsigned int frames, const std::vector<double> &ratios, Result &result)
+{
+  if (!resampler.Init(TEST_LAYOUT, TEST_CHANNELS, dstRate, AV_SAMPLE_FMT_FLTP, 32, 0,
+                      TEST_LAYOUT, TEST_CHANNELS, srcRate, AV_SAMPLE_FMT_FLTP, 32, 0,
+                      false, true, NULL, quality, false))
+    return false;
+
+  std::vector<float> input[TEST_CHANNELS];
+  for (unsigned int ch = 0; ch < TEST_CHANNELS; ch++)
+  {
+    input[ch].resize(frames);
+    for (unsigned int i = 0; i < frames; i++)
+      input[ch][i] = static_cast<float>(0.5 * sin(2.0 * M_PI * TEST_FREQ * i / srcRate + 0.3 * ch));
+  }
+
+  // room for a block at the highest ratio plus what the filter held back
+  int size = TEST_BLOCK * 4 * std::max(dstRate / srcRate, 1) + 4096;
+  std::vector<float> output[TEST_CHANNELS];
+  uint8_t *dst[TEST_CHANNELS];
+  for (unsigned int ch = 0; ch < TEST_CHANNELS; ch++)
+  {
+    output[ch].resize(size);
+    dst[ch] = reinterpret_cast<uint8_t*>(output[ch].data());
+  }
+
+  unsigned int blocks = (frames + TEST_BLOCK - 1) / TEST_BLOCK;
+  clock_t start = clock();
+  for (unsigned int block = 0; block <= blocks; block++)
+  {
+    uint8_t *src[TEST_CHANNELS];
+    uint8_t **in = NULL;
+    int samples = 0;
+    double ratio = ratios[std::min(block * ratios.size() / blocks, ratios.size() - 1)];
+    if (block < blocks)
+    {
+      samples = std::min(TEST_BLOCK, static_cast<int>(frames - block * TEST_BLOCK));
+      for (unsigned int ch = 0; ch < TEST_CHANNELS; ch++)
+        src[ch] = reinterpret_cast<uint8_t*>(&input[ch][block * TEST_BLOCK]);
+      in = src;
+    }
+
+    int out;
+    do
+    {
+      out = resampler.Resample(dst, size, in, samples, ratio);
+      if (out < 0)
+        return false;
+      for (unsigned int ch = 0; ch < TEST_CHANNELS; ch++)
+        result.samples[ch].insert(result.samples[ch].end(), output[ch].begin(), output[ch].begin() + out);
+      in = NULL;
+      samples = 0;
+    } while (block == blocks && out > 0);
+  }
+  result.seconds = static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+  return true;
+}
+
+// noise and distortion relative to a fitted sine in dB, leaves out the edges
+double THDN(const std::vector<float> &samples, double frequency, int sampleRate)
+{
+  size_t start = samples.size() / 10;
+  size_t end = samples.size() - start;
+  double w = 2.0 * M_PI * frequency / sampleRate;
+  double ss = 0.0, cc = 0.0, sc = 0.0, ys = 0.0, yc = 0.0;
+  for (size_t i = start; i < end; i++)
+  {
+    double s = sin(w * i);
+    double c = cos(w * i);
+    ss += s * s;
+    cc += c * c;
+    sc += s * c;
+    ys += samples[i] * s;
+    yc += samples[i] * c;
+  }
+  double det = ss * cc - sc * sc;
+  double a = (ys * cc - yc * sc) / det;
+  double b = (yc * ss - ys * sc) / det;
+
+  double signal = 0.0, noise = 0.0;
+  for (size_t i = start; i < end; i++)
+  {
+    double fit = a * sin(w * i) + b * cos(w * i);
+    signal += fit * fit;
+    noise += (samples[i] - fit) * (samples[i] - fit);
+  }
+  return 10.0 * log10(noise / signal);
+}
+}
+
+struct RatePair
+{
+  int src;
+  int dst;
+};
+
+static const RatePair ratePairs[] =
+{
+  { 44100, 48000 },
+  { 48000, 44100 },
+  { 96000, 48000 },
+  { 22050, 48000 },
+};
+
+TEST(TestActiveAEResample, SampleCount)
+{
+  for (const RatePair &rates : ratePairs)
+  {
+    CActiveAEResamplePolyphase resampler;
+    Result result;
+    std::vector<double> ratios(1, 1.0);
+    ASSERT_TRUE(Convert(resampler, rates.src, rates.dst, AE_QUALITY_MID, rates.src * 2, ratios, result));
+    EXPECT_NEAR(rates.dst * 2, static_cast<int>(result.samples[0].size()), 1) << rates.src << " -> " << rates.dst;
+    EXPECT_EQ(result.samples[0].size(), result.samples[1].size());
+  }
+}
+
+TEST(TestActiveAEResample, BufferedSamples)
+{
+  CActiveAEResamplePolyphase resampler;
+  ASSERT_TRUE(resampler.Init(TEST_LAYOUT, TEST_CHANNELS, 48000, AV_SAMPLE_FMT_FLTP, 32, 0,
+                             TEST_LAYOUT, TEST_CHANNELS, 44100, AV_SAMPLE_FMT_FLTP, 32, 0,
+                             false, true, NULL, AE_QUALITY_MID, false));
+
+  std::vector<float> input(TEST_BLOCK, 0.25f);
+  std::vector<float> output(TEST_BLOCK * 2);
+  uint8_t *src[TEST_CHANNELS] = { reinterpret_cast<uint8_t*>(input.data()), reinterpret_cast<uint8_t*>(input.data()) };
+  uint8_t *dst[TEST_CHANNELS] = { reinterpret_cast<uint8_t*>(output.data()), reinterpret_cast<uint8_t*>(output.data()) };
+  ASSERT_GT(resampler.Resample(dst, TEST_BLOCK * 2, src, TEST_BLOCK, 1.0), 0);
+
+  // what the filter holds back comes out on drain
+  int buffered = resampler.GetBufferedSamples();
+  EXPECT_GT(resampler.GetDelay(1000000), 0);
+  int drained = 0;
+  int out;
+  while ((out = resampler.Resample(dst, TEST_BLOCK * 2, NULL, 0, 1.0)) > 0)
+    drained += out;
+  EXPECT_EQ(0, out);
+  EXPECT_NEAR(buffered, drained, 1);
+  EXPECT_EQ(0, resampler.GetBufferedSamples());
+}
+
+TEST(TestActiveAEResample, SkippedInput)
+{
+  // the engine fills its packets like this and calls without input whenever
+  // the resampler doesn't want any for the room left, that must not be taken
+  // for a drain while the filter is still short of input
+  CActiveAEResamplePolyphase resampler;
+  ASSERT_TRUE(resampler.Init(TEST_LAYOUT, TEST_CHANNELS, 48000, AV_SAMPLE_FMT_FLTP, 32, 0,
+                             TEST_LAYOUT, TEST_CHANNELS, 44100, AV_SAMPLE_FMT_FLTP, 32, 0,
+                             false, true, NULL, AE_QUALITY_MID, false));
+
+  const int block = 40;
+  const int packet = 100;
+  std::vector<float> input(44100);
+  for (size_t i = 0; i < input.size(); i++)
+    input[i] = static_cast<float>(0.5 * sin(2.0 * M_PI * TEST_FREQ * i / 44100));
+  std::vector<float> output(packet);
+  std::vector<float> samples;
+
+  size_t pos = 0;
+  int filled = 0;
+  bool empty = true;
+  bool drained = false;
+  while (!drained)
+  {
+    uint8_t *src[TEST_CHANNELS] = { reinterpret_cast<uint8_t*>(&input[pos]), reinterpret_cast<uint8_t*>(&input[pos]) };
+    uint8_t *dst[TEST_CHANNELS] = { reinterpret_cast<uint8_t*>(&output[filled]), reinterpret_cast<uint8_t*>(&output[filled]) };
+    bool skipInput = !resampler.WantsNewSamples(packet - filled) && !empty;
+    bool hasInput = pos < input.size();
+    int frames = hasInput && !skipInput ? std::min(block, static_cast<int>(input.size() - pos)) : 0;
+    int out = resampler.Resample(dst, packet - filled, frames ? src : NULL, frames, 1.0);
+    ASSERT_GE(out, 0);
+    pos += frames;
+    filled += out;
+    empty = out == 0;
+    drained = !hasInput && empty;
+    if (filled == packet || drained)
+    {
+      samples.insert(samples.end(), output.begin(), output.begin() + filled);
+      filled = 0;
+    }
+  }
+
+  // no silence inserted on the way: the tone never jumps and the length is right
+  EXPECT_NEAR(48000, static_cast<int>(samples.size()), 1);
+  float step = 0.0f;
+  for (size_t i = 1; i < samples.size(); i++)
+    step = std::max(step, fabsf(samples[i] - samples[i - 1]));
+  EXPECT_LT(step, 0.5f * 2.0f * M_PI * TEST_FREQ / 48000 * 1.05f);
+}
+
+TEST(TestActiveAEResample, RatioChange)
+{
+  // a resync moves the ratio a little up and down without setting anything up again
+  CActiveAEResamplePolyphase resampler;
+  Result result;
+  std::vector<double> ratios = { 1.0, 1.001, 0.999, 1.0 };
+  ASSERT_TRUE(Convert(resampler, 44100, 48000, AE_QUALITY_MID, 44100 * 4, ratios, result));
+  EXPECT_NEAR(48000 * 4, static_cast<int>(result.samples[0].size()), 48);
+
+  // no steps from switching, a 1kHz tone at 0.5 never moves more than this
+  float step = 0.0f;
+  for (size_t i = 1; i < result.samples[0].size(); i++)
+    step = std::max(step, fabsf(result.samples[0][i] - result.samples[0][i - 1]));
+  EXPECT_LT(step, 0.5f * 2.0f * M_PI * TEST_FREQ / 48000 * 1.05f);
+}
+
+TEST(TestActiveAEResample, Quality)
+{
+  const AEQuality qualities[] = { AE_QUALITY_LOW, AE_QUALITY_MID, AE_QUALITY_HIGH };
+  for (AEQuality quality : qualities)
+  {
+    for (const RatePair &rates : ratePairs)
+    {
+      std::vector<double> ratios(1, 1.0);
+      Result polyphase, swr;
+      CActiveAEResamplePolyphase polyphaseResampler;
+      CActiveAEResampleFFMPEG swrResampler;
+      ASSERT_TRUE(Convert(polyphaseResampler, rates.src, rates.dst, quality, rates.src * 2, ratios, polyphase));
+      ASSERT_TRUE(Convert(swrResampler, rates.src, rates.dst, quality, rates.src * 2, ratios, swr));
+
+      double polyphaseTHDN = THDN(polyphase.samples[0], TEST_FREQ, rates.dst);
+      double swrTHDN = THDN(swr.samples[0], TEST_FREQ, rates.dst);
+      std::cout << rates.src << " -> " << rates.dst << " quality " << quality
+                << ": THD+N polyphase " << polyphaseTHDN << " dB, swresample " << swrTHDN << " dB" << std::endl;
+      EXPECT_LT(polyphaseTHDN, -90.0);
+    }
+  }
+}
+
+TEST(TestActiveAEResample, Benchmark)
+{
+  const AEQuality qualities[] = { AE_QUALITY_LOW, AE_QUALITY_MID, AE_QUALITY_HIGH };
+  const int seconds = 10;
+  for (AEQuality quality : qualities)
+  {
+    for (const RatePair &rates : ratePairs)
+    {
+      std::vector<double> ratios = { 1.0, 1.0005 };
+      Result polyphase, swr;
+      CActiveAEResamplePolyphase polyphaseResampler;
+      CActiveAEResampleFFMPEG swrResampler;
+      ASSERT_TRUE(Convert(polyphaseResampler, rates.src, rates.dst, quality, rates.src * seconds, ratios, polyphase));
+      ASSERT_TRUE(Convert(swrResampler, rates.src, rates.dst, quality, rates.src * seconds, ratios, swr));
+
+      double samples = static_cast<double>(polyphase.samples[0].size()) * TEST_CHANNELS;
+      std::cout << rates.src << " -> " << rates.dst << " quality " << quality
+                << ": polyphase " << polyphase.seconds * 1e9 / samples << " ns/sample"
+                << ", swresample " << swr.seconds * 1e9 / samples << " ns/sample" << std::endl;
+    }
+  }
+}
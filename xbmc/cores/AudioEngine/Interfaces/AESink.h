@@ -65,6 +65,29 @@ public:
   */
   virtual unsigned int AddPackets(uint8_t **data, unsigned int frames, unsigned int offset) = 0;
 
+  /*!
+   * @brief Indicates if the sink hands out its own memory via GetBuffer/CommitBuffer.
+   * The engine then converts samples directly into that memory instead of passing
+   * them to AddPackets. AddPackets must keep working, it is still used for silence.
+   */
+  virtual bool HasBufferAccess() { return false; };
+
+  /*!
+   * @brief Get memory of the device to write the next frames to, this routine MUST block or sleep
+   * like AddPackets. Every call has to be followed by CommitBuffer.
+   * @param data receives a pointer to interleaved memory in the format of the sink
+   * @param frames max number of frames the caller wants to write
+   * @return number of frames that fit at data, 0 on error
+   */
+  virtual unsigned int GetBuffer(uint8_t *&data, unsigned int frames) { return 0; };
+
+  /*!
+   * @brief Hands the frames written to the memory returned by GetBuffer to the device
+   * @param frames number of frames written, may be less than GetBuffer returned
+   * @return number of frames consumed by the sink
+   */
+  virtual unsigned int CommitBuffer(unsigned int frames) { return 0; };
+
   /*!
    * @brief instruct the sink to add a pause
    * @param millis ms to pause
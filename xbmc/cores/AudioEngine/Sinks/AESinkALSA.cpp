@@ -95,7 +95,10 @@ CAESinkALSA::CAESinkALSA() :
   m_pcm(NULL),
   m_timeout(0),
   m_fragmented(false),
-  m_originalPeriodSize(AE_MIN_PERIODSIZE)
+  m_originalPeriodSize(AE_MIN_PERIODSIZE),
+  m_mmap(false),
+  m_mmapOffset(0),
+  m_startThreshold(0)
 {
   /* ensure that ALSA has been initialized */
   if (!snd_config)
@@ -662,7 +665,12 @@ bool CAESinkALSA::InitializeHW(const ALSAConfig &inconfig, ALSAConfig &outconfig
   memset(hw_params, 0, snd_pcm_hw_params_sizeof());
 
   snd_pcm_hw_params_any(m_pcm, hw_params);
-  snd_pcm_hw_params_set_access(m_pcm, hw_params, SND_PCM_ACCESS_RW_INTERLEAVED);
+
+  /* mmap access lets the engine write pcm straight into the buffer of the device */
+  m_mmap = !m_passthrough &&
+           snd_pcm_hw_params_set_access(m_pcm, hw_params, SND_PCM_ACCESS_MMAP_INTERLEAVED) == 0;
+  if (!m_mmap)
+    snd_pcm_hw_params_set_access(m_pcm, hw_params, SND_PCM_ACCESS_RW_INTERLEAVED);
 
   unsigned int sampleRate   = inconfig.sampleRate;
   snd_pcm_hw_params_set_rate_near    (m_pcm, hw_params, &sampleRate, NULL);
@@ -861,6 +869,9 @@ bool CAESinkALSA::InitializeSW(const ALSAConfig &inconfig)
   snd_pcm_sw_params_set_silence_size     (m_pcm, sw_params, boundary);
   snd_pcm_sw_params_set_avail_min        (m_pcm, sw_params, inconfig.periodSize);
 
+  // the mmap path starts the device itself, once two periods are queued
+  m_startThreshold = std::min(2 * (snd_pcm_uframes_t)inconfig.periodSize, (snd_pcm_uframes_t)m_bufferSize);
+
   if (snd_pcm_sw_params(m_pcm, sw_params) < 0)
   {
     CLog::Log(LOGERROR, "CAESinkALSA::InitializeSW - Failed to set the parameters");
@@ -933,7 +944,7 @@ unsigned int CAESinkALSA::AddPackets(uint8_t **data, unsigned int frames, unsign
     else // take care as we can come here a second time if the sink does not eat all data
       amount = (unsigned int) data_left;
 
-    int ret = snd_pcm_writei(m_pcm, buffer, amount);
+    int ret = m_mmap ? snd_pcm_mmap_writei(m_pcm, buffer, amount) : snd_pcm_writei(m_pcm, buffer, amount);
     if (ret < 0)
     {
       CLog::Log(LOGERROR, "CAESinkALSA - snd_pcm_writei(%d) %s - trying to recover", ret, snd_strerror(ret));
@@ -941,7 +952,7 @@ unsigned int CAESinkALSA::AddPackets(uint8_t **data, unsigned int frames, unsign
       if(ret < 0)
       {
         HandleError("snd_pcm_writei(1)", ret);
-        ret = snd_pcm_writei(m_pcm, buffer, amount);
+        ret = m_mmap ? snd_pcm_mmap_writei(m_pcm, buffer, amount) : snd_pcm_writei(m_pcm, buffer, amount);
         if (ret < 0)
         {
           HandleError("snd_pcm_writei(2)", ret);
@@ -963,6 +974,71 @@ unsigned int CAESinkALSA::AddPackets(uint8_t **data, unsigned int frames, unsign
   return frames_written;
 }
 
+unsigned int CAESinkALSA::GetBuffer(uint8_t *&data, unsigned int frames)
+{
+  if (!m_pcm || !m_mmap)
+    return 0;
+
+  snd_pcm_sframes_t avail = snd_pcm_avail_update(m_pcm);
+  if (avail == 0)
+  {
+    /* block like snd_pcm_writei does until there is room for data */
+    snd_pcm_wait(m_pcm, m_timeout);
+    avail = snd_pcm_avail_update(m_pcm);
+  }
+
+  if (avail < 0)
+  {
+    CLog::Log(LOGERROR, "CAESinkALSA - snd_pcm_avail_update(%d) %s - trying to recover", (int)avail, snd_strerror(avail));
+    int ret = snd_pcm_recover(m_pcm, avail, 1);
+    if (ret < 0)
+      HandleError("snd_pcm_avail_update", ret);
+    return 0;
+  }
+  else if (avail == 0)
+    return 0;
+
+  snd_pcm_uframes_t amount = std::min((snd_pcm_uframes_t)avail, (snd_pcm_uframes_t)frames);
+  if (m_fragmented)
+    amount = std::min(amount, (snd_pcm_uframes_t)m_originalPeriodSize);
+
+  const snd_pcm_channel_area_t *areas;
+  int ret = snd_pcm_mmap_begin(m_pcm, &areas, &m_mmapOffset, &amount);
+  if (ret < 0)
+  {
+    HandleError("snd_pcm_mmap_begin", ret);
+    return 0;
+  }
+
+  data = (uint8_t*)areas[0].addr + areas[0].first / 8 + m_mmapOffset * areas[0].step / 8;
+  return amount;
+}
+
+unsigned int CAESinkALSA::CommitBuffer(unsigned int frames)
+{
+  if (!m_pcm || !m_mmap)
+    return INT_MAX;
+
+  snd_pcm_sframes_t ret = snd_pcm_mmap_commit(m_pcm, m_mmapOffset, frames);
+  if (ret < 0)
+  {
+    CLog::Log(LOGERROR, "CAESinkALSA - snd_pcm_mmap_commit(%d) %s - trying to recover", (int)ret, snd_strerror(ret));
+    if (snd_pcm_recover(m_pcm, ret, 1) < 0)
+      HandleError("snd_pcm_mmap_commit", ret);
+    return 0;
+  }
+
+  // starting on the first commit would underrun while the next period is converted
+  if (ret > 0 && snd_pcm_state(m_pcm) == SND_PCM_STATE_PREPARED)
+  {
+    snd_pcm_sframes_t avail = snd_pcm_avail_update(m_pcm);
+    if (avail >= 0 && m_bufferSize - (snd_pcm_uframes_t)avail >= m_startThreshold)
+      snd_pcm_start(m_pcm);
+  }
+
+  return ret;
+}
+
 void CAESinkALSA::HandleError(const char* name, int err)
 {
   switch(err)
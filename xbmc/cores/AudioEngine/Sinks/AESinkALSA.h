@@ -52,6 +52,9 @@ public:
   virtual void         GetDelay        (AEDelayStatus& status);
   virtual double       GetCacheTotal   ();
   virtual unsigned int AddPackets      (uint8_t **data, unsigned int frames, unsigned int offset);
+  virtual bool         HasBufferAccess () { return m_mmap; }
+  virtual unsigned int GetBuffer       (uint8_t *&data, unsigned int frames);
+  virtual unsigned int CommitBuffer    (unsigned int frames);
   virtual void         Drain           ();
 
   static void EnumerateDevicesEx(AEDeviceInfoList &list, bool force = false);
@@ -87,6 +90,10 @@ private:
   // support fragmentation, e.g. looping in the sink to get a certain amount of data onto the device
   bool              m_fragmented;
   unsigned int      m_originalPeriodSize;
+  // pcm is written through the mmap area of the device
+  bool              m_mmap;
+  snd_pcm_uframes_t m_mmapOffset;
+  snd_pcm_uframes_t m_startThreshold; // queued frames before CommitBuffer starts the device
 
 #if HAVE_LIBUDEV
   static CALSADeviceMonitor m_deviceMonitor;
@@ -20,20 +20,33 @@
 
 #include "system.h"
 
+#include <algorithm>
 #include <stdint.h>
 #include <limits.h>
+#include <string.h>
 
 #include "AESinkNULL.h"
 #include "cores/AudioEngine/Utils/AEUtil.h"
+#include "threads/SystemClock.h"
 #include "utils/log.h"
 
+CCriticalSection CAESinkNULL::m_captureSection;
+std::vector<uint8_t> CAESinkNULL::m_captureData;
+AEAudioFormat CAESinkNULL::m_captureFormat;
+
 CAESinkNULL::CAESinkNULL()
   : CThread("AESinkNull"),
     m_draining(false),
     m_sink_frameSize(0),
     m_sinkbuffer_size(0),
     m_sinkbuffer_level(0),
-    m_sinkbuffer_sec_per_byte(0)
+    m_sinkbuffer_sec_per_byte(0),
+    m_measure(false),
+    m_writePos(0),
+    m_readPos(0),
+    m_bytesCopied(0),
+    m_bytesInPlace(0),
+    m_capture(false)
 {
 }
 
@@ -54,6 +67,23 @@ bool CAESinkNULL::Initialize(AEAudioFormat &format, std::string &device)
   m_sinkbuffer_size = m_sink_frameSize * format.m_sampleRate / 2;
   m_sinkbuffer_sec_per_byte = 1.0 / (double)(m_sink_frameSize * format.m_sampleRate);
 
+  m_measure = (device == "measure");
+  m_capture = (device == "capture");
+  m_buffer.clear();
+  if (m_measure || m_capture)
+    m_buffer.resize(m_sinkbuffer_size);
+  m_writePos = 0;
+  m_readPos = 0;
+  m_bytesCopied = 0;
+  m_bytesInPlace = 0;
+
+  if (m_capture)
+  {
+    CSingleLock lock(m_captureSection);
+    m_captureData.clear();
+    m_captureFormat = format;
+  }
+
   m_draining = false;
   m_wake.Reset();
   m_inited.Reset();
@@ -72,6 +102,10 @@ void CAESinkNULL::Deinitialize()
   // force m_bStop and set m_wake, if might be sleeping.
   m_bStop = true;
   StopThread();
+
+  // a capture holds everything the sink was given
+  if (m_capture)
+    Consume(m_sinkbuffer_level);
 }
 
 void CAESinkNULL::GetDelay(AEDelayStatus& status)
@@ -93,6 +127,16 @@ unsigned int CAESinkNULL::AddPackets(uint8_t **data, unsigned int frames, unsign
 
   if (frames)
   {
+    if (!m_buffer.empty())
+    {
+      uint8_t *src = data[0] + offset * m_sink_frameSize;
+      unsigned int bytes = frames * m_sink_frameSize;
+      unsigned int first = std::min(bytes, m_sinkbuffer_size - m_writePos);
+      memcpy(m_buffer.data() + m_writePos, src, first);
+      memcpy(m_buffer.data(), src + first, bytes - first);
+      m_writePos = (m_writePos + bytes) % m_sinkbuffer_size;
+      m_bytesCopied += bytes;
+    }
     m_sinkbuffer_level += frames * m_sink_frameSize;
     m_wake.Set();
   }
@@ -100,6 +144,38 @@ unsigned int CAESinkNULL::AddPackets(uint8_t **data, unsigned int frames, unsign
   return frames;
 }
 
+unsigned int CAESinkNULL::GetBuffer(uint8_t *&data, unsigned int frames)
+{
+  if (m_buffer.empty())
+    return 0;
+
+  // hand out what is free up to the end of the ring buffer
+  unsigned int max_frames = (m_sinkbuffer_size - m_sinkbuffer_level) / m_sink_frameSize;
+  max_frames = std::min(max_frames, (m_sinkbuffer_size - m_writePos) / m_sink_frameSize);
+  if (frames > max_frames)
+    frames = max_frames;
+
+  data = m_buffer.data() + m_writePos;
+  return frames;
+}
+
+unsigned int CAESinkNULL::CommitBuffer(unsigned int frames)
+{
+  if (m_buffer.empty())
+    return 0;
+
+  if (frames)
+  {
+    unsigned int bytes = frames * m_sink_frameSize;
+    m_writePos = (m_writePos + bytes) % m_sinkbuffer_size;
+    m_bytesInPlace += bytes;
+    m_sinkbuffer_level += bytes;
+    m_wake.Set();
+  }
+
+  return frames;
+}
+
 void CAESinkNULL::Drain()
 {
   m_draining = true;
@@ -111,6 +187,54 @@ void CAESinkNULL::EnumerateDevices (AEDeviceList &devices, bool passthrough)
   // we never return any devices
 }
 
+void CAESinkNULL::EnumerateDevicesEx(AEDeviceInfoList &list, bool force)
+{
+  // only listed on request (AE_SINK=NULL), this is what allows the engine
+  // to open the capture device for passthrough
+  CAEDeviceInfo info;
+  info.m_deviceName = "capture";
+  info.m_displayName = "Capture";
+  info.m_displayNameExtra = "to memory";
+  info.m_deviceType = AE_DEVTYPE_HDMI;
+  info.m_channels = AE_CH_LAYOUT_7_1;
+  info.m_sampleRates = { 32000, 44100, 48000, 88200, 96000, 176400, 192000 };
+  info.m_dataFormats = { AE_FMT_FLOAT, AE_FMT_S32NE, AE_FMT_S16NE, AE_FMT_RAW };
+  info.m_streamTypes = { CAEStreamInfo::STREAM_TYPE_AC3,
+                         CAEStreamInfo::STREAM_TYPE_EAC3,
+                         CAEStreamInfo::STREAM_TYPE_DTS_512,
+                         CAEStreamInfo::STREAM_TYPE_DTS_1024,
+                         CAEStreamInfo::STREAM_TYPE_DTS_2048,
+                         CAEStreamInfo::STREAM_TYPE_DTSHD_CORE,
+                         CAEStreamInfo::STREAM_TYPE_DTSHD,
+                         CAEStreamInfo::STREAM_TYPE_TRUEHD };
+  info.m_wantsIECPassthrough = true;
+  list.push_back(info);
+}
+
+void CAESinkNULL::GetCapture(std::vector<uint8_t> &data, AEAudioFormat &format)
+{
+  CSingleLock lock(m_captureSection);
+  data.clear();
+  data.swap(m_captureData);
+  format = m_captureFormat;
+}
+
+void CAESinkNULL::Consume(unsigned int bytes)
+{
+  if (!m_buffer.empty())
+  {
+    if (m_capture)
+    {
+      unsigned int first = std::min(bytes, m_sinkbuffer_size - m_readPos);
+      CSingleLock lock(m_captureSection);
+      m_captureData.insert(m_captureData.end(), m_buffer.begin() + m_readPos, m_buffer.begin() + m_readPos + first);
+      m_captureData.insert(m_captureData.end(), m_buffer.begin(), m_buffer.begin() + (bytes - first));
+    }
+    m_readPos = (m_readPos + bytes) % m_sinkbuffer_size;
+  }
+  m_sinkbuffer_level -= bytes;
+}
+
 void CAESinkNULL::Process()
 {
   CLog::Log(LOGDEBUG, "CAESinkNULL::Process");
@@ -121,12 +245,20 @@ void CAESinkNULL::Process()
   Sleep(0);
 
   SetPriority(THREAD_PRIORITY_ABOVE_NORMAL);
+  XbmcThreads::EndTime reportTimer(10000);
   while (!m_bStop)
   {
+    if (m_measure && reportTimer.IsTimePast())
+    {
+      CLog::Log(LOGNOTICE, "CAESinkNULL::Process - bytes copied: %.0f/s, bytes written in place: %.0f/s",
+                m_bytesCopied.exchange(0) / 10.0, m_bytesInPlace.exchange(0) / 10.0);
+      reportTimer.Set(10000);
+    }
+
     if (m_draining)
     {
       //! @todo is it correct to not take data at the appropriate rate while draining?
-      m_sinkbuffer_level = 0;
+      Consume(m_sinkbuffer_level);
       m_draining = false;
     }
 
@@ -139,7 +271,7 @@ void CAESinkNULL::Process()
     if (read_bytes > 0)
     {
       // drain it
-      m_sinkbuffer_level -= read_bytes;
+      Consume(read_bytes);
 
       // we MUST drain at the correct audio sample rate
       // or the NULL sink will not work right. So calc
@@ -19,9 +19,14 @@
  *
  */
 
+#include <atomic>
+#include <vector>
+
 #include "system.h"
+#include "threads/CriticalSection.h"
 #include "threads/Thread.h"
 #include "cores/AudioEngine/Interfaces/AESink.h"
+#include "cores/AudioEngine/Utils/AEDeviceInfo.h"
 
 class CAESinkNULL : public CThread, public IAESink
 {
@@ -37,11 +42,30 @@ public:
   virtual void         GetDelay        (AEDelayStatus& status);
   virtual double       GetCacheTotal   ();
   virtual unsigned int AddPackets      (uint8_t **data, unsigned int frames, unsigned int offset);
+  virtual bool         HasBufferAccess () { return !m_buffer.empty(); }
+  virtual unsigned int GetBuffer       (uint8_t *&data, unsigned int frames);
+  virtual unsigned int CommitBuffer    (unsigned int frames);
   virtual void         Drain           ();
 
   static void          EnumerateDevices(AEDeviceList &devices, bool passthrough);
+  static void          EnumerateDevicesEx(AEDeviceInfoList &list, bool force = false);
+
+  /*!
+   * @brief Hands out what the "capture" device has consumed since it was opened
+   * or since the last call. Used by tests to run the engine without hardware.
+   * @param data receives the interleaved samples or IEC packets, in the format of the sink
+   * @param format receives the format the sink was opened with
+   */
+  static void          GetCapture(std::vector<uint8_t> &data, AEAudioFormat &format);
+
+  /*!
+   * @brief Bytes the "measure" device got through AddPackets and through
+   * GetBuffer/CommitBuffer since the last report, which is every 10 seconds.
+   */
+  void                 GetMeasurement(uint64_t &copied, uint64_t &inPlace) const { copied = m_bytesCopied; inPlace = m_bytesInPlace; }
 private:
   virtual void         Process();
+  void                 Consume(unsigned int bytes);
 
   CEvent               m_wake;
   CEvent               m_inited;
@@ -49,6 +73,22 @@ private:
   AEAudioFormat        m_format;
   unsigned int         m_sink_frameSize;
   unsigned int         m_sinkbuffer_size;  ///< total size of the buffer
-  unsigned int         m_sinkbuffer_level; ///< current level in the buffer
+  std::atomic<unsigned int> m_sinkbuffer_level; ///< current level in the buffer
   double               m_sinkbuffer_sec_per_byte;
+
+  // device "measure" keeps the samples in a real buffer and reports how many
+  // bytes were copied by AddPackets and how many were written in place
+  bool                  m_measure;
+  std::vector<uint8_t>  m_buffer;
+  unsigned int          m_writePos;
+  unsigned int          m_readPos;
+  std::atomic<uint64_t> m_bytesCopied;
+  std::atomic<uint64_t> m_bytesInPlace;
+
+  // device "capture" uses the same buffer and appends whatever gets played
+  // to a static store, the engine owns the sink so there is no other handle
+  bool                  m_capture;
+  static CCriticalSection     m_captureSection;
+  static std::vector<uint8_t> m_captureData;
+  static AEAudioFormat        m_captureFormat;
 };
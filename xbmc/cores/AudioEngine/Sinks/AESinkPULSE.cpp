@@ -495,6 +495,8 @@ CAESinkPULSE::CAESinkPULSE()
   m_IsStreamPaused = false;
   m_volume_needs_update = false;
   m_periodSize = 0;
+  m_writeBuffer = NULL;
+  m_writeFree = 0;
   pa_cvolume_init(&m_Volume);
 }
 
@@ -891,6 +893,73 @@ unsigned int CAESinkPULSE::AddPackets(uint8_t **data, unsigned int frames, unsig
   return res;
 }
 
+unsigned int CAESinkPULSE::GetBuffer(uint8_t *&data, unsigned int frames)
+{
+  if (!m_IsAllocated || m_passthrough)
+    return 0;
+
+  if (m_IsStreamPaused)
+  {
+    Pause(false);
+  }
+
+  pa_threaded_mainloop_lock(m_MainLoop);
+
+  unsigned int length = 0;
+  // care a bit for fragmentation
+  while ((length = pa_stream_writable_size(m_Stream)) < m_periodSize)
+    pa_threaded_mainloop_wait(m_MainLoop);
+
+  m_writeFree = length;
+  size_t size = std::min(length, frames * m_format.m_frameSize);
+  void *buffer = NULL;
+  int error = pa_stream_begin_write(m_Stream, &buffer, &size);
+  if (!error && size < m_format.m_frameSize)
+  {
+    pa_stream_cancel_write(m_Stream);
+    buffer = NULL;
+  }
+  pa_threaded_mainloop_unlock(m_MainLoop);
+
+  if (error || !buffer)
+  {
+    CLog::Log(LOGERROR, "CAESinkPULSE::GetBuffer - pa_stream_begin_write failed");
+    m_writeBuffer = NULL;
+    return 0;
+  }
+
+  m_writeBuffer = (uint8_t*)buffer;
+  data = m_writeBuffer;
+  return size / m_format.m_frameSize;
+}
+
+unsigned int CAESinkPULSE::CommitBuffer(unsigned int frames)
+{
+  if (!m_IsAllocated || !m_writeBuffer)
+    return 0;
+
+  unsigned int length = frames * m_format.m_frameSize;
+
+  pa_threaded_mainloop_lock(m_MainLoop);
+  int error;
+  if (length > 0)
+    error = pa_stream_write(m_Stream, m_writeBuffer, length, NULL, 0, PA_SEEK_RELATIVE);
+  else
+    error = pa_stream_cancel_write(m_Stream);
+  pa_threaded_mainloop_unlock(m_MainLoop);
+  m_writeBuffer = NULL;
+
+  if (error)
+  {
+    CLog::Log(LOGERROR, "CAESinkPULSE::CommitBuffer - pa_stream_write failed");
+    return 0;
+  }
+  m_lastPackageStamp = CurrentHostCounter();
+  m_filled_bytes = m_BufferSize - (m_writeFree - length);
+
+  return frames;
+}
+
 void CAESinkPULSE::Drain()
 {
   if (!m_IsAllocated)
@@ -42,6 +42,9 @@ public:
   virtual void         GetDelay        (AEDelayStatus& status);
   virtual double       GetCacheTotal   ();
   virtual unsigned int AddPackets      (uint8_t **data, unsigned int frames, unsigned int offset);
+  virtual bool         HasBufferAccess () { return !m_passthrough; }
+  virtual unsigned int GetBuffer       (uint8_t *&data, unsigned int frames);
+  virtual unsigned int CommitBuffer    (unsigned int frames);
   virtual void         Drain           ();
 
   virtual bool HasVolume() { return true; };
@@ -72,6 +75,9 @@ private:
   uint32_t m_periodSize;
   uint64_t m_lastPackageStamp;
   uint64_t m_filled_bytes;
+  // memory handed out by pa_stream_begin_write until it is committed
+  uint8_t *m_writeBuffer;
+  unsigned int m_writeFree;
 
   pa_context *m_Context;
   pa_threaded_mainloop *m_MainLoop;
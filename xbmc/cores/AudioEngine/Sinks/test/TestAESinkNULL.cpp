@@ -0,0 +1,90 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+#include <vector>
+
+#include "cores/AudioEngine/Sinks/AESinkNULL.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+AEAudioFormat StereoFloat()
+{
+  AEAudioFormat format;
+  format.m_dataFormat = AE_FMT_FLOAT;
+  format.m_sampleRate = 48000;
+  format.m_channelLayout = AE_CH_LAYOUT_2_0;
+  return format;
+}
+}
+
+TEST(TestAESinkNULL, Measure)
+{
+  CAESinkNULL sink;
+  AEAudioFormat format = StereoFloat();
+  std::string device = "measure";
+  ASSERT_TRUE(sink.Initialize(format, device));
+  ASSERT_TRUE(sink.HasBufferAccess());
+  ASSERT_EQ(8u, format.m_frameSize);
+
+  // written in place
+  uint8_t *buffer = nullptr;
+  ASSERT_EQ(1000u, sink.GetBuffer(buffer, 1000));
+  ASSERT_TRUE(buffer != nullptr);
+  memset(buffer, 0, 1000 * format.m_frameSize);
+  EXPECT_EQ(1000u, sink.CommitBuffer(1000));
+
+  // copied
+  std::vector<uint8_t> packet(500 * format.m_frameSize);
+  uint8_t *data[] = { packet.data() };
+  EXPECT_EQ(500u, sink.AddPackets(data, 500, 0));
+
+  uint64_t copied, inPlace;
+  sink.GetMeasurement(copied, inPlace);
+  EXPECT_EQ(500u * format.m_frameSize, copied);
+  EXPECT_EQ(1000u * format.m_frameSize, inPlace);
+
+  // the sink never hands out more than the 500ms it can hold
+  EXPECT_GE(format.m_sampleRate / 2, sink.GetBuffer(buffer, 10 * format.m_sampleRate));
+  EXPECT_EQ(0u, sink.CommitBuffer(0));
+
+  sink.Deinitialize();
+}
+
+TEST(TestAESinkNULL, NoBufferAccess)
+{
+  // the plain device takes packets only
+  CAESinkNULL sink;
+  AEAudioFormat format = StereoFloat();
+  std::string device = "default";
+  ASSERT_TRUE(sink.Initialize(format, device));
+  EXPECT_FALSE(sink.HasBufferAccess());
+
+  uint8_t *buffer = nullptr;
+  EXPECT_EQ(0u, sink.GetBuffer(buffer, 1000));
+
+  std::vector<uint8_t> packet(500 * format.m_frameSize);
+  uint8_t *data[] = { packet.data() };
+  EXPECT_EQ(500u, sink.AddPackets(data, 500, 0));
+
+  sink.Deinitialize();
+}
@@ -0,0 +1,173 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AEKernels.h"
+
+#include <algorithm>
+#include <math.h>
+
+#include "utils/CPUInfo.h"
+#include "utils/log.h"
+
+// this file is built with -ffp-contract=off, a fused multiply-add would
+// round differently than the vector implementations
+
+static void Mix(float *dst, const float *src, float gain, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; i++)
+    dst[i] += src[i] * gain;
+}
+
+static void Gain(float *data, float gain, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; i++)
+    data[i] *= gain;
+}
+
+static void Clamp(float *data, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; i++)
+  {
+    // same as CAEUtil::SoftClamp(), which is 1 at 3 already
+    float x = std::min(std::max(data[i], -3.0f), 3.0f);
+    float y = x * x;
+    data[i] = x * (27.0f + y) / (27.0f + 9.0f * y);
+  }
+}
+
+static float PeakAbs(const float *data, unsigned int count)
+{
+  float peak = 0.0f;
+  for (unsigned int i = 0; i < count; i++)
+    peak = std::max(peak, fabsf(data[i]));
+  return peak;
+}
+
+static float Dot(const float *a, const float *b, unsigned int count)
+{
+  float sums[8] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+  for (unsigned int i = 0; i < count; i++)
+    sums[i % 8] += a[i] * b[i];
+  return CAEKernels::SumLanes(sums);
+}
+
+static void Interleave(float *dst, const float * const *src, unsigned int channels, unsigned int frames)
+{
+  for (unsigned int ch = 0; ch < channels; ch++)
+  {
+    const float *plane = src[ch];
+    float *out = dst + ch;
+    for (unsigned int i = 0; i < frames; i++, out += channels)
+      *out = plane[i];
+  }
+}
+
+static void Deinterleave(float * const *dst, const float *src, unsigned int channels, unsigned int frames)
+{
+  for (unsigned int ch = 0; ch < channels; ch++)
+  {
+    float *plane = dst[ch];
+    const float *in = src + ch;
+    for (unsigned int i = 0; i < frames; i++, in += channels)
+      plane[i] = *in;
+  }
+}
+
+static void FloatToS16(int16_t *dst, const float *src, unsigned int count, uint32_t *dither)
+{
+  for (unsigned int i = 0; i < count; i++)
+  {
+    float v = src[i] * AE_S16_SCALE;
+    if (dither)
+      v += static_cast<float>(CAEKernels::DitherNoise(*dither, i)) * AE_DITHER_SCALE;
+    v = std::min(std::max(v, AE_S16_MIN), AE_S16_MAX);
+    dst[i] = static_cast<int16_t>(lrintf(v));
+  }
+
+  if (dither)
+    *dither += count;
+}
+
+static void FloatToS32(int32_t *dst, const float *src, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; i++)
+  {
+    float v = std::min(std::max(src[i] * AE_S32_SCALE, -AE_S32_SCALE), AE_S32_MAX);
+    dst[i] = static_cast<int32_t>(lrintf(v));
+  }
+}
+
+static void S16ToFloat(float *dst, const int16_t *src, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; i++)
+    dst[i] = static_cast<float>(src[i]) * (1.0f / AE_S16_SCALE);
+}
+
+static void S32ToFloat(float *dst, const int32_t *src, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; i++)
+    dst[i] = static_cast<float>(src[i]) * (1.0f / AE_S32_SCALE);
+}
+
+static const AEKernels scalarKernels =
+{
+  "scalar",
+  Mix,
+  Gain,
+  Clamp,
+  PeakAbs,
+  Dot,
+  Interleave,
+  Deinterleave,
+  FloatToS16,
+  FloatToS32,
+  S16ToFloat,
+  S32ToFloat
+};
+
+const AEKernels& CAEKernels::GetScalar()
+{
+  return scalarKernels;
+}
+
+const AEKernels& CAEKernels::Select(unsigned int cpuFeatures)
+{
+  const AEKernels *kernels = GetAVX2(cpuFeatures);
+  if (!kernels)
+    kernels = GetSSE2(cpuFeatures);
+  if (!kernels)
+    kernels = GetNEON(cpuFeatures);
+  if (!kernels)
+    kernels = &scalarKernels;
+  return *kernels;
+}
+
+static const AEKernels& SelectForCPU()
+{
+  const AEKernels &kernels = CAEKernels::Select(g_cpuInfo.GetCPUFeatures());
+  CLog::Log(LOGNOTICE, "CAEKernels::%s - using %s kernels", __FUNCTION__, kernels.name);
+  return kernels;
+}
+
+const AEKernels& CAEKernels::Get()
+{
+  static const AEKernels &kernels = SelectForCPU();
+  return kernels;
+}
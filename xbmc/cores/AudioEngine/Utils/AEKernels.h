@@ -0,0 +1,127 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*!
+ \brief The sample processing kernels of the audio engine.
+
+ Every instruction set fills in the same table. All implementations give
+ bit exact results, so the scalar one is the reference the others are tested
+ against. Buffers need no particular alignment.
+ */
+struct AEKernels
+{
+  const char *name;
+
+  /*! \brief dst[i] += src[i] * gain */
+  void (*Mix)(float *dst, const float *src, float gain, unsigned int count);
+  /*! \brief data[i] *= gain */
+  void (*Gain)(float *data, float gain, unsigned int count);
+  /*! \brief Soft clips samples into -1..1, see CAEUtil::SoftClamp() */
+  void (*Clamp)(float *data, unsigned int count);
+  /*! \brief Returns the highest absolute sample value */
+  float (*PeakAbs)(const float *data, unsigned int count);
+  /*!
+   \brief Returns the sum of a[i] * b[i]. Products go to eight partial sums by
+          i % 8 which are added up by CAEKernels::SumLanes(), that order keeps
+          the result exact across instruction sets. This also needs every
+          product rounded before it is added, so the kernel sources are built
+          with -ffp-contract=off (/fp:strict on msvc) to stop the compiler
+          from fusing them into a multiply-add.
+   */
+  float (*Dot)(const float *a, const float *b, unsigned int count);
+
+  /*! \brief Interleaves planar channels into frames */
+  void (*Interleave)(float *dst, const float * const *src, unsigned int channels, unsigned int frames);
+  /*! \brief Splits frames into planar channels */
+  void (*Deinterleave)(float * const *dst, const float *src, unsigned int channels, unsigned int frames);
+
+  /*!
+   \brief Converts samples to signed 16 bit, rounding to nearest and saturating.
+   \param dither if not NULL, triangular dither of one LSB is added. The
+          noise depends on the seed and the sample position only, the seed
+          is advanced by count.
+   */
+  void (*FloatToS16)(int16_t *dst, const float *src, unsigned int count, uint32_t *dither);
+  /*! \brief Converts samples to signed 32 bit, rounding to nearest and saturating */
+  void (*FloatToS32)(int32_t *dst, const float *src, unsigned int count);
+  void (*S16ToFloat)(float *dst, const int16_t *src, unsigned int count);
+  void (*S32ToFloat)(float *dst, const int32_t *src, unsigned int count);
+};
+
+class CAEKernels
+{
+public:
+  /*!
+   \brief The fastest kernels the cpu supports, selected once on first use.
+   */
+  static const AEKernels& Get();
+
+  /*!
+   \brief Selects the fastest kernels for the given CPU_FEATURE_* flags.
+   */
+  static const AEKernels& Select(unsigned int cpuFeatures);
+
+  /*!
+   \brief The implementations for one instruction set.
+   \return NULL if it's not compiled in or the cpu doesn't support it.
+   */
+  static const AEKernels& GetScalar();
+  static const AEKernels* GetSSE2(unsigned int cpuFeatures);
+  static const AEKernels* GetAVX2(unsigned int cpuFeatures);
+  static const AEKernels* GetNEON(unsigned int cpuFeatures);
+
+  /*!
+   \brief The dither noise added to sample number index, in -1..1 LSB.
+   */
+  static inline int32_t DitherNoise(uint32_t seed, uint32_t index)
+  {
+    uint32_t x = seed + index;
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return static_cast<int32_t>(x & 0xffff) - static_cast<int32_t>(x >> 16);
+  }
+
+  /*!
+   \brief Adds the eight partial sums of Dot(), the tree a vector register
+          is reduced in.
+   */
+  static inline float SumLanes(const float *sums)
+  {
+    return ((sums[0] + sums[4]) + (sums[2] + sums[6])) + ((sums[1] + sums[5]) + (sums[3] + sums[7]));
+  }
+};
+
+// shared by the implementations
+#define AE_S16_SCALE      32768.0f
+#define AE_S32_SCALE      2147483648.0f
+#define AE_S16_MIN        -32768.0f
+#define AE_S16_MAX        32767.0f
+// the largest float below 2^31, higher values would not convert
+#define AE_S32_MAX        2147483520.0f
+#define AE_DITHER_SCALE   (1.0f / 65536.0f)
+// adding and removing 2^23 rounds 0 <= x < 2^23 to nearest even, for cpus that only truncate
+#define AE_ROUND_MAGIC    8388608.0f
@@ -0,0 +1,285 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AEKernels.h"
+
+// this file alone is built with avx2 enabled, nothing in here may run before
+// the cpu has been checked
+#ifdef __AVX2__
+
+#include <immintrin.h>
+
+#include "utils/CPUInfo.h"
+
+static void Mix(float *dst, const float *src, float gain, unsigned int count)
+{
+  const __m256 g = _mm256_set1_ps(gain);
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+    _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(_mm256_loadu_ps(src + i), g)));
+  for (; i < count; i++)
+    dst[i] += src[i] * gain;
+}
+
+static void Gain(float *data, float gain, unsigned int count)
+{
+  const __m256 g = _mm256_set1_ps(gain);
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+    _mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), g));
+  for (; i < count; i++)
+    data[i] *= gain;
+}
+
+static inline __m256 SoftClamp(__m256 x)
+{
+  x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-3.0f)), _mm256_set1_ps(3.0f));
+  const __m256 y = _mm256_mul_ps(x, x);
+  const __m256 num = _mm256_add_ps(_mm256_set1_ps(27.0f), y);
+  const __m256 den = _mm256_add_ps(_mm256_set1_ps(27.0f), _mm256_mul_ps(_mm256_set1_ps(9.0f), y));
+  return _mm256_div_ps(_mm256_mul_ps(x, num), den);
+}
+
+static inline __m128 SoftClamp(__m128 x)
+{
+  x = _mm_min_ss(_mm_max_ss(x, _mm_set_ss(-3.0f)), _mm_set_ss(3.0f));
+  const __m128 y = _mm_mul_ss(x, x);
+  const __m128 num = _mm_add_ss(_mm_set_ss(27.0f), y);
+  const __m128 den = _mm_add_ss(_mm_set_ss(27.0f), _mm_mul_ss(_mm_set_ss(9.0f), y));
+  return _mm_div_ss(_mm_mul_ss(x, num), den);
+}
+
+static void Clamp(float *data, unsigned int count)
+{
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+    _mm256_storeu_ps(data + i, SoftClamp(_mm256_loadu_ps(data + i)));
+  for (; i < count; i++)
+    _mm_store_ss(data + i, SoftClamp(_mm_load_ss(data + i)));
+}
+
+static float PeakAbs(const float *data, unsigned int count)
+{
+  const __m256 mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+  __m256 peak = _mm256_setzero_ps();
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+    peak = _mm256_max_ps(peak, _mm256_and_ps(_mm256_loadu_ps(data + i), mask));
+
+  __m128 peak4 = _mm_max_ps(_mm256_castps256_ps128(peak), _mm256_extractf128_ps(peak, 1));
+  for (; i < count; i++)
+    peak4 = _mm_max_ss(peak4, _mm_and_ps(_mm_load_ss(data + i), _mm256_castps256_ps128(mask)));
+
+  peak4 = _mm_max_ps(peak4, _mm_movehl_ps(peak4, peak4));
+  peak4 = _mm_max_ss(peak4, _mm_shuffle_ps(peak4, peak4, _MM_SHUFFLE(1, 1, 1, 1)));
+  return _mm_cvtss_f32(peak4);
+}
+
+static float Dot(const float *a, const float *b, unsigned int count)
+{
+  __m256 acc = _mm256_setzero_ps();
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+    acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+  float sums[8];
+  _mm256_storeu_ps(sums, acc);
+  for (; i < count; i++)
+    sums[i % 8] += a[i] * b[i];
+  return CAEKernels::SumLanes(sums);
+}
+
+static void Interleave(float *dst, const float * const *src, unsigned int channels, unsigned int frames)
+{
+  unsigned int i = 0;
+  if (channels == 2)
+  {
+    const float *left = src[0];
+    const float *right = src[1];
+    for (; i + 8 <= frames; i += 8)
+    {
+      const __m256 l = _mm256_loadu_ps(left + i);
+      const __m256 r = _mm256_loadu_ps(right + i);
+      // unpack works within 128 bit lanes, the permutes put the lanes in order
+      const __m256 lo = _mm256_unpacklo_ps(l, r);
+      const __m256 hi = _mm256_unpackhi_ps(l, r);
+      _mm256_storeu_ps(dst + i * 2, _mm256_permute2f128_ps(lo, hi, 0x20));
+      _mm256_storeu_ps(dst + i * 2 + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+  }
+
+  for (unsigned int ch = 0; ch < channels; ch++)
+  {
+    for (unsigned int j = i; j < frames; j++)
+      dst[j * channels + ch] = src[ch][j];
+  }
+}
+
+static void Deinterleave(float * const *dst, const float *src, unsigned int channels, unsigned int frames)
+{
+  unsigned int i = 0;
+  if (channels == 2)
+  {
+    float *left = dst[0];
+    float *right = dst[1];
+    const __m256i order = _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7);
+    for (; i + 8 <= frames; i += 8)
+    {
+      const __m256 a = _mm256_loadu_ps(src + i * 2);
+      const __m256 b = _mm256_loadu_ps(src + i * 2 + 8);
+      const __m256 l = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+      const __m256 r = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+      _mm256_storeu_ps(left + i, _mm256_permutevar8x32_ps(l, order));
+      _mm256_storeu_ps(right + i, _mm256_permutevar8x32_ps(r, order));
+    }
+  }
+
+  for (unsigned int ch = 0; ch < channels; ch++)
+  {
+    for (unsigned int j = i; j < frames; j++)
+      dst[ch][j] = src[j * channels + ch];
+  }
+}
+
+static inline __m256 DitherNoise(uint32_t seed, unsigned int index)
+{
+  // the hash of CAEKernels::DitherNoise() for eight samples at once
+  __m256i x = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(seed + index)),
+                               _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+  x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+  x = _mm256_mullo_epi32(x, _mm256_set1_epi32(0x7feb352d));
+  x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+  x = _mm256_mullo_epi32(x, _mm256_set1_epi32(static_cast<int>(0x846ca68bU)));
+  x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+  const __m256i noise = _mm256_sub_epi32(_mm256_and_si256(x, _mm256_set1_epi32(0xffff)), _mm256_srli_epi32(x, 16));
+  return _mm256_cvtepi32_ps(noise);
+}
+
+static void FloatToS16(int16_t *dst, const float *src, unsigned int count, uint32_t *dither)
+{
+  const __m256 scale = _mm256_set1_ps(AE_S16_SCALE);
+  const __m256 ditherScale = _mm256_set1_ps(AE_DITHER_SCALE);
+  const __m256 lo = _mm256_set1_ps(AE_S16_MIN);
+  const __m256 hi = _mm256_set1_ps(AE_S16_MAX);
+  unsigned int i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    __m256 a = _mm256_mul_ps(_mm256_loadu_ps(src + i), scale);
+    __m256 b = _mm256_mul_ps(_mm256_loadu_ps(src + i + 8), scale);
+    if (dither)
+    {
+      a = _mm256_add_ps(a, _mm256_mul_ps(DitherNoise(*dither, i), ditherScale));
+      b = _mm256_add_ps(b, _mm256_mul_ps(DitherNoise(*dither, i + 8), ditherScale));
+    }
+    a = _mm256_min_ps(_mm256_max_ps(a, lo), hi);
+    b = _mm256_min_ps(_mm256_max_ps(b, lo), hi);
+    // packs works within 128 bit lanes as well
+    const __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+  }
+  for (; i < count; i++)
+  {
+    __m128 v = _mm_mul_ss(_mm_load_ss(src + i), _mm256_castps256_ps128(scale));
+    if (dither)
+      v = _mm_add_ss(v, _mm_mul_ss(_mm_set_ss(static_cast<float>(CAEKernels::DitherNoise(*dither, i))),
+                                   _mm256_castps256_ps128(ditherScale)));
+    v = _mm_min_ss(_mm_max_ss(v, _mm256_castps256_ps128(lo)), _mm256_castps256_ps128(hi));
+    dst[i] = static_cast<int16_t>(_mm_cvtss_si32(v));
+  }
+
+  if (dither)
+    *dither += count;
+}
+
+static void FloatToS32(int32_t *dst, const float *src, unsigned int count)
+{
+  const __m256 scale = _mm256_set1_ps(AE_S32_SCALE);
+  const __m256 lo = _mm256_set1_ps(-AE_S32_SCALE);
+  const __m256 hi = _mm256_set1_ps(AE_S32_MAX);
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256 v = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(src + i), scale), lo), hi);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_cvtps_epi32(v));
+  }
+  for (; i < count; i++)
+  {
+    __m128 v = _mm_mul_ss(_mm_load_ss(src + i), _mm256_castps256_ps128(scale));
+    v = _mm_min_ss(_mm_max_ss(v, _mm256_castps256_ps128(lo)), _mm256_castps256_ps128(hi));
+    dst[i] = _mm_cvtss_si32(v);
+  }
+}
+
+static void S16ToFloat(float *dst, const int16_t *src, unsigned int count)
+{
+  const __m256 scale = _mm256_set1_ps(1.0f / AE_S16_SCALE);
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    const __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+    _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+  }
+  for (; i < count; i++)
+    dst[i] = static_cast<float>(src[i]) * (1.0f / AE_S16_SCALE);
+}
+
+static void S32ToFloat(float *dst, const int32_t *src, unsigned int count)
+{
+  const __m256 scale = _mm256_set1_ps(1.0f / AE_S32_SCALE);
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+  }
+  for (; i < count; i++)
+    dst[i] = static_cast<float>(src[i]) * (1.0f / AE_S32_SCALE);
+}
+
+static const AEKernels avx2Kernels =
+{
+  "avx2",
+  Mix,
+  Gain,
+  Clamp,
+  PeakAbs,
+  Dot,
+  Interleave,
+  Deinterleave,
+  FloatToS16,
+  FloatToS32,
+  S16ToFloat,
+  S32ToFloat
+};
+
+const AEKernels* CAEKernels::GetAVX2(unsigned int cpuFeatures)
+{
+  if (cpuFeatures & CPU_FEATURE_AVX2)
+    return &avx2Kernels;
+  return NULL;
+}
+
+#else
+
+const AEKernels* CAEKernels::GetAVX2(unsigned int)
+{
+  return NULL;
+}
+
+#endif
@@ -0,0 +1,289 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AEKernels.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(__aarch64__)
+
+#include <algorithm>
+#include <arm_neon.h>
+#include <math.h>
+
+#include "utils/CPUInfo.h"
+
+// vmlaq_f32 may be fused on some cores, the kernels only use separate
+// multiplies and adds to stay bit exact with the scalar ones. armv7 neon
+// flushes denormals to zero, those are the only values that differ there
+
+static void Mix(float *dst, const float *src, float gain, unsigned int count)
+{
+  const float32x4_t g = vdupq_n_f32(gain);
+  unsigned int i = 0;
+  for (; i + 4 <= count; i += 4)
+    vst1q_f32(dst + i, vaddq_f32(vld1q_f32(dst + i), vmulq_f32(vld1q_f32(src + i), g)));
+  for (; i < count; i++)
+    dst[i] += src[i] * gain;
+}
+
+static void Gain(float *data, float gain, unsigned int count)
+{
+  const float32x4_t g = vdupq_n_f32(gain);
+  unsigned int i = 0;
+  for (; i + 4 <= count; i += 4)
+    vst1q_f32(data + i, vmulq_f32(vld1q_f32(data + i), g));
+  for (; i < count; i++)
+    data[i] *= gain;
+}
+
+static void Clamp(float *data, unsigned int count)
+{
+  unsigned int i = 0;
+#if defined(__aarch64__)
+  const float32x4_t lo = vdupq_n_f32(-3.0f);
+  const float32x4_t hi = vdupq_n_f32(3.0f);
+  const float32x4_t c27 = vdupq_n_f32(27.0f);
+  const float32x4_t c9 = vdupq_n_f32(9.0f);
+  for (; i + 4 <= count; i += 4)
+  {
+    float32x4_t x = vminq_f32(vmaxq_f32(vld1q_f32(data + i), lo), hi);
+    float32x4_t y = vmulq_f32(x, x);
+    float32x4_t num = vaddq_f32(c27, y);
+    float32x4_t den = vaddq_f32(c27, vmulq_f32(c9, y));
+    vst1q_f32(data + i, vdivq_f32(vmulq_f32(x, num), den));
+  }
+#endif
+  // armv7 has no vector division, its reciprocal estimate is not exact
+  for (; i < count; i++)
+  {
+    float x = std::min(std::max(data[i], -3.0f), 3.0f);
+    float y = x * x;
+    data[i] = x * (27.0f + y) / (27.0f + 9.0f * y);
+  }
+}
+
+static float PeakAbs(const float *data, unsigned int count)
+{
+  float32x4_t peak = vdupq_n_f32(0.0f);
+  unsigned int i = 0;
+  for (; i + 4 <= count; i += 4)
+    peak = vmaxq_f32(peak, vabsq_f32(vld1q_f32(data + i)));
+
+  float32x2_t peak2 = vpmax_f32(vget_low_f32(peak), vget_high_f32(peak));
+  peak2 = vpmax_f32(peak2, peak2);
+  float result = vget_lane_f32(peak2, 0);
+  for (; i < count; i++)
+    result = std::max(result, fabsf(data[i]));
+  return result;
+}
+
+static float Dot(const float *a, const float *b, unsigned int count)
+{
+  float32x4_t lo = vdupq_n_f32(0.0f);
+  float32x4_t hi = vdupq_n_f32(0.0f);
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    lo = vaddq_f32(lo, vmulq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+    hi = vaddq_f32(hi, vmulq_f32(vld1q_f32(a + i + 4), vld1q_f32(b + i + 4)));
+  }
+  float sums[8];
+  vst1q_f32(sums, lo);
+  vst1q_f32(sums + 4, hi);
+  for (; i < count; i++)
+    sums[i % 8] += a[i] * b[i];
+  return CAEKernels::SumLanes(sums);
+}
+
+static void Interleave(float *dst, const float * const *src, unsigned int channels, unsigned int frames)
+{
+  unsigned int i = 0;
+  if (channels == 2)
+  {
+    const float *left = src[0];
+    const float *right = src[1];
+    for (; i + 4 <= frames; i += 4)
+    {
+      float32x4x2_t v;
+      v.val[0] = vld1q_f32(left + i);
+      v.val[1] = vld1q_f32(right + i);
+      vst2q_f32(dst + i * 2, v);
+    }
+  }
+
+  for (unsigned int ch = 0; ch < channels; ch++)
+  {
+    for (unsigned int j = i; j < frames; j++)
+      dst[j * channels + ch] = src[ch][j];
+  }
+}
+
+static void Deinterleave(float * const *dst, const float *src, unsigned int channels, unsigned int frames)
+{
+  unsigned int i = 0;
+  if (channels == 2)
+  {
+    float *left = dst[0];
+    float *right = dst[1];
+    for (; i + 4 <= frames; i += 4)
+    {
+      float32x4x2_t v = vld2q_f32(src + i * 2);
+      vst1q_f32(left + i, v.val[0]);
+      vst1q_f32(right + i, v.val[1]);
+    }
+  }
+
+  for (unsigned int ch = 0; ch < channels; ch++)
+  {
+    for (unsigned int j = i; j < frames; j++)
+      dst[ch][j] = src[j * channels + ch];
+  }
+}
+
+static inline int32x4_t Round(float32x4_t v)
+{
+#if defined(__aarch64__)
+  return vcvtnq_s32_f32(v);
+#else
+  // vcvtq truncates, round the magnitude to nearest even first
+  const float32x4_t magic = vdupq_n_f32(AE_ROUND_MAGIC);
+  const uint32x4_t sign = vdupq_n_u32(0x80000000);
+  float32x4_t a = vabsq_f32(v);
+  uint32x4_t small = vcltq_f32(a, magic);
+  float32x4_t r = vsubq_f32(vaddq_f32(a, magic), magic);
+  a = vbslq_f32(small, r, a);
+  a = vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a), vandq_u32(vreinterpretq_u32_f32(v), sign)));
+  return vcvtq_s32_f32(a);
+#endif
+}
+
+static inline int32_t Round(float v)
+{
+  return vgetq_lane_s32(Round(vdupq_n_f32(v)), 0);
+}
+
+static void FloatToS16(int16_t *dst, const float *src, unsigned int count, uint32_t *dither)
+{
+  const float32x4_t scale = vdupq_n_f32(AE_S16_SCALE);
+  const float32x4_t lo = vdupq_n_f32(AE_S16_MIN);
+  const float32x4_t hi = vdupq_n_f32(AE_S16_MAX);
+  unsigned int i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    float32x4_t v = vmulq_f32(vld1q_f32(src + i), scale);
+    if (dither)
+    {
+      float noise[4];
+      for (unsigned int j = 0; j < 4; j++)
+        noise[j] = static_cast<float>(CAEKernels::DitherNoise(*dither, i + j));
+      v = vaddq_f32(v, vmulq_f32(vld1q_f32(noise), vdupq_n_f32(AE_DITHER_SCALE)));
+    }
+    v = vminq_f32(vmaxq_f32(v, lo), hi);
+    vst1_s16(dst + i, vmovn_s32(Round(v)));
+  }
+  for (; i < count; i++)
+  {
+    float v = src[i] * AE_S16_SCALE;
+    if (dither)
+      v += static_cast<float>(CAEKernels::DitherNoise(*dither, i)) * AE_DITHER_SCALE;
+    v = std::min(std::max(v, AE_S16_MIN), AE_S16_MAX);
+    dst[i] = static_cast<int16_t>(Round(v));
+  }
+
+  if (dither)
+    *dither += count;
+}
+
+static void FloatToS32(int32_t *dst, const float *src, unsigned int count)
+{
+  const float32x4_t scale = vdupq_n_f32(AE_S32_SCALE);
+  const float32x4_t lo = vdupq_n_f32(-AE_S32_SCALE);
+  const float32x4_t hi = vdupq_n_f32(AE_S32_MAX);
+  unsigned int i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    float32x4_t v = vminq_f32(vmaxq_f32(vmulq_f32(vld1q_f32(src + i), scale), lo), hi);
+    vst1q_s32(dst + i, Round(v));
+  }
+  for (; i < count; i++)
+  {
+    float v = std::min(std::max(src[i] * AE_S32_SCALE, -AE_S32_SCALE), AE_S32_MAX);
+    dst[i] = Round(v);
+  }
+}
+
+static void S16ToFloat(float *dst, const int16_t *src, unsigned int count)
+{
+  const float32x4_t scale = vdupq_n_f32(1.0f / AE_S16_SCALE);
+  unsigned int i = 0;
+  for (; i + 4 <= count; i += 4)
+    vst1q_f32(dst + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vld1_s16(src + i))), scale));
+  for (; i < count; i++)
+    dst[i] = static_cast<float>(src[i]) * (1.0f / AE_S16_SCALE);
+}
+
+static void S32ToFloat(float *dst, const int32_t *src, unsigned int count)
+{
+  const float32x4_t scale = vdupq_n_f32(1.0f / AE_S32_SCALE);
+  unsigned int i = 0;
+  for (; i + 4 <= count; i += 4)
+    vst1q_f32(dst + i, vmulq_f32(vcvtq_f32_s32(vld1q_s32(src + i)), scale));
+  for (; i < count; i++)
+    dst[i] = static_cast<float>(src[i]) * (1.0f / AE_S32_SCALE);
+}
+
+static const AEKernels neonKernels =
+{
+  "neon",
+  Mix,
+  Gain,
+  Clamp,
+  PeakAbs,
+  Dot,
+  Interleave,
+  Deinterleave,
+  FloatToS16,
+  FloatToS32,
+  S16ToFloat,
+  S32ToFloat
+};
+
+#if defined(__aarch64__)
+const AEKernels* CAEKernels::GetNEON(unsigned int)
+{
+  return &neonKernels;
+}
+#else
+const AEKernels* CAEKernels::GetNEON(unsigned int cpuFeatures)
+{
+  // armv7 builds may run on cpus without neon
+  if (!(cpuFeatures & CPU_FEATURE_NEON))
+    return NULL;
+  return &neonKernels;
+}
+#endif
+
+#else
+
+const AEKernels* CAEKernels::GetNEON(unsigned int)
+{
+  return NULL;
+}
+
+#endif
@@ -0,0 +1,273 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AEKernels.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AE_KERNELS_SSE2
+#endif
+
+#ifdef AE_KERNELS_SSE2
+
+#include <emmintrin.h>
+
+#include "utils/CPUInfo.h"
+
+// the scalar loops finish what doesn't fill a whole vector, they have to
+// round exactly like the vector code does
+
+static void Mix(float *dst, const float *src, float gain, unsigned int count)
+{
+  const __m128 g = _mm_set1_ps(gain);
+  unsigned int i = 0;
+  for (; i + 4 <= count; i += 4)
+    _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+  for (; i < count; i++)
+    dst[i] += src[i] * gain;
+}
+
+static void Gain(float *data, float gain, unsigned int count)
+{
+  const __m128 g = _mm_set1_ps(gain);
+  unsigned int i = 0;
+  for (; i + 4 <= count; i += 4)
+    _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), g));
+  for (; i < count; i++)
+    data[i] *= gain;
+}
+
+static inline __m128 SoftClamp(__m128 x)
+{
+  x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-3.0f)), _mm_set1_ps(3.0f));
+  const __m128 y = _mm_mul_ps(x, x);
+  const __m128 num = _mm_add_ps(_mm_set1_ps(27.0f), y);
+  const __m128 den = _mm_add_ps(_mm_set1_ps(27.0f), _mm_mul_ps(_mm_set1_ps(9.0f), y));
+  return _mm_div_ps(_mm_mul_ps(x, num), den);
+}
+
+static void Clamp(float *data, unsigned int count)
+{
+  unsigned int i = 0;
+  for (; i + 4 <= count; i += 4)
+    _mm_storeu_ps(data + i, SoftClamp(_mm_loadu_ps(data + i)));
+  for (; i < count; i++)
+    _mm_store_ss(data + i, SoftClamp(_mm_load_ss(data + i)));
+}
+
+static float PeakAbs(const float *data, unsigned int count)
+{
+  const __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  __m128 peak = _mm_setzero_ps();
+  unsigned int i = 0;
+  for (; i + 4 <= count; i += 4)
+    peak = _mm_max_ps(peak, _mm_and_ps(_mm_loadu_ps(data + i), mask));
+  for (; i < count; i++)
+    peak = _mm_max_ss(peak, _mm_and_ps(_mm_load_ss(data + i), mask));
+
+  peak = _mm_max_ps(peak, _mm_movehl_ps(peak, peak));
+  peak = _mm_max_ss(peak, _mm_shuffle_ps(peak, peak, _MM_SHUFFLE(1, 1, 1, 1)));
+  return _mm_cvtss_f32(peak);
+}
+
+static float Dot(const float *a, const float *b, unsigned int count)
+{
+  __m128 lo = _mm_setzero_ps();
+  __m128 hi = _mm_setzero_ps();
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    lo = _mm_add_ps(lo, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    hi = _mm_add_ps(hi, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+  }
+  float sums[8];
+  _mm_storeu_ps(sums, lo);
+  _mm_storeu_ps(sums + 4, hi);
+  for (; i < count; i++)
+    sums[i % 8] += a[i] * b[i];
+  return CAEKernels::SumLanes(sums);
+}
+
+static void Interleave(float *dst, const float * const *src, unsigned int channels, unsigned int frames)
+{
+  unsigned int i = 0;
+  if (channels == 2)
+  {
+    const float *left = src[0];
+    const float *right = src[1];
+    for (; i + 4 <= frames; i += 4)
+    {
+      const __m128 l = _mm_loadu_ps(left + i);
+      const __m128 r = _mm_loadu_ps(right + i);
+      _mm_storeu_ps(dst + i * 2, _mm_unpacklo_ps(l, r));
+      _mm_storeu_ps(dst + i * 2 + 4, _mm_unpackhi_ps(l, r));
+    }
+  }
+
+  for (unsigned int ch = 0; ch < channels; ch++)
+  {
+    for (unsigned int j = i; j < frames; j++)
+      dst[j * channels + ch] = src[ch][j];
+  }
+}
+
+static void Deinterleave(float * const *dst, const float *src, unsigned int channels, unsigned int frames)
+{
+  unsigned int i = 0;
+  if (channels == 2)
+  {
+    float *left = dst[0];
+    float *right = dst[1];
+    for (; i + 4 <= frames; i += 4)
+    {
+      const __m128 a = _mm_loadu_ps(src + i * 2);
+      const __m128 b = _mm_loadu_ps(src + i * 2 + 4);
+      _mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+      _mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+  }
+
+  for (unsigned int ch = 0; ch < channels; ch++)
+  {
+    for (unsigned int j = i; j < frames; j++)
+      dst[ch][j] = src[j * channels + ch];
+  }
+}
+
+static inline __m128 DitherNoise(uint32_t seed, unsigned int index)
+{
+  return _mm_setr_ps(static_cast<float>(CAEKernels::DitherNoise(seed, index)),
+                     static_cast<float>(CAEKernels::DitherNoise(seed, index + 1)),
+                     static_cast<float>(CAEKernels::DitherNoise(seed, index + 2)),
+                     static_cast<float>(CAEKernels::DitherNoise(seed, index + 3)));
+}
+
+static void FloatToS16(int16_t *dst, const float *src, unsigned int count, uint32_t *dither)
+{
+  const __m128 scale = _mm_set1_ps(AE_S16_SCALE);
+  const __m128 ditherScale = _mm_set1_ps(AE_DITHER_SCALE);
+  const __m128 lo = _mm_set1_ps(AE_S16_MIN);
+  const __m128 hi = _mm_set1_ps(AE_S16_MAX);
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m128 a = _mm_mul_ps(_mm_loadu_ps(src + i), scale);
+    __m128 b = _mm_mul_ps(_mm_loadu_ps(src + i + 4), scale);
+    if (dither)
+    {
+      a = _mm_add_ps(a, _mm_mul_ps(DitherNoise(*dither, i), ditherScale));
+      b = _mm_add_ps(b, _mm_mul_ps(DitherNoise(*dither, i + 4), ditherScale));
+    }
+    a = _mm_min_ps(_mm_max_ps(a, lo), hi);
+    b = _mm_min_ps(_mm_max_ps(b, lo), hi);
+    // the values are in range already, so the saturation of packs does nothing
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+  }
+  for (; i < count; i++)
+  {
+    __m128 v = _mm_mul_ss(_mm_load_ss(src + i), scale);
+    if (dither)
+      v = _mm_add_ss(v, _mm_mul_ss(_mm_set_ss(static_cast<float>(CAEKernels::DitherNoise(*dither, i))), ditherScale));
+    v = _mm_min_ss(_mm_max_ss(v, lo), hi);
+    dst[i] = static_cast<int16_t>(_mm_cvtss_si32(v));
+  }
+
+  if (dither)
+    *dither += count;
+}
+
+static void FloatToS32(int32_t *dst, const float *src, unsigned int count)
+{
+  const __m128 scale = _mm_set1_ps(AE_S32_SCALE);
+  const __m128 lo = _mm_set1_ps(-AE_S32_SCALE);
+  const __m128 hi = _mm_set1_ps(AE_S32_MAX);
+  unsigned int i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128 v = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i), scale), lo), hi);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_cvtps_epi32(v));
+  }
+  for (; i < count; i++)
+  {
+    __m128 v = _mm_min_ss(_mm_max_ss(_mm_mul_ss(_mm_load_ss(src + i), scale), lo), hi);
+    dst[i] = _mm_cvtss_si32(v);
+  }
+}
+
+static void S16ToFloat(float *dst, const int16_t *src, unsigned int count)
+{
+  const __m128 scale = _mm_set1_ps(1.0f / AE_S16_SCALE);
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    // sign extend by shifting the samples into the upper half
+    const __m128i a = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+    const __m128i b = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(a), scale));
+    _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(b), scale));
+  }
+  for (; i < count; i++)
+    dst[i] = static_cast<float>(src[i]) * (1.0f / AE_S16_SCALE);
+}
+
+static void S32ToFloat(float *dst, const int32_t *src, unsigned int count)
+{
+  const __m128 scale = _mm_set1_ps(1.0f / AE_S32_SCALE);
+  unsigned int i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+  }
+  for (; i < count; i++)
+    dst[i] = static_cast<float>(src[i]) * (1.0f / AE_S32_SCALE);
+}
+
+static const AEKernels sse2Kernels =
+{
+  "sse2",
+  Mix,
+  Gain,
+  Clamp,
+  PeakAbs,
+  Dot,
+  Interleave,
+  Deinterleave,
+  FloatToS16,
+  FloatToS32,
+  S16ToFloat,
+  S32ToFloat
+};
+
+const AEKernels* CAEKernels::GetSSE2(unsigned int cpuFeatures)
+{
+  if (cpuFeatures & CPU_FEATURE_SSE2)
+    return &sse2Kernels;
+  return NULL;
+}
+
+#else
+
+const AEKernels* CAEKernels::GetSSE2(unsigned int)
+{
+  return NULL;
+}
+
+#endif
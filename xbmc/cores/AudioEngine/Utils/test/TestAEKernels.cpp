@@ -0,0 +1,294 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <iostream>
+#include <limits>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "cores/AudioEngine/Utils/AEKernels.h"
+#include "threads/SystemClock.h"
+#include "utils/CPUInfo.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+// odd sizes and offsets, so that the scalar tails and unaligned loads run
+const unsigned int sizes[] = { 0, 1, 3, 7, 8, 15, 16, 17, 33, 1023 };
+const unsigned int offsets[] = { 0, 1, 3 };
+
+std::vector<float> MakeSamples(unsigned int count, uint32_t seed, float range)
+{
+  std::vector<float> samples(count);
+  for (unsigned int i = 0; i < count; i++)
+    samples[i] = CAEKernels::DitherNoise(seed, i) / 65536.0f * range;
+  // the limits, exact halves and values that only differ in rounding
+  const float special[] = { 0.0f, -0.0f, 1.0f, -1.0f, 3.0f, -3.5f, 0.5f / 32768, 1.5f / 32768, 2.5f / 32768,
+                            -2.5f / 32768, 32767.5f / 32768, -32768.5f / 32768, 4.0f, -4.0f };
+  for (unsigned int i = 0; i < count && i < sizeof(special) / sizeof(special[0]); i++)
+    samples[(i * 7) % count] = special[i];
+  return samples;
+}
+
+// the tables to compare against the scalar one, all the cpu can run
+std::vector<const AEKernels*> GetKernels()
+{
+  unsigned int features = g_cpuInfo.GetCPUFeatures();
+  std::vector<const AEKernels*> kernels;
+  if (CAEKernels::GetSSE2(features))
+    kernels.push_back(CAEKernels::GetSSE2(features));
+  if (CAEKernels::GetAVX2(features))
+    kernels.push_back(CAEKernels::GetAVX2(features));
+  if (CAEKernels::GetNEON(features))
+    kernels.push_back(CAEKernels::GetNEON(features));
+  return kernels;
+}
+
+template<typename T>
+void ExpectEqual(const std::vector<T> &expected, const std::vector<T> &actual, const AEKernels *kernels,
+                 const char *function, unsigned int size, unsigned int offset)
+{
+  ASSERT_EQ(expected.size(), actual.size());
+  EXPECT_EQ(0, memcmp(expected.data(), actual.data(), expected.size() * sizeof(T)))
+    << kernels->name << " " << function << " size " << size << " offset " << offset;
+}
+}
+
+TEST(TestAEKernels, Select)
+{
+  const AEKernels &kernels = CAEKernels::Get();
+  EXPECT_EQ(&kernels, &CAEKernels::Select(g_cpuInfo.GetCPUFeatures()));
+  EXPECT_EQ(&CAEKernels::GetScalar(), &CAEKernels::Select(0));
+  std::cout << "selected " << kernels.name << " kernels" << std::endl;
+}
+
+TEST(TestAEKernels, ScalarClamp)
+{
+  // the curve of CAEUtil::SoftClamp(), flat beyond +-3
+  const float in[] = { -4.0f, -3.0f, -1.0f, -0.5f, 0.0f, 0.5f, 1.0f, 3.0f, 4.0f };
+  float out[9];
+  memcpy(out, in, sizeof(in));
+  CAEKernels::GetScalar().Clamp(out, 9);
+  EXPECT_EQ(-1.0f, out[0]);
+  EXPECT_EQ(-1.0f, out[1]);
+  EXPECT_EQ(0.0f, out[4]);
+  EXPECT_EQ(1.0f, out[7]);
+  EXPECT_EQ(1.0f, out[8]);
+  EXPECT_FLOAT_EQ(0.5f * 27.25f / 29.25f, out[5]);
+  EXPECT_FLOAT_EQ(28.0f / 36.0f, out[6]);
+  for (unsigned int i = 1; i < 9; i++)
+    EXPECT_LE(out[i - 1], out[i]);
+}
+
+TEST(TestAEKernels, ScalarConversion)
+{
+  const AEKernels &scalar = CAEKernels::GetScalar();
+  const float in[] = { 0.0f, 1.0f, -1.0f, 2.0f, -2.0f, 0.5f / 32768, 1.5f / 32768, -0.5f / 32768 };
+  int16_t s16[8];
+  scalar.FloatToS16(s16, in, 8, NULL);
+  const int16_t expected16[] = { 0, 32767, -32768, 32767, -32768, 0, 2, 0 };
+  EXPECT_EQ(0, memcmp(expected16, s16, sizeof(s16)));
+
+  int32_t s32[8];
+  scalar.FloatToS32(s32, in, 8);
+  EXPECT_EQ(2147483520, s32[1]);
+  EXPECT_EQ(std::numeric_limits<int32_t>::min(), s32[2]);
+  EXPECT_EQ(2147483520, s32[3]);
+  EXPECT_EQ(std::numeric_limits<int32_t>::min(), s32[4]);
+
+  float back[8];
+  scalar.S16ToFloat(back, expected16, 8);
+  EXPECT_EQ(-1.0f, back[2]);
+  EXPECT_EQ(32767.0f / 32768, back[1]);
+
+  // dither moves samples by one step at most and advances the seed
+  uint32_t seed = 1234;
+  std::vector<float> silence(1024, 0.0f);
+  std::vector<int16_t> dithered(1024);
+  scalar.FloatToS16(dithered.data(), silence.data(), silence.size(), &seed);
+  EXPECT_EQ(1234u + 1024u, seed);
+  bool nonZero = false;
+  for (unsigned int i = 0; i < dithered.size(); i++)
+  {
+    EXPECT_LE(abs(dithered[i]), 1);
+    nonZero |= dithered[i] != 0;
+  }
+  EXPECT_TRUE(nonZero);
+}
+
+TEST(TestAEKernels, ScalarDot)
+{
+  const AEKernels &scalar = CAEKernels::GetScalar();
+  std::vector<float> a = MakeSamples(1023, 11, 1.0f);
+  std::vector<float> b = MakeSamples(1023, 12, 1.0f);
+  double expected = 0.0;
+  for (unsigned int i = 0; i < a.size(); i++)
+    expected += static_cast<double>(a[i]) * b[i];
+  EXPECT_NEAR(expected, scalar.Dot(a.data(), b.data(), a.size()), 1e-3);
+  EXPECT_EQ(0.0f, scalar.Dot(a.data(), b.data(), 0));
+  EXPECT_EQ(a[0] * b[0], scalar.Dot(a.data(), b.data(), 1));
+}
+
+TEST(TestAEKernels, BitExact)
+{
+  const AEKernels &scalar = CAEKernels::GetScalar();
+  std::vector<const AEKernels*> kernels = GetKernels();
+  if (kernels.empty())
+    std::cout << "no vector kernels for this cpu" << std::endl;
+
+  for (unsigned int k = 0; k < kernels.size(); k++)
+  {
+    const AEKernels *test = kernels[k];
+    for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+      for (unsigned int o = 0; o < sizeof(offsets) / sizeof(offsets[0]); o++)
+      {
+        unsigned int size = sizes[s];
+        unsigned int offset = offsets[o];
+        std::vector<float> a = MakeSamples(size + offset + 1, size * 3 + offset, 2.0f);
+        std::vector<float> b = MakeSamples(size + offset + 1, size * 5 + offset + 1, 4.0f);
+
+        std::vector<float> expected = a, actual = a;
+        scalar.Mix(expected.data() + offset, b.data() + offset, 0.7f, size);
+        test->Mix(actual.data() + offset, b.data() + offset, 0.7f, size);
+        ExpectEqual(expected, actual, test, "Mix", size, offset);
+
+        expected = b, actual = b;
+        scalar.Gain(expected.data() + offset, 0.3f, size);
+        test->Gain(actual.data() + offset, 0.3f, size);
+        ExpectEqual(expected, actual, test, "Gain", size, offset);
+
+        expected = b, actual = b;
+        scalar.Clamp(expected.data() + offset, size);
+        test->Clamp(actual.data() + offset, size);
+        ExpectEqual(expected, actual, test, "Clamp", size, offset);
+
+        EXPECT_EQ(scalar.PeakAbs(b.data() + offset, size), test->PeakAbs(b.data() + offset, size))
+          << test->name << " PeakAbs size " << size << " offset " << offset;
+
+        float expectedDot = scalar.Dot(a.data() + offset, b.data() + offset, size);
+        float actualDot = test->Dot(a.data() + offset, b.data() + offset, size);
+        EXPECT_EQ(0, memcmp(&expectedDot, &actualDot, sizeof(float)))
+          << test->name << " Dot size " << size << " offset " << offset;
+
+        for (unsigned int dither = 0; dither < 2; dither++)
+        {
+          std::vector<int16_t> expected16(a.size()), actual16(a.size());
+          uint32_t expectedSeed = 77, actualSeed = 77;
+          scalar.FloatToS16(expected16.data() + offset, a.data() + offset, size, dither ? &expectedSeed : NULL);
+          test->FloatToS16(actual16.data() + offset, a.data() + offset, size, dither ? &actualSeed : NULL);
+          ExpectEqual(expected16, actual16, test, dither ? "FloatToS16 dithered" : "FloatToS16", size, offset);
+          EXPECT_EQ(expectedSeed, actualSeed);
+
+          std::vector<float> expectedFloat(a.size()), actualFloat(a.size());
+          scalar.S16ToFloat(expectedFloat.data() + offset, expected16.data() + offset, size);
+          test->S16ToFloat(actualFloat.data() + offset, expected16.data() + offset, size);
+          ExpectEqual(expectedFloat, actualFloat, test, "S16ToFloat", size, offset);
+        }
+
+        std::vector<int32_t> expected32(a.size()), actual32(a.size());
+        scalar.FloatToS32(expected32.data() + offset, a.data() + offset, size);
+        test->FloatToS32(actual32.data() + offset, a.data() + offset, size);
+        ExpectEqual(expected32, actual32, test, "FloatToS32", size, offset);
+
+        std::vector<float> expectedFloat(a.size()), actualFloat(a.size());
+        scalar.S32ToFloat(expectedFloat.data() + offset, expected32.data() + offset, size);
+        test->S32ToFloat(actualFloat.data() + offset, expected32.data() + offset, size);
+        ExpectEqual(expectedFloat, actualFloat, test, "S32ToFloat", size, offset);
+
+        for (unsigned int channels = 1; channels <= 6; channels++)
+        {
+          std::vector<float> frames = MakeSamples(size * channels + offset, size + channels, 1.0f);
+          std::vector<std::vector<float> > expectedPlanes(channels, std::vector<float>(size + offset));
+          std::vector<std::vector<float> > actualPlanes = expectedPlanes;
+          std::vector<float*> expectedPtrs, actualPtrs;
+          for (unsigned int ch = 0; ch < channels; ch++)
+          {
+            expectedPtrs.push_back(expectedPlanes[ch].data() + offset);
+            actualPtrs.push_back(actualPlanes[ch].data() + offset);
+          }
+
+          scalar.Deinterleave(expectedPtrs.data(), frames.data() + offset, channels, size);
+          test->Deinterleave(actualPtrs.data(), frames.data() + offset, channels, size);
+          for (unsigned int ch = 0; ch < channels; ch++)
+            ExpectEqual(expectedPlanes[ch], actualPlanes[ch], test, "Deinterleave", size, offset);
+
+          // keep what's before the offset, for comparing with the source
+          std::vector<float> expectedFrames(frames.begin(), frames.begin() + offset);
+          expectedFrames.resize(frames.size());
+          std::vector<float> actualFrames = expectedFrames;
+          scalar.Interleave(expectedFrames.data() + offset, expectedPtrs.data(), channels, size);
+          test->Interleave(actualFrames.data() + offset, expectedPtrs.data(), channels, size);
+          ExpectEqual(expectedFrames, actualFrames, test, "Interleave", size, offset);
+          ExpectEqual(frames, expectedFrames, &scalar, "Interleave round trip", size, offset);
+        }
+      }
+    }
+  }
+}
+
+TEST(TestAEKernels, Throughput)
+{
+  const unsigned int count = 8 * 1024;
+  const unsigned int loops = 2000;
+  std::vector<float> a = MakeSamples(count, 1, 2.0f);
+  std::vector<float> b = MakeSamples(count, 2, 2.0f);
+  std::vector<int16_t> s16(count);
+
+  std::vector<const AEKernels*> kernels = GetKernels();
+  kernels.insert(kernels.begin(), &CAEKernels::GetScalar());
+  for (unsigned int k = 0; k < kernels.size(); k++)
+  {
+    const AEKernels *test = kernels[k];
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    for (unsigned int i = 0; i < loops; i++)
+      test->Mix(a.data(), b.data(), 0.5f, count);
+    unsigned int mix = XbmcThreads::SystemClockMillis() - start;
+
+    start = XbmcThreads::SystemClockMillis();
+    for (unsigned int i = 0; i < loops; i++)
+      test->Clamp(a.data(), count);
+    unsigned int clamp = XbmcThreads::SystemClockMillis() - start;
+
+    start = XbmcThreads::SystemClockMillis();
+    for (unsigned int i = 0; i < loops; i++)
+      test->FloatToS16(s16.data(), b.data(), count, NULL);
+    unsigned int convert = XbmcThreads::SystemClockMillis() - start;
+
+    // a resampler sized dot product, the result must not be optimized away
+    volatile float sink = 0.0f;
+    start = XbmcThreads::SystemClockMillis();
+    for (unsigned int i = 0; i < loops; i++)
+    {
+      for (unsigned int j = 0; j + 64 <= count; j += 64)
+        sink = sink + test->Dot(a.data() + j, b.data() + j, 64);
+    }
+    unsigned int dot = XbmcThreads::SystemClockMillis() - start;
+
+    // millions of samples per second
+    double samples = static_cast<double>(count) * loops / 1000;
+    std::cout << test->name << " Msamples/s: mix " << samples / (mix ? mix : 1)
+              << ", clamp " << samples / (clamp ? clamp : 1)
+              << ", s16 " << samples / (convert ? convert : 1)
+              << ", dot " << samples / (dot ? dot : 1) << std::endl;
+  }
+}
@@ -25,6 +25,8 @@
 CDataCacheCore::CDataCacheCore()
 {
   m_hasAVInfoChanges = false;
+  m_demuxInfo.poolSteady = 0;
+  m_demuxInfo.poolPeak = 0;
 }
 
 CDataCacheCore& GetInstance()
@@ -235,3 +237,48 @@ bool CDataCacheCore::CDataCacheCore::IsSeeking()
 
   return m_stateInfo.m_stateSeeking;
 }
+
+// demuxer info
+void CDataCacheCore::SetDemuxPoolUsage(size_t steady, size_t peak)
+{
+  CSingleLock lock(m_demuxSection);
+
+  m_demuxInfo.poolSteady = steady;
+  m_demuxInfo.poolPeak = peak;
+}
+
+size_t CDataCacheCore::GetDemuxPoolSteady()
+{
+  CSingleLock lock(m_demuxSection);
+
+  return m_demuxInfo.poolSteady;
+}
+
+size_t CDataCacheCore::GetDemuxPoolPeak()
+{
+  CSingleLock lock(m_demuxSection);
+
+  return m_demuxInfo.poolPeak;
+}
+
+// audio engine info
+void CDataCacheCore::SetAudioQueueLatency(unsigned int streamId, const AudioQueueLatency &latency)
+{
+  CSingleLock lock(m_audioEngineSection);
+
+  m_audioQueueLatency[streamId] = latency;
+}
+
+void CDataCacheCore::ResetAudioQueueLatency(unsigned int streamId)
+{
+  CSingleLock lock(m_audioEngineSection);
+
+  m_audioQueueLatency.erase(streamId);
+}
+
+std::map<unsigned int, CDataCacheCore::AudioQueueLatency> CDataCacheCore::GetAudioQueueLatency()
+{
+  CSingleLock lock(m_audioEngineSection);
+
+  return m_audioQueueLatency;
+}
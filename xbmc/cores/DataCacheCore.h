@@ -20,7 +20,9 @@
 *
 */
 
+#include <array>
 #include <atomic>
+#include <map>
 #include <string>
 #include "threads/CriticalSection.h"
 
@@ -67,6 +69,19 @@ public:
   void SetStateSeeking(bool active);
   bool IsSeeking();
 
+  // demuxer info, pool usage in bytes
+  void SetDemuxPoolUsage(size_t steady, size_t peak);
+  size_t GetDemuxPoolSteady();
+  size_t GetDemuxPoolPeak();
+
+  // audio engine info, histogram per stream of the time filled buffers waited
+  // for the engine. bucket n counts waits below 2^n ms, the last one all longer
+  static const unsigned int AUDIO_QUEUE_BUCKETS = 8;
+  typedef std::array<unsigned int, AUDIO_QUEUE_BUCKETS> AudioQueueLatency;
+  void SetAudioQueueLatency(unsigned int streamId, const AudioQueueLatency &latency);
+  void ResetAudioQueueLatency(unsigned int streamId);
+  std::map<unsigned int, AudioQueueLatency> GetAudioQueueLatency();
+
 protected:
   std::atomic_bool m_hasAVInfoChanges;
 
@@ -103,4 +118,14 @@ protected:
   {
     bool m_stateSeeking;
   } m_stateInfo;
+
+  CCriticalSection m_demuxSection;
+  struct SDemuxInfo
+  {
+    size_t poolSteady;
+    size_t poolPeak;
+  } m_demuxInfo;
+
+  CCriticalSection m_audioEngineSection;
+  std::map<unsigned int, AudioQueueLatency> m_audioQueueLatency;
 };
@@ -22,6 +22,7 @@
   #include "config.h"
 #endif
 #include "DVDDemuxUtils.h"
+#include "DemuxPacketPool.h"
 #include "DVDClock.h"
 #include "utils/log.h"
 #include "system.h"
@@ -39,8 +40,14 @@ void CDVDDemuxUtils::FreeDemuxPacket(DemuxPacket* pPacket)
   if (pPacket)
   {
     try {
-      if (pPacket->pData) _aligned_free(pPacket->pData);
-      delete pPacket;
+      SDemuxPacketBlock* block = reinterpret_cast<SDemuxPacketBlock*>(pPacket);
+      if (block->pool)
+        block->pool->Put(block);
+      else
+      {
+        if (pPacket->pData) _aligned_free(pPacket->pData);
+        delete block;
+      }
     }
     catch(...) {
       CLog::Log(LOGERROR, "%s - Exception thrown while freeing packet", __FUNCTION__);
@@ -50,12 +57,28 @@ void CDVDDemuxUtils::FreeDemuxPacket(DemuxPacket* pPacket)
 
 DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(int iDataSize)
 {
-  DemuxPacket* pPacket = new DemuxPacket;
-  if (!pPacket) return NULL;
+  // recycle the buffer if the calling thread belongs to a player
+  SDemuxPacketBlock* block = NULL;
+  CDemuxPacketPool* pool = CDemuxPacketPool::GetCurrent();
+  if (pool && iDataSize > 0)
+    block = pool->Get(iDataSize + FF_INPUT_BUFFER_PADDING_SIZE);
+
+  if (!block)
+  {
+    block = new SDemuxPacketBlock;
+    if (!block) return NULL;
+    block->packet.pData = NULL;
+    block->pool = NULL;
+    block->capacity = 0;
+    block->next = NULL;
+  }
+  DemuxPacket* pPacket = &block->packet;
 
   try
   {
+    unsigned char* pData = pPacket->pData;
     memset(pPacket, 0, sizeof(DemuxPacket));
+    pPacket->pData = pData;
 
     if (iDataSize > 0)
     {
@@ -68,11 +91,14 @@ DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(int iDataSize)
         * Note, if the first 23 bits of the additional bytes are not 0 then damaged
         * MPEG bitstreams could cause overread and segfault
         */
-      pPacket->pData =(uint8_t*)_aligned_malloc(iDataSize + FF_INPUT_BUFFER_PADDING_SIZE, 16);
       if (!pPacket->pData)
       {
-        FreeDemuxPacket(pPacket);
-        return NULL;
+        pPacket->pData =(uint8_t*)_aligned_malloc(iDataSize + FF_INPUT_BUFFER_PADDING_SIZE, 16);
+        if (!pPacket->pData)
+        {
+          FreeDemuxPacket(pPacket);
+          return NULL;
+        }
       }
 
       // reset the last 8 bytes to 0;
@@ -0,0 +1,205 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DemuxPacketPool.h"
+#include "threads/SingleLock.h"
+#include "threads/ThreadLocal.h"
+
+#ifdef TARGET_POSIX
+#include "linux/XMemUtils.h"
+#endif
+
+#include <new>
+
+namespace
+{
+XbmcThreads::ThreadLocal<CDemuxPacketPool> currentPool;
+
+// weight of a new sample in the steady state average
+const double STEADY_WEIGHT = 1.0 / 64;
+}
+
+CDemuxPacketPool::CDemuxPacketPool(size_t maxCached)
+  : m_maxCached(maxCached)
+  , m_cached(0)
+  , m_used(0)
+  , m_peak(0)
+  , m_steady(0.0)
+{
+  for (int i = 0; i < NUM_CLASSES; i++)
+    m_free[i] = NULL;
+}
+
+CDemuxPacketPool::~CDemuxPacketPool()
+{
+  Trim();
+}
+
+int CDemuxPacketPool::GetSizeClass(int size, int &capacity)
+{
+  if (size > (1 << MAX_CLASS_SHIFT))
+    return -1;
+
+  if (size <= (1 << MIN_CLASS_SHIFT))
+  {
+    capacity = 1 << MIN_CLASS_SHIFT;
+    return 0;
+  }
+
+  // base < size <= 2 * base, split into four steps
+  int shift = MIN_CLASS_SHIFT;
+  while ((1 << (shift + 1)) < size)
+    shift++;
+  int base = 1 << shift;
+  int step = base / 4;
+  int steps = (size - base + step - 1) / step;
+
+  capacity = base + steps * step;
+  return (shift - MIN_CLASS_SHIFT) * 4 + steps;
+}
+
+SDemuxPacketBlock* CDemuxPacketPool::Get(int size)
+{
+  int capacity;
+  int sizeClass = GetSizeClass(size, capacity);
+  if (sizeClass < 0)
+    return NULL;
+
+  SDemuxPacketBlock* block;
+  {
+    CSingleLock lock(m_section);
+
+    block = m_free[sizeClass];
+    if (block)
+    {
+      m_free[sizeClass] = block->next;
+      m_cached -= capacity;
+    }
+    m_used += capacity;
+
+    size_t total = m_used + m_cached;
+    if (total > m_peak)
+      m_peak = total;
+    m_steady += (total - m_steady) * STEADY_WEIGHT;
+  }
+
+  if (!block)
+  {
+    block = new (std::nothrow) SDemuxPacketBlock;
+    unsigned char* data = static_cast<unsigned char*>(_aligned_malloc(capacity, 16));
+    if (!block || !data)
+    {
+      delete block;
+      _aligned_free(data);
+
+      CSingleLock lock(m_section);
+      m_used -= capacity;
+      return NULL;
+    }
+    block->packet.pData = data;
+    block->capacity = capacity;
+  }
+
+  block->pool = Acquire();
+  block->next = NULL;
+  return block;
+}
+
+void CDemuxPacketPool::Put(SDemuxPacketBlock* block)
+{
+  SDemuxPacketBlock* release = NULL;
+  {
+    CSingleLock lock(m_section);
+
+    int capacity;
+    int sizeClass = GetSizeClass(block->capacity, capacity);
+    m_used -= block->capacity;
+
+    if (m_cached + block->capacity <= m_maxCached)
+    {
+      block->next = m_free[sizeClass];
+      m_free[sizeClass] = block;
+      m_cached += block->capacity;
+    }
+    else
+      release = block;
+  }
+
+  if (release)
+  {
+    release->next = NULL;
+    FreeBlocks(release);
+  }
+
+  // the block may have held the last reference
+  Release();
+}
+
+void CDemuxPacketPool::Trim()
+{
+  for (int i = 0; i < NUM_CLASSES; i++)
+  {
+    SDemuxPacketBlock* list;
+    {
+      CSingleLock lock(m_section);
+      list = m_free[i];
+      m_free[i] = NULL;
+      for (SDemuxPacketBlock* block = list; block; block = block->next)
+        m_cached -= block->capacity;
+    }
+    FreeBlocks(list);
+  }
+}
+
+void CDemuxPacketPool::FreeBlocks(SDemuxPacketBlock* list)
+{
+  while (list)
+  {
+    SDemuxPacketBlock* next = list->next;
+    _aligned_free(list->packet.pData);
+    delete list;
+    list = next;
+  }
+}
+
+void CDemuxPacketPool::GetUsage(size_t &steady, size_t &peak)
+{
+  CSingleLock lock(m_section);
+
+  steady = static_cast<size_t>(m_steady);
+  peak = m_peak;
+}
+
+size_t CDemuxPacketPool::GetCachedSize()
+{
+  CSingleLock lock(m_section);
+
+  return m_cached;
+}
+
+void CDemuxPacketPool::SetCurrent(CDemuxPacketPool* pool)
+{
+  currentPool.set(pool);
+}
+
+CDemuxPacketPool* CDemuxPacketPool::GetCurrent()
+{
+  return currentPool.get();
+}
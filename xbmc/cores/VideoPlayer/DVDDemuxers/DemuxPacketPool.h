@@ -0,0 +1,103 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DVDDemuxPacket.h"
+#include "DVDResource.h"
+#include "threads/CriticalSection.h"
+
+#include <cstddef>
+
+class CDemuxPacketPool;
+
+/**
+ * Allocation unit handed out by CDVDDemuxUtils. The packet has to stay the
+ * first member, addons and the rest of the player only ever see the
+ * DemuxPacket part of it.
+ */
+struct SDemuxPacketBlock
+{
+  DemuxPacket packet;
+  CDemuxPacketPool* pool;   // pool the buffer goes back to, NULL if not pooled
+  int capacity;             // size of packet.pData, padding included
+  SDemuxPacketBlock* next;  // free list link while cached
+};
+
+/**
+ * Recycles demux packets and their data buffers.
+ *
+ * Buffers are grouped into size classes of a quarter octave each, so a packet
+ * of a given size is served from a cached buffer that wastes at most 25%.
+ * Packets can be returned from any thread, usually a codec thread, and go back
+ * to the pool that allocated them, even if the player is gone by then.
+ *
+ * A player binds its pool to the demuxer thread with SetCurrent(), any
+ * CDVDDemuxUtils::AllocateDemuxPacket() on that thread, including the ones
+ * from inputstream and pvr addons, is then served by the pool.
+ */
+class CDemuxPacketPool : public IDVDResourceCounted<CDemuxPacketPool>
+{
+public:
+  explicit CDemuxPacketPool(size_t maxCached = 16 * 1024 * 1024);
+  ~CDemuxPacketPool() override;
+
+  /**
+   * Get a block with a buffer of at least size bytes. Returns NULL if the size
+   * is out of the range of the pool or the allocation failed.
+   */
+  SDemuxPacketBlock* Get(int size);
+
+  /**
+   * Hand a block back, it is kept for reuse as long as the cache limit allows.
+   */
+  void Put(SDemuxPacketBlock* block);
+
+  /**
+   * Free all cached buffers.
+   */
+  void Trim();
+
+  /**
+   * Bytes held by the pool, handed out and cached. Steady is a moving average
+   * over the allocations, peak the maximum since creation.
+   */
+  void GetUsage(size_t &steady, size_t &peak);
+  size_t GetCachedSize();
+
+  static void SetCurrent(CDemuxPacketPool* pool);
+  static CDemuxPacketPool* GetCurrent();
+
+private:
+  static int GetSizeClass(int size, int &capacity);
+  void FreeBlocks(SDemuxPacketBlock* list);
+
+  static const int MIN_CLASS_SHIFT = 10;
+  static const int MAX_CLASS_SHIFT = 24;
+  static const int NUM_CLASSES = (MAX_CLASS_SHIFT - MIN_CLASS_SHIFT) * 4 + 1;
+
+  CCriticalSection m_section;
+  SDemuxPacketBlock* m_free[NUM_CLASSES];
+  size_t m_maxCached;
+  size_t m_cached;
+  size_t m_used;
+  size_t m_peak;
+  double m_steady;
+};
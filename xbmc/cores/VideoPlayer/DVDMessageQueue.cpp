@@ -25,11 +25,19 @@
 #include "DVDClock.h"
 #include "math.h"
 
-CDVDMessageQueue::CDVDMessageQueue(const std::string &owner) : m_hEvent(true), m_owner(owner)
+#include <vector>
+
+// ~8 seconds of a high bitrate video stream before messages spill over into the list
+#define MSGQ_RING_SIZE 512
+
+CDVDMessageQueue::CDVDMessageQueue(const std::string &owner) : m_hEvent(true), m_owner(owner), m_ring(MSGQ_RING_SIZE)
 {
   m_iDataSize     = 0;
   m_bAbortRequest = false;
   m_bInitialized = false;
+  m_waiting = false;
+  m_drain = false;
+  m_prioCount = 0;
 
   m_TimeBack = DVD_NOPTS_VALUE;
   m_TimeFront = DVD_NOPTS_VALUE;
@@ -55,8 +63,26 @@ void CDVDMessageQueue::Init()
 
 void CDVDMessageQueue::Flush(CDVDMsg::Message type)
 {
+  CSingleLock consumerLock(m_consumerSection);
   CSingleLock lock(m_section);
 
+  // empty the ring, messages we keep are the oldest of the normal lane
+  // so they go to the back of the list in their original order
+  std::vector<CDVDMsg*> keep;
+  CDVDMsg* msg;
+  while (m_ring.Pop(msg))
+  {
+    if (type == CDVDMsg::NONE || msg->IsType(type))
+      msg->Release();
+    else
+      keep.push_back(msg);
+  }
+  for (auto it = keep.rbegin(); it != keep.rend(); ++it)
+  {
+    m_messages.emplace_back(*it, 0);
+    (*it)->Release();
+  }
+
   m_messages.remove_if([type](const DVDMessageListItem &item){
     return type == CDVDMsg::NONE || item.message->IsType(type);
   });
@@ -64,6 +90,7 @@ void CDVDMessageQueue::Flush(CDVDMsg::Message type)
   m_prioMessages.remove_if([type](const DVDMessageListItem &item){
     return type == CDVDMsg::NONE || item.message->IsType(type);
   });
+  m_prioCount = m_prioMessages.size();
 
   if (type == CDVDMsg::DEMUXER_PACKET ||  type == CDVDMsg::NONE)
   {
@@ -85,10 +112,10 @@ void CDVDMessageQueue::Abort()
 
 void CDVDMessageQueue::End()
 {
-  CSingleLock lock(m_section);
-
   Flush(CDVDMsg::NONE);
 
+  CSingleLock lock(m_section);
+
   m_bInitialized = false;
   m_iDataSize = 0;
   m_bAbortRequest = false;
@@ -96,8 +123,6 @@ void CDVDMessageQueue::End()
 
 MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority, bool front)
 {
-  CSingleLock lock(m_section);
-
   if (!m_bInitialized)
   {
     CLog::Log(LOGWARNING, "CDVDMessageQueue(%s)::Put MSGQ_NOT_INITIALIZED", m_owner.c_str());
@@ -110,54 +135,88 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority, bool front
     return MSGQ_INVALID_MSG;
   }
 
-  if (priority > 0)
   {
-    int prio = priority;
-    if (!front)
-      prio++;
-
-    auto it = std::find_if(m_prioMessages.begin(), m_prioMessages.end(),
-                           [prio](const DVDMessageListItem &item){
-                             return prio <= item.priority;
-                           });
-    m_prioMessages.emplace(it, pMsg, priority);
-  }
-  else
-  {
-    if (front)
-      m_messages.emplace_front(pMsg, priority);
-    else
-      m_messages.emplace_back(pMsg, priority);
-  }
+    CSingleLock lock(m_section);
 
-  if (pMsg->IsType(CDVDMsg::DEMUXER_PACKET) && priority == 0)
-  {
-    DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
-    if (packet)
+    if (priority == 0)
+      UpdateSizePut(pMsg);
+
+    if (priority > 0 || !front)
     {
-      m_iDataSize += packet->iSize;
-      if (packet->dts != DVD_NOPTS_VALUE)
-        m_TimeFront = packet->dts;
-      else if (packet->pts != DVD_NOPTS_VALUE)
-        m_TimeFront = packet->pts;
-
-      if (m_TimeBack == DVD_NOPTS_VALUE)
-        m_TimeBack = m_TimeFront;
+      // normal messages put at the back are next in line, ahead of the ring,
+      // so they go below any real priority messages
+      int prio = priority;
+      if (!front)
+        prio++;
+
+      auto it = std::find_if(m_prioMessages.begin(), m_prioMessages.end(),
+                             [prio](const DVDMessageListItem &item){
+                               return prio <= item.priority;
+                             });
+      m_prioMessages.emplace(it, pMsg, priority);
+      m_prioCount = m_prioMessages.size();
+      pMsg->Release();
     }
+    else if (!m_messages.empty() || !m_ring.Push(pMsg))
+    {
+      m_messages.emplace_front(pMsg, priority);
+      pMsg->Release();
+    }
+    // else the ring took over our reference
   }
 
-  pMsg->Release();
-
   // inform waiter for new packet
-  m_hEvent.Set();
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (m_waiting)
+    m_hEvent.Set();
 
   return MSGQ_OK;
 }
 
-MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutInMilliSeconds, int &priority)
+bool CDVDMessageQueue::TryGet(CDVDMsg** pMsg, int &priority)
 {
+  CSingleLock consumerLock(m_consumerSection);
+  CDVDMsg* msg;
+
+  // fast path, the ring holds the oldest normal messages
+  if (priority == 0 && m_prioCount == 0 && m_ring.Pop(msg))
+  {
+    UpdateSizeGet(msg);
+    *pMsg = msg;
+    return true;
+  }
+
   CSingleLock lock(m_section);
 
+  std::list<DVDMessageListItem> &msgs = (priority > 0 || !m_prioMessages.empty()) ? m_prioMessages : m_messages;
+
+  // a message may have arrived in the ring since we checked
+  if (&msgs == &m_messages && m_ring.Pop(msg))
+  {
+    priority = 0;
+    UpdateSizeGet(msg);
+    *pMsg = msg;
+    return true;
+  }
+
+  if (!msgs.empty() && (msgs.back().priority >= priority || m_drain))
+  {
+    DVDMessageListItem& item(msgs.back());
+    priority = item.priority;
+
+    if (item.priority == 0)
+      UpdateSizeGet(item.message);
+
+    *pMsg = item.message->Acquire();
+    msgs.pop_back();
+    m_prioCount = m_prioMessages.size();
+    return true;
+  }
+  return false;
+}
+
+MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutInMilliSeconds, int &priority)
+{
   *pMsg = NULL;
 
   int ret = 0;
@@ -170,29 +229,8 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
 
   while (!m_bAbortRequest)
   {
-    std::list<DVDMessageListItem> &msgs = (priority > 0 || !m_prioMessages.empty()) ? m_prioMessages : m_messages;
-
-    if (!msgs.empty() && (msgs.back().priority >= priority || m_drain))
+    if (TryGet(pMsg, priority))
     {
-      DVDMessageListItem& item(msgs.back());
-      priority = item.priority;
-
-      if (item.message->IsType(CDVDMsg::DEMUXER_PACKET) && item.priority == 0)
-      {
-        DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)item.message)->GetPacket();
-        if (packet)
-        {
-          m_iDataSize -= packet->iSize;
-          if (packet->dts != DVD_NOPTS_VALUE)
-            m_TimeBack = packet->dts;
-          else if (packet->pts != DVD_NOPTS_VALUE)
-            m_TimeBack = packet->pts;
-        }
-      }
-
-      *pMsg = item.message->Acquire();
-      msgs.pop_back();
-
       ret = MSGQ_OK;
       break;
     }
@@ -203,14 +241,29 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
     }
     else
     {
+      // producers only signal a consumer that announced it's waiting,
+      // so check once more after announcing
       m_hEvent.Reset();
-      lock.Leave();
+      m_waiting = true;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      if (m_bAbortRequest)
+      {
+        m_waiting = false;
+        break;
+      }
+      if (TryGet(pMsg, priority))
+      {
+        m_waiting = false;
+        ret = MSGQ_OK;
+        break;
+      }
 
       // wait for a new message
-      if (!m_hEvent.WaitMSec(iTimeoutInMilliSeconds))
+      bool signaled = m_hEvent.WaitMSec(iTimeoutInMilliSeconds);
+      m_waiting = false;
+      if (!signaled)
         return MSGQ_TIMEOUT;
-
-      lock.Enter();
     }
   }
 
@@ -220,14 +273,55 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
   return (MsgQueueReturnCode)ret;
 }
 
+void CDVDMessageQueue::UpdateSizePut(CDVDMsg* pMsg)
+{
+  if (!pMsg->IsType(CDVDMsg::DEMUXER_PACKET))
+    return;
+
+  DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
+  if (packet)
+  {
+    m_iDataSize += packet->iSize;
+    if (packet->dts != DVD_NOPTS_VALUE)
+      m_TimeFront = packet->dts;
+    else if (packet->pts != DVD_NOPTS_VALUE)
+      m_TimeFront = packet->pts;
+
+    // the consumer only moves m_TimeBack once it has taken a packet
+    double noPts = DVD_NOPTS_VALUE;
+    m_TimeBack.compare_exchange_strong(noPts, m_TimeFront);
+  }
+}
+
+void CDVDMessageQueue::UpdateSizeGet(CDVDMsg* pMsg)
+{
+  if (!pMsg->IsType(CDVDMsg::DEMUXER_PACKET))
+    return;
+
+  DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
+  if (packet)
+  {
+    m_iDataSize -= packet->iSize;
+    if (packet->dts != DVD_NOPTS_VALUE)
+      m_TimeBack = packet->dts;
+    else if (packet->pts != DVD_NOPTS_VALUE)
+      m_TimeBack = packet->pts;
+  }
+}
+
 unsigned CDVDMessageQueue::GetPacketCount(CDVDMsg::Message type)
 {
+  CSingleLock consumerLock(m_consumerSection);
   CSingleLock lock(m_section);
 
   if (!m_bInitialized)
     return 0;
 
   unsigned count = 0;
+  m_ring.ForEach([type, &count](CDVDMsg* msg){
+    if (msg->IsType(type))
+      count++;
+  });
   for (const auto &item : m_messages)
   {
     if(item.message->IsType(type))
@@ -241,7 +335,6 @@ unsigned CDVDMessageQueue::GetPacketCount(CDVDMsg::Message type)
 
   return count;
 }
-
 void CDVDMessageQueue::WaitUntilEmpty()
 {
   {
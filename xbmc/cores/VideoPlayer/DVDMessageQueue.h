@@ -27,6 +27,7 @@
 #include <algorithm>
 #include "threads/CriticalSection.h"
 #include "threads/Event.h"
+#include "threads/SPSCQueue.h"
 
 struct DVDMessageListItem
 {
@@ -108,23 +109,37 @@ public:
   bool IsDataBased() const;
 
 private:
+  bool TryGet(CDVDMsg** pMsg, int &priority);
+  void UpdateSizePut(CDVDMsg* pMsg);
+  void UpdateSizeGet(CDVDMsg* pMsg);
 
   CEvent m_hEvent;
-  mutable CCriticalSection m_section;
+  mutable CCriticalSection m_section;         // producer side and the lists
+  mutable CCriticalSection m_consumerSection; // consumer side of m_ring
 
   std::atomic<bool> m_bAbortRequest;
-  bool m_bInitialized;
+  std::atomic<bool> m_bInitialized;
+  std::atomic<bool> m_waiting;
   bool m_drain;
 
-  int m_iDataSize;
-  double m_TimeFront;
-  double m_TimeBack;
+  std::atomic<int> m_iDataSize;
+  std::atomic<double> m_TimeFront;
+  std::atomic<double> m_TimeBack;
   double m_TimeSize;
 
   int m_iMaxDataSize;
   std::string m_owner;
 
+  /**
+   * The oldest normal (priority 0) messages travel through a lock-free ring, so
+   * the producer and consumer don't share a lock or allocate a list node per
+   * packet. If the ring is full, newer messages spill over into m_messages and
+   * keep going there until the consumer has drained it, which keeps the ring
+   * strictly older than the list.
+   */
+  XbmcThreads::CSPSCQueue<CDVDMsg*> m_ring;
   std::list<DVDMessageListItem> m_messages;
   std::list<DVDMessageListItem> m_prioMessages;
+  std::atomic<size_t> m_prioCount;
 };
 
@@ -38,6 +38,8 @@ CProcessInfo* CProcessInfo::CreateInstance()
 CProcessInfo::CProcessInfo()
 {
   ResetVideoCodecInfo();
+  m_demuxPoolSteady = 0;
+  m_demuxPoolPeak = 0;
 }
 
 CProcessInfo::~CProcessInfo()
@@ -365,3 +367,22 @@ bool CProcessInfo::IsSeeking()
 
   return m_stateSeeking;
 }
+
+// demuxer info
+void CProcessInfo::SetDemuxPoolUsage(size_t steady, size_t peak)
+{
+  CSingleLock lock(m_demuxSection);
+
+  m_demuxPoolSteady = steady;
+  m_demuxPoolPeak = peak;
+
+  CServiceBroker::GetDataCacheCore().SetDemuxPoolUsage(steady, peak);
+}
+
+void CProcessInfo::GetDemuxPoolUsage(size_t &steady, size_t &peak)
+{
+  CSingleLock lock(m_demuxSection);
+
+  steady = m_demuxPoolSteady;
+  peak = m_demuxPoolPeak;
+}
@@ -74,6 +74,10 @@ public:
   void SetStateSeeking(bool active);
   bool IsSeeking();
 
+  // demuxer info, pool usage in bytes
+  void SetDemuxPoolUsage(size_t steady, size_t peak);
+  void GetDemuxPoolUsage(size_t &steady, size_t &peak);
+
 protected:
   CProcessInfo();
 
@@ -105,4 +109,9 @@ protected:
   // player states
   CCriticalSection m_stateSection;
   bool m_stateSeeking;
+
+  // demuxer info
+  CCriticalSection m_demuxSection;
+  size_t m_demuxPoolSteady;
+  size_t m_demuxPoolPeak;
 };
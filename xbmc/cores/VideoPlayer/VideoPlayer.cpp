@@ -32,6 +32,7 @@
 #include "DVDDemuxers/DVDDemuxVobsub.h"
 #include "DVDDemuxers/DVDFactoryDemuxer.h"
 #include "DVDDemuxers/DVDDemuxFFmpeg.h"
+#include "DVDDemuxers/DemuxPacketPool.h"
 
 #include "DVDFileInfo.h"
 
@@ -666,6 +667,7 @@ CVideoPlayer::CVideoPlayer(IPlayerCallback& callback)
   m_SkipCommercials = true;
 
   m_processInfo.reset(CProcessInfo::CreateInstance());
+  m_packetPool = new CDemuxPacketPool();
   CreatePlayers();
 
   m_displayLost = false;
@@ -678,6 +680,9 @@ CVideoPlayer::~CVideoPlayer()
 
   CloseFile();
   DestroyPlayers();
+
+  // packets still in flight keep the pool alive
+  m_packetPool->Release();
 }
 
 bool CVideoPlayer::OpenFile(const CFileItem& file, const CPlayerOptions &options)
@@ -1225,6 +1230,9 @@ void CVideoPlayer::Process()
 {
   CFFmpegLog::SetLogLevel(1);
 
+  // everything the demuxers allocate on this thread is recycled
+  CDemuxPacketPool::SetCurrent(m_packetPool);
+
   if (!OpenInputStream())
   {
     m_bAbortRequest = true;
@@ -2514,6 +2522,9 @@ void CVideoPlayer::OnExit()
   // set event to inform openfile something went wrong in case openfile is still waiting for this event
   m_ready.Set();
 
+  CDemuxPacketPool::SetCurrent(NULL);
+  m_packetPool->Trim();
+
   CFFmpegLog::ClearLogLevel();
 }
 
@@ -5057,6 +5068,10 @@ void CVideoPlayer::UpdatePlayState(double timeout)
   else
     state.caching = false;
 
+  size_t poolSteady, poolPeak;
+  m_packetPool->GetUsage(poolSteady, poolPeak);
+  m_processInfo->SetDemuxPoolUsage(poolSteady, poolPeak);
+
   double level, delay, offset;
   if (GetCachingTimes(level, delay, offset))
   {
@@ -142,6 +142,7 @@ struct SPlayerState
 class CDVDInputStream;
 
 class CDVDDemux;
+class CDemuxPacketPool;
 class CDemuxStreamVideo;
 class CDemuxStreamAudio;
 class CStreamInfo;
@@ -505,6 +506,7 @@ protected:
   CFileItem    m_item;
   XbmcThreads::EndTime m_ChannelEntryTimeOut;
   std::unique_ptr<CProcessInfo> m_processInfo;
+  CDemuxPacketPool* m_packetPool;
 
   CCurrentStream m_CurrentAudio;
   CCurrentStream m_CurrentVideo;
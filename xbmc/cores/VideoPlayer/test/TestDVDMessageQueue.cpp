@@ -0,0 +1,282 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/VideoPlayer/DVDMessageQueue.h"
+#include "cores/VideoPlayer/DVDMessage.h"
+#include "cores/VideoPlayer/DVDClock.h"
+#include "cores/VideoPlayer/DVDDemuxers/DVDDemuxPacket.h"
+#include "cores/VideoPlayer/DVDDemuxers/DVDDemuxUtils.h"
+#include "threads/Thread.h"
+#include "utils/TimeUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+// a UHD remux: ~80 Mbit/s of video at 23.976 fps interleaved with TrueHD audio
+const int VIDEO_PACKET_SIZE = 417000;
+const int AUDIO_PACKET_SIZE = 4000;
+const double FRAME_DURATION = DVD_TIME_BASE / 23.976;
+
+CDVDMsgDemuxerPacket* CreatePacket(int size, double dts)
+{
+  // the queue only looks at the size and timestamps, so skip the payload
+  DemuxPacket* packet = CDVDDemuxUtils::AllocateDemuxPacket(0);
+  packet->iSize = size;
+  packet->dts = dts;
+  packet->pts = dts;
+  return new CDVDMsgDemuxerPacket(packet);
+}
+
+double GetDts(CDVDMsg* msg)
+{
+  return static_cast<CDVDMsgDemuxerPacket*>(msg)->GetPacket()->dts;
+}
+
+class CPacketProducer : public CThread
+{
+public:
+  CPacketProducer(CDVDMessageQueue &queue, int packets, unsigned int interval)
+    : CThread("PacketProducer")
+    , m_queue(queue)
+    , m_packets(packets)
+    , m_interval(interval)
+  {
+  }
+
+  void Process() override
+  {
+    for (int i = 0; i < m_packets && !m_bStop; i++)
+    {
+      // full queues block the demuxer in VideoPlayer, do the same
+      while (m_queue.GetDataSize() > m_queue.GetMaxDataSize() && !m_bStop)
+        Sleep(0);
+
+      CDVDMsgDemuxerPacket* msg = CreatePacket(i % 4 ? AUDIO_PACKET_SIZE : VIDEO_PACKET_SIZE, i * FRAME_DURATION);
+      // stash the time of the hand-off for the latency measurement
+      msg->GetPacket()->duration = static_cast<double>(CurrentHostCounter());
+      m_queue.Put(msg);
+
+      if (m_interval)
+        Sleep(m_interval);
+    }
+  }
+
+private:
+  CDVDMessageQueue &m_queue;
+  int m_packets;
+  unsigned int m_interval;
+};
+}
+
+class TestDVDMessageQueue : public testing::Test
+{
+protected:
+  TestDVDMessageQueue() : m_queue("test")
+  {
+    m_queue.SetMaxDataSize(40 * 1024 * 1024);
+    m_queue.Init();
+  }
+
+  ~TestDVDMessageQueue()
+  {
+    m_queue.End();
+  }
+
+  CDVDMessageQueue m_queue;
+};
+
+TEST_F(TestDVDMessageQueue, Order)
+{
+  // more than fit in the ring, so part of them take the list
+  const int count = 2000;
+  for (int i = 0; i < count; i++)
+    EXPECT_EQ(MSGQ_OK, m_queue.Put(CreatePacket(100, i)));
+
+  EXPECT_EQ(100 * count, m_queue.GetDataSize());
+  EXPECT_EQ(static_cast<unsigned>(count), m_queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+
+  for (int i = 0; i < count; i++)
+  {
+    CDVDMsg* msg;
+    ASSERT_EQ(MSGQ_OK, m_queue.Get(&msg, 0));
+    EXPECT_EQ(i, GetDts(msg));
+    msg->Release();
+
+    // keep producing while draining, the new packets have to queue up behind
+    if (i == count / 2)
+      m_queue.Put(CreatePacket(100, count));
+  }
+
+  CDVDMsg* msg;
+  ASSERT_EQ(MSGQ_OK, m_queue.Get(&msg, 0));
+  EXPECT_EQ(count, GetDts(msg));
+  msg->Release();
+
+  EXPECT_EQ(0, m_queue.GetDataSize());
+  EXPECT_EQ(MSGQ_TIMEOUT, m_queue.Get(&msg, 0));
+}
+
+TEST_F(TestDVDMessageQueue, Priority)
+{
+  m_queue.Put(CreatePacket(100, 1));
+  m_queue.Put(new CDVDMsg(CDVDMsg::GENERAL_RESYNC), 1);
+  m_queue.Put(new CDVDMsg(CDVDMsg::GENERAL_FLUSH), 2);
+  m_queue.Put(CreatePacket(100, 2), 0, false);
+
+  CDVDMsg* msg;
+  int priority = 0;
+  ASSERT_EQ(MSGQ_OK, m_queue.Get(&msg, 0, priority));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_FLUSH));
+  EXPECT_EQ(2, priority);
+  msg->Release();
+
+  // only messages of at least the given priority
+  priority = 2;
+  EXPECT_EQ(MSGQ_TIMEOUT, m_queue.Get(&msg, 0, priority));
+
+  priority = 0;
+  ASSERT_EQ(MSGQ_OK, m_queue.Get(&msg, 0, priority));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_RESYNC));
+  msg->Release();
+
+  // put at the back jumps the queue
+  priority = 0;
+  ASSERT_EQ(MSGQ_OK, m_queue.Get(&msg, 0, priority));
+  EXPECT_EQ(2, GetDts(msg));
+  msg->Release();
+
+  ASSERT_EQ(MSGQ_OK, m_queue.Get(&msg, 0, priority));
+  EXPECT_EQ(1, GetDts(msg));
+  msg->Release();
+}
+
+TEST_F(TestDVDMessageQueue, Flush)
+{
+  for (int i = 0; i < 10; i++)
+    m_queue.Put(CreatePacket(100, i));
+  m_queue.Put(new CDVDMsg(CDVDMsg::GENERAL_RESET));
+  m_queue.Put(CreatePacket(100, 10));
+  m_queue.Put(new CDVDMsg(CDVDMsg::GENERAL_EOF));
+
+  m_queue.Flush();
+  EXPECT_EQ(0, m_queue.GetDataSize());
+  EXPECT_EQ(0u, m_queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+  EXPECT_EQ(0, m_queue.GetLevel());
+
+  // the other messages stay, in order, and new ones queue up behind them
+  m_queue.Put(CreatePacket(100, 11));
+
+  CDVDMsg* msg;
+  ASSERT_EQ(MSGQ_OK, m_queue.Get(&msg, 0));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_RESET));
+  msg->Release();
+  ASSERT_EQ(MSGQ_OK, m_queue.Get(&msg, 0));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_EOF));
+  msg->Release();
+  ASSERT_EQ(MSGQ_OK, m_queue.Get(&msg, 0));
+  EXPECT_EQ(11, GetDts(msg));
+  msg->Release();
+}
+
+TEST_F(TestDVDMessageQueue, Level)
+{
+  // one second worth of video, time based
+  m_queue.SetMaxTimeSize(4.0);
+  for (int i = 0; i <= 24; i++)
+    m_queue.Put(CreatePacket(VIDEO_PACKET_SIZE, i * FRAME_DURATION));
+
+  EXPECT_FALSE(m_queue.IsDataBased());
+  EXPECT_EQ(1, m_queue.GetTimeSize());
+  EXPECT_EQ(26, m_queue.GetLevel());
+}
+
+TEST_F(TestDVDMessageQueue, Abort)
+{
+  class CWaiter : public CThread
+  {
+  public:
+    CWaiter(CDVDMessageQueue &queue) : CThread("Waiter"), m_queue(queue), m_ret(MSGQ_OK) {}
+    void Process() override
+    {
+      CDVDMsg* msg;
+      m_ret = m_queue.Get(&msg, 10000);
+    }
+    CDVDMessageQueue &m_queue;
+    MsgQueueReturnCode m_ret;
+  };
+
+  CWaiter waiter(m_queue);
+  waiter.Create();
+  XbmcThreads::ThreadSleep(50);
+  m_queue.Abort();
+  EXPECT_TRUE(waiter.WaitForThreadExit(5000));
+  EXPECT_EQ(MSGQ_ABORT, waiter.m_ret);
+}
+
+TEST_F(TestDVDMessageQueue, Throughput)
+{
+  const int count = 20000;
+  CPacketProducer producer(m_queue, count, 0);
+
+  int64_t start = CurrentHostCounter();
+  producer.Create();
+
+  int64_t bytes = 0;
+  for (int i = 0; i < count; i++)
+  {
+    CDVDMsg* msg;
+    ASSERT_EQ(MSGQ_OK, m_queue.Get(&msg, 1000));
+    EXPECT_EQ(i * FRAME_DURATION, GetDts(msg));
+    bytes += static_cast<CDVDMsgDemuxerPacket*>(msg)->GetPacketSize();
+    msg->Release();
+  }
+  double seconds = static_cast<double>(CurrentHostCounter() - start) / CurrentHostFrequency();
+  producer.StopThread();
+
+  std::cout << "packets/sec: " << static_cast<int64_t>(count / seconds)
+            << ", Mbit/s: " << static_cast<int64_t>(bytes * 8 / seconds / 1000000) << std::endl;
+}
+
+TEST_F(TestDVDMessageQueue, WakeupLatency)
+{
+  const int count = 200;
+  CPacketProducer producer(m_queue, count, 2);
+  producer.Create();
+
+  std::vector<double> latencies;
+  for (int i = 0; i < count; i++)
+  {
+    CDVDMsg* msg;
+    ASSERT_EQ(MSGQ_OK, m_queue.Get(&msg, 1000));
+    double sent = static_cast<CDVDMsgDemuxerPacket*>(msg)->GetPacket()->duration;
+    latencies.push_back((CurrentHostCounter() - sent) * 1000000.0 / CurrentHostFrequency());
+    msg->Release();
+  }
+  producer.StopThread();
+
+  std::sort(latencies.begin(), latencies.end());
+  std::cout << "wakeup latency usec, median: " << static_cast<int>(latencies[count / 2])
+            << ", 99th: " << static_cast<int>(latencies[count * 99 / 100]) << std::endl;
+}
@@ -0,0 +1,165 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/VideoPlayer/DVDClock.h"
+#include "cores/VideoPlayer/DVDDemuxers/DemuxPacketPool.h"
+#include "cores/VideoPlayer/DVDDemuxers/DVDDemuxUtils.h"
+#include "utils/TimeUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <iostream>
+#include <vector>
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+}
+
+class TestDemuxPacketPool : public testing::Test
+{
+protected:
+  TestDemuxPacketPool()
+  {
+    m_pool = new CDemuxPacketPool(4 * 1024 * 1024);
+    CDemuxPacketPool::SetCurrent(m_pool);
+  }
+
+  ~TestDemuxPacketPool()
+  {
+    CDemuxPacketPool::SetCurrent(NULL);
+    m_pool->Release();
+  }
+
+  CDemuxPacketPool* m_pool;
+};
+
+TEST_F(TestDemuxPacketPool, Recycle)
+{
+  DemuxPacket* packet = CDVDDemuxUtils::AllocateDemuxPacket(1000);
+  ASSERT_TRUE(packet != NULL);
+  unsigned char* data = packet->pData;
+  packet->pts = 1;
+  packet->iStreamId = 3;
+  CDVDDemuxUtils::FreeDemuxPacket(packet);
+  EXPECT_LT(0u, m_pool->GetCachedSize());
+
+  // same size class, same buffer, fresh defaults
+  packet = CDVDDemuxUtils::AllocateDemuxPacket(1010);
+  ASSERT_TRUE(packet != NULL);
+  EXPECT_EQ(data, packet->pData);
+  EXPECT_EQ(DVD_NOPTS_VALUE, packet->pts);
+  EXPECT_EQ(-1, packet->iStreamId);
+  EXPECT_EQ(0, packet->iSize);
+  for (int i = 1010; i < 1010 + FF_INPUT_BUFFER_PADDING_SIZE; i++)
+    EXPECT_EQ(0, packet->pData[i]);
+  CDVDDemuxUtils::FreeDemuxPacket(packet);
+}
+
+TEST_F(TestDemuxPacketPool, SizeClasses)
+{
+  // a bigger packet doesn't fit the cached buffer
+  DemuxPacket* small = CDVDDemuxUtils::AllocateDemuxPacket(1000);
+  unsigned char* data = small->pData;
+  CDVDDemuxUtils::FreeDemuxPacket(small);
+
+  DemuxPacket* big = CDVDDemuxUtils::AllocateDemuxPacket(100000);
+  ASSERT_TRUE(big != NULL);
+  EXPECT_NE(data, big->pData);
+  big->pData[99999] = 1;
+  CDVDDemuxUtils::FreeDemuxPacket(big);
+
+  // too large for the pool and packets without payload are plain allocations
+  DemuxPacket* huge = CDVDDemuxUtils::AllocateDemuxPacket(20 * 1024 * 1024);
+  ASSERT_TRUE(huge != NULL);
+  DemuxPacket* empty = CDVDDemuxUtils::AllocateDemuxPacket(0);
+  ASSERT_TRUE(empty != NULL);
+  EXPECT_TRUE(empty->pData == NULL);
+  size_t cached = m_pool->GetCachedSize();
+  CDVDDemuxUtils::FreeDemuxPacket(huge);
+  CDVDDemuxUtils::FreeDemuxPacket(empty);
+  EXPECT_EQ(cached, m_pool->GetCachedSize());
+}
+
+TEST_F(TestDemuxPacketPool, CacheLimit)
+{
+  std::vector<DemuxPacket*> packets;
+  for (int i = 0; i < 32; i++)
+    packets.push_back(CDVDDemuxUtils::AllocateDemuxPacket(400000));
+
+  size_t steady, peak;
+  m_pool->GetUsage(steady, peak);
+  EXPECT_LE(32u * 400000, peak);
+
+  for (auto packet : packets)
+    CDVDDemuxUtils::FreeDemuxPacket(packet);
+  EXPECT_GE(4u * 1024 * 1024, m_pool->GetCachedSize());
+
+  m_pool->Trim();
+  EXPECT_EQ(0u, m_pool->GetCachedSize());
+}
+
+TEST_F(TestDemuxPacketPool, Lifetime)
+{
+  // packets outlive the player that allocated them
+  DemuxPacket* packet = CDVDDemuxUtils::AllocateDemuxPacket(1000);
+  CDemuxPacketPool::SetCurrent(NULL);
+  m_pool->Release();
+  m_pool = NULL;
+
+  packet->pData[999] = 1;
+  CDVDDemuxUtils::FreeDemuxPacket(packet);
+
+  m_pool = new CDemuxPacketPool();
+}
+
+TEST_F(TestDemuxPacketPool, Throughput)
+{
+  // keep a second of a 100 Mbit/s stream in flight like the message queues do
+  const int count = 50000;
+  const int inFlight = 24;
+  std::vector<DemuxPacket*> packets(inFlight, nullptr);
+
+  for (int pooled = 0; pooled < 2; pooled++)
+  {
+    CDemuxPacketPool::SetCurrent(pooled ? m_pool : NULL);
+
+    int64_t start = CurrentHostCounter();
+    for (int i = 0; i < count; i++)
+    {
+      DemuxPacket*& slot = packets[i % inFlight];
+      CDVDDemuxUtils::FreeDemuxPacket(slot);
+      slot = CDVDDemuxUtils::AllocateDemuxPacket(i % 4 ? 4000 : 400000 + (i * 7919) % 200000);
+      slot->pData[0] = 0;
+    }
+    for (auto& packet : packets)
+    {
+      CDVDDemuxUtils::FreeDemuxPacket(packet);
+      packet = nullptr;
+    }
+    double seconds = static_cast<double>(CurrentHostCounter() - start) / CurrentHostFrequency();
+
+    std::cout << (pooled ? "pooled" : "malloc") << " packets/sec: "
+              << static_cast<int64_t>(count / seconds) << std::endl;
+  }
+
+  size_t steady, peak;
+  m_pool->GetUsage(steady, peak);
+  std::cout << "pool steady: " << steady / 1024 << " KiB, peak: " << peak / 1024 << " KiB" << std::endl;
+}
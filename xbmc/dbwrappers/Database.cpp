@@ -155,6 +155,8 @@ CDatabase::CDatabase(void)
   m_sqlite = true;
   m_bMultiWrite = false;
   m_multipleExecute = false;
+  m_batch = false;
+  m_batchDepth = 0;
 }
 
 CDatabase::~CDatabase(void)
@@ -306,6 +308,53 @@ bool CDatabase::ResultQuery(const std::string &strQuery)
   return bReturn;
 }
 
+bool CDatabase::ExecuteQuery(const std::string &strQuery, const dbiplus::ParamValues &params)
+{
+  bool bReturn = false;
+
+  try
+  {
+    if (NULL == m_pDB.get()) return bReturn;
+    if (NULL == m_pDS.get()) return bReturn;
+
+    if (m_multipleExecute)
+    {
+      m_multipleQueries.push_back(m_pDB->bind(strQuery, params));
+      return true;
+    }
+
+    m_pDS->exec(strQuery, params);
+    bReturn = true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s - failed to execute query '%s'",
+        __FUNCTION__, strQuery.c_str());
+  }
+
+  return bReturn;
+}
+
+bool CDatabase::ResultQuery(const std::string &strQuery, const dbiplus::ParamValues &params)
+{
+  bool bReturn = false;
+
+  try
+  {
+    if (NULL == m_pDB.get()) return bReturn;
+    if (NULL == m_pDS.get()) return bReturn;
+
+    bReturn = m_pDS->query(strQuery, params);
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s - failed to execute query '%s'",
+        __FUNCTION__, strQuery.c_str());
+  }
+
+  return bReturn;
+}
+
 bool CDatabase::QueueInsertQuery(const std::string &strQuery)
 {
   if (strQuery.empty())
@@ -529,6 +578,8 @@ void CDatabase::Close()
 
   m_openCount = 0;
   m_multipleExecute = false;
+  m_batch = false;
+  m_batchDepth = 0;
 
   if (NULL == m_pDB.get() ) return ;
   if (NULL != m_pDS.get()) m_pDS->close();
@@ -584,7 +635,12 @@ void CDatabase::BeginTransaction()
   try
   {
     if (NULL != m_pDB.get())
-      m_pDB->start_transaction();
+    {
+      if (m_batch)
+        m_pDS->exec(StringUtils::Format("SAVEPOINT batch%u", ++m_batchDepth));
+      else
+        m_pDB->start_transaction();
+    }
   }
   catch (...)
   {
@@ -597,7 +653,15 @@ bool CDatabase::CommitTransaction()
   try
   {
     if (NULL != m_pDB.get())
-      m_pDB->commit_transaction();
+    {
+      if (m_batch)
+      {
+        if (m_batchDepth > 0)
+          m_pDS->exec(StringUtils::Format("RELEASE SAVEPOINT batch%u", m_batchDepth--));
+      }
+      else
+        m_pDB->commit_transaction();
+    }
   }
   catch (...)
   {
@@ -612,7 +676,19 @@ void CDatabase::RollbackTransaction()
   try
   {
     if (NULL != m_pDB.get())
-      m_pDB->rollback_transaction();
+    {
+      if (m_batch)
+      {
+        // only undo the nested transaction, the rest of the batch is kept
+        if (m_batchDepth > 0)
+        {
+          m_pDS->exec(StringUtils::Format("ROLLBACK TO SAVEPOINT batch%u", m_batchDepth));
+          m_pDS->exec(StringUtils::Format("RELEASE SAVEPOINT batch%u", m_batchDepth--));
+        }
+      }
+      else
+        m_pDB->rollback_transaction();
+    }
   }
   catch (...)
   {
@@ -620,6 +696,38 @@ void CDatabase::RollbackTransaction()
   }
 }
 
+bool CDatabase::BeginBatch()
+{
+  if (NULL == m_pDB.get() || m_batch)
+    return false;
+
+  BeginTransaction();
+  m_batch = true;
+  m_batchDepth = 0;
+  return true;
+}
+
+bool CDatabase::CommitBatch()
+{
+  if (!m_batch)
+    return false;
+
+  // committing ends any nested transaction that was left open
+  m_batch = false;
+  m_batchDepth = 0;
+  return CommitTransaction();
+}
+
+void CDatabase::RollbackBatch()
+{
+  if (!m_batch)
+    return;
+
+  m_batch = false;
+  m_batchDepth = 0;
+  RollbackTransaction();
+}
+
 bool CDatabase::InTransaction()
 {
   if (NULL != m_pDB.get()) return false;
@@ -29,6 +29,8 @@ namespace dbiplus {
 #include <string>
 #include <vector>
 
+#include "dbwrappers/qry_dat.h"
+
 class DatabaseSettings; // forward
 class CDbUrl;
 struct SortDescription;
@@ -86,6 +88,27 @@ public:
   virtual bool CommitTransaction();
   void RollbackTransaction();
   bool InTransaction();
+
+  /*!
+   * @brief Start a batch of writes that are committed together by CommitBatch().
+   *        Transactions begun during the batch are nested in it as savepoints,
+   *        so they can still be rolled back on their own.
+   * @return true if the batch was started, false if there is no connection or a batch is running.
+   * @sa CommitBatch
+   */
+  bool BeginBatch();
+
+  /*!
+   * @brief Commit all writes since BeginBatch() in one transaction.
+   * @return True if the batch was committed successfully, false otherwise.
+   */
+  virtual bool CommitBatch();
+
+  /*!
+   * @brief Undo all writes since BeginBatch() and end the batch.
+   */
+  void RollbackBatch();
+  bool InBatch() const { return m_batch; }
   void CopyDB(const std::string& latestDb);
   void DropAnalytics();
 
@@ -128,6 +151,17 @@ public:
    */
   bool ExecuteQuery(const std::string &strQuery);
 
+  /*!
+   * @brief Execute a query that does not return any result, binding the
+   *        parameters to its '?' placeholders. The statement is prepared once
+   *        per connection and reused, so prefer this for repeated writes.
+   * @param strQuery The query to execute, not formatted with PrepareSQL().
+   * @param params The values of the placeholders.
+   * @return True if the query was executed successfully, false otherwise.
+   * @sa ExecuteQuery
+   */
+  bool ExecuteQuery(const std::string &strQuery, const dbiplus::ParamValues &params);
+
   /*!
    * @brief Execute a query that returns a result.
    * @remarks Call m_pDS->close(); to clean up the dataset when done.
@@ -136,6 +170,16 @@ public:
    */
   bool ResultQuery(const std::string &strQuery);
 
+  /*!
+   * @brief Execute a query that returns a result, binding the parameters to
+   *        its '?' placeholders. The statement is prepared once per connection and reused.
+   * @remarks Call m_pDS->close(); to clean up the dataset when done.
+   * @param strQuery The query to execute, not formatted with PrepareSQL().
+   * @param params The values of the placeholders.
+   * @return True if the query was executed successfully, false otherwise.
+   */
+  bool ResultQuery(const std::string &strQuery, const dbiplus::ParamValues &params);
+
   /*!
    * @brief Start a multiple execution queue. Any ExecuteQuery() function
    *        following this call will be queued rather than executed until
@@ -231,4 +275,7 @@ private:
 
   bool m_multipleExecute;
   std::vector<std::string> m_multipleQueries;
+
+  bool m_batch;
+  unsigned int m_batchDepth;
 };
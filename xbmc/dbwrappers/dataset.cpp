@@ -82,6 +82,58 @@ std::string Database::prepare(const char *format, ...)
   return result;
 }
 
+std::string Database::bind(const std::string &sql, const ParamValues &params)
+{
+  std::string result;
+  result.reserve(sql.size());
+  size_t param = 0;
+  char quote = 0;
+  for (std::string::const_iterator c = sql.begin(); c != sql.end(); ++c)
+  {
+    if (quote)
+    {
+      if (*c == quote)
+        quote = 0;
+    }
+    else if (*c == '\'' || *c == '"' || *c == '`')
+      quote = *c;
+    else if (*c == '?')
+    {
+      if (param >= params.size())
+        throw DbErrors("Missing parameter %u of '%s'", (unsigned int)param + 1, sql.c_str());
+
+      const field_value &value = params[param++];
+      if (value.get_isNull())
+        result += "NULL";
+      else
+      {
+        switch (value.get_fType())
+        {
+        case ft_String:
+          result += prepare("'%s'", value.get_asString().c_str());
+          break;
+        case ft_Float:
+        case ft_Double:
+          result += prepare("%.17g", value.get_asDouble());
+          break;
+        case ft_Boolean:
+          result += value.get_asBool() ? "1" : "0";
+          break;
+        default:
+          result += std::to_string(value.get_asInt64());
+          break;
+        }
+      }
+      continue;
+    }
+    result += *c;
+  }
+  if (param != params.size())
+    throw DbErrors("Too many parameters for '%s'", sql.c_str());
+
+  return result;
+}
+
 //************* Dataset implementation ***************
 
 Dataset::Dataset():
@@ -202,6 +254,16 @@ void Dataset::parse_sql(std::string &sql) {
 }
 
 
+int Dataset::exec(const std::string &sql, const ParamValues &params) {
+  if (db == NULL) throw DbErrors("No Database Connection");
+  return exec(db->bind(sql, params));
+}
+
+bool Dataset::query(const std::string &sql, const ParamValues &params) {
+  if (db == NULL) throw DbErrors("No Database Connection");
+  return query(db->bind(sql, params));
+}
+
 void Dataset::close(void) {
   haveError  = false;
   frecno = 0;
@@ -56,6 +56,65 @@ class Dataset;		// forward declaration of class Dataset
 #define DB_UNEXPECTED		7	// This shouldn't ever happen
 #define DB_UNEXPECTED_RESULT   -1       //For integer functions
 
+#define DB_STATEMENT_CACHE_SIZE 64      // Prepared statements kept per connection
+
+/******************* Class StatementCache definition **************
+
+   least recently used prepared statements of a connection,
+   keyed by their SQL text
+
+******************************************************************/
+template<typename T>
+class StatementCache {
+public:
+  StatementCache(size_t capacity = DB_STATEMENT_CACHE_SIZE) : capacity_(capacity), hits_(0), misses_(0) {}
+
+/* returns the statement prepared for sql or NULL, marking it as most recently used */
+  T get(const std::string &sql) {
+    typename Index::iterator it = index_.find(sql);
+    if (it == index_.end()) {
+      misses_++;
+      return NULL;
+    }
+    hits_++;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return it->second->second;
+  }
+/* adds a statement, returns the least recently used one if it had to make room or NULL */
+  T put(const std::string &sql, T stmt) {
+    entries_.push_front(std::make_pair(sql, stmt));
+    index_[sql] = entries_.begin();
+    if (entries_.size() <= capacity_)
+      return NULL;
+    T evicted = entries_.back().second;
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+    return evicted;
+  }
+/* removes all statements, returning them to be finalized */
+  std::vector<T> clear() {
+    std::vector<T> stmts;
+    for (typename Entries::iterator it = entries_.begin(); it != entries_.end(); ++it)
+      stmts.push_back(it->second);
+    entries_.clear();
+    index_.clear();
+    return stmts;
+  }
+
+  size_t size() const { return entries_.size(); }
+  unsigned int hits() const { return hits_; }
+  unsigned int misses() const { return misses_; }
+
+private:
+  typedef std::list<std::pair<std::string, T> > Entries;
+  typedef std::map<std::string, typename Entries::iterator> Index;
+
+  size_t capacity_;
+  Entries entries_;
+  Index index_;
+  unsigned int hits_, misses_;
+};
+
 /******************* Class Database definition ********************
 
    represents  connection with database server;
@@ -165,6 +224,14 @@ public:
 
   virtual bool in_transaction() {return false;};
 
+  /*! \brief Substitute the '?' placeholders of a SQL statement with the escaped parameters.
+   Used by backends that can't bind parameters to a prepared statement.
+   \param sql - statement with one '?' per parameter, placeholders in quoted strings are left alone.
+   \param params - values to substitute, a NULL value is written as NULL.
+   \return escaped and formatted string.
+   */
+  std::string bind(const std::string &sql, const ParamValues &params);
+
 };
 
 
@@ -308,6 +375,11 @@ public:
   virtual const void* getExecRes()=0;
 /* as open, but with our query exept Sql */
   virtual bool query(const std::string &sql) = 0;
+/* as exec and query, with the '?' placeholders of sql bound to params.
+   Backends cache the prepared statement on the connection, so repeating
+   the same sql with other values skips parsing and planning */
+  virtual int  exec (const std::string &sql, const ParamValues &params);
+  virtual bool query(const std::string &sql, const ParamValues &params);
 /* Close SQL Query*/
   virtual void close();
 /* This function looks for field Field_name with value equal Field_value
@@ -20,6 +20,7 @@
 
 #include <iostream>
 #include <string>
+#include <memory>
 #include <set>
 #include <algorithm>
 
@@ -40,6 +41,11 @@
 #define MYSQL_OK          0
 #define ER_BAD_DB_ERROR   1049
 
+// MySQL 8 dropped my_bool in favour of bool
+#if !defined(MARIADB_BASE_VERSION) && MYSQL_VERSION_ID >= 80001
+typedef bool my_bool;
+#endif
+
 namespace dbiplus {
 
 //************* MysqlDatabase implementation ***************
@@ -253,6 +259,11 @@ int MysqlDatabase::connect(bool create_new) {
 }
 
 void MysqlDatabase::disconnect(void) {
+  // statements have to be closed before the connection they were prepared on
+  std::vector<MYSQL_STMT*> stmts = statements.clear();
+  for (std::vector<MYSQL_STMT*>::iterator i = stmts.begin(); i != stmts.end(); ++i)
+    mysql_stmt_close(*i);
+
   if (conn != NULL)
   {
     mysql_close(conn);
@@ -456,6 +467,54 @@ int MysqlDatabase::query_with_reconnect(const char* query) {
   return result;
 }
 
+MYSQL_STMT* MysqlDatabase::execute_with_reconnect(const char* query, MYSQL_BIND *params, int &result) {
+  int attempts = 5;
+
+  while (true)
+  {
+    MYSQL_STMT *stmt = statements.get(query);
+    if (stmt == NULL && (stmt = mysql_stmt_init(conn)) != NULL)
+    {
+      // size the result buffers from the longest value of each column
+      my_bool updateMaxLength = 1;
+      mysql_stmt_attr_set(stmt, STMT_ATTR_UPDATE_MAX_LENGTH, &updateMaxLength);
+      if (mysql_stmt_prepare(stmt, query, strlen(query)) == MYSQL_OK)
+      {
+        MYSQL_STMT *evicted = statements.put(query, stmt);
+        if (evicted != NULL)
+          mysql_stmt_close(evicted);
+      }
+      else
+      {
+        result = mysql_stmt_errno(stmt);
+        mysql_stmt_close(stmt);
+        stmt = NULL;
+      }
+    }
+    else if (stmt == NULL)
+      result = mysql_errno(conn);
+
+    if (stmt != NULL)
+    {
+      if (mysql_stmt_bind_param(stmt, params) == MYSQL_OK &&
+          mysql_stmt_execute(stmt) == MYSQL_OK)
+      {
+        result = MYSQL_OK;
+        return stmt;
+      }
+      result = mysql_stmt_errno(stmt);
+    }
+
+    // try to reconnect if server is gone, this closes all statements of the connection
+    if ((result != CR_SERVER_GONE_ERROR && result != CR_SERVER_LOST) || attempts-- <= 0)
+      return NULL;
+
+    CLog::Log(LOGINFO,"MYSQL server has gone. Will try %d more attempt(s) to reconnect.", attempts);
+    active = false;
+    connect(true);
+  }
+}
+
 long MysqlDatabase::nextid(const char* sname) {
   CLog::Log(LOGDEBUG,"MysqlDatabase::nextid for %s",sname);
   if (!active) return DB_UNEXPECTED_RESULT;
@@ -1496,6 +1555,107 @@ static size_t ci_find(const std::string& where, const std::string& what)
     return loc - where.begin();
 }
 
+static void fill_field_value(field_value &v, const MYSQL_FIELD &field, const char *value)
+{
+  switch (field.type)
+  {
+    case MYSQL_TYPE_LONGLONG:
+    case MYSQL_TYPE_DECIMAL:
+    case MYSQL_TYPE_NEWDECIMAL:
+    case MYSQL_TYPE_TINY:
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_INT24:
+    case MYSQL_TYPE_LONG:
+      if (value != NULL)
+      {
+        v.set_asInt(atoi(value));
+      }
+      else
+      {
+        v.set_asInt(0);
+      }
+      break;
+    case MYSQL_TYPE_FLOAT:
+    case MYSQL_TYPE_DOUBLE:
+      if (value != NULL)
+      {
+        v.set_asDouble(atof(value));
+      }
+      else
+      {
+        v.set_asDouble(0);
+      }
+      break;
+    case MYSQL_TYPE_STRING:
+    case MYSQL_TYPE_VAR_STRING:
+    case MYSQL_TYPE_VARCHAR:
+      if (value != NULL) v.set_asString(value);
+      break;
+    case MYSQL_TYPE_TINY_BLOB:
+    case MYSQL_TYPE_MEDIUM_BLOB:
+    case MYSQL_TYPE_LONG_BLOB:
+    case MYSQL_TYPE_BLOB:
+      if (value != NULL) v.set_asString(value);
+      break;
+    case MYSQL_TYPE_NULL:
+    default:
+      CLog::Log(LOGDEBUG,"MYSQL: Unknown field type: %u", field.type);
+      v.set_asString("");
+      v.set_isNull();
+      break;
+  }
+}
+
+/* Buffers of the parameters bound to a prepared statement */
+struct ParamBinds
+{
+  ParamBinds(const ParamValues &params)
+    : binds(params.size()), strings(params.size()), lengths(params.size()), ints(params.size()), doubles(params.size())
+  {
+    for (unsigned int i = 0; i < params.size(); i++)
+    {
+      const field_value &v = params[i];
+      MYSQL_BIND &bind = binds[i];
+      memset(&bind, 0, sizeof(bind));
+      if (v.get_isNull())
+      {
+        bind.buffer_type = MYSQL_TYPE_NULL;
+        continue;
+      }
+      switch (v.get_fType())
+      {
+      case ft_String:
+        strings[i] = v.get_asString();
+        lengths[i] = strings[i].size();
+        bind.buffer_type = MYSQL_TYPE_STRING;
+        bind.buffer = const_cast<char*>(strings[i].c_str());
+        bind.buffer_length = lengths[i];
+        bind.length = &lengths[i];
+        break;
+      case ft_Float:
+      case ft_Double:
+        doubles[i] = v.get_asDouble();
+        bind.buffer_type = MYSQL_TYPE_DOUBLE;
+        bind.buffer = &doubles[i];
+        break;
+      default:
+        ints[i] = v.get_asInt64();
+        bind.buffer_type = MYSQL_TYPE_LONGLONG;
+        bind.buffer = &ints[i];
+        break;
+      }
+    }
+  }
+
+  MYSQL_BIND *get() { return binds.empty() ? NULL : &binds[0]; }
+
+  std::vector<MYSQL_BIND> binds;
+  std::vector<std::string> strings;
+  std::vector<unsigned long> lengths;
+  std::vector<long long> ints;
+  std::vector<double> doubles;
+};
+
 int MysqlDataset::exec(const std::string &sql) {
   if (!handle()) throw DbErrors("No Database Connection");
   std::string qry = sql;
@@ -1587,54 +1747,7 @@ bool MysqlDataset::query(const std::string &query) {
     res->resize(numColumns);
     for (unsigned int i = 0; i < numColumns; i++)
     {
-      field_value &v = res->at(i);
-      switch (fields[i].type)
-      {
-        case MYSQL_TYPE_LONGLONG:
-        case MYSQL_TYPE_DECIMAL:
-        case MYSQL_TYPE_NEWDECIMAL:
-        case MYSQL_TYPE_TINY:
-        case MYSQL_TYPE_SHORT:
-        case MYSQL_TYPE_INT24:
-        case MYSQL_TYPE_LONG:
-          if (row[i] != NULL)
-          {
-            v.set_asInt(atoi(row[i]));
-          }
-          else
-          {
-            v.set_asInt(0);
-          }
-          break;
-        case MYSQL_TYPE_FLOAT:
-        case MYSQL_TYPE_DOUBLE:
-          if (row[i] != NULL)
-          {
-            v.set_asDouble(atof(row[i]));
-          }
-          else
-          {
-            v.set_asDouble(0);
-          }
-          break;
-        case MYSQL_TYPE_STRING:
-        case MYSQL_TYPE_VAR_STRING:
-        case MYSQL_TYPE_VARCHAR:
-          if (row[i] != NULL) v.set_asString((const char *)row[i] );
-          break;
-        case MYSQL_TYPE_TINY_BLOB:
-        case MYSQL_TYPE_MEDIUM_BLOB:
-        case MYSQL_TYPE_LONG_BLOB:
-        case MYSQL_TYPE_BLOB:
-          if (row[i] != NULL) v.set_asString((const char *)row[i]);
-          break;
-        case MYSQL_TYPE_NULL:
-        default:
-          CLog::Log(LOGDEBUG,"MYSQL: Unknown field type: %u", fields[i].type);
-          v.set_asString("");
-          v.set_isNull();
-          break;
-      }
+      fill_field_value(res->at(i), fields[i], row[i]);
     }
     result.records.push_back(res);
   }
@@ -1645,6 +1758,107 @@ bool MysqlDataset::query(const std::string &query) {
   return true;
 }
 
+int MysqlDataset::exec(const std::string &sql, const ParamValues &params) {
+  if (!handle()) throw DbErrors("No Database Connection");
+  exec_res.clear();
+
+  ParamBinds binds(params);
+  int res;
+  MYSQL_STMT *stmt = static_cast<MysqlDatabase*>(db)->execute_with_reconnect(sql.c_str(), binds.get(), res);
+  if (db->setErr(res, sql.c_str()) != MYSQL_OK)
+    throw DbErrors(db->getErrorMsg());
+
+  mysql_stmt_free_result(stmt);
+  return res;
+}
+
+bool MysqlDataset::query(const std::string &query, const ParamValues &params) {
+  if(!handle()) throw DbErrors("No Database Connection");
+  std::string qry = query;
+
+  close();
+
+  size_t loc;
+
+  // mysql doesn't understand CAST(foo as integer) => change to CAST(foo as signed integer)
+  while ((loc = ci_find(qry, "as integer)")) != std::string::npos)
+    qry = qry.insert(loc + 3, "signed ");
+
+  ParamBinds binds(params);
+  int res;
+  MYSQL_STMT *stmt = static_cast<MysqlDatabase*>(db)->execute_with_reconnect(qry.c_str(), binds.get(), res);
+  if (db->setErr(res, qry.c_str()) != MYSQL_OK)
+    throw DbErrors(db->getErrorMsg());
+
+  MYSQL_RES *meta = mysql_stmt_result_metadata(stmt);
+  if (meta == NULL)
+    throw DbErrors("Missing result set!");
+  if (db->setErr(mysql_stmt_store_result(stmt), qry.c_str()) != MYSQL_OK)
+  {
+    mysql_free_result(meta);
+    throw DbErrors(db->getErrorMsg());
+  }
+
+  // column headers, every column is fetched as text like in the unprepared query
+  const unsigned int numColumns = mysql_num_fields(meta);
+  MYSQL_FIELD *fields = mysql_fetch_fields(meta);
+  std::vector<MYSQL_BIND> columns(numColumns);
+  std::vector<std::vector<char> > buffers(numColumns);
+  std::vector<unsigned long> lengths(numColumns);
+  std::unique_ptr<my_bool[]> nulls(new my_bool[numColumns]);
+  result.record_header.resize(numColumns);
+  for (unsigned int i = 0; i < numColumns; i++)
+  {
+    result.record_header[i].name = fields[i].name;
+    buffers[i].resize(std::max(fields[i].max_length, 64UL) + 1);
+    memset(&columns[i], 0, sizeof(MYSQL_BIND));
+    columns[i].buffer_type = MYSQL_TYPE_STRING;
+    columns[i].buffer = &buffers[i][0];
+    columns[i].buffer_length = buffers[i].size();
+    columns[i].length = &lengths[i];
+    columns[i].is_null = &nulls[i];
+  }
+  mysql_stmt_bind_result(stmt, columns.empty() ? NULL : &columns[0]);
+
+  // returned rows
+  while ((res = mysql_stmt_fetch(stmt)) == MYSQL_OK || res == MYSQL_DATA_TRUNCATED)
+  { // have a row of data
+    sql_record *rec = new sql_record;
+    rec->resize(numColumns);
+    for (unsigned int i = 0; i < numColumns; i++)
+    {
+      if (nulls[i])
+      {
+        fill_field_value(rec->at(i), fields[i], NULL);
+        continue;
+      }
+      if (lengths[i] < buffers[i].size())
+      {
+        buffers[i][lengths[i]] = '\0';
+        fill_field_value(rec->at(i), fields[i], &buffers[i][0]);
+        continue;
+      }
+      // value didn't fit the buffer
+      std::vector<char> value(lengths[i] + 1);
+      MYSQL_BIND bind;
+      memset(&bind, 0, sizeof(bind));
+      bind.buffer_type = MYSQL_TYPE_STRING;
+      bind.buffer = &value[0];
+      bind.buffer_length = value.size();
+      mysql_stmt_fetch_column(stmt, &bind, i, 0);
+      value[lengths[i]] = '\0';
+      fill_field_value(rec->at(i), fields[i], &value[0]);
+    }
+    result.records.push_back(rec);
+  }
+  mysql_free_result(meta);
+  mysql_stmt_free_result(stmt);
+  active = true;
+  ds_state = dsSelect;
+  this->first();
+  return true;
+}
+
 void MysqlDataset::open(const std::string &sql) {
    set_select_sql(sql);
    open();
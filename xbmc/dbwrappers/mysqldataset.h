@@ -36,6 +36,8 @@ protected:
   MYSQL* conn;
   bool _in_transaction;
   int last_err;
+/* prepared statements of the connection */
+  StatementCache<MYSQL_STMT*> statements;
 
 
 public:
@@ -84,6 +86,10 @@ public:
 
   bool in_transaction() {return _in_transaction;};
   int query_with_reconnect(const char* query);
+/* executes the cached prepared statement for query with params bound, reconnecting if the server is gone.
+   Returns the statement or NULL with the error code in result */
+  MYSQL_STMT* execute_with_reconnect(const char* query, MYSQL_BIND *params, int &result);
+  const StatementCache<MYSQL_STMT*> &getStatementCache() const { return statements; }
   void configure_connection();
 
 private:
@@ -146,9 +152,11 @@ or insert() operations default = false) */
 /* func. executes a query without results to return */
   virtual int  exec ();
   virtual int  exec (const std::string &sql);
+  virtual int  exec (const std::string &sql, const ParamValues &params);
   virtual const void* getExecRes();
 /* as open, but with our query exept Sql */
   virtual bool query(const std::string &query);
+  virtual bool query(const std::string &query, const ParamValues &params);
 /* func. closes a query */
   virtual void close(void);
 /* Cancel changes, made in insert or edit states of dataset */
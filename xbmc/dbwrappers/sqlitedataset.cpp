@@ -87,6 +87,42 @@ static int busy_callback(void*, int busyCount)
   return 1;
 }
 
+static int bind_params(sqlite3_stmt *stmt, const ParamValues &params)
+{
+  if (sqlite3_bind_parameter_count(stmt) != (int)params.size())
+    return SQLITE_RANGE;
+
+  for (unsigned int i = 0; i < params.size(); i++)
+  {
+    const field_value &v = params[i];
+    int res;
+    if (v.get_isNull())
+      res = sqlite3_bind_null(stmt, i + 1);
+    else
+    {
+      switch (v.get_fType())
+      {
+      case ft_String:
+      {
+        const std::string str = v.get_asString();
+        res = sqlite3_bind_text(stmt, i + 1, str.c_str(), str.size(), SQLITE_TRANSIENT);
+        break;
+      }
+      case ft_Float:
+      case ft_Double:
+        res = sqlite3_bind_double(stmt, i + 1, v.get_asDouble());
+        break;
+      default:
+        res = sqlite3_bind_int64(stmt, i + 1, v.get_asInt64());
+        break;
+      }
+    }
+    if (res != SQLITE_OK)
+      return res;
+  }
+  return SQLITE_OK;
+}
+
 //************* SqliteDatabase implementation ***************
 
 SqliteDatabase::SqliteDatabase() {
@@ -261,10 +297,28 @@ bool SqliteDatabase::exists(void)
 
 void SqliteDatabase::disconnect(void) {
   if (active == false) return;
+  // the connection can't be closed while it has unfinalized statements
+  std::vector<sqlite3_stmt*> stmts = statements.clear();
+  for (std::vector<sqlite3_stmt*>::iterator i = stmts.begin(); i != stmts.end(); ++i)
+    sqlite3_finalize(*i);
   sqlite3_close(conn);
   active = false;
 }
 
+sqlite3_stmt *SqliteDatabase::getStatement(const std::string &sql) {
+  sqlite3_stmt *stmt = statements.get(sql);
+  if (stmt != NULL)
+    return stmt;
+
+  if (setErr(sqlite3_prepare_v2(conn, sql.c_str(), -1, &stmt, NULL), sql.c_str()) != SQLITE_OK)
+    throw DbErrors(getErrorMsg());
+
+  sqlite3_stmt *evicted = statements.put(sql, stmt);
+  if (evicted != NULL)
+    sqlite3_finalize(evicted);
+  return stmt;
+}
+
 int SqliteDatabase::create() {
   return connect(true);
 }
@@ -640,20 +694,27 @@ const void* SqliteDataset::getExecRes() {
 }
 
 
-bool SqliteDataset::query(const std::string &query) {
-    if(!handle()) throw DbErrors("No Database Connection");
-    std::string qry = query;
-    int fs = qry.find("select");
-    int fS = qry.find("SELECT");
-    if (!( fs >= 0 || fS >=0))                                 
-         throw DbErrors("MUST be select SQL!"); 
+int SqliteDataset::exec(const std::string &sql, const ParamValues &params) {
+  if (!handle()) throw DbErrors("No Database Connection");
+  exec_res.clear();
 
-  close();
+  sqlite3_stmt *stmt = static_cast<SqliteDatabase*>(db)->getStatement(sql);
+  int res = bind_params(stmt, params);
+  if (res == SQLITE_OK)
+  {
+    while ((res = sqlite3_step(stmt)) == SQLITE_ROW) ;
+    if (res == SQLITE_DONE)
+      res = SQLITE_OK;
+  }
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
 
-  sqlite3_stmt *stmt = NULL;
-  if (db->setErr(sqlite3_prepare_v2(handle(),query.c_str(),-1,&stmt, NULL),query.c_str()) != SQLITE_OK)
+  if (db->setErr(res, sql.c_str()) != SQLITE_OK)
     throw DbErrors(db->getErrorMsg());
+  return res;
+}
 
+void SqliteDataset::fetch_rows(sqlite3_stmt *stmt) {
   // column headers
   const unsigned int numColumns = sqlite3_column_count(stmt);
   result.record_header.resize(numColumns);
@@ -691,6 +752,24 @@ bool SqliteDataset::query(const std::string &query) {
     }
     result.records.push_back(res);
   }
+}
+
+bool SqliteDataset::query(const std::string &query) {
+    if(!handle()) throw DbErrors("No Database Connection");
+    std::string qry = query;
+    int fs = qry.find("select");
+    int fS = qry.find("SELECT");
+    if (!( fs >= 0 || fS >=0))                                 
+         throw DbErrors("MUST be select SQL!"); 
+
+  close();
+
+  sqlite3_stmt *stmt = NULL;
+  if (db->setErr(sqlite3_prepare_v2(handle(),query.c_str(),-1,&stmt, NULL),query.c_str()) != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+
+  fetch_rows(stmt);
+
   if (db->setErr(sqlite3_finalize(stmt),query.c_str()) == SQLITE_OK)
   {
     active = true;
@@ -704,6 +783,34 @@ bool SqliteDataset::query(const std::string &query) {
   }  
 }
 
+bool SqliteDataset::query(const std::string &query, const ParamValues &params) {
+  if (!handle()) throw DbErrors("No Database Connection");
+
+  close();
+
+  sqlite3_stmt *stmt = static_cast<SqliteDatabase*>(db)->getStatement(query);
+  int res = bind_params(stmt, params);
+  if (res == SQLITE_OK)
+  {
+    fetch_rows(stmt);
+    res = sqlite3_reset(stmt);
+  }
+  else
+    sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+
+  if (db->setErr(res, query.c_str()) != SQLITE_OK)
+  {
+    close();
+    throw DbErrors(db->getErrorMsg());
+  }
+
+  active = true;
+  ds_state = dsSelect;
+  this->first();
+  return true;
+}
+
 void SqliteDataset::open(const std::string &sql) {
   set_select_sql(sql);
   open();
@@ -44,6 +44,8 @@ protected:
   sqlite3 *conn;
   bool _in_transaction;
   int last_err;
+/* prepared statements of the connection */
+  StatementCache<sqlite3_stmt*> statements;
 
 public:
 /* default constructor */
@@ -55,6 +57,10 @@ public:
 
 /* func. returns connection handle with SQLite-server */
   sqlite3 *getHandle() {  return conn; }
+/* func. returns the cached prepared statement for sql, preparing it if needed.
+   Callers reset it and clear its bindings once done */
+  sqlite3_stmt *getStatement(const std::string &sql);
+  const StatementCache<sqlite3_stmt*> &getStatementCache() const { return statements; }
 /* func. returns current status about SQLite-server connection */
   virtual int status();
   virtual int setErr(int err_code,const char * qry);
@@ -110,6 +116,9 @@ class SqliteDataset : public Dataset {
 protected:
   sqlite3* handle();
 
+/* Fills the result set with the rows returned by stmt */
+  void fetch_rows(sqlite3_stmt *stmt);
+
 /* Makes direct queries to database */
   virtual void make_query(StringList &_sql);
 /* Makes direct inserts into database */
@@ -145,9 +154,11 @@ or insert() operations default = false) */
 /* func. executes a query without results to return */
   virtual int  exec ();
   virtual int  exec (const std::string &sql);
+  virtual int  exec (const std::string &sql, const ParamValues &params);
   virtual const void* getExecRes();
 /* as open, but with our query exept Sql */
   virtual bool query(const std::string &query);
+  virtual bool query(const std::string &query, const ParamValues &params);
 /* func. closes a query */
   virtual void close(void);
 /* Cancel changes, made in insert or edit states of dataset */
@@ -0,0 +1,149 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "dbwrappers/sqlitedataset.h"
+#include "filesystem/SpecialProtocol.h"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+
+#include "gtest/gtest.h"
+
+using namespace dbiplus;
+
+class TestPreparedStatements : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_db.setHostName(CSpecialProtocol::TranslatePath("special://temp/").c_str());
+    m_db.setDatabase("TestPreparedStatements");
+    ASSERT_EQ(DB_CONNECTION_OK, m_db.connect(true));
+    m_ds.reset(m_db.CreateDataset());
+    CreateTable();
+  }
+
+  void CreateTable()
+  {
+    m_ds->exec("DROP TABLE IF EXISTS song");
+    m_ds->exec("CREATE TABLE song (idSong INTEGER PRIMARY KEY, idAlbum INTEGER, strTitle TEXT, rating FLOAT, lastplayed TEXT)");
+    m_ds->exec("CREATE INDEX ix_song ON song (idAlbum, strTitle)");
+  }
+
+  void TearDown() override
+  {
+    m_ds.reset();
+    m_db.disconnect();
+  }
+
+  SqliteDatabase m_db;
+  std::unique_ptr<Dataset> m_ds;
+};
+
+TEST_F(TestPreparedStatements, Bind)
+{
+  field_value null;
+  null.set_isNull();
+  EXPECT_EQ("INSERT INTO song VALUES (NULL, 3, 'it''s', 7.5, NULL)",
+            m_db.bind("INSERT INTO song VALUES (NULL, ?, ?, ?, ?)", { 3, "it's", 7.5, null }));
+  EXPECT_EQ("SELECT '?' FROM song WHERE strTitle='a?'", m_db.bind("SELECT '?' FROM song WHERE strTitle=?", { "a?" }));
+  EXPECT_THROW(m_db.bind("SELECT * FROM song WHERE idSong=?", ParamValues()), DbErrors);
+  EXPECT_THROW(m_db.bind("SELECT * FROM song", { 1 }), DbErrors);
+}
+
+TEST_F(TestPreparedStatements, ExecQuery)
+{
+  field_value null;
+  null.set_isNull();
+  m_ds->exec("INSERT INTO song VALUES (NULL, ?, ?, ?, ?)", { 1, "it's", 7.5, "2017-01-01 10:00:00" });
+  m_ds->exec("INSERT INTO song VALUES (NULL, ?, ?, ?, ?)", { 1, std::string("second"), 8.0, null });
+  EXPECT_EQ(2, m_ds->lastinsertid());
+
+  ASSERT_TRUE(m_ds->query("SELECT * FROM song WHERE idAlbum = ? ORDER BY idSong", { 1 }));
+  ASSERT_EQ(2, m_ds->num_rows());
+  EXPECT_EQ("it's", m_ds->fv("strTitle").get_asString());
+  EXPECT_DOUBLE_EQ(7.5, m_ds->fv("rating").get_asDouble());
+  m_ds->next();
+  EXPECT_EQ("second", m_ds->fv("strTitle").get_asString());
+  EXPECT_TRUE(m_ds->fv("lastplayed").get_isNull());
+  m_ds->close();
+
+  // the statements are prepared once
+  EXPECT_TRUE(m_ds->query("SELECT * FROM song WHERE idAlbum = ? ORDER BY idSong", { 2 }));
+  EXPECT_EQ(0, m_ds->num_rows());
+  m_ds->close();
+  EXPECT_EQ(2u, m_db.getStatementCache().size());
+  EXPECT_EQ(2u, m_db.getStatementCache().hits());
+
+  EXPECT_THROW(m_ds->exec("INSERT INTO song VALUES (NULL, ?, ?, ?, ?)", { 1 }), DbErrors);
+  EXPECT_THROW(m_ds->query("SELECT * FROM nosuchtable WHERE idSong = ?", { 1 }), DbErrors);
+}
+
+TEST_F(TestPreparedStatements, Cache)
+{
+  StatementCache<int*> cache(2);
+  int a, b, c;
+  EXPECT_EQ(NULL, cache.put("a", &a));
+  EXPECT_EQ(NULL, cache.put("b", &b));
+  EXPECT_EQ(&a, cache.get("a"));
+  // b is the least recently used
+  EXPECT_EQ(&b, cache.put("c", &c));
+  EXPECT_EQ(NULL, cache.get("b"));
+  EXPECT_EQ(&c, cache.get("c"));
+  EXPECT_EQ(2u, cache.clear().size());
+  EXPECT_EQ(0u, cache.size());
+}
+
+TEST_F(TestPreparedStatements, Performance)
+{
+  // adding the songs of a scan, once formatted and once with bound parameters
+  const int songs = 5000;
+  auto start = std::chrono::steady_clock::now();
+  m_db.start_transaction();
+  for (int i = 0; i < songs; i++)
+  {
+    if (!m_ds->query(m_db.prepare("SELECT * FROM song WHERE idAlbum = %i AND strTitle = '%s'", i / 10, "title")))
+      break;
+    m_ds->close();
+    m_ds->exec(m_db.prepare("INSERT INTO song VALUES (NULL, %i, '%s', %f, NULL)", i / 10, "title", 5.0));
+  }
+  m_db.commit_transaction();
+  auto formatted = std::chrono::steady_clock::now() - start;
+
+  CreateTable();
+  start = std::chrono::steady_clock::now();
+  m_db.start_transaction();
+  for (int i = 0; i < songs; i++)
+  {
+    if (!m_ds->query("SELECT * FROM song WHERE idAlbum = ? AND strTitle = ?", { i / 10, "title" }))
+      break;
+    m_ds->close();
+    m_ds->exec("INSERT INTO song VALUES (NULL, ?, ?, ?, NULL)", { i / 10, "title", 5.0 });
+  }
+  m_db.commit_transaction();
+  auto bound = std::chrono::steady_clock::now() - start;
+
+  EXPECT_EQ(songs, m_ds->lastinsertid());
+  EXPECT_EQ(2u * songs - 2, m_db.getStatementCache().hits());
+  std::cout << "adding " << songs << " songs: "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(formatted).count() << " ms formatted, "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(bound).count() << " ms prepared" << std::endl;
+}
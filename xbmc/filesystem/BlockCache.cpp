@@ -0,0 +1,882 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#if defined(TARGET_POSIX)
+
+#include "BlockCache.h"
+#include "CurlFile.h"
+#include "File.h"
+#include "SpecialProtocol.h"
+#include "URL.h"
+#include "PlatformDefs.h" //for PRIu64
+#include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/log.h"
+#include "utils/md5.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace XFILE;
+
+namespace
+{
+const char INDEX_MAGIC[4] = { 'K', 'B', 'C', 'I' };
+const uint32_t INDEX_VERSION = 2;
+
+// mapped blocks kept per open file, reads are mostly sequential
+const size_t MAX_MAPPINGS = 4;
+}
+
+CBlockCacheStore::CBlockCacheStore(const std::string &path, uint64_t budget, unsigned int blockSize)
+  : m_path(path)
+  , m_budget(budget)
+  , m_blockSize(blockSize)
+{
+  memset(&m_stats, 0, sizeof(m_stats));
+  m_stats.budget = budget;
+
+  if (!m_budget)
+    return;
+
+  URIUtils::AddSlashAtEnd(m_path);
+  if (mkdir(m_path.c_str(), 0755) != 0 && errno != EEXIST)
+  {
+    CLog::Log(LOGERROR, "CBlockCacheStore - unable to create %s, disabling", m_path.c_str());
+    m_budget = 0;
+    return;
+  }
+
+  // load what is left from earlier sessions, least recently used first
+  std::vector<std::pair<time_t, std::string> > indexes;
+  std::vector<std::string> data;
+  DIR *dir = opendir(m_path.c_str());
+  if (dir)
+  {
+    while (struct dirent *ent = readdir(dir))
+    {
+      std::string name = ent->d_name;
+      std::string file = m_path + name;
+      struct stat st;
+      if (URIUtils::HasExtension(name, ".idx") && stat(file.c_str(), &st) == 0)
+        indexes.push_back(std::make_pair(st.st_mtime, URIUtils::ReplaceExtension(name, "")));
+      else if (URIUtils::HasExtension(name, ".blk"))
+        data.push_back(URIUtils::ReplaceExtension(name, ""));
+    }
+    closedir(dir);
+  }
+
+  std::sort(indexes.begin(), indexes.end());
+  for (const auto &index : indexes)
+  {
+    if (!LoadIndex(index.second))
+    {
+      unlink((m_path + index.second + ".idx").c_str());
+      unlink((m_path + index.second + ".blk").c_str());
+    }
+  }
+
+  // data without index is left over from a crash, its contents are unknown
+  for (const auto &name : data)
+  {
+    if (m_entries.find(name) == m_entries.end())
+      unlink((m_path + name + ".blk").c_str());
+  }
+
+  CSingleLock lock(m_section);
+  Evict();
+}
+
+CBlockCacheStore::~CBlockCacheStore()
+{
+  for (auto &it : m_entries)
+  {
+    SEntry *entry = it.second;
+    UnmapAll(entry);
+    CloseData(entry);
+    if (!entry->handles.empty() && !entry->version.empty())
+      SaveIndex(entry);
+    delete entry;
+  }
+}
+
+CBlockCacheStore& CBlockCacheStore::GetInstance()
+{
+  static CBlockCacheStore store(CSpecialProtocol::TranslatePath("special://temp/blockcache/"),
+                                static_cast<uint64_t>(g_advancedSettings.m_cacheBlockStoreSize) * 1024 * 1024);
+  return store;
+}
+
+bool CBlockCacheStore::IsCacheable(const std::string &url)
+{
+  return URIUtils::IsSmb(url) || URIUtils::IsNfs(url) || URIUtils::IsHTTP(url);
+}
+
+void CBlockCacheStore::GetStats(SBlockCacheStats &stats)
+{
+  CSingleLock lock(m_section);
+  stats = m_stats;
+}
+
+std::string CBlockCacheStore::GetPath(const SEntry *entry, const char *extension) const
+{
+  return m_path + entry->name + extension;
+}
+
+CBlockCacheStore::SHandle* CBlockCacheStore::OpenHandle(const std::string &url, int64_t length, const std::string &version)
+{
+  CSingleLock lock(m_section);
+
+  if (!m_budget || length <= 0)
+    return NULL;
+
+  std::string name = XBMC::XBMC_MD5::GetMD5(url);
+  SEntry *entry = NULL;
+  auto it = m_entries.find(name);
+  if (it != m_entries.end())
+  {
+    entry = it->second;
+    if (entry->url != url || entry->length != length || entry->version != version)
+    {
+      // the file changed, or another url has the same hash and is in use
+      if (!entry->handles.empty())
+        return NULL;
+      CLog::Log(LOGDEBUG, "CBlockCacheStore - dropping stale data of %s", CURL::GetRedacted(entry->url).c_str());
+      RemoveEntry(entry);
+      entry = NULL;
+    }
+  }
+
+  if (!entry)
+  {
+    entry = new SEntry;
+    entry->url = url;
+    entry->name = name;
+    entry->version = version;
+    entry->length = length;
+    entry->fd = -1;
+    entry->used = 0;
+    entry->valid.assign((length + m_blockSize - 1) / m_blockSize, m_blockSize);
+    m_entries[name] = entry;
+  }
+
+  if (entry->fd < 0 && !OpenData(entry, true))
+  {
+    if (entry->handles.empty())
+      RemoveEntry(entry);
+    return NULL;
+  }
+
+  // the index is only valid while nobody writes, a crash has to lose the entry
+  if (entry->handles.empty())
+    unlink(GetPath(entry, ".idx").c_str());
+
+  SHandle *handle = new SHandle;
+  handle->entry = entry;
+  handle->runStart = 0;
+  handle->writePos = 0;
+  handle->readPos = 0;
+  entry->handles.push_back(handle);
+  return handle;
+}
+
+void CBlockCacheStore::CloseHandle(SHandle *handle)
+{
+  CSingleLock lock(m_section);
+
+  SEntry *entry = handle->entry;
+  entry->handles.remove(handle);
+  delete handle;
+
+  if (!entry->handles.empty())
+    return;
+
+  UnmapAll(entry);
+  CloseData(entry);
+  if (entry->used == 0)
+    RemoveEntry(entry);
+  else if (entry->version.empty())
+    return; // can't tell whether the source changed after a restart, no index
+  else if (!SaveIndex(entry))
+    RemoveEntry(entry);
+}
+
+bool CBlockCacheStore::ResetHandle(SHandle *handle, int64_t position)
+{
+  CSingleLock lock(m_section);
+
+  int64_t end = GetCachedEnd(handle, position);
+  if (end > position)
+    m_stats.seekHits++;
+  else
+    m_stats.seekMisses++;
+
+  // keep writing behind the cached data, the source has been positioned there
+  if (end != handle->writePos)
+  {
+    handle->runStart = end;
+    handle->writePos = end;
+  }
+  handle->readPos = position;
+  return end == position;
+}
+
+int CBlockCacheStore::Write(SHandle *handle, const char *buffer, size_t size)
+{
+  CSingleLock lock(m_section);
+
+  SEntry *entry = handle->entry;
+  int64_t position = handle->writePos;
+
+  size_t written = 0;
+  bool full = false;
+  while (written < size)
+  {
+    ssize_t ret = pwrite(entry->fd, buffer + written, size - written, position + written);
+    if (ret < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      if (errno == ENOSPC && !full)
+      {
+        // the disk filled up before the budget did, make room and try once more
+        uint64_t budget = m_budget;
+        m_budget = 0;
+        Evict();
+        m_budget = budget;
+        full = true;
+        continue;
+      }
+      CLog::Log(LOGERROR, "CBlockCacheStore - write to %s failed (%s)", entry->name.c_str(), strerror(errno));
+      break;
+    }
+    written += ret;
+  }
+
+  if (written > 0)
+  {
+    // the source is longer than it was when opened, a recording in progress
+    // or a length that was only estimated
+    if (position + static_cast<int64_t>(written) > entry->length)
+      Grow(entry, position + written);
+
+    handle->writePos += written;
+    m_stats.bytesFetched += written;
+
+    int64_t begin = std::max(handle->runStart, position - position % m_blockSize);
+    Validate(entry, begin, handle->writePos);
+    Evict();
+  }
+
+  handle->written.Set();
+  if (written == 0 && size > 0)
+    return CACHE_RC_ERROR;
+  return written;
+}
+
+int CBlockCacheStore::Read(SHandle *handle, char *buffer, size_t size)
+{
+  CSingleLock lock(m_section);
+
+  SEntry *entry = handle->entry;
+  int64_t position = handle->readPos;
+  int64_t available = GetCachedEnd(handle, position) - position;
+  size_t toRead = static_cast<size_t>(std::max<int64_t>(0, std::min<int64_t>(size, available)));
+
+  size_t done = 0;
+  while (done < toRead)
+  {
+    int64_t pos = position + done;
+    int64_t block = pos / m_blockSize;
+    int64_t offset = pos - block * m_blockSize;
+    size_t chunk = static_cast<size_t>(std::min<int64_t>(toRead - done, GetBlockLength(entry, block) - offset));
+
+    uint8_t *data = Map(entry, block);
+    if (data)
+      memcpy(buffer + done, data + offset, chunk);
+    else if (pread(entry->fd, buffer + done, chunk, pos) != static_cast<ssize_t>(chunk))
+    {
+      CLog::Log(LOGERROR, "CBlockCacheStore - read from %s failed", entry->name.c_str());
+      break;
+    }
+
+    // anything outside of what this reader fetched itself came from the store
+    if (pos < handle->runStart || pos >= handle->writePos)
+      m_stats.bytesHit += chunk;
+    if (entry->valid[block] <= offset)
+      Touch(entry, block);
+
+    done += chunk;
+  }
+
+  handle->readPos += done;
+  return done;
+}
+
+int64_t CBlockCacheStore::GetCachedEnd(SHandle *handle, int64_t position)
+{
+  CSingleLock lock(m_section);
+
+  int64_t end = position;
+  while (true)
+  {
+    int64_t previous = end;
+    if (end >= handle->runStart && end < handle->writePos)
+      end = handle->writePos;
+    end = GetValidEnd(handle->entry, end);
+    if (end == previous)
+      return end;
+  }
+}
+
+int64_t CBlockCacheStore::GetWriteSpace(SHandle *handle)
+{
+  CSingleLock lock(m_section);
+
+  // blocks between readers and their write positions can't be evicted, once
+  // they fill the budget read ahead has to wait for the readers
+  int64_t pinned = 0;
+  for (const auto &it : m_entries)
+  {
+    const SEntry *entry = it.second;
+    for (const SHandle *other : entry->handles)
+    {
+      if (other->writePos < other->readPos)
+        continue;
+      int64_t last = other->writePos / m_blockSize;
+      for (int64_t block = other->readPos / m_blockSize; block <= last; block++)
+      {
+        int64_t bytes = 0;
+        if (block < static_cast<int64_t>(entry->valid.size()))
+          bytes = std::max<int64_t>(0, GetBlockLength(entry, block) - entry->valid[block]);
+        // the block being written only counts once it is complete
+        if (block == last)
+          bytes = std::max(bytes, other->writePos - std::max(other->runStart, last * m_blockSize));
+        pinned += bytes;
+      }
+    }
+  }
+
+  int64_t space = static_cast<int64_t>(m_budget) - pinned;
+
+  // a reader that consumed everything must always get more, even when the
+  // budget is smaller than the blocks it touches
+  if (handle->readPos >= handle->writePos)
+    space = std::max<int64_t>(space, m_blockSize - handle->writePos % m_blockSize);
+  return std::max<int64_t>(0, space);
+}
+
+void CBlockCacheStore::Grow(SEntry *entry, int64_t length)
+{
+  // mappings are sized by the block length at the time they were created
+  UnmapAll(entry);
+  entry->length = length;
+  entry->valid.resize((length + m_blockSize - 1) / m_blockSize, m_blockSize);
+}
+
+bool CBlockCacheStore::IsCached(SHandle *handle, int64_t position)
+{
+  CSingleLock lock(m_section);
+
+  // only data that leads up to the write position can be read without the source
+  return position <= handle->writePos && GetCachedEnd(handle, position) >= handle->writePos;
+}
+
+int64_t CBlockCacheStore::GetBlockLength(const SEntry *entry, int64_t block) const
+{
+  return std::min<int64_t>(m_blockSize, entry->length - block * m_blockSize);
+}
+
+int64_t CBlockCacheStore::GetValidEnd(const SEntry *entry, int64_t position) const
+{
+  while (position < entry->length)
+  {
+    int64_t block = position / m_blockSize;
+    if (entry->valid[block] > position - block * m_blockSize)
+      break;
+    position = block * m_blockSize + GetBlockLength(entry, block);
+  }
+  return position;
+}
+
+void CBlockCacheStore::Validate(SEntry *entry, int64_t begin, int64_t end)
+{
+  for (int64_t block = begin / m_blockSize; block * m_blockSize < end; block++)
+  {
+    int64_t start = block * m_blockSize;
+    int64_t length = GetBlockLength(entry, block);
+    int64_t from = std::max(begin, start) - start;
+    int64_t to = std::min(end, start + length) - start;
+    int64_t valid = std::min<int64_t>(entry->valid[block], length);
+
+    // a block holds a single valid range that reaches up to its end
+    if ((to == length || to >= valid) && from < valid)
+    {
+      entry->used += valid - from;
+      m_stats.used += valid - from;
+      entry->valid[block] = static_cast<uint32_t>(from);
+    }
+    if (entry->valid[block] < length)
+      Touch(entry, block);
+  }
+}
+
+void CBlockCacheStore::Touch(SEntry *entry, int64_t block)
+{
+  auto key = std::make_pair(entry, block);
+  auto it = m_lruIndex.find(key);
+  if (it != m_lruIndex.end())
+    m_lru.splice(m_lru.end(), m_lru, it->second);
+  else
+    m_lruIndex[key] = m_lru.insert(m_lru.end(), key);
+}
+
+bool CBlockCacheStore::IsPinned(const SEntry *entry, int64_t block) const
+{
+  // never drop what a reader is about to consume
+  for (const SHandle *handle : entry->handles)
+  {
+    if (block >= handle->readPos / m_blockSize && block <= handle->writePos / m_blockSize)
+      return true;
+  }
+  return false;
+}
+
+void CBlockCacheStore::Evict()
+{
+  std::vector<SEntry*> closed;
+  auto it = m_lru.begin();
+  while (m_stats.used > m_budget && it != m_lru.end())
+  {
+    SEntry *entry = it->first;
+    int64_t block = it->second;
+    ++it;
+    if (IsPinned(entry, block))
+      continue;
+
+    if (entry->fd < 0)
+    {
+      if (!OpenData(entry, false))
+        continue;
+      closed.push_back(entry);
+    }
+    Invalidate(entry, block);
+  }
+
+  // closed entries have to be consistent on disk right away
+  for (SEntry *entry : closed)
+  {
+    CloseData(entry);
+    if (entry->used == 0 || !SaveIndex(entry))
+      RemoveEntry(entry);
+  }
+}
+
+void CBlockCacheStore::Invalidate(SEntry *entry, int64_t block)
+{
+  int64_t start = block * m_blockSize;
+  int64_t length = GetBlockLength(entry, block);
+  int64_t size = length - std::min<int64_t>(entry->valid[block], length);
+
+  for (auto it = entry->mappings.begin(); it != entry->mappings.end(); ++it)
+  {
+    if (it->block == block)
+    {
+      munmap(it->data, it->size);
+      entry->mappings.erase(it);
+      break;
+    }
+  }
+
+#if defined(TARGET_LINUX) || defined(TARGET_ANDROID)
+  // give the space back, elsewhere it's reclaimed once the whole file is dropped
+  fallocate(entry->fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, start, length);
+#endif
+
+  entry->valid[block] = m_blockSize;
+  entry->used -= size;
+  m_stats.used -= size;
+  m_stats.bytesEvicted += size;
+
+  auto it = m_lruIndex.find(std::make_pair(entry, block));
+  if (it != m_lruIndex.end())
+  {
+    m_lru.erase(it->second);
+    m_lruIndex.erase(it);
+  }
+
+  // readers can't rely on the data they fetched themselves any longer
+  for (SHandle *handle : entry->handles)
+  {
+    if (handle->runStart < start + length && handle->writePos > start)
+      handle->runStart = std::min(handle->writePos, start + length);
+  }
+}
+
+uint8_t* CBlockCacheStore::Map(SEntry *entry, int64_t block)
+{
+  for (auto it = entry->mappings.begin(); it != entry->mappings.end(); ++it)
+  {
+    if (it->block == block)
+    {
+      entry->mappings.splice(entry->mappings.begin(), entry->mappings, it);
+      return it->data;
+    }
+  }
+
+  SMapping mapping;
+  mapping.block = block;
+  mapping.size = static_cast<size_t>(GetBlockLength(entry, block));
+  void *data = mmap(NULL, mapping.size, PROT_READ, MAP_SHARED, entry->fd, block * m_blockSize);
+  if (data == MAP_FAILED)
+    return NULL;
+  mapping.data = static_cast<uint8_t*>(data);
+
+  if (entry->mappings.size() >= MAX_MAPPINGS)
+  {
+    munmap(entry->mappings.back().data, entry->mappings.back().size);
+    entry->mappings.pop_back();
+  }
+  entry->mappings.push_front(mapping);
+  return mapping.data;
+}
+
+void CBlockCacheStore::UnmapAll(SEntry *entry)
+{
+  for (const auto &mapping : entry->mappings)
+    munmap(mapping.data, mapping.size);
+  entry->mappings.clear();
+}
+
+bool CBlockCacheStore::OpenData(SEntry *entry, bool create)
+{
+  std::string path = GetPath(entry, ".blk");
+  entry->fd = open(path.c_str(), O_RDWR | O_CLOEXEC | (create ? O_CREAT : 0), 0644);
+  if (entry->fd < 0)
+  {
+    CLog::Log(LOGERROR, "CBlockCacheStore - unable to open %s (%s)", path.c_str(), strerror(errno));
+    return false;
+  }
+
+  // sparse, blocks only take up space once written
+  struct stat st;
+  if (fstat(entry->fd, &st) != 0 || (st.st_size != entry->length && ftruncate(entry->fd, entry->length) != 0))
+  {
+    CLog::Log(LOGERROR, "CBlockCacheStore - unable to size %s (%s)", path.c_str(), strerror(errno));
+    CloseData(entry);
+    return false;
+  }
+  return true;
+}
+
+void CBlockCacheStore::CloseData(SEntry *entry)
+{
+  if (entry->fd >= 0)
+    close(entry->fd);
+  entry->fd = -1;
+}
+
+void CBlockCacheStore::RemoveEntry(SEntry *entry)
+{
+  for (int64_t block = 0; block < static_cast<int64_t>(entry->valid.size()); block++)
+  {
+    auto it = m_lruIndex.find(std::make_pair(entry, block));
+    if (it != m_lruIndex.end())
+    {
+      m_lru.erase(it->second);
+      m_lruIndex.erase(it);
+    }
+  }
+  m_stats.used -= entry->used;
+
+  UnmapAll(entry);
+  CloseData(entry);
+  unlink(GetPath(entry, ".idx").c_str());
+  unlink(GetPath(entry, ".blk").c_str());
+
+  m_entries.erase(entry->name);
+  delete entry;
+}
+
+bool CBlockCacheStore::LoadIndex(const std::string &name)
+{
+  FILE *file = fopen((m_path + name + ".idx").c_str(), "rb");
+  if (!file)
+    return false;
+
+  char magic[4];
+  uint32_t version, blockSize, urlLength, versionLength, count;
+  int64_t length;
+  bool ok = fread(magic, sizeof(magic), 1, file) == 1 &&
+            memcmp(magic, INDEX_MAGIC, sizeof(magic)) == 0 &&
+            fread(&version, sizeof(version), 1, file) == 1 && version == INDEX_VERSION &&
+            fread(&blockSize, sizeof(blockSize), 1, file) == 1 && blockSize == m_blockSize &&
+            fread(&length, sizeof(length), 1, file) == 1 && length > 0 &&
+            fread(&urlLength, sizeof(urlLength), 1, file) == 1 && urlLength < 65536;
+
+  std::string url(ok ? urlLength : 0, '\0');
+  ok = ok && (urlLength == 0 || fread(&url[0], urlLength, 1, file) == 1) &&
+       fread(&versionLength, sizeof(versionLength), 1, file) == 1 && versionLength > 0 && versionLength < 1024;
+
+  std::string sourceVersion(ok ? versionLength : 0, '\0');
+  ok = ok && fread(&sourceVersion[0], versionLength, 1, file) == 1 &&
+       fread(&count, sizeof(count), 1, file) == 1 &&
+       count == static_cast<uint32_t>((length + m_blockSize - 1) / m_blockSize);
+
+  std::vector<uint32_t> valid(ok ? count : 0);
+  ok = ok && fread(valid.data(), sizeof(uint32_t), count, file) == count;
+  fclose(file);
+
+  struct stat st;
+  if (!ok || stat((m_path + name + ".blk").c_str(), &st) != 0 || st.st_size != length)
+    return false;
+
+  SEntry *entry = new SEntry;
+  entry->url = url;
+  entry->name = name;
+  entry->version = sourceVersion;
+  entry->length = length;
+  entry->fd = -1;
+  entry->used = 0;
+  entry->valid.swap(valid);
+  m_entries[name] = entry;
+
+  for (int64_t block = 0; block < static_cast<int64_t>(count); block++)
+  {
+    int64_t blockLength = GetBlockLength(entry, block);
+    if (entry->valid[block] >= blockLength)
+      entry->valid[block] = m_blockSize;
+    else
+    {
+      entry->used += blockLength - entry->valid[block];
+      Touch(entry, block);
+    }
+  }
+  m_stats.used += entry->used;
+
+  if (entry->used == 0)
+    RemoveEntry(entry);
+  return true;
+}
+
+bool CBlockCacheStore::SaveIndex(SEntry *entry)
+{
+  std::string path = GetPath(entry, ".idx");
+  std::string temp = path + ".tmp";
+  FILE *file = fopen(temp.c_str(), "wb");
+  if (!file)
+    return false;
+
+  uint32_t blockSize = m_blockSize;
+  uint32_t urlLength = entry->url.size();
+  uint32_t versionLength = entry->version.size();
+  uint32_t count = entry->valid.size();
+  bool ok = fwrite(INDEX_MAGIC, sizeof(INDEX_MAGIC), 1, file) == 1 &&
+            fwrite(&INDEX_VERSION, sizeof(INDEX_VERSION), 1, file) == 1 &&
+            fwrite(&blockSize, sizeof(blockSize), 1, file) == 1 &&
+            fwrite(&entry->length, sizeof(entry->length), 1, file) == 1 &&
+            fwrite(&urlLength, sizeof(urlLength), 1, file) == 1 &&
+            fwrite(entry->url.data(), urlLength, 1, file) == 1 &&
+            fwrite(&versionLength, sizeof(versionLength), 1, file) == 1 &&
+            fwrite(entry->version.data(), versionLength, 1, file) == 1 &&
+            fwrite(&count, sizeof(count), 1, file) == 1 &&
+            fwrite(entry->valid.data(), sizeof(uint32_t), count, file) == count;
+  ok = (fclose(file) == 0) && ok;
+
+  // replace in one go so a crash leaves either the old or the new index
+  if (!ok || rename(temp.c_str(), path.c_str()) != 0)
+  {
+    CLog::Log(LOGERROR, "CBlockCacheStore - unable to write %s", path.c_str());
+    unlink(temp.c_str());
+    return false;
+  }
+  return true;
+}
+
+
+CBlockCache::CBlockCache(CBlockCacheStore &store, const std::string &url, int64_t length, const std::string &version)
+  : m_store(store)
+  , m_url(url)
+  , m_length(length)
+  , m_version(version)
+  , m_handle(NULL)
+{
+}
+
+CBlockCache::~CBlockCache()
+{
+  Close();
+}
+
+int CBlockCache::Open()
+{
+  Close();
+
+  m_handle = m_store.OpenHandle(m_url, m_length, m_version);
+  if (!m_handle)
+  {
+    CLog::Log(LOGERROR, "CBlockCache::Open - unable to cache %s", CURL::GetRedacted(m_url).c_str());
+    return CACHE_RC_ERROR;
+  }
+  return CACHE_RC_OK;
+}
+
+void CBlockCache::Close()
+{
+  if (!m_handle)
+    return;
+
+  m_store.CloseHandle(m_handle);
+  m_handle = NULL;
+
+  SBlockCacheStats stats;
+  m_store.GetStats(stats);
+  CLog::Log(LOGDEBUG, "CBlockCache::Close - seeks hit/missed %" PRIu64"/%" PRIu64", bytes hit/fetched/evicted %" PRIu64"/%" PRIu64"/%" PRIu64", used %" PRIu64" of %" PRIu64,
+            stats.seekHits, stats.seekMisses, stats.bytesHit, stats.bytesFetched, stats.bytesEvicted, stats.used, stats.budget);
+}
+
+size_t CBlockCache::GetMaxWriteSize(const size_t& iRequestSize)
+{
+  return static_cast<size_t>(std::min<int64_t>(iRequestSize, m_store.GetWriteSpace(m_handle)));
+}
+
+int CBlockCache::WriteToCache(const char *pBuffer, size_t iSize)
+{
+  return m_store.Write(m_handle, pBuffer, iSize);
+}
+
+int64_t CBlockCache::GetAvailableRead()
+{
+  return std::max<int64_t>(0, m_store.GetCachedEnd(m_handle, m_handle->readPos) - m_handle->readPos);
+}
+
+int CBlockCache::ReadFromCache(char *pBuffer, size_t iMaxSize)
+{
+  int readBytes = m_store.Read(m_handle, pBuffer, iMaxSize);
+  if (readBytes <= 0)
+    return m_bEndOfInput ? 0 : CACHE_RC_WOULD_BLOCK;
+
+  m_space.Set();
+  return readBytes;
+}
+
+int64_t CBlockCache::WaitForData(unsigned int iMinAvail, unsigned int iMillis)
+{
+  if (iMillis == 0 || IsEndOfInput())
+    return GetAvailableRead();
+
+  XbmcThreads::EndTime endTime(iMillis);
+  while (!IsEndOfInput())
+  {
+    int64_t iAvail = GetAvailableRead();
+    if (iAvail >= iMinAvail)
+      return iAvail;
+
+    if (!m_handle->written.WaitMSec(endTime.MillisLeft()))
+      return CACHE_RC_TIMEOUT;
+  }
+  return GetAvailableRead();
+}
+
+int64_t CBlockCache::Seek(int64_t iFilePosition)
+{
+  // if seek is a bit over what we have, wait for the data instead of seeking the source
+  int64_t writePos = CachedDataEndPos();
+  if (iFilePosition > writePos && iFilePosition < writePos + 100000 && IsCachedPosition(m_handle->readPos))
+  {
+    WaitForData(static_cast<unsigned int>(iFilePosition - m_handle->readPos), 5000);
+  }
+
+  if (!IsCachedPosition(iFilePosition))
+    return CACHE_RC_ERROR;
+
+  CSingleLock lock(m_store.m_section);
+  m_handle->readPos = iFilePosition;
+  m_space.Set();
+  return iFilePosition;
+}
+
+bool CBlockCache::Reset(int64_t iSourcePosition, bool clearAnyway)
+{
+  // cached data stays valid as long as the source doesn't change, so there
+  // is nothing to clear
+  return m_store.ResetHandle(m_handle, iSourcePosition);
+}
+
+void CBlockCache::EndOfInput()
+{
+  CCacheStrategy::EndOfInput();
+  m_handle->written.Set();
+}
+
+int64_t CBlockCache::CachedDataEndPosIfSeekTo(int64_t iFilePosition)
+{
+  return m_store.GetCachedEnd(m_handle, iFilePosition);
+}
+
+int64_t CBlockCache::CachedDataEndPos()
+{
+  CSingleLock lock(m_store.m_section);
+  return m_handle->writePos;
+}
+
+bool CBlockCache::IsCachedPosition(int64_t iFilePosition)
+{
+  return m_store.IsCached(m_handle, iFilePosition);
+}
+
+CCacheStrategy *CBlockCache::CreateNew()
+{
+  return new CBlockCache(m_store, m_url, m_length, m_version);
+}
+
+std::string CBlockCache::GetVersion(CFile &source)
+{
+  CCurlFile *curl = dynamic_cast<CCurlFile*>(source.GetImplemenation());
+  if (curl)
+  {
+    const CHttpHeader &header = curl->GetHttpHeader();
+    std::string etag = header.GetValue("etag");
+    // weak validators don't promise identical bytes
+    if (!etag.empty() && !StringUtils::StartsWith(etag, "W/"))
+      return "etag:" + etag;
+    std::string modified = header.GetValue("last-modified");
+    if (!modified.empty())
+      return "modified:" + modified;
+    return "";
+  }
+
+  struct __stat64 st;
+  if (source.Stat(&st) == 0 && st.st_mtime != 0)
+    return StringUtils::Format("mtime:%lld", static_cast<long long>(st.st_mtime));
+  return "";
+}
+
+#endif
@@ -0,0 +1,209 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "CacheStrategy.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace XFILE {
+
+class CBlockCache;
+class CFile;
+
+struct SBlockCacheStats
+{
+  uint64_t seekHits;     //!< seeks that landed in cached data
+  uint64_t seekMisses;   //!< seeks that had to go to the source
+  uint64_t bytesHit;     //!< bytes read that were cached by an earlier read
+  uint64_t bytesFetched; //!< bytes written from the source
+  uint64_t bytesEvicted; //!< bytes dropped to stay within the budget
+  uint64_t used;         //!< bytes currently stored
+  uint64_t budget;       //!< maximum bytes to keep
+};
+
+/*!
+ \brief Disk backed store of file data, shared by all CBlockCache instances.
+
+ Every source gets a sparse data file, keyed by the hash of its URL, which
+ is divided into fixed size blocks. The store remembers which part of each
+ block holds valid data and evicts the least recently used blocks once the
+ budget is exceeded. The index is written next to the data file when the
+ last reader closes, so cached data survives a restart.
+
+ Entries are matched by URL, length and a version of the source, the ETag
+ or modification time. Data of a source whose version differs is dropped,
+ and data of a source without a version is kept for the current session
+ only.
+
+ Cached data is read through read only mappings of the data file. Data is
+ written with pwrite(), so running out of disk space shows up as a write
+ error instead of a fault on a mapped page.
+ */
+class CBlockCacheStore
+{
+public:
+  static const unsigned int DEFAULT_BLOCK_SIZE = 1024 * 1024;
+
+  CBlockCacheStore(const std::string &path, uint64_t budget, unsigned int blockSize = DEFAULT_BLOCK_SIZE);
+  ~CBlockCacheStore();
+
+  /*!
+   \brief The store configured by the <cache><blockstoresize> advanced setting.
+   */
+  static CBlockCacheStore& GetInstance();
+
+  bool IsEnabled() const { return m_budget > 0; }
+  uint64_t GetBudget() const { return m_budget; }
+  unsigned int GetBlockSize() const { return m_blockSize; }
+  void GetStats(SBlockCacheStats &stats);
+
+  /*!
+   \brief Whether files from this location are worth keeping, that is network file systems and http.
+   */
+  static bool IsCacheable(const std::string &url);
+
+private:
+  friend class CBlockCache;
+
+  struct SHandle;
+  struct SMapping
+  {
+    int64_t block;
+    uint8_t *data;
+    size_t size;
+  };
+  struct SEntry
+  {
+    std::string url;
+    std::string name;
+    std::string version;         // ETag or modification time of the source
+    int64_t length;
+    int fd;
+    int64_t used;                // valid bytes in the data file
+    std::vector<uint32_t> valid; // per block, offset from which on the block is valid
+    std::list<SHandle*> handles;
+    std::list<SMapping> mappings;
+  };
+  struct SHandle
+  {
+    SEntry *entry;
+    int64_t runStart; // data written since the last reset, [runStart, writePos)
+    int64_t writePos;
+    int64_t readPos;
+    CEvent written;
+  };
+  typedef std::list<std::pair<SEntry*, int64_t> > LruList;
+
+  SHandle* OpenHandle(const std::string &url, int64_t length, const std::string &version);
+  void CloseHandle(SHandle *handle);
+  bool ResetHandle(SHandle *handle, int64_t position);
+  int Write(SHandle *handle, const char *buffer, size_t size);
+  int Read(SHandle *handle, char *buffer, size_t size);
+  int64_t GetCachedEnd(SHandle *handle, int64_t position);
+  int64_t GetWriteSpace(SHandle *handle);
+  bool IsCached(SHandle *handle, int64_t position);
+
+  int64_t GetBlockLength(const SEntry *entry, int64_t block) const;
+  int64_t GetValidEnd(const SEntry *entry, int64_t position) const;
+  void Grow(SEntry *entry, int64_t length);
+  void Validate(SEntry *entry, int64_t begin, int64_t end);
+  void Touch(SEntry *entry, int64_t block);
+  void Evict();
+  bool IsPinned(const SEntry *entry, int64_t block) const;
+  void Invalidate(SEntry *entry, int64_t block);
+  uint8_t* Map(SEntry *entry, int64_t block);
+  void UnmapAll(SEntry *entry);
+  bool OpenData(SEntry *entry, bool create);
+  void CloseData(SEntry *entry);
+  void RemoveEntry(SEntry *entry);
+  bool LoadIndex(const std::string &name);
+  bool SaveIndex(SEntry *entry);
+  std::string GetPath(const SEntry *entry, const char *extension) const;
+
+  CCriticalSection m_section;
+  std::string m_path;
+  uint64_t m_budget;
+  unsigned int m_blockSize;
+  std::map<std::string, SEntry*> m_entries;
+  LruList m_lru;
+  std::map<std::pair<SEntry*, int64_t>, LruList::iterator> m_lruIndex;
+  SBlockCacheStats m_stats;
+};
+
+/*!
+ \brief Cache strategy backed by CBlockCacheStore.
+
+ Unlike the memory and temp file strategies the data stays in the store
+ after a seek or when the file is closed, so backward seeks and replays are
+ served without going back to the source.
+ */
+class CBlockCache : public CCacheStrategy
+{
+public:
+  /*!
+   \brief Cache the source at url.
+   \param version identifies the contents of the source, see GetVersion(). Data
+   cached with another version is dropped.
+   */
+  CBlockCache(CBlockCacheStore &store, const std::string &url, int64_t length, const std::string &version);
+  virtual ~CBlockCache();
+
+  virtual int Open();
+  virtual void Close();
+
+  virtual size_t GetMaxWriteSize(const size_t& iRequestSize);
+  virtual int WriteToCache(const char *pBuffer, size_t iSize);
+  virtual int ReadFromCache(char *pBuffer, size_t iMaxSize);
+  virtual int64_t WaitForData(unsigned int iMinAvail, unsigned int iMillis);
+
+  virtual int64_t Seek(int64_t iFilePosition);
+  virtual bool Reset(int64_t iSourcePosition, bool clearAnyway=true);
+  virtual void EndOfInput();
+
+  virtual int64_t CachedDataEndPosIfSeekTo(int64_t iFilePosition);
+  virtual int64_t CachedDataEndPos();
+  virtual bool IsCachedPosition(int64_t iFilePosition);
+
+  virtual CCacheStrategy *CreateNew();
+
+  /*!
+   \brief Version of an opened source, its ETag, Last-Modified header or
+   modification time. Empty if the source doesn't tell.
+   */
+  static std::string GetVersion(CFile &source);
+
+protected:
+  int64_t GetAvailableRead();
+
+  CBlockCacheStore &m_store;
+  std::string m_url;
+  int64_t m_length;
+  std::string m_version;
+  CBlockCacheStore::SHandle *m_handle;
+};
+
+}
@@ -29,6 +29,7 @@
 #include "threads/SystemClock.h"
 #include "utils/Base64.h"
 
+#include <algorithm>
 #include <vector>
 #include <climits>
 #include <cassert>
@@ -66,6 +67,9 @@ curl_proxytype proxyType2CUrlProxyType[] = {
 #define FILLBUFFER_NO_DATA    1
 #define FILLBUFFER_FAIL       2
 
+// bytes fetched by each request when the file is fetched over several connections
+#define SEGMENT_SIZE          (1024 * 1024)
+
 // curl calls this routine to debug
 extern "C" int debug_callback(CURL_HANDLE *handle, curl_infotype info, char *output, size_t size, void *data)
 {
@@ -130,6 +134,23 @@ extern "C" size_t header_callback(void *ptr, size_t size, size_t nmemb, void *st
   return state->HeaderCallback(ptr, size, nmemb);
 }
 
+extern "C" size_t segment_write_callback(char *buffer,
+               size_t size,
+               size_t nitems,
+               void *userp)
+{
+  if(userp == NULL) return 0;
+
+  CCurlFile::CReadState::SSegment *segment = (CCurlFile::CReadState::SSegment *)userp;
+  return segment->WriteCallback(buffer, size, nitems);
+}
+
+extern "C" size_t segment_header_callback(void *ptr, size_t size, size_t nmemb, void *stream)
+{
+  CCurlFile::CReadState::SSegment *segment = (CCurlFile::CReadState::SSegment *)stream;
+  return segment->HeaderCallback(ptr, size, nmemb);
+}
+
 /* used only by CCurlFile::Stat to bail out of unwanted transfers */
 extern "C" int transfer_abort_callback(void *clientp,
                curl_off_t dltotal,
@@ -249,6 +270,49 @@ size_t CCurlFile::CReadState::WriteCallback(char *buffer, size_t size, size_t ni
   return size * nitems;
 }
 
+size_t CCurlFile::CReadState::SSegment::HeaderCallback(void *ptr, size_t size, size_t nmemb)
+{
+  std::string inString;
+  const char* strBuf = (const char*)ptr;
+  const size_t iSize = size * nmemb;
+  if (strBuf[iSize - 1] == 0)
+    inString.assign(strBuf, iSize - 1);
+  else
+    inString.append(strBuf, iSize);
+
+  m_httpheader.Parse(inString);
+
+  return iSize;
+}
+
+size_t CCurlFile::CReadState::SSegment::WriteCallback(char *buffer, size_t size, size_t nitems)
+{
+  size_t amount = size * nitems;
+
+  if (!m_checked)
+  {
+    // a server that ignores the range sends the whole file, that must not end up in the stream
+    long response = 0;
+    g_curlInterface.easy_getinfo(m_easyHandle, CURLINFO_RESPONSE_CODE, &response);
+    std::string contentRange = m_httpheader.GetValue("Content-Range");
+    if (response != 206 ||
+        (contentRange != HttpRangeUtils::GenerateContentRangeHeaderValue(m_requestStart, m_range.GetLastPosition(), m_fileSize) &&
+         contentRange != HttpRangeUtils::GenerateContentRangeHeaderValue(m_requestStart, m_range.GetLastPosition(), 0)))
+    {
+      CLog::Log(LOGWARNING, "CCurlFile::SSegment::WriteCallback - unexpected response %ld (%s) for range %" PRIu64"-%" PRIu64,
+                response, contentRange.c_str(), m_requestStart, m_range.GetLastPosition());
+      return 0;
+    }
+    m_checked = true;
+  }
+
+  if (m_data.size() + amount > m_range.GetLength())
+    return 0;
+
+  m_data.insert(m_data.end(), buffer, buffer + amount);
+  return amount;
+}
+
 CCurlFile::CReadState::CReadState()
 {
   m_easyHandle = NULL;
@@ -268,6 +332,8 @@ CCurlFile::CReadState::CReadState()
   m_bRetry = true;
   m_curlHeaderList = NULL;
   m_curlAliasList = NULL;
+  m_segmentSize = 0;
+  m_segmentPos = 0;
 }
 
 CCurlFile::CReadState::~CReadState()
@@ -381,6 +447,8 @@ long CCurlFile::CReadState::Connect(unsigned int size)
 
 void CCurlFile::CReadState::Disconnect()
 {
+  StopSegments();
+
   if(m_multiHandle && m_easyHandle)
     g_curlInterface.multi_remove_handle(m_multiHandle, m_easyHandle);
 
@@ -444,6 +512,7 @@ CCurlFile::CCurlFile()
   m_httpresponse = -1;
   m_acceptCharset = "UTF-8,*;q=0.8"; /* prefer UTF-8 if available */
   m_allowRetry = true;
+  m_segmentCount = 1;
 }
 
 //Has to be called before Open()
@@ -780,6 +849,8 @@ void CCurlFile::ParseAndCorrectUrl(CURL &url2)
                 proxyType2CUrlProxyType[m_proxytype]);
     }
 
+    m_segmentCount = g_advancedSettings.m_curlSegments;
+
     // get username and password
     m_username = url2.GetUserName();
     m_password = url2.GetPassWord();
@@ -815,6 +886,8 @@ void CCurlFile::ParseAndCorrectUrl(CURL &url2)
           m_skipshout = true;
         else if (name == "seekable" && value == "0")
           m_seekable = false;
+        else if (name == "segments")
+          m_segmentCount = std::max(1, std::min(16, atoi(value.c_str())));
         else if (name == "accept-charset")
           SetAcceptCharset(value);
         else if (name == "sslcipherlist")
@@ -1087,6 +1160,10 @@ bool CCurlFile::Open(const CURL& url)
     m_url = efurl;
   }
 
+  // fetch ranges over several connections where a single one can't keep up
+  if (m_seekable && m_multisession && m_state->StartSegments(m_url, m_segmentCount, SEGMENT_SIZE))
+    CLog::Log(LOGDEBUG, "CCurlFile::Open - fetching %u ranges in parallel", m_segmentCount);
+
   return true;
 }
 
@@ -1355,6 +1432,9 @@ int64_t CCurlFile::Seek(int64_t iFilePosition, int iWhence)
 
   SetCorrectHeaders(m_state);
 
+  if (m_multisession)
+    m_state->StartSegments(m_url, m_segmentCount, SEGMENT_SIZE);
+
   return m_state->m_filePos;
 }
 
@@ -1533,13 +1613,103 @@ ssize_t CCurlFile::CReadState::Read(void* lpBuf, size_t uiBufSize)
   return 0;
 }
 
-/* use to attempt to fill the read buffer up to requested number of bytes */
-int8_t CCurlFile::CReadState::FillBuffer(unsigned int want)
+/* wait for activity on the transfers of a multi handle, false on socket errors */
+static bool WaitForTransfers(CURLM* multiHandle)
 {
-  int retry = 0;
   fd_set fdread;
   fd_set fdwrite;
   fd_set fdexcep;
+  int maxfd = -1;
+  FD_ZERO(&fdread);
+  FD_ZERO(&fdwrite);
+  FD_ZERO(&fdexcep);
+
+  // get file descriptors from the transfers
+  g_curlInterface.multi_fdset(multiHandle, &fdread, &fdwrite, &fdexcep, &maxfd);
+
+  long timeout = 0;
+  if (CURLM_OK != g_curlInterface.multi_timeout(multiHandle, &timeout) || timeout == -1 || timeout < 200)
+    timeout = 200;
+
+  XbmcThreads::EndTime endTime(timeout);
+  int rc;
+
+  do
+  {
+    /* On success the value of maxfd is guaranteed to be >= -1. We call
+     * select(maxfd + 1, ...); specially in case of (maxfd == -1) there are
+     * no fds ready yet so we call select(0, ...) --or Sleep() on Windows--
+     * to sleep 100ms, which is the minimum suggested value in the
+     * curl_multi_fdset() doc.
+     */
+    if (maxfd == -1)
+    {
+#ifdef TARGET_WINDOWS
+      /* Windows does not support using select() for sleeping without a dummy
+       * socket. Instead use Windows' Sleep() and sleep for 100ms which is the
+       * minimum suggested value in the curl_multi_fdset() doc.
+       */
+      Sleep(100);
+      rc = 0;
+#else
+      /* Portable sleep for platforms other than Windows. */
+      struct timeval wait = { 0, 100 * 1000 }; /* 100ms */
+      rc = select(0, NULL, NULL, NULL, &wait);
+#endif
+    }
+    else
+    {
+      unsigned int time_left = endTime.MillisLeft();
+      struct timeval wait = { (int)time_left / 1000, ((int)time_left % 1000) * 1000 };
+      rc = select(maxfd + 1, &fdread, &fdwrite, &fdexcep, &wait);
+    }
+#ifdef TARGET_WINDOWS
+  } while(rc == SOCKET_ERROR && WSAGetLastError() == WSAEINTR);
+#else
+  } while(rc == SOCKET_ERROR && errno == EINTR);
+#endif
+
+  if(rc == SOCKET_ERROR)
+  {
+#ifdef TARGET_WINDOWS
+    char buf[256];
+    strerror_s(buf, 256, WSAGetLastError());
+    CLog::Log(LOGERROR, "CCurlFile::FillBuffer - Failed with socket error:%s", buf);
+#else
+    char const * str = strerror(errno);
+    CLog::Log(LOGERROR, "CCurlFile::FillBuffer - Failed with socket error:%s", str);
+#endif
+
+    return false;
+  }
+  return true;
+}
+
+/* move what is left in the overflow buffer to the ring buffer, false if there was nothing */
+bool CCurlFile::CReadState::FlushOverflow()
+{
+  if (!m_overflowSize)
+    return false;
+
+  unsigned amount = XMIN((unsigned int)m_buffer.getMaxWriteSize(), m_overflowSize);
+  m_buffer.WriteData(m_overflowBuffer, amount);
+
+  if (amount < m_overflowSize)
+    memmove(m_overflowBuffer, m_overflowBuffer + amount, m_overflowSize - amount);
+
+  m_overflowSize -= amount;
+  // Shrink memory:
+  m_overflowBuffer = (char*)realloc_simple(m_overflowBuffer, m_overflowSize);
+  return true;
+}
+
+/* use to attempt to fill the read buffer up to requested number of bytes */
+int8_t CCurlFile::CReadState::FillBuffer(unsigned int want)
+{
+  if (!m_segments.empty())
+    return FillBufferFromSegments(want);
+
+  int retry = 0;
 
   // only attempt to fill buffer if transactions still running and buffer
   // doesnt exceed required size already
@@ -1549,19 +1719,8 @@ int8_t CCurlFile::CReadState::FillBuffer(unsigned int want)
       return FILLBUFFER_NO_DATA;
 
     /* if there is data in overflow buffer, try to use that first */
-    if (m_overflowSize)
-    {
-      unsigned amount = XMIN((unsigned int)m_buffer.getMaxWriteSize(), m_overflowSize);
-      m_buffer.WriteData(m_overflowBuffer, amount);
-
-      if (amount < m_overflowSize)
-        memmove(m_overflowBuffer, m_overflowBuffer + amount, m_overflowSize - amount);
-
-      m_overflowSize -= amount;
-      // Shrink memory:
-      m_overflowBuffer = (char*)realloc_simple(m_overflowBuffer, m_overflowSize);
+    if (FlushOverflow())
       continue;
-    }
 
     CURLMcode result = g_curlInterface.multi_perform(m_multiHandle, &m_stillRunning);
     if (!m_stillRunning)
@@ -1673,69 +1832,8 @@ int8_t CCurlFile::CReadState::FillBuffer(unsigned int want)
     {
       case CURLM_OK:
       {
-        int maxfd = -1;
-        FD_ZERO(&fdread);
-        FD_ZERO(&fdwrite);
-        FD_ZERO(&fdexcep);
-
-        // get file descriptors from the transfers
-        g_curlInterface.multi_fdset(m_multiHandle, &fdread, &fdwrite, &fdexcep, &maxfd);
-
-        long timeout = 0;
-        if (CURLM_OK != g_curlInterface.multi_timeout(m_multiHandle, &timeout) || timeout == -1 || timeout < 200)
-          timeout = 200;
-
-        XbmcThreads::EndTime endTime(timeout);
-        int rc;
-
-        do
-        {
-          /* On success the value of maxfd is guaranteed to be >= -1. We call
-           * select(maxfd + 1, ...); specially in case of (maxfd == -1) there are
-           * no fds ready yet so we call select(0, ...) --or Sleep() on Windows--
-           * to sleep 100ms, which is the minimum suggested value in the
-           * curl_multi_fdset() doc.
-           */
-          if (maxfd == -1)
-          {
-#ifdef TARGET_WINDOWS
-            /* Windows does not support using select() for sleeping without a dummy
-             * socket. Instead use Windows' Sleep() and sleep for 100ms which is the
-             * minimum suggested value in the curl_multi_fdset() doc.
-             */
-            Sleep(100);
-            rc = 0;
-#else
-            /* Portable sleep for platforms other than Windows. */
-            struct timeval wait = { 0, 100 * 1000 }; /* 100ms */
-            rc = select(0, NULL, NULL, NULL, &wait);
-#endif
-          }
-          else
-          {
-            unsigned int time_left = endTime.MillisLeft();
-            struct timeval wait = { (int)time_left / 1000, ((int)time_left % 1000) * 1000 };
-            rc = select(maxfd + 1, &fdread, &fdwrite, &fdexcep, &wait);
-          }
-#ifdef TARGET_WINDOWS
-        } while(rc == SOCKET_ERROR && WSAGetLastError() == WSAEINTR);
-#else
-        } while(rc == SOCKET_ERROR && errno == EINTR);
-#endif
-
-        if(rc == SOCKET_ERROR)
-        {
-#ifdef TARGET_WINDOWS
-          char buf[256];
-          strerror_s(buf, 256, WSAGetLastError());
-          CLog::Log(LOGERROR, "CCurlFile::FillBuffer - Failed with socket error:%s", buf);
-#else
-          char const * str = strerror(errno);
-          CLog::Log(LOGERROR, "CCurlFile::FillBuffer - Failed with socket error:%s", str);
-#endif
-
+        if (!WaitForTransfers(m_multiHandle))
           return FILLBUFFER_FAIL;
-        }
       }
       break;
       case CURLM_CALL_MULTI_PERFORM:
@@ -1757,6 +1855,202 @@ int8_t CCurlFile::CReadState::FillBuffer(unsigned int want)
   return FILLBUFFER_OK;
 }
 
+bool CCurlFile::CReadState::StartSegments(const std::string& url, unsigned int count, unsigned int segmentSize)
+{
+  // everything the single connection already received stays in front of the first segment
+  int64_t start = m_filePos + m_buffer.getMaxReadSize() + m_overflowSize;
+  if (count < 2 || m_fileSize <= 0 || m_fileSize - start <= segmentSize || !m_stillRunning)
+    return false;
+
+  g_curlInterface.multi_remove_handle(m_multiHandle, m_easyHandle);
+
+  m_segmentSize = segmentSize;
+  m_segmentPos = start;
+  for (unsigned int i = 0; i < count && m_segmentPos < m_fileSize; i++)
+  {
+    SSegment* segment = new SSegment;
+    g_curlInterface.easy_duplicate(m_easyHandle, NULL, &segment->m_easyHandle, NULL);
+    segment->m_fileSize = m_fileSize;
+    segment->m_running = false;
+
+    // the copy starts out with the options of the single connection, redirects are resolved already
+    g_curlInterface.easy_setopt(segment->m_easyHandle, CURLOPT_URL, url.c_str());
+    g_curlInterface.easy_setopt(segment->m_easyHandle, CURLOPT_WRITEDATA, segment);
+    g_curlInterface.easy_setopt(segment->m_easyHandle, CURLOPT_WRITEFUNCTION, segment_write_callback);
+    g_curlInterface.easy_setopt(segment->m_easyHandle, CURLOPT_WRITEHEADER, segment);
+    g_curlInterface.easy_setopt(segment->m_easyHandle, CURLOPT_HEADERFUNCTION, segment_header_callback);
+    g_curlInterface.easy_setopt(segment->m_easyHandle, CURLOPT_RESUME_FROM_LARGE, (curl_off_t)0);
+
+    segment->m_range.SetFirstPosition(m_segmentPos);
+    segment->m_range.SetLastPosition(XMIN(m_segmentPos + segmentSize, m_fileSize) - 1);
+    segment->m_data.reserve(segmentSize);
+    segment->m_consumed = 0;
+    segment->m_retries = 0;
+    m_segmentPos = segment->m_range.GetLastPosition() + 1;
+    m_segments.push_back(segment);
+
+    RequestSegment(segment);
+  }
+
+  m_stillRunning = 1;
+  return true;
+}
+
+void CCurlFile::CReadState::StopSegments()
+{
+  for (std::vector<SSegment*>::iterator it = m_segments.begin(); it != m_segments.end(); ++it)
+  {
+    SSegment* segment = *it;
+    if (segment->m_running)
+      g_curlInterface.multi_remove_handle(m_multiHandle, segment->m_easyHandle);
+    g_curlInterface.easy_release(&segment->m_easyHandle, NULL);
+    delete segment;
+  }
+  m_segments.clear();
+  m_segmentPos = 0;
+}
+
+void CCurlFile::CReadState::RequestSegment(SSegment* segment)
+{
+  // a retry only asks for what is still missing
+  segment->m_requestStart = segment->m_range.GetFirstPosition() + segment->m_data.size();
+  segment->m_checked = false;
+  segment->m_httpheader.Clear();
+
+  std::string range = StringUtils::Format("%" PRIu64"-%" PRIu64, segment->m_requestStart, segment->m_range.GetLastPosition());
+  g_curlInterface.easy_setopt(segment->m_easyHandle, CURLOPT_RANGE, range.c_str());
+  g_curlInterface.multi_add_handle(m_multiHandle, segment->m_easyHandle);
+  segment->m_running = true;
+}
+
+int8_t CCurlFile::CReadState::FillBufferFromSegments(unsigned int want)
+{
+  while ((unsigned int)m_buffer.getMaxReadSize() < want && m_buffer.getMaxWriteSize() > 0)
+  {
+    if (m_cancelled)
+      return FILLBUFFER_NO_DATA;
+
+    if (FlushOverflow())
+      continue;
+
+    if (m_segments.empty())
+    {
+      // the whole file has been passed on
+      m_stillRunning = 0;
+      return m_buffer.getMaxReadSize() ? FILLBUFFER_OK : FILLBUFFER_NO_DATA;
+    }
+
+    // only the first segment continues the stream, the others wait for their turn
+    SSegment* first = m_segments.front();
+    unsigned int amount = XMIN((unsigned int)m_buffer.getMaxWriteSize(), (unsigned int)(first->m_data.size() - first->m_consumed));
+    if (amount)
+    {
+      m_buffer.WriteData(&first->m_data[first->m_consumed], amount);
+      first->m_consumed += amount;
+      continue;
+    }
+
+    if (!first->m_running && first->m_consumed == first->m_range.GetLength())
+    {
+      // reuse the connection for the next range of the file
+      m_segments.erase(m_segments.begin());
+      if (m_segmentPos < m_fileSize)
+      {
+        first->m_range.SetFirstPosition(m_segmentPos);
+        first->m_range.SetLastPosition(XMIN(m_segmentPos + m_segmentSize, m_fileSize) - 1);
+        first->m_data.clear();
+        first->m_consumed = 0;
+        first->m_retries = 0;
+        m_segmentPos = first->m_range.GetLastPosition() + 1;
+        m_segments.push_back(first);
+        RequestSegment(first);
+      }
+      else
+      {
+        g_curlInterface.easy_release(&first->m_easyHandle, NULL);
+        delete first;
+      }
+      continue;
+    }
+
+    int running;
+    CURLMcode result = g_curlInterface.multi_perform(m_multiHandle, &running);
+
+    int msgs;
+    CURLMsg* msg;
+    while ((msg = g_curlInterface.multi_info_read(m_multiHandle, &msgs)))
+    {
+      if (msg->msg != CURLMSG_DONE)
+        continue;
+
+      SSegment* segment = NULL;
+      for (std::vector<SSegment*>::iterator it = m_segments.begin(); it != m_segments.end() && !segment; ++it)
+      {
+        if ((*it)->m_easyHandle == msg->easy_handle)
+          segment = *it;
+      }
+      if (!segment)
+        continue;
+
+      CURLcode code = msg->data.result;
+      g_curlInterface.multi_remove_handle(m_multiHandle, segment->m_easyHandle);
+      segment->m_running = false;
+      if (code == CURLE_OK && segment->m_data.size() == segment->m_range.GetLength())
+        continue;
+
+      CLog::Log(LOGWARNING, "CCurlFile::FillBuffer - Range %" PRIu64"-%" PRIu64" failed: %s(%d)",
+                segment->m_range.GetFirstPosition(), segment->m_range.GetLastPosition(), g_curlInterface.easy_strerror(code), code);
+
+      // a server that doesn't serve ranges won't start doing so on a retry
+      if (segment->m_checked && segment->m_retries < g_advancedSettings.m_curlretries)
+      {
+        segment->m_retries++;
+        RequestSegment(segment);
+        continue;
+      }
+      return FallBackFromSegments(want);
+    }
+
+    switch (result)
+    {
+      case CURLM_OK:
+      {
+        if (!WaitForTransfers(m_multiHandle))
+          return FILLBUFFER_FAIL;
+      }
+      break;
+      case CURLM_CALL_MULTI_PERFORM:
+        continue;
+      default:
+      {
+        CLog::Log(LOGERROR, "CCurlFile::FillBuffer - Multi perform failed with code %d, aborting", result);
+        return FILLBUFFER_FAIL;
+      }
+      break;
+    }
+  }
+  return FILLBUFFER_OK;
+}
+
+int8_t CCurlFile::CReadState::FallBackFromSegments(unsigned int want)
+{
+  CLog::Log(LOGWARNING, "CCurlFile::FillBuffer - Continuing at %" PRId64" over a single connection", m_filePos);
+
+  StopSegments();
+
+  // drop what is buffered and resume where the reader is, like a reconnect does
+  m_buffer.Clear();
+  free(m_overflowBuffer);
+  m_overflowBuffer = NULL;
+  m_overflowSize = 0;
+
+  SetResume();
+  g_curlInterface.multi_add_handle(m_multiHandle, m_easyHandle);
+  m_stillRunning = 1;
+
+  return FillBuffer(want);
+}
+
 void CCurlFile::CReadState::SetReadBuffer(const void* lpBuf, int64_t uiBufSize)
 {
   m_readBuffer = (char*)lpBuf;
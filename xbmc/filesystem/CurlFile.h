@@ -23,7 +23,9 @@
 #include "utils/RingBuffer.h"
 #include <map>
 #include <string>
+#include <vector>
 #include "utils/HttpHeader.h"
+#include "utils/HttpRangeUtils.h"
 
 namespace XCURL
 {
@@ -138,6 +140,28 @@ namespace XFILE
           struct XCURL::curl_slist* m_curlHeaderList;
           struct XCURL::curl_slist* m_curlAliasList;
 
+          /* a range of the file fetched over its own connection */
+          struct SSegment
+          {
+            XCURL::CURL_HANDLE* m_easyHandle;
+            CHttpRange        m_range;        // bytes of the file this segment covers
+            uint64_t          m_requestStart; // first byte asked for by the running request
+            int64_t           m_fileSize;
+            CHttpHeader       m_httpheader;
+            std::vector<char> m_data;         // bytes received so far
+            size_t            m_consumed;     // bytes already passed on to the ring buffer
+            bool              m_running;
+            bool              m_checked;      // response was verified to match the request
+            int               m_retries;
+
+            size_t WriteCallback(char *buffer, size_t size, size_t nitems);
+            size_t HeaderCallback(void *ptr, size_t size, size_t nmemb);
+          };
+
+          std::vector<SSegment*> m_segments;  // in file order, the first one feeds the ring buffer
+          unsigned int    m_segmentSize;
+          int64_t         m_segmentPos;       // first byte not requested by any segment yet
+
           size_t ReadCallback(char *buffer, size_t size, size_t nitems);
           size_t WriteCallback(char *buffer, size_t size, size_t nitems);
           size_t HeaderCallback(void *ptr, size_t size, size_t nmemb);
@@ -151,6 +175,20 @@ namespace XFILE
           void         SetResume(void);
           long         Connect(unsigned int size);
           void         Disconnect();
+
+          /*!
+           \brief Continue the transfer over several connections, each fetching
+           a range of segmentSize bytes. The ranges are passed on in file order.
+           \return false if the rest of the file is too small to be worth it
+           */
+          bool         StartSegments(const std::string& url, unsigned int count, unsigned int segmentSize);
+          void         StopSegments();
+
+      private:
+          bool         FlushOverflow();
+          int8_t       FillBufferFromSegments(unsigned int want);
+          void         RequestSegment(SSegment* segment);
+          int8_t       FallBackFromSegments(unsigned int want);
       };
 
     protected:
@@ -198,6 +236,7 @@ namespace XFILE
       bool            m_skipshout;
       bool            m_postdataset;
       bool            m_allowRetry;
+      unsigned int    m_segmentCount;     // number of parallel range requests, 1 disables them
 
       CRingBuffer     m_buffer;           // our ringhold buffer
       char *          m_overflowBuffer;   // in the rare case we would overflow the above buffer
@@ -198,8 +198,8 @@ bool CDirectory::GetDirectory(const CURL& url, CFileItemList &items, const CHint
         }
       }
 
-      // cache the directory, if necessary
-      if (!(hints.flags & DIR_FLAG_BYPASS_CACHE))
+      // cache the directory, if necessary. Paged listings are only valid for the caller that asked for them
+      if (!(hints.flags & DIR_FLAG_BYPASS_CACHE) && !items.GetPager())
         g_directoryCache.SetDirectory(realURL.Get(), items, pDirectory->GetCacheType(url));
     }
 
@@ -0,0 +1,206 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DirectoryChangeTracker.h"
+
+#ifdef HAVE_INOTIFY
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+#endif
+
+#include "filesystem/SpecialProtocol.h"
+#include "threads/SingleLock.h"
+#include "URL.h"
+#include "utils/log.h"
+#include "utils/URIUtils.h"
+
+#ifdef HAVE_INOTIFY
+// filesystems that don't report changes made by other hosts
+static const long NonLocalFilesystems[] = {
+  0x6969,             // NFS
+  0xFF534D42,         // CIFS
+  0x517B,             // SMB
+  0xFE534D42,         // SMB2
+  0x65735546,         // FUSE
+  0x73757245,         // CODA
+  0x564c,             // NCP
+};
+#endif
+
+using namespace XFILE;
+
+CDirectoryChangeTracker::CDirectoryChangeTracker()
+  : CThread("DirectoryChangeTracker"),
+    m_fd(-1)
+{
+}
+
+CDirectoryChangeTracker::~CDirectoryChangeTracker()
+{
+  Stop();
+}
+
+CDirectoryChangeTracker& CDirectoryChangeTracker::GetInstance()
+{
+  static CDirectoryChangeTracker sDirectoryChangeTracker;
+  return sDirectoryChangeTracker;
+}
+
+bool CDirectoryChangeTracker::IsLocal(const std::string &strDirectory, std::string &localPath)
+{
+#ifdef HAVE_INOTIFY
+  CURL url(strDirectory);
+  if (url.IsProtocol("special"))
+    url = CURL(CSpecialProtocol::TranslatePath(strDirectory));
+  if (!url.GetProtocol().empty() && !url.IsProtocol("file"))
+    return false;
+
+  localPath = url.GetFileName();
+  if (url.IsProtocol("file"))
+    localPath = "/" + localPath;
+  URIUtils::RemoveSlashAtEnd(localPath);
+  if (localPath.empty())
+    localPath = "/";
+
+  struct statfs buffer;
+  if (statfs(localPath.c_str(), &buffer) != 0)
+    return false;
+  for (long type : NonLocalFilesystems)
+  {
+    if (static_cast<long>(static_cast<uint32_t>(buffer.f_type)) == type)
+      return false;
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool CDirectoryChangeTracker::Watch(const std::string &strDirectory)
+{
+#ifdef HAVE_INOTIFY
+  CSingleLock lock(m_section);
+  if (m_watched.find(strDirectory) != m_watched.end())
+    return true;
+
+  std::string localPath;
+  if (!IsLocal(strDirectory, localPath))
+    return false;
+
+  if (m_fd < 0)
+  {
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd < 0)
+    {
+      CLog::Log(LOGERROR, "%s - inotify_init1 failed (%s)", __FUNCTION__, strerror(errno));
+      return false;
+    }
+    Create();
+  }
+
+  int wd = inotify_add_watch(m_fd, localPath.c_str(),
+                             IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB |
+                             IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+  if (wd < 0)
+  {
+    // most likely ENOSPC, the directory is compared by its fingerprint instead
+    CLog::Log(LOGDEBUG, "%s - unable to watch %s (%s)", __FUNCTION__, CURL::GetRedacted(strDirectory).c_str(), strerror(errno));
+    return false;
+  }
+
+  // a descriptor is reused if the same inode was watched under another name
+  auto previous = m_watches.find(wd);
+  if (previous != m_watches.end())
+    m_watched.erase(previous->second);
+  m_watches[wd] = strDirectory;
+  m_watched[strDirectory] = wd;
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool CDirectoryChangeTracker::TakeChanged(const std::string &strDirectory)
+{
+  CSingleLock lock(m_section);
+  return m_changed.erase(strDirectory) > 0;
+}
+
+void CDirectoryChangeTracker::Stop()
+{
+  StopThread();
+#ifdef HAVE_INOTIFY
+  CSingleLock lock(m_section);
+  if (m_fd >= 0)
+    close(m_fd);
+  m_fd = -1;
+  m_watches.clear();
+  m_watched.clear();
+  m_changed.clear();
+#endif
+}
+
+void CDirectoryChangeTracker::Process()
+{
+#ifdef HAVE_INOTIFY
+  char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+  while (!m_bStop)
+  {
+    struct pollfd pfd = { m_fd, POLLIN, 0 };
+    if (poll(&pfd, 1, 500) <= 0)
+      continue;
+
+    ssize_t length = read(m_fd, buffer, sizeof(buffer));
+    if (length <= 0)
+      continue;
+
+    CSingleLock lock(m_section);
+    for (char *ptr = buffer; ptr < buffer + length; )
+    {
+      const struct inotify_event *event = reinterpret_cast<const struct inotify_event*>(ptr);
+      ptr += sizeof(struct inotify_event) + event->len;
+
+      if (event->mask & IN_Q_OVERFLOW)
+      {
+        // events were lost, every watched directory has to be scanned again
+        for (const auto &watched : m_watched)
+          m_changed.insert(watched.first);
+        continue;
+      }
+
+      auto watch = m_watches.find(event->wd);
+      if (watch == m_watches.end())
+        continue;
+
+      m_changed.insert(watch->second);
+      if (event->mask & IN_IGNORED)
+      {
+        // the directory is gone or was moved away
+        m_watched.erase(watch->second);
+        m_watches.erase(watch);
+      }
+    }
+  }
+#endif
+}
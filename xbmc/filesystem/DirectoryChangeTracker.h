@@ -0,0 +1,76 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <set>
+#include <string>
+
+#include "threads/CriticalSection.h"
+#include "threads/Thread.h"
+
+namespace XFILE
+{
+  /*!
+   \brief Records changes to watched directories on local filesystems using inotify.
+
+   Used by the incremental library scans: a directory that has been watched
+   since it was last scanned only needs to be scanned again if a change was
+   recorded for it, which also catches files that are rewritten in place.
+   Watching is not available for directories on network filesystems, as
+   changes made by other hosts aren't reported there, nor on platforms
+   without inotify.
+   */
+  class CDirectoryChangeTracker : protected CThread
+  {
+  public:
+    static CDirectoryChangeTracker& GetInstance();
+
+    /*!
+     \brief Start watching a directory, subdirectories have to be watched on their own.
+     \return true if the directory is watched.
+     */
+    bool Watch(const std::string &strDirectory);
+
+    /*!
+     \brief Check whether a change was recorded for a watched directory since the last call.
+     */
+    bool TakeChanged(const std::string &strDirectory);
+
+    void Stop();
+
+  protected:
+    void Process() override;
+
+  private:
+    CDirectoryChangeTracker();
+    ~CDirectoryChangeTracker() override;
+    CDirectoryChangeTracker(const CDirectoryChangeTracker&) = delete;
+    CDirectoryChangeTracker& operator=(const CDirectoryChangeTracker&) = delete;
+
+    static bool IsLocal(const std::string &strDirectory, std::string &localPath);
+
+    CCriticalSection m_section;
+    int m_fd;
+    std::map<int, std::string> m_watches;   // watch descriptor -> directory
+    std::map<std::string, int> m_watched;   // directory -> watch descriptor
+    std::set<std::string> m_changed;
+  };
+}
@@ -25,6 +25,9 @@
 #include "URL.h"
 
 #include "CircularCache.h"
+#if defined(TARGET_POSIX)
+#include "BlockCache.h"
+#endif
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "settings/AdvancedSettings.h"
@@ -179,6 +182,18 @@ bool CFileCache::Open(const CURL& url)
 
   if (!m_pCache)
   {
+#if defined(TARGET_POSIX)
+    // keep network files around for seeking back and replays
+    if (m_seekPossible > 0 && m_fileSize > 0 && CBlockCacheStore::IsCacheable(m_sourcePath) &&
+        CBlockCacheStore::GetInstance().IsEnabled())
+    {
+      m_pCache = new CBlockCache(CBlockCacheStore::GetInstance(), m_sourcePath, m_fileSize,
+                                 CBlockCache::GetVersion(m_source));
+      // read ahead is limited by the budget of the store
+      m_forwardCacheSize = static_cast<size_t>(CBlockCacheStore::GetInstance().GetBudget());
+    }
+    else
+#endif
     if (g_advancedSettings.m_cacheMemSize == 0)
     {
       // Use cache on disk
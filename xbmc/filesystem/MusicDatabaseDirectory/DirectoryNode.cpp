@@ -52,6 +52,7 @@ CDirectoryNode::CDirectoryNode(NODE_TYPE Type, const std::string& strName, CDire
   m_Type=Type;
   m_strName=strName;
   m_pParent=pParent;
+  m_flags=0;
 }
 
 CDirectoryNode::~CDirectoryNode()
@@ -252,7 +253,7 @@ NODE_TYPE CDirectoryNode::GetChildType() const
 }
 
 //  Get the child fileitems of this node
-bool CDirectoryNode::GetChilds(CFileItemList& items)
+bool CDirectoryNode::GetChilds(CFileItemList& items, int flags /* = 0 */)
 {
   if (CanCache() && items.Load())
     return true;
@@ -263,10 +264,11 @@ bool CDirectoryNode::GetChilds(CFileItemList& items)
   if (pNode.get())
   {
     pNode->m_options = m_options;
+    pNode->m_flags = flags;
     bSuccess=pNode->GetContent(items);
     if (bSuccess)
     {
-      if (CanCache())
+      if (CanCache() && !items.GetPager())
         items.SetCacheToDisc(CFileItemList::CACHE_ALWAYS);
     }
     else
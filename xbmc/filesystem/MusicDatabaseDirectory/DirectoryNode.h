@@ -70,7 +70,11 @@ namespace XFILE
 
       NODE_TYPE GetType() const;
 
-      bool GetChilds(CFileItemList& items);
+      /*!
+       \brief Gets the items of the child node
+       \param flags the DIR_FLAG values of the directory request, passed on to GetContent()
+       */
+      bool GetChilds(CFileItemList& items, int flags = 0);
       virtual NODE_TYPE GetChildType() const;
       virtual std::string GetLocalizedName() const;
 
@@ -91,12 +95,14 @@ namespace XFILE
       void RemoveParent();
 
       virtual bool GetContent(CFileItemList& items) const;
+      int GetFlags() const { return m_flags; }
 
     private:
       NODE_TYPE m_Type;
       std::string m_strName;
       CDirectoryNode* m_pParent;
       CUrlOptions m_options;
+      int m_flags;
     };
   }
 }
@@ -20,6 +20,7 @@
 
 #include "DirectoryNodeSong.h"
 #include "QueryParams.h"
+#include "filesystem/IDirectory.h"
 #include "music/MusicDatabase.h"
 
 using namespace XFILE::MUSICDATABASEDIRECTORY;
@@ -40,7 +41,8 @@ bool CDirectoryNodeSong::GetContent(CFileItemList& items) const
   CollectQueryParams(params);
 
   std::string strBaseDir=BuildPath();
-  bool bSuccess=musicdatabase.GetSongsNav(strBaseDir, items, params.GetGenreId(), params.GetArtistId(), params.GetAlbumId());
+  bool bSuccess=musicdatabase.GetSongsNav(strBaseDir, items, params.GetGenreId(), params.GetArtistId(), params.GetAlbumId(),
+                                          SortDescription(), (GetFlags() & DIR_FLAG_PAGED) != 0);
 
   musicdatabase.Close();
 
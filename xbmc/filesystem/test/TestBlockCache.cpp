@@ -0,0 +1,301 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#if defined(TARGET_POSIX)
+
+#include "filesystem/BlockCache.h"
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace XFILE;
+
+namespace
+{
+const char *URL = "http://example.com/movie.mkv";
+const char *VERSION = "etag:\"1\"";
+const unsigned int BLOCK_SIZE = 4096;
+const int64_t LENGTH = 100000;
+
+char ByteAt(int64_t position)
+{
+  return static_cast<char>(position * 7 + position / 251);
+}
+
+// feeds the cache like CFileCache does after positioning the source
+void Fill(CBlockCache &cache, int64_t end)
+{
+  std::vector<char> buffer(3000);
+  for (int64_t pos = cache.CachedDataEndPos(); pos < end;)
+  {
+    int size = static_cast<int>(std::min<int64_t>(buffer.size(), end - pos));
+    ASSERT_LE(static_cast<size_t>(size), cache.GetMaxWriteSize(size)) << "at " << pos;
+    for (int i = 0; i < size; i++)
+      buffer[i] = ByteAt(pos + i);
+    ASSERT_EQ(size, cache.WriteToCache(buffer.data(), size));
+    pos += size;
+  }
+}
+
+void Verify(CBlockCache &cache, int64_t from, int64_t to)
+{
+  std::vector<char> buffer(5000);
+  for (int64_t pos = from; pos < to;)
+  {
+    int size = cache.ReadFromCache(buffer.data(), static_cast<size_t>(std::min<int64_t>(buffer.size(), to - pos)));
+    ASSERT_LT(0, size);
+    for (int i = 0; i < size; i++)
+      ASSERT_EQ(ByteAt(pos + i), buffer[i]) << "at " << pos + i;
+    pos += size;
+  }
+}
+}
+
+class TestBlockCache : public testing::Test
+{
+protected:
+  TestBlockCache()
+  {
+    char path[] = "/tmp/blockcacheXXXXXX";
+    m_path = mkdtemp(path);
+  }
+
+  ~TestBlockCache()
+  {
+    DIR *dir = opendir(m_path.c_str());
+    while (struct dirent *ent = readdir(dir))
+      unlink((m_path + "/" + ent->d_name).c_str());
+    closedir(dir);
+    rmdir(m_path.c_str());
+  }
+
+  std::string m_path;
+};
+
+TEST_F(TestBlockCache, WriteRead)
+{
+  CBlockCacheStore store(m_path, 1024 * 1024, BLOCK_SIZE);
+  CBlockCache cache(store, URL, LENGTH, VERSION);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+
+  EXPECT_TRUE(cache.Reset(0));
+  EXPECT_EQ(CACHE_RC_WOULD_BLOCK, cache.ReadFromCache(NULL, 1));
+  Fill(cache, 50000);
+  EXPECT_EQ(50000, cache.WaitForData(0, 0));
+  Verify(cache, 0, 50000);
+
+  // seeking back stays in the cache
+  EXPECT_TRUE(cache.IsCachedPosition(1000));
+  EXPECT_EQ(1000, cache.Seek(1000));
+  Verify(cache, 1000, 2000);
+  EXPECT_FALSE(cache.IsCachedPosition(80000));
+}
+
+TEST_F(TestBlockCache, Persistent)
+{
+  {
+    CBlockCacheStore store(m_path, 1024 * 1024, BLOCK_SIZE);
+    CBlockCache cache(store, URL, LENGTH, VERSION);
+    ASSERT_EQ(CACHE_RC_OK, cache.Open());
+    cache.Reset(0);
+    Fill(cache, LENGTH);
+    cache.Close();
+  }
+
+  // a new session finds the whole file without touching the source
+  CBlockCacheStore store(m_path, 1024 * 1024, BLOCK_SIZE);
+  SBlockCacheStats stats;
+  store.GetStats(stats);
+  EXPECT_EQ(static_cast<uint64_t>(LENGTH), stats.used);
+
+  CBlockCache cache(store, URL, LENGTH, VERSION);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+  EXPECT_EQ(LENGTH, cache.CachedDataEndPosIfSeekTo(20000));
+  EXPECT_FALSE(cache.Reset(20000, false));
+  EXPECT_EQ(LENGTH, cache.CachedDataEndPos());
+  Verify(cache, 20000, LENGTH);
+
+  store.GetStats(stats);
+  EXPECT_EQ(1u, stats.seekHits);
+  EXPECT_EQ(static_cast<uint64_t>(LENGTH - 20000), stats.bytesHit);
+  EXPECT_EQ(0u, stats.bytesFetched);
+  cache.Close();
+
+  // a different file behind the same url starts from scratch
+  CBlockCache changed(store, URL, LENGTH + 1, VERSION);
+  ASSERT_EQ(CACHE_RC_OK, changed.Open());
+  EXPECT_EQ(0, changed.CachedDataEndPosIfSeekTo(0));
+}
+
+TEST_F(TestBlockCache, Versions)
+{
+  {
+    CBlockCacheStore store(m_path, 1024 * 1024, BLOCK_SIZE);
+    CBlockCache cache(store, URL, LENGTH, VERSION);
+    ASSERT_EQ(CACHE_RC_OK, cache.Open());
+    cache.Reset(0);
+    Fill(cache, LENGTH);
+    cache.Close();
+  }
+
+  // the file was replaced by one of the same length
+  CBlockCacheStore store(m_path, 1024 * 1024, BLOCK_SIZE);
+  CBlockCache changed(store, URL, LENGTH, "etag:\"2\"");
+  ASSERT_EQ(CACHE_RC_OK, changed.Open());
+  EXPECT_EQ(0, changed.CachedDataEndPosIfSeekTo(0));
+  EXPECT_FALSE(changed.IsCachedPosition(LENGTH - 10));
+  changed.Close();
+
+  SBlockCacheStats stats;
+  store.GetStats(stats);
+  EXPECT_EQ(0u, stats.used);
+}
+
+TEST_F(TestBlockCache, Unversioned)
+{
+  {
+    CBlockCacheStore store(m_path, 1024 * 1024, BLOCK_SIZE);
+    CBlockCache cache(store, URL, LENGTH, "");
+    ASSERT_EQ(CACHE_RC_OK, cache.Open());
+    cache.Reset(0);
+    Fill(cache, LENGTH);
+    cache.Close();
+
+    // kept for replays within the session
+    CBlockCache replay(store, URL, LENGTH, "");
+    ASSERT_EQ(CACHE_RC_OK, replay.Open());
+    EXPECT_EQ(LENGTH, replay.CachedDataEndPosIfSeekTo(0));
+    replay.Close();
+  }
+
+  // but nothing tells whether it is still the same file after a restart
+  CBlockCacheStore store(m_path, 1024 * 1024, BLOCK_SIZE);
+  SBlockCacheStats stats;
+  store.GetStats(stats);
+  EXPECT_EQ(0u, stats.used);
+
+  CBlockCache cache(store, URL, LENGTH, "");
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+  EXPECT_EQ(0, cache.CachedDataEndPosIfSeekTo(0));
+}
+
+TEST_F(TestBlockCache, PartialBlocks)
+{
+  CBlockCacheStore store(m_path, 1024 * 1024, BLOCK_SIZE);
+  CBlockCache cache(store, URL, LENGTH, VERSION);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+
+  // start in the middle of a block
+  EXPECT_TRUE(cache.Reset(5000));
+  Fill(cache, 20000);
+  Verify(cache, 5000, 20000);
+
+  // fetching the start later fills the gap, the store keeps the complete
+  // blocks of the earlier run but not its unfinished last block
+  EXPECT_EQ(CACHE_RC_ERROR, cache.Seek(0));
+  EXPECT_EQ(0, cache.CachedDataEndPosIfSeekTo(0));
+  EXPECT_TRUE(cache.Reset(0));
+  Fill(cache, 5000);
+  EXPECT_EQ(4 * BLOCK_SIZE, cache.CachedDataEndPosIfSeekTo(0));
+  Verify(cache, 0, 4 * BLOCK_SIZE);
+}
+
+TEST_F(TestBlockCache, Eviction)
+{
+  CBlockCacheStore store(m_path, 4 * BLOCK_SIZE, BLOCK_SIZE);
+  CBlockCache cache(store, URL, LENGTH, VERSION);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+  cache.Reset(0);
+
+  // play through the file, the reader stays close to the writer
+  for (int64_t pos = 0; pos < LENGTH; pos += 10000)
+  {
+    Fill(cache, pos + 10000);
+    Verify(cache, pos, pos + 10000);
+  }
+
+  SBlockCacheStats stats;
+  store.GetStats(stats);
+  EXPECT_LE(stats.used, stats.budget);
+  EXPECT_LT(0u, stats.bytesEvicted);
+  EXPECT_EQ(stats.bytesFetched, stats.used + stats.bytesEvicted);
+
+  // the start is gone, the end is still there
+  EXPECT_EQ(0, cache.CachedDataEndPosIfSeekTo(0));
+  EXPECT_EQ(LENGTH, cache.CachedDataEndPosIfSeekTo(LENGTH - BLOCK_SIZE));
+  EXPECT_EQ(LENGTH - BLOCK_SIZE, cache.Seek(LENGTH - BLOCK_SIZE));
+  Verify(cache, LENGTH - BLOCK_SIZE, LENGTH);
+}
+
+TEST_F(TestBlockCache, Pinned)
+{
+  CBlockCacheStore store(m_path, 4 * BLOCK_SIZE, BLOCK_SIZE);
+  CBlockCache cache(store, URL, LENGTH, VERSION);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+  cache.Reset(0);
+
+  // read ahead stops once the data ahead of the reader fills the budget
+  std::vector<char> buffer(1000);
+  int64_t pos = 0;
+  while (size_t size = cache.GetMaxWriteSize(buffer.size()))
+  {
+    for (size_t i = 0; i < size; i++)
+      buffer[i] = ByteAt(pos + i);
+    ASSERT_EQ(static_cast<int>(size), cache.WriteToCache(buffer.data(), size));
+    pos += size;
+    ASSERT_LE(pos, 10 * BLOCK_SIZE);
+  }
+  EXPECT_EQ(4 * BLOCK_SIZE, cache.CachedDataEndPos());
+
+  SBlockCacheStats stats;
+  store.GetStats(stats);
+  EXPECT_EQ(stats.budget, stats.used);
+
+  // and goes on as the reader moves through the blocks
+  Verify(cache, 0, BLOCK_SIZE + 100);
+  EXPECT_EQ(static_cast<size_t>(BLOCK_SIZE), cache.GetMaxWriteSize(10 * BLOCK_SIZE));
+  Fill(cache, 5 * BLOCK_SIZE);
+  Verify(cache, BLOCK_SIZE + 100, 5 * BLOCK_SIZE);
+  store.GetStats(stats);
+  EXPECT_LE(stats.used, stats.budget);
+}
+
+TEST_F(TestBlockCache, Growing)
+{
+  CBlockCacheStore store(m_path, 1024 * 1024, BLOCK_SIZE);
+  CBlockCache cache(store, URL, LENGTH, VERSION);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+  cache.Reset(0);
+
+  // a recording in progress delivers more than its length at open
+  Fill(cache, LENGTH + 3 * BLOCK_SIZE + 10);
+  EXPECT_EQ(LENGTH + 3 * BLOCK_SIZE + 10, cache.CachedDataEndPos());
+  Verify(cache, 0, LENGTH + 3 * BLOCK_SIZE + 10);
+  EXPECT_TRUE(cache.IsCachedPosition(LENGTH - 10));
+  EXPECT_EQ(LENGTH - 10, cache.Seek(LENGTH - 10));
+  Verify(cache, LENGTH - 10, LENGTH + 3 * BLOCK_SIZE + 10);
+}
+
+#endif
@@ -81,3 +81,106 @@ void CGreedyDirtyRegionSolver::Solve(const CDirtyRegionList &input, CDirtyRegion
       output.push_back(currentRegion);
   }
 }
+
+namespace
+{
+bool CoveredBy(const CDirtyRegionList &regions, const CDirtyRegionList &cover)
+{
+  for (unsigned int i = 0; i < regions.size(); i++)
+  {
+    bool covered = false;
+    for (unsigned int j = 0; j < cover.size() && !covered; j++)
+      covered = cover[j].x1 <= regions[i].x1 && cover[j].y1 <= regions[i].y1 &&
+                cover[j].x2 >= regions[i].x2 && cover[j].y2 >= regions[i].y2;
+    if (!covered)
+      return false;
+  }
+  return true;
+}
+}
+
+CCostModelDirtyRegionSolver::CCostModelDirtyRegionSolver(float passCost)
+  : m_passCost(passCost),
+    m_decision("none")
+{
+}
+
+void CCostModelDirtyRegionSolver::Solve(const CDirtyRegionList &input, CDirtyRegionList &output)
+{
+  Solve(input, g_graphicsContext.GetViewWindow(), output);
+}
+
+float CCostModelDirtyRegionSolver::GetCost(const CDirtyRegionList &regions, const CRect &viewport) const
+{
+  float area = 0.0f;
+  for (unsigned int i = 0; i < regions.size(); i++)
+    area += regions[i].Area();
+  return area / viewport.Area() + m_passCost * regions.size();
+}
+
+void CCostModelDirtyRegionSolver::Solve(const CDirtyRegionList &input, const CRect &viewport, CDirtyRegionList &output)
+{
+  CDirtyRegionList regions;
+  for (unsigned int i = 0; i < input.size(); i++)
+  {
+    CDirtyRegion region(input[i]);
+    region.Intersect(viewport);
+    if (!region.IsEmpty())
+      regions.push_back(region);
+  }
+
+  if (regions.empty() || viewport.IsEmpty())
+  {
+    m_previous.clear();
+    m_decision = "none";
+    return;
+  }
+
+  // merge the pair that saves the most until merging costs more than it saves
+  float viewportArea = viewport.Area();
+  while (regions.size() > 1)
+  {
+    float bestSaving = 0.0f;
+    unsigned int first = 0;
+    unsigned int second = 0;
+    for (unsigned int i = 0; i < regions.size(); i++)
+    {
+      for (unsigned int j = i + 1; j < regions.size(); j++)
+      {
+        CDirtyRegion merged(regions[i]);
+        merged.Union(regions[j]);
+        float saving = m_passCost - (merged.Area() - regions[i].Area() - regions[j].Area()) / viewportArea;
+        if (saving > bestSaving)
+        {
+          bestSaving = saving;
+          first = i;
+          second = j;
+        }
+      }
+    }
+    if (bestSaving <= 0.0f)
+      break;
+
+    regions[first].Union(regions[second]);
+    regions.erase(regions.begin() + second);
+  }
+  m_decision = regions.size() > 1 ? "split" : "merged";
+
+  float cost = GetCost(regions, viewport);
+  if (cost >= 1.0f + m_passCost)
+  {
+    regions.assign(1, CDirtyRegion(viewport));
+    cost = 1.0f + m_passCost;
+    m_decision = "viewport";
+  }
+
+  if (!m_previous.empty() && CoveredBy(regions, m_previous) &&
+      GetCost(m_previous, viewport) <= cost + m_passCost * 0.5f)
+  {
+    regions = m_previous;
+    m_decision = "kept";
+  }
+
+  m_previous = regions;
+  output.insert(output.end(), regions.begin(), regions.end());
+}
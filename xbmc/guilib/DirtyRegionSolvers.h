@@ -48,3 +48,28 @@ private:
   float m_costNewRegion;
   float m_costPerArea;
 };
+
+/*!
+ \brief Merges dirty regions while that is cheaper than rendering them in separate passes.
+
+ Costs are in units of filling the whole viewport. Every pass costs passCost on
+ top of the area it fills, as the whole gui is walked for each of them. Regions
+ are merged pairwise, cheapest merge first, until no merge lowers the total
+ cost. As the tracker keeps regions dirty for a few frames, the solution of the
+ previous frame is kept while it covers all regions and isn't notably more
+ expensive, so the passes don't jump around from frame to frame.
+ */
+class CCostModelDirtyRegionSolver : public IDirtyRegionSolver
+{
+public:
+  CCostModelDirtyRegionSolver(float passCost = 0.125f);
+  virtual void Solve(const CDirtyRegionList &input, CDirtyRegionList &output);
+  virtual const char *GetDecision() const { return m_decision; }
+
+  void Solve(const CDirtyRegionList &input, const CRect &viewport, CDirtyRegionList &output);
+  float GetCost(const CDirtyRegionList &regions, const CRect &viewport) const;
+private:
+  float m_passCost;
+  CDirtyRegionList m_previous;
+  const char *m_decision;
+};
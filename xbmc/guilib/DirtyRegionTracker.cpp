@@ -19,15 +19,20 @@
  */
 
 #include "DirtyRegionTracker.h"
+#include "GraphicContext.h"
 #include "settings/AdvancedSettings.h"
 #include "utils/log.h"
+#include "utils/StringUtils.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include "DirtyRegionSolvers.h"
 
 CDirtyRegionTracker::CDirtyRegionTracker(int buffering)
 {
   m_buffering = buffering;
   m_solver = NULL;
+  m_lastPasses = 0;
+  m_lastArea = 0.0f;
 }
 
 CDirtyRegionTracker::~CDirtyRegionTracker()
@@ -49,6 +54,10 @@ void CDirtyRegionTracker::SelectAlgorithm()
       CLog::Log(LOGDEBUG, "guilib: Cost reduction as algorithm for solving rendering passes");
       m_solver = new CGreedyDirtyRegionSolver();
       break;
+    case DIRTYREGION_SOLVER_COST_MODEL:
+      CLog::Log(LOGDEBUG, "guilib: Cost model as algorithm for solving rendering passes");
+      m_solver = new CCostModelDirtyRegionSolver();
+      break;
     case DIRTYREGION_SOLVER_UNION:
       m_solver = new CUnionDirtyRegionSolver();
       CLog::Log(LOGDEBUG, "guilib: Union as algorithm for solving rendering passes");
@@ -79,9 +88,54 @@ CDirtyRegionList CDirtyRegionTracker::GetDirtyRegions()
   if (m_solver)
     m_solver->Solve(m_markedRegions, output);
 
+  if (g_advancedSettings.m_guiTraceDirtyRegions && !m_markedRegions.empty())
+    CLog::Log(LOGDEBUG, "DirtyRegionTrace: %s", FormatTrace(m_markedRegions).c_str());
+
+  m_lastPasses = output.size();
+  m_lastArea = 0.0f;
+  for (CDirtyRegionList::const_iterator i = output.begin(); i != output.end(); ++i)
+    m_lastArea += i->Area();
+
   return output;
 }
 
+std::string CDirtyRegionTracker::GetDebugInfo() const
+{
+  float screen = (float)g_graphicsContext.GetWidth() * g_graphicsContext.GetHeight();
+  const char *decision = m_solver ? m_solver->GetDecision() : NULL;
+  return StringUtils::Format("Dirty regions: %u marked, %u passes, %.0f%% of screen%s%s",
+                             (unsigned int)m_markedRegions.size(), m_lastPasses,
+                             screen > 0 ? 100.0f * m_lastArea / screen : 0.0f,
+                             decision ? " - " : "", decision ? decision : "");
+}
+
+std::string CDirtyRegionTracker::FormatTrace(const CDirtyRegionList &regions)
+{
+  std::string trace;
+  for (CDirtyRegionList::const_iterator i = regions.begin(); i != regions.end(); ++i)
+  {
+    if (!trace.empty())
+      trace += " ";
+    trace += StringUtils::Format("%g,%g,%g,%g", i->x1, i->y1, i->x2, i->y2);
+  }
+  return trace;
+}
+
+CDirtyRegionList CDirtyRegionTracker::ParseTrace(const std::string &trace)
+{
+  CDirtyRegionList regions;
+  std::vector<std::string> rects = StringUtils::Tokenize(trace, " \t\r\n");
+  for (std::vector<std::string>::const_iterator i = rects.begin(); i != rects.end(); ++i)
+  {
+    std::vector<std::string> coords = StringUtils::Split(*i, ',');
+    if (coords.size() != 4)
+      continue;
+    regions.push_back(CDirtyRegion((float)atof(coords[0].c_str()), (float)atof(coords[1].c_str()),
+                                   (float)atof(coords[2].c_str()), (float)atof(coords[3].c_str())));
+  }
+  return regions;
+}
+
 void CDirtyRegionTracker::CleanMarkedRegions()
 {
   int buffering = g_advancedSettings.m_guiVisualizeDirtyRegions ? 20 : m_buffering;
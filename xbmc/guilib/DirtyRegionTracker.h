@@ -19,6 +19,8 @@
  *
  */
 
+#include <string>
+
 #include "IDirtyRegionSolver.h"
 
 #if defined(TARGET_DARWIN_IOS)
@@ -39,8 +41,19 @@ public:
   CDirtyRegionList GetDirtyRegions();
   void CleanMarkedRegions();
 
+  /*!
+   \brief Describes the last solution: regions, passes and the part of the screen they cover.
+   */
+  std::string GetDebugInfo() const;
+
+  // Dirty region traces have a line per frame of regions "x1,y1,x2,y2" separated by spaces
+  static std::string FormatTrace(const CDirtyRegionList &regions);
+  static CDirtyRegionList ParseTrace(const std::string &trace);
+
 private:
   CDirtyRegionList m_markedRegions;
+  unsigned int m_lastPasses;
+  float m_lastArea;
   int m_buffering;
   IDirtyRegionSolver *m_solver;
 };
@@ -27,6 +27,7 @@
 #include "utils/SortUtils.h"
 #include "utils/StringUtils.h"
 #include "FileItem.h"
+#include "IFileItemListPager.h"
 #include "input/Key.h"
 #include "utils/MathUtils.h"
 #include "utils/XBMCTinyXML.h"
@@ -106,6 +107,9 @@ void CGUIBaseContainer::Process(unsigned int currentTime, CDirtyRegionList &dirt
   if ((int)m_items.size() > m_itemsPerPage + cacheBefore + cacheAfter)
     FreeMemory(CorrectOffset(offset - cacheBefore, 0), CorrectOffset(offset + m_itemsPerPage + 1 + cacheAfter, 0));
 
+  if (m_pager)
+    UpdatePagedItems(CorrectOffset(offset - cacheBefore, 0), CorrectOffset(offset + m_itemsPerPage + 1 + cacheAfter, 0));
+
   CPoint origin = CPoint(m_posX, m_posY) + m_renderOffset;
   float pos = (m_orientation == VERTICAL) ? origin.y : origin.x;
   float end = (m_orientation == VERTICAL) ? m_posY + m_height : m_posX + m_width;
@@ -414,6 +418,7 @@ bool CGUIBaseContainer::OnMessage(CGUIMessage& message)
         CFileItemList *items = (CFileItemList *)message.GetPointer();
         for (int i = 0; i < items->Size(); i++)
           m_items.push_back(items->Get(i));
+        m_pager = items->GetPager();
         UpdateLayout(true); // true to refresh all items
         UpdateScrollByLetter();
         SelectItem(message.GetParam1());
@@ -1136,6 +1141,8 @@ void CGUIBaseContainer::Reset()
   m_wasReset = true;
   m_items.clear();
   m_lastItem.reset();
+  m_pager.reset();
+  m_pagedItems.clear();
   ResetAutoScrolling();
 }
 
@@ -1193,6 +1200,54 @@ void CGUIBaseContainer::FreeMemory(int keepStart, int keepEnd)
   }
 }
 
+void CGUIBaseContainer::UpdatePagedItems(int keepStart, int keepEnd)
+{
+  int size = (int)m_items.size();
+  if (size <= 0)
+    return;
+
+  // pages are loaded in the background, placeholders are shown until they arrive
+  if (m_pager->Update())
+    MarkDirtyRegion();
+
+  // load a page ahead in both directions so that scrolling rarely waits for the pager,
+  // and only evict items well outside of that so that scrolling back and forth doesn't thrash
+  int page = std::max(m_itemsPerPage, 1);
+  int loadStart = keepStart - page;
+  int loadEnd = keepEnd + page;
+  if (keepStart > keepEnd)
+    loadEnd += size; // wrapping
+  else
+  {
+    loadStart = std::max(loadStart, 0);
+    loadEnd = std::min(loadEnd, size - 1);
+  }
+  int range = std::min(loadEnd - loadStart, size - 1);
+
+  VECFILEITEMS load;
+  for (int i = loadStart; i <= loadStart + range; ++i)
+  {
+    int item = (i % size + size) % size;
+    if (m_pagedItems.insert(item).second)
+      load.push_back(std::static_pointer_cast<CFileItem>(m_items[item]));
+  }
+  if (!load.empty())
+    m_pager->LoadAsync(load);
+
+  for (std::set<int>::iterator it = m_pagedItems.begin(); it != m_pagedItems.end(); )
+  {
+    int position = ((*it - loadStart) % size + size) % size;
+    if (position > range + 4 * page && position < size - 4 * page)
+    {
+      m_items[*it]->FreeMemory();
+      m_pager->Evict(*std::static_pointer_cast<CFileItem>(m_items[*it]));
+      it = m_pagedItems.erase(it);
+    }
+    else
+      ++it;
+  }
+}
+
 bool CGUIBaseContainer::InsideLayout(const CGUIListItemLayout *layout, const CPoint &point) const
 {
   if (!layout) return false;
@@ -25,6 +25,8 @@
  *
  */
 
+#include <memory>
+#include <set>
 #include <utility>
 #include <vector>
 
@@ -38,6 +40,7 @@
  */
 
 class IListProvider;
+class IFileItemListPager;
 
 class CGUIBaseContainer : public IGUIContainer
 {
@@ -136,6 +139,7 @@ protected:
   inline float Size() const;
   void MoveToRow(int row);
   void FreeMemory(int keepStart, int keepEnd);
+  void UpdatePagedItems(int keepStart, int keepEnd);
   void GetCurrentLayouts();
   CGUIListItemLayout *GetFocusedLayout() const;
 
@@ -167,6 +171,9 @@ protected:
 
   IListProvider *m_listProvider;
 
+  std::shared_ptr<IFileItemListPager> m_pager; ///< loads the placeholders of a bound list on demand, if any
+  std::set<int> m_pagedItems;                  ///< items loaded through m_pager
+
   bool m_wasReset;  // true if we've received a Reset message until we've rendered once.  Allows
                     // us to make sure we don't tell the infomanager that we've been moving when
                     // the "movement" was simply due to the list being repopulated (thus cursor position
@@ -0,0 +1,181 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUIBenchmark.h"
+
+#include <limits>
+#include <stdlib.h>
+
+#include "GUIControlProfiler.h"
+#include "GUIWindowManager.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "input/ButtonTranslator.h"
+#include "input/Key.h"
+#include "messaging/ApplicationMessenger.h"
+#include "utils/StringUtils.h"
+#include "utils/log.h"
+
+using namespace KODI::MESSAGING;
+
+#define DEFAULT_REPORT_FILE "special://home/guibenchmark.txt"
+
+CGUIBenchmark::CGUIBenchmark()
+  : m_loaded(false),
+    m_step(0),
+    m_repeat(0)
+{
+}
+
+CGUIBenchmark& CGUIBenchmark::GetInstance()
+{
+  static CGUIBenchmark sGUIBenchmark;
+  return sGUIBenchmark;
+}
+
+bool CGUIBenchmark::ParseScript(const std::string &script, std::vector<Step> &steps, std::string &reportFile)
+{
+  std::vector<std::string> lines = StringUtils::Split(script, '\n');
+  for (unsigned int i = 0; i < lines.size(); i++)
+  {
+    std::string line = lines[i];
+    StringUtils::Trim(line);
+    if (line.empty() || line[0] == '#')
+      continue;
+
+    std::vector<std::string> args = StringUtils::Tokenize(line, " \t");
+    const std::string &command = args[0];
+    Step step;
+    step.id = 0;
+    step.count = 1;
+    if (command == "window" && args.size() == 2)
+    {
+      step.type = Step::WINDOW;
+      step.id = CButtonTranslator::TranslateWindow(args[1]);
+      if (step.id == WINDOW_INVALID)
+      {
+        CLog::Log(LOGERROR, "%s - unknown window '%s' in line %u", __FUNCTION__, args[1].c_str(), i + 1);
+        return false;
+      }
+    }
+    else if (command == "action" && (args.size() == 2 || args.size() == 3))
+    {
+      step.type = Step::ACTION;
+      if (!CButtonTranslator::TranslateActionString(args[1].c_str(), step.id) ||
+          step.id == ACTION_BUILT_IN_FUNCTION)
+      {
+        CLog::Log(LOGERROR, "%s - unknown action '%s' in line %u", __FUNCTION__, args[1].c_str(), i + 1);
+        return false;
+      }
+      if (args.size() == 3)
+      {
+        if (!StringUtils::IsNaturalNumber(args[2]))
+        {
+          CLog::Log(LOGERROR, "%s - invalid count in line %u", __FUNCTION__, i + 1);
+          return false;
+        }
+        step.count = strtoul(args[2].c_str(), NULL, 10);
+      }
+    }
+    else if (command == "frames" && args.size() == 2 && StringUtils::IsNaturalNumber(args[1]))
+    {
+      step.type = Step::FRAMES;
+      step.count = strtoul(args[1].c_str(), NULL, 10);
+    }
+    else if (command == "report" && args.size() == 2)
+    {
+      reportFile = args[1];
+      continue;
+    }
+    else
+    {
+      CLog::Log(LOGERROR, "%s - invalid command '%s' in line %u", __FUNCTION__, line.c_str(), i + 1);
+      return false;
+    }
+    steps.push_back(step);
+  }
+  return true;
+}
+
+bool CGUIBenchmark::Load()
+{
+  XFILE::CFile file;
+  XUTILS::auto_buffer buffer;
+  if (file.LoadFile(m_scriptFile, buffer) < 0)
+  {
+    CLog::Log(LOGERROR, "%s - unable to read %s", __FUNCTION__, m_scriptFile.c_str());
+    return false;
+  }
+
+  m_steps.clear();
+  m_reportFile = DEFAULT_REPORT_FILE;
+  return ParseScript(std::string(buffer.get(), buffer.size()), m_steps, m_reportFile);
+}
+
+void CGUIBenchmark::FrameMove()
+{
+  if (!IsActive())
+    return;
+
+  if (!m_loaded)
+  {
+    m_loaded = true;
+    if (!Load())
+    {
+      m_scriptFile.clear();
+      CApplicationMessenger::GetInstance().PostMsg(TMSG_QUIT);
+      return;
+    }
+
+    CLog::Log(LOGNOTICE, "%s - running %s, %u steps", __FUNCTION__, m_scriptFile.c_str(), (unsigned int)m_steps.size());
+    CGUIControlProfiler &profiler = CGUIControlProfiler::Instance();
+    profiler.SetOutputFile("");
+    profiler.SetReportFile(CSpecialProtocol::TranslatePath(m_reportFile));
+    profiler.SetMaxFrameCount(std::numeric_limits<int>::max());
+    profiler.Start();
+  }
+
+  while (m_step < m_steps.size() && m_repeat >= m_steps[m_step].count)
+  {
+    m_step++;
+    m_repeat = 0;
+  }
+  if (m_step == m_steps.size())
+  {
+    Finish();
+    return;
+  }
+
+  const Step &step = m_steps[m_step];
+  m_repeat++;
+  if (step.type == Step::WINDOW)
+    g_windowManager.ActivateWindow(step.id);
+  else if (step.type == Step::ACTION)
+    g_windowManager.OnAction(CAction(step.id));
+}
+
+void CGUIBenchmark::Finish()
+{
+  CGUIControlProfiler::Instance().Stop();
+  CLog::Log(LOGNOTICE, "%s - done, timings written to %s", __FUNCTION__, m_reportFile.c_str());
+
+  m_scriptFile.clear();
+  CApplicationMessenger::GetInstance().PostMsg(TMSG_QUIT);
+}
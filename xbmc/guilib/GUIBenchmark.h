@@ -0,0 +1,86 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+#include <vector>
+
+/*!
+ \ingroup winman
+ \brief Drives the gui through a scripted navigation while the control profiler runs.
+
+ The script is a text file with one command per line, each taking one frame:
+
+   window <name or id>       activates a window
+   action <name> [count]     sends an action to the window manager, count times
+   frames <count>            lets the gui run for count frames
+   report <file>             where the timings are written to
+
+ Empty lines and lines starting with # are skipped. Once the script is done the
+ profiler's per control frame time histograms are written to the report and
+ the application quits.
+ */
+class CGUIBenchmark
+{
+public:
+  struct Step
+  {
+    enum Type
+    {
+      WINDOW,
+      ACTION,
+      FRAMES
+    };
+
+    Type type;
+    int id;              // window or action id
+    unsigned int count;  // frames the step takes
+  };
+
+  static CGUIBenchmark& GetInstance();
+
+  static bool ParseScript(const std::string &script, std::vector<Step> &steps, std::string &reportFile);
+
+  /*!
+   \brief Sets the script to run, it's loaded once the gui runs.
+   */
+  void SetScript(const std::string &scriptFile) { m_scriptFile = scriptFile; }
+  bool IsActive() const { return !m_scriptFile.empty(); }
+
+  /*!
+   \brief Runs the next step of the script, called once per frame before the gui is processed.
+   */
+  void FrameMove();
+
+private:
+  CGUIBenchmark();
+  CGUIBenchmark(const CGUIBenchmark&);
+  CGUIBenchmark const& operator=(CGUIBenchmark const&);
+
+  bool Load();
+  void Finish();
+
+  std::string m_scriptFile;
+  std::string m_reportFile;
+  std::vector<Step> m_steps;
+  bool m_loaded;
+  unsigned int m_step;
+  unsigned int m_repeat;  // frames the current step ran for
+};
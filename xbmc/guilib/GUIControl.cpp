@@ -138,7 +138,9 @@ void CGUIControl::DoProcess(unsigned int currentTime, CDirtyRegionList &dirtyreg
     if (m_hasCamera)
       g_graphicsContext.SetCameraPosition(m_camera);
 
+    GUIPROFILER_PROCESS_BEGIN(this);
     Process(currentTime, dirtyregions);
+    GUIPROFILER_PROCESS_END(this);
     m_bInvalidated = false;
 
     if (dirtyRegion != m_renderRegion)
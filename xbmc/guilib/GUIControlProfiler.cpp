@@ -19,15 +19,23 @@
  */
 
 #include "GUIControlProfiler.h"
+#include "filesystem/File.h"
 #include "utils/XBMCTinyXML.h"
 #include "utils/TimeUtils.h"
 #include "utils/StringUtils.h"
 
+#include <algorithm>
+#include <inttypes.h>
+
 bool CGUIControlProfiler::m_bIsRunning = false;
 
 CGUIControlProfilerItem::CGUIControlProfilerItem(CGUIControlProfiler *pProfiler, CGUIControlProfilerItem *pParent, CGUIControl *pControl)
-: m_pProfiler(pProfiler), m_pParent(pParent), m_pControl(pControl), m_visTime(0), m_renderTime(0), m_i64VisStart(0), m_i64RenderStart(0)
+: m_pProfiler(pProfiler), m_pParent(pParent), m_pControl(pControl), m_visTime(0), m_renderTime(0), m_processTime(0),
+  m_i64VisStart(0), m_i64RenderStart(0), m_i64ProcessStart(0), m_i64FrameTime(0), m_bInFrame(false),
+  m_frameCount(0), m_maxFrameTime(0)
 {
+  std::fill(m_histogram, m_histogram + GUIPROFILER_HISTOGRAM_BUCKETS, 0);
+
   if (m_pControl)
   {
     m_controlID = m_pControl->GetID();
@@ -54,6 +62,12 @@ void CGUIControlProfilerItem::Reset(CGUIControlProfiler *pProfiler)
 
   m_visTime = 0;
   m_renderTime = 0;
+  m_processTime = 0;
+  m_i64FrameTime = 0;
+  m_bInFrame = false;
+  m_frameCount = 0;
+  m_maxFrameTime = 0;
+  std::fill(m_histogram, m_histogram + GUIPROFILER_HISTOGRAM_BUCKETS, 0);
   const unsigned int dwSize = m_vecChildren.size();
   for (unsigned int i=0; i<dwSize; ++i)
     delete m_vecChildren[i];
@@ -79,16 +93,58 @@ void CGUIControlProfilerItem::BeginRender(void)
 
 void CGUIControlProfilerItem::EndRender(void)
 {
-  m_renderTime += (unsigned int)(m_pProfiler->m_fPerfScale * (CurrentHostCounter() - m_i64RenderStart));
+  int64_t time = CurrentHostCounter() - m_i64RenderStart;
+  m_renderTime += (unsigned int)(m_pProfiler->m_fPerfScale * time);
+  m_i64FrameTime += time;
+  m_bInFrame = true;
 }
 
-void CGUIControlProfilerItem::SaveToXML(TiXmlElement *parent)
+void CGUIControlProfilerItem::BeginProcess(void)
 {
-  TiXmlElement *xmlControl = new TiXmlElement("control");
-  parent->LinkEndChild(xmlControl);
+  m_i64ProcessStart = CurrentHostCounter();
+}
+
+void CGUIControlProfilerItem::EndProcess(void)
+{
+  int64_t time = CurrentHostCounter() - m_i64ProcessStart;
+  m_processTime += (unsigned int)(m_pProfiler->m_fPerfScale * time);
+  m_i64FrameTime += time;
+  m_bInFrame = true;
+}
+
+unsigned int CGUIControlProfilerItem::GetHistogramBucket(unsigned int time)
+{
+  // 0 for times below 1us, n for times from 2^(n-1) up to 2^n us
+  unsigned int bucket = 0;
+  while (time && bucket < GUIPROFILER_HISTOGRAM_BUCKETS - 1)
+  {
+    time >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+void CGUIControlProfilerItem::EndFrame(void)
+{
+  if (m_bInFrame)
+  {
+    unsigned int time = (unsigned int)(m_pProfiler->m_fMicroScale * m_i64FrameTime);
+    m_histogram[GetHistogramBucket(time)]++;
+    m_maxFrameTime = std::max(m_maxFrameTime, time);
+    m_frameCount++;
+    m_i64FrameTime = 0;
+    m_bInFrame = false;
+  }
+
+  const unsigned int dwSize = m_vecChildren.size();
+  for (unsigned int i=0; i<dwSize; ++i)
+    m_vecChildren[i]->EndFrame();
+}
 
+const char *CGUIControlProfilerItem::GetTypeName(CGUIControl::GUICONTROLTYPES type)
+{
   const char *lpszType = NULL;
-  switch (m_ControlType)
+  switch (type)
   {
   case CGUIControl::GUICONTROL_BUTTON:
     lpszType = "button"; break;
@@ -151,7 +207,15 @@ void CGUIControlProfilerItem::SaveToXML(TiXmlElement *parent)
   default:
     break;
   }
+  return lpszType;
+}
 
+void CGUIControlProfilerItem::SaveToXML(TiXmlElement *parent)
+{
+  TiXmlElement *xmlControl = new TiXmlElement("control");
+  parent->LinkEndChild(xmlControl);
+
+  const char *lpszType = GetTypeName(m_ControlType);
   if (lpszType)
     xmlControl->SetAttribute("type", lpszType);
   if (m_controlID != 0)
@@ -178,7 +242,8 @@ void CGUIControlProfilerItem::SaveToXML(TiXmlElement *parent)
   // Note time is stored in 1/100 milliseconds but reported in ms
   unsigned int vis = m_visTime / 100;
   unsigned int rend = m_renderTime / 100;
-  if (vis || rend)
+  unsigned int proc = m_processTime / 100;
+  if (vis || rend || proc)
   {
     std::string val;
     TiXmlElement *elem = new TiXmlElement("rendertime");
@@ -192,6 +257,12 @@ void CGUIControlProfilerItem::SaveToXML(TiXmlElement *parent)
     val = StringUtils::Format("%u", vis);
     text = new TiXmlText(val.c_str());
     elem->LinkEndChild(text);
+
+    elem = new TiXmlElement("processtime");
+    xmlControl->LinkEndChild(elem);
+    val = StringUtils::Format("%u", proc);
+    text = new TiXmlText(val.c_str());
+    elem->LinkEndChild(text);
   }
 
   if (m_vecChildren.size())
@@ -204,6 +275,39 @@ void CGUIControlProfilerItem::SaveToXML(TiXmlElement *parent)
   }
 }
 
+void CGUIControlProfilerItem::SaveToReport(std::string &report, const std::string &parentPath, unsigned int index) const
+{
+  // controls without id are named by their position in the parent
+  std::string path = parentPath;
+  if (m_pParent)
+  {
+    if (!path.empty())
+      path += "/";
+    path += m_controlID != 0 ? StringUtils::Format("%d", m_controlID) : StringUtils::Format("#%u", index);
+  }
+
+  if (m_frameCount)
+  {
+    const char *lpszType = m_pParent && !m_pParent->m_pParent ? "window" : GetTypeName(m_ControlType);
+    // process and render times are kept in 1/100 milliseconds, the report is in microseconds
+    report += StringUtils::Format("%s %s frames=%u process=%" PRIu64" render=%" PRIu64" max=%u hist=", path.c_str(),
+                                  lpszType ? lpszType : "unknown", m_frameCount,
+                                  static_cast<uint64_t>(m_processTime) * 10, static_cast<uint64_t>(m_renderTime) * 10,
+                                  m_maxFrameTime);
+    for (unsigned int i = 0; i < GUIPROFILER_HISTOGRAM_BUCKETS; ++i)
+      report += StringUtils::Format(i ? ",%u" : "%u", m_histogram[i]);
+    report += "\n";
+  }
+
+  // children in id order, so that the order they were first seen in doesn't matter
+  std::vector<std::pair<int, unsigned int> > children;
+  for (unsigned int i = 0; i < m_vecChildren.size(); ++i)
+    children.push_back(std::make_pair(m_vecChildren[i]->m_controlID, i));
+  std::stable_sort(children.begin(), children.end());
+  for (std::vector<std::pair<int, unsigned int> >::const_iterator it = children.begin(); it != children.end(); ++it)
+    m_vecChildren[it->second]->SaveToReport(report, path, it->second);
+}
+
 CGUIControlProfilerItem *CGUIControlProfilerItem::AddControl(CGUIControl *pControl)
 {
   m_vecChildren.push_back(new CGUIControlProfilerItem(m_pProfiler, this, pControl));
@@ -233,6 +337,7 @@ CGUIControlProfiler::CGUIControlProfiler(void)
 // m_bIsRunning(false), no isRunning because it is static
 {
   m_fPerfScale = 100000.0f / CurrentHostFrequency();
+  m_fMicroScale = 1000000.0f / CurrentHostFrequency();
 }
 
 CGUIControlProfiler &CGUIControlProfiler::Instance(void)
@@ -278,6 +383,18 @@ void CGUIControlProfiler::EndRender(CGUIControl *pControl)
   item->EndRender();
 }
 
+void CGUIControlProfiler::BeginProcess(CGUIControl *pControl)
+{
+  CGUIControlProfilerItem *item = FindOrAddControl(pControl);
+  item->BeginProcess();
+}
+
+void CGUIControlProfiler::EndProcess(CGUIControl *pControl)
+{
+  CGUIControlProfilerItem *item = FindOrAddControl(pControl);
+  item->EndProcess();
+}
+
 CGUIControlProfilerItem *CGUIControlProfiler::FindOrAddControl(CGUIControl *pControl)
 {
   if (m_pLastItem)
@@ -308,21 +425,31 @@ CGUIControlProfilerItem *CGUIControlProfiler::FindOrAddControl(CGUIControl *pCon
 
 void CGUIControlProfiler::EndFrame(void)
 {
+  m_ItemHead.EndFrame();
   m_iFrameCount++;
   if (m_iFrameCount >= m_iMaxFrameCount)
+    Stop();
+}
+
+void CGUIControlProfiler::Stop(void)
+{
+  if (!m_bIsRunning)
+    return;
+
+  const unsigned int dwSize = m_ItemHead.m_vecChildren.size();
+  for (unsigned int i=0; i<dwSize; ++i)
   {
-    const unsigned int dwSize = m_ItemHead.m_vecChildren.size();
-    for (unsigned int i=0; i<dwSize; ++i)
-    {
-      CGUIControlProfilerItem *p = m_ItemHead.m_vecChildren[i];
-      m_ItemHead.m_visTime += p->m_visTime;
-      m_ItemHead.m_renderTime += p->m_renderTime;
-    }
-
-    m_bIsRunning = false;
-    if (SaveResults())
-      m_ItemHead.Reset(this);
+    CGUIControlProfilerItem *p = m_ItemHead.m_vecChildren[i];
+    m_ItemHead.m_visTime += p->m_visTime;
+    m_ItemHead.m_renderTime += p->m_renderTime;
+    m_ItemHead.m_processTime += p->m_processTime;
   }
+
+  m_bIsRunning = false;
+  bool saved = SaveResults();
+  saved |= SaveReport();
+  if (saved)
+    m_ItemHead.Reset(this);
 }
 
 bool CGUIControlProfiler::SaveResults(void)
@@ -343,3 +470,21 @@ bool CGUIControlProfiler::SaveResults(void)
   m_ItemHead.SaveToXML(root);
   return doc.SaveFile(m_strOutputFile);
 }
+
+bool CGUIControlProfiler::SaveReport(void)
+{
+  if (m_strReportFile.empty())
+    return false;
+
+  std::string report = StringUtils::Format("# frames=%d, times in microseconds\n", m_iFrameCount);
+  report += "# hist=<1";
+  for (unsigned int i = 1; i < GUIPROFILER_HISTOGRAM_BUCKETS - 1; ++i)
+    report += StringUtils::Format(",<%u", 1u << i);
+  report += StringUtils::Format(",>=%u\n", 1u << (GUIPROFILER_HISTOGRAM_BUCKETS - 2));
+  m_ItemHead.SaveToReport(report, "", 0);
+
+  XFILE::CFile file;
+  if (!file.OpenForWrite(m_strReportFile, true))
+    return false;
+  return file.Write(report.c_str(), report.size()) == static_cast<ssize_t>(report.size());
+}
@@ -22,10 +22,14 @@
 #define GUILIB_GUICONTROLPROFILER_H__
 #pragma once
 
+#include <string>
 #include <vector>
 
 #include "GUIControl.h"
 
+// frame time histograms have a bucket per power of 2 microseconds
+#define GUIPROFILER_HISTOGRAM_BUCKETS 16
+
 class CGUIControlProfiler;
 class TiXmlElement;
 
@@ -41,8 +45,15 @@ public:
   CGUIControl::GUICONTROLTYPES m_ControlType;
   unsigned int m_visTime;
   unsigned int m_renderTime;
+  unsigned int m_processTime;
   int64_t m_i64VisStart;
   int64_t m_i64RenderStart;
+  int64_t m_i64ProcessStart;
+  int64_t m_i64FrameTime;     // process and render time of the current frame, in host counter ticks
+  bool m_bInFrame;            // whether the control was processed or rendered this frame
+  unsigned int m_frameCount;
+  unsigned int m_maxFrameTime; // in microseconds
+  unsigned int m_histogram[GUIPROFILER_HISTOGRAM_BUCKETS];
 
   CGUIControlProfilerItem(CGUIControlProfiler *pProfiler, CGUIControlProfilerItem *pParent, CGUIControl *pControl);
   ~CGUIControlProfilerItem(void);
@@ -52,8 +63,15 @@ public:
   void EndVisibility(void);
   void BeginRender(void);
   void EndRender(void);
+  void BeginProcess(void);
+  void EndProcess(void);
+  void EndFrame(void);
   void SaveToXML(TiXmlElement *parent);
-  unsigned int GetTotalTime(void) const { return m_visTime + m_renderTime; };
+  void SaveToReport(std::string &report, const std::string &parentPath, unsigned int index) const;
+  unsigned int GetTotalTime(void) const { return m_visTime + m_renderTime + m_processTime; };
+
+  static const char *GetTypeName(CGUIControl::GUICONTROLTYPES type);
+  static unsigned int GetHistogramBucket(unsigned int time);
 
   CGUIControlProfilerItem *AddControl(CGUIControl *pControl);
   CGUIControlProfilerItem *FindOrAddControl(CGUIControl *pControl, bool recurse);
@@ -71,14 +89,27 @@ public:
   void EndVisibility(CGUIControl *pControl);
   void BeginRender(CGUIControl *pControl);
   void EndRender(CGUIControl *pControl);
+  void BeginProcess(CGUIControl *pControl);
+  void EndProcess(CGUIControl *pControl);
+  void Stop(void);
   int GetMaxFrameCount(void) const { return m_iMaxFrameCount; };
   void SetMaxFrameCount(int iMaxFrameCount) { m_iMaxFrameCount = iMaxFrameCount; };
   void SetOutputFile(const std::string &strOutputFile) { m_strOutputFile = strOutputFile; };
   const std::string &GetOutputFile(void) const { return m_strOutputFile; };
+  void SetReportFile(const std::string &strReportFile) { m_strReportFile = strReportFile; };
   bool SaveResults(void);
+
+  /*!
+   \brief Writes the frame time histograms of all windows and controls as text.
+
+   There's a line per control, sorted by window and control ids, so reports
+   of runs of the same navigation can be compared with diff.
+   */
+  bool SaveReport(void);
   unsigned int GetTotalTime(void) const { return m_ItemHead.GetTotalTime(); };
 
   float m_fPerfScale;
+  float m_fMicroScale;
 private:
   CGUIControlProfiler(void);
   ~CGUIControlProfiler(void) {};
@@ -91,6 +122,7 @@ private:
 
   static bool m_bIsRunning;
   std::string m_strOutputFile;
+  std::string m_strReportFile;
   int m_iMaxFrameCount;
   int m_iFrameCount;
 };
@@ -99,5 +131,7 @@ private:
 #define GUIPROFILER_VISIBILITY_END(x) { if (CGUIControlProfiler::IsRunning()) CGUIControlProfiler::Instance().EndVisibility(x); }
 #define GUIPROFILER_RENDER_BEGIN(x) { if (CGUIControlProfiler::IsRunning()) CGUIControlProfiler::Instance().BeginRender(x); }
 #define GUIPROFILER_RENDER_END(x) { if (CGUIControlProfiler::IsRunning()) CGUIControlProfiler::Instance().EndRender(x); }
+#define GUIPROFILER_PROCESS_BEGIN(x) { if (CGUIControlProfiler::IsRunning()) CGUIControlProfiler::Instance().BeginProcess(x); }
+#define GUIPROFILER_PROCESS_END(x) { if (CGUIControlProfiler::IsRunning()) CGUIControlProfiler::Instance().EndProcess(x); }
 
 #endif
@@ -24,6 +24,10 @@
 #include "addons/Skin.h"
 #include "GUIFontTTF.h"
 #include "GUIFont.h"
+#include "GUITextLayoutCache.h"
+#include "LocalizeStrings.h"
+#include "threads/SystemClock.h"
+#include "utils/JobManager.h"
 #include "utils/XMLUtils.h"
 #include "GUIControlFactory.h"
 #include "filesystem/Directory.h"
@@ -39,6 +43,9 @@
 #include "filesystem/SpecialProtocol.h"
 #endif
 
+#include <algorithm>
+#include <map>
+
 GUIFontManager::GUIFontManager(void)
 {
   m_canReload = true;
@@ -205,6 +212,10 @@ void GUIFontManager::ReloadTTFFonts(void)
   if (!m_vecFonts.size())
     return;   // we haven't even loaded fonts in yet
 
+  // texts are measured differently with the new fonts, and the glyphs of the old sizes aren't drawn anymore
+  CGUITextLayoutCache::GetInstance().Clear();
+  CGlyphAtlas::GetInstance().Clear();
+
   for (unsigned int i = 0; i < m_vecFonts.size(); i++)
   {
     CGUIFont* font = m_vecFonts[i];
@@ -235,6 +246,64 @@ void GUIFontManager::ReloadTTFFonts(void)
 
     font->SetFont(pFontFile);
   }
+
+  PrewarmGlyphs();
+}
+
+void GUIFontManager::PrewarmGlyphs()
+{
+  struct FontFile
+  {
+    std::string path;
+    float size;
+    float aspect;
+    bool border;
+    std::vector<uint32_t> styles;
+  };
+
+  // the font files in use and the styles they are drawn in, as in CGUIFontTTFBase::GetCharacter()
+  std::map<std::string, FontFile> fontFiles;
+  for (size_t i = 0; i < m_vecFonts.size() && i < m_vecFontInfo.size(); i++)
+  {
+    const OrigFontInfo &fontInfo = m_vecFontInfo[i];
+    FontFile fontFile;
+    fontFile.path = fontInfo.fontFilePath;
+    fontFile.size = (float)fontInfo.size;
+    fontFile.aspect = fontInfo.aspect;
+    fontFile.border = fontInfo.border;
+    RescaleFontSizeAndAspect(&fontFile.size, &fontFile.aspect, fontInfo.sourceRes, fontInfo.preserveAspect);
+
+    std::string key = CGUIFontTTFBase::GetAtlasKey(fontFile.path, fontFile.size, fontFile.aspect, fontFile.border);
+    auto it = fontFiles.insert(std::make_pair(key, fontFile)).first;
+    uint32_t style = m_vecFonts[i]->GetStyle() & (FONT_STYLE_BOLD | FONT_STYLE_ITALICS | FONT_STYLE_LIGHT);
+    if (std::find(it->second.styles.begin(), it->second.styles.end(), style) == it->second.styles.end())
+      it->second.styles.push_back(style);
+  }
+  if (fontFiles.empty())
+    return;
+
+  CJobManager::GetInstance().Submit([fontFiles]() {
+    // ascii first, then whatever the language needs
+    std::wstring characters;
+    for (wchar_t letter = L' '; letter < 0x7f; letter++)
+      characters.push_back(letter);
+    for (wchar_t letter : g_localizeStrings.GetCharacters())
+    {
+      if (letter > 0x7e && static_cast<uint32_t>(letter) <= 0xffff)
+        characters.push_back(letter);
+    }
+
+    unsigned int time = XbmcThreads::SystemClockMillis();
+    unsigned int count = 0;
+    for (const auto& fontFile : fontFiles)
+    {
+      count += CGUIFontTTFBase::PrewarmGlyphs(fontFile.second.path, fontFile.second.size, fontFile.second.aspect,
+                                              fontFile.second.border, fontFile.second.styles, characters,
+                                              CGlyphAtlas::GetInstance());
+    }
+    CLog::Log(LOGDEBUG, "GUIFontManager::PrewarmGlyphs - rasterized %u glyphs of %u fonts in %u ms", count,
+              static_cast<unsigned int>(fontFiles.size()), XbmcThreads::SystemClockMillis() - time);
+  }, CJob::PRIORITY_NORMAL);
 }
 
 void GUIFontManager::Unload(const std::string& strFontName)
@@ -243,6 +312,7 @@ void GUIFontManager::Unload(const std::string& strFontName)
   {
     if (StringUtils::EqualsNoCase((*iFont)->GetFontName(), strFontName))
     {
+      CGUITextLayoutCache::GetInstance().Clear();
       delete (*iFont);
       m_vecFonts.erase(iFont);
       return;
@@ -324,6 +394,9 @@ CGUIFont* GUIFontManager::GetDefaultFont(bool border)
 
 void GUIFontManager::Clear()
 {
+  CGUITextLayoutCache::GetInstance().Clear();
+  CGlyphAtlas::GetInstance().Clear();
+
   for (int i = 0; i < (int)m_vecFonts.size(); ++i)
   {
     CGUIFont* pFont = m_vecFonts[i];
@@ -370,6 +443,7 @@ void GUIFontManager::LoadFonts(const std::string& fontSet)
       if (StringUtils::EqualsNoCase(fontSet, idAttr))
       {
         LoadFonts(pChild->FirstChild("font"));
+        PrewarmGlyphs();
         return;
       }
     }
@@ -83,6 +83,7 @@ public:
 
 protected:
   void ReloadTTFFonts();
+  void PrewarmGlyphs();
   static void RescaleFontSizeAndAspect(float *size, float *aspect, const RESOLUTION_INFO &sourceRes, bool preserveAspect);
   void LoadFonts(const TiXmlNode* fontNode);
   CGUIFontTTFBase* GetFontFile(const std::string& strFontFile);
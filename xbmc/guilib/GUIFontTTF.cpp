@@ -29,9 +29,12 @@
 #include "windowing/WindowingFactory.h"
 #include "URL.h"
 #include "filesystem/File.h"
+#include "threads/SingleLock.h"
 #include "threads/SystemClock.h"
+#include "utils/StringUtils.h"
 
 #include <math.h>
+#include <string.h>
 #include <memory>
 #include <queue>
 
@@ -56,6 +59,7 @@
 #define GLYPH_STRENGTH_LIGHT -48
 
 
+// faces are created and released under our lock, as fonts may be rasterized on other threads
 class CFreeTypeLibrary
 {
 public:
@@ -72,6 +76,8 @@ public:
 
   FT_Face GetFont(const std::string &filename, float size, float aspect, XUTILS::auto_buffer& memoryBuf)
   {
+    CSingleLock lock(m_section);
+
     // don't have it yet - create it
     if (!m_library)
       FT_Init_FreeType(&m_library);
@@ -125,6 +131,7 @@ public:
   
   FT_Stroker GetStroker()
   {
+    CSingleLock lock(m_section);
     if (!m_library)
       return NULL;
 
@@ -135,28 +142,41 @@ public:
     return stroker;
   };
 
-  static void ReleaseFont(FT_Face face)
+  void ReleaseFont(FT_Face face)
   {
+    CSingleLock lock(m_section);
     assert(face);
     FT_Done_Face(face);
   };
   
-  static void ReleaseStroker(FT_Stroker stroker)
+  void ReleaseStroker(FT_Stroker stroker)
   {
+    CSingleLock lock(m_section);
     assert(stroker);
     FT_Stroker_Done(stroker);
   }
 
 private:
   FT_Library   m_library;
+  CCriticalSection m_section;
 };
 
 XBMC_GLOBAL_REF(CFreeTypeLibrary, g_freeTypeLibrary); // our freetype library
 #define g_freeTypeLibrary XBMC_GLOBAL_USE(CFreeTypeLibrary)
 
+// strength of the border of bordered fonts, in 26.6 pixels
+static FT_Pos GetBorderStrength(FT_Face face)
+{
+  FT_Pos strength = FT_MulFix( face->units_per_EM, face->size->metrics.y_scale) / 12;
+  if (strength < 128)
+    strength = 128;
+  return strength;
+}
+
 CGUIFontTTFBase::CGUIFontTTFBase(const std::string& strFileName) : m_staticCache(*this), m_dynamicCache(*this)
 {
   m_texture = NULL;
+  m_atlasFont = 0;
   m_char = NULL;
   m_maxChars = 0;
   m_nestedBeginCount = 0;
@@ -279,9 +299,7 @@ bool CGUIFontTTFBase::Load(const std::string& strFilename, float height, float a
      add on the strength of any border - the non-bordered font needs
      aligning with the bordered font by utilising GetTextBaseLine()
      */
-    FT_Pos strength = FT_MulFix( m_face->units_per_EM, m_face->size->metrics.y_scale) / 12;
-    if (strength < 128)
-      strength = 128;
+    FT_Pos strength = GetBorderStrength(m_face);
 
     cellDescender -= strength;
     cellAscender  += strength;
@@ -310,6 +328,7 @@ bool CGUIFontTTFBase::Load(const std::string& strFilename, float height, float a
   m_numChars = 0;
 
   m_strFilename = strFilename;
+  m_atlasFont = CGlyphAtlas::GetInstance().GetFontId(GetAtlasKey(strFilename, height, aspect, border));
 
   m_textureHeight = 0;
   m_textureWidth = ((m_cellHeight * CHARS_PER_TEXTURE_LINE) & ~63) + 64;
@@ -689,55 +708,133 @@ CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
   return m_char + low;
 }
 
-bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *ch)
+std::string CGUIFontTTFBase::GetAtlasKey(const std::string& strFilename, float height, float aspect, bool border)
 {
-  int glyph_index = FT_Get_Char_Index( m_face, letter );
+  return StringUtils::Format("%s_%f_%f%s", strFilename.c_str(), height, aspect, border ? "_border" : "");
+}
+
+bool CGUIFontTTFBase::RasterizeGlyph(FT_Face face, FT_Stroker stroker, wchar_t letter, uint32_t style, CGlyphAtlas::Glyph &glyph, std::vector<unsigned char> &pixels)
+{
+  int glyph_index = FT_Get_Char_Index( face, letter );
 
-  FT_Glyph glyph = NULL;
-  if (FT_Load_Glyph( m_face, glyph_index, FT_LOAD_TARGET_LIGHT ))
+  FT_Glyph ftGlyph = NULL;
+  if (FT_Load_Glyph( face, glyph_index, FT_LOAD_TARGET_LIGHT ))
   {
     CLog::Log(LOGDEBUG, "%s Failed to load glyph %x", __FUNCTION__, letter);
     return false;
   }
   // make bold if applicable
   if (style & FONT_STYLE_BOLD)
-    SetGlyphStrength(m_face->glyph, GLYPH_STRENGTH_BOLD);
+    SetGlyphStrength(face->glyph, GLYPH_STRENGTH_BOLD);
   // and italics if applicable
   if (style & FONT_STYLE_ITALICS)
-    ObliqueGlyph(m_face->glyph);
+    ObliqueGlyph(face->glyph);
   // and light if applicable
   if (style & FONT_STYLE_LIGHT)
-    SetGlyphStrength(m_face->glyph, GLYPH_STRENGTH_LIGHT);
+    SetGlyphStrength(face->glyph, GLYPH_STRENGTH_LIGHT);
   // grab the glyph
-  if (FT_Get_Glyph(m_face->glyph, &glyph))
+  if (FT_Get_Glyph(face->glyph, &ftGlyph))
   {
     CLog::Log(LOGDEBUG, "%s Failed to get glyph %x", __FUNCTION__, letter);
     return false;
   }
-  if (m_stroker)
-    FT_Glyph_StrokeBorder(&glyph, m_stroker, 0, 1);
+  if (stroker)
+    FT_Glyph_StrokeBorder(&ftGlyph, stroker, 0, 1);
   // render the glyph
-  if (FT_Glyph_To_Bitmap(&glyph, FT_RENDER_MODE_NORMAL, NULL, 1))
+  if (FT_Glyph_To_Bitmap(&ftGlyph, FT_RENDER_MODE_NORMAL, NULL, 1))
   {
     CLog::Log(LOGDEBUG, "%s Failed to render glyph %x to a bitmap", __FUNCTION__, letter);
+    FT_Done_Glyph(ftGlyph);
     return false;
   }
-  FT_BitmapGlyph bitGlyph = (FT_BitmapGlyph)glyph;
-  FT_Bitmap bitmap = bitGlyph->bitmap;
-  bool isEmptyGlyph = (bitmap.width == 0 || bitmap.rows == 0);
+  FT_BitmapGlyph bitGlyph = (FT_BitmapGlyph)ftGlyph;
+  const FT_Bitmap &bitmap = bitGlyph->bitmap;
+
+  glyph.left = bitGlyph->left;
+  glyph.top = bitGlyph->top;
+  glyph.width = bitmap.width;
+  glyph.rows = bitmap.rows;
+  glyph.advance = (float)MathUtils::round_int( (float)face->glyph->advance.x / 64 );
+
+  pixels.resize(glyph.width * glyph.rows);
+  for (unsigned int y = 0; y < glyph.rows; y++)
+    memcpy(&pixels[y * glyph.width], bitmap.buffer + y * bitmap.pitch, glyph.width);
+
+  // free the glyph
+  FT_Done_Glyph(ftGlyph);
+  return true;
+}
+
+unsigned int CGUIFontTTFBase::PrewarmGlyphs(const std::string& strFilename, float height, float aspect, bool border,
+                                            const std::vector<uint32_t> &styles, const std::wstring &characters, CGlyphAtlas &atlas)
+{
+  XUTILS::auto_buffer fontFileInMemory;
+  FT_Face face = g_freeTypeLibrary.GetFont(strFilename, height, aspect, fontFileInMemory);
+  if (!face)
+    return 0;
+
+  FT_Stroker stroker = NULL;
+  if (border)
+  {
+    stroker = g_freeTypeLibrary.GetStroker();
+    if (stroker)
+      FT_Stroker_Set(stroker, GetBorderStrength(face), FT_STROKER_LINECAP_ROUND, FT_STROKER_LINEJOIN_ROUND, 0);
+  }
+
+  unsigned int font = atlas.GetFontId(GetAtlasKey(strFilename, height, aspect, border));
+  unsigned int count = 0;
+  bool full = false;
+  CGlyphAtlas::Glyph glyph;
+  std::vector<unsigned char> pixels;
+  for (uint32_t style : styles)
+  {
+    for (size_t i = 0; i < characters.size() && !full; i++)
+    {
+      character_t letterAndStyle = (style << 16) | (characters[i] & 0xffff);
+      if (atlas.Has(font, letterAndStyle) ||
+          !RasterizeGlyph(face, stroker, characters[i], style, glyph, pixels))
+        continue;
+
+      // don't push out glyphs that are in use
+      full = !atlas.Add(font, letterAndStyle, glyph, pixels.data(), glyph.width, false);
+      if (!full)
+        count++;
+    }
+  }
+
+  if (stroker)
+    g_freeTypeLibrary.ReleaseStroker(stroker);
+  g_freeTypeLibrary.ReleaseFont(face);
+  return count;
+}
+
+bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *ch)
+{
+  // the glyph is usually in the atlas already, rasterized by PrewarmGlyphs() or an other font
+  character_t letterAndStyle = (style << 16) | letter;
+  CGlyphAtlas::Glyph glyph;
+  std::vector<unsigned char> pixels;
+  CGlyphAtlas &atlas = CGlyphAtlas::GetInstance();
+  if (!atlas.Get(m_atlasFont, letterAndStyle, glyph, pixels))
+  {
+    if (!RasterizeGlyph(m_face, m_stroker, letter, style, glyph, pixels))
+      return false;
+    atlas.Add(m_atlasFont, letterAndStyle, glyph, pixels.data(), glyph.width);
+  }
+  bool isEmptyGlyph = (glyph.width == 0 || glyph.rows == 0);
 
   if (!isEmptyGlyph)
   {
-    if (bitGlyph->left < 0)
-      m_posX += -bitGlyph->left;
+    if (glyph.left < 0)
+      m_posX += -glyph.left;
 
     // check we have enough room for the character
-    if ((m_posX + bitGlyph->left + bitmap.width) > static_cast<int>(m_textureWidth))
+    if ((m_posX + glyph.left + static_cast<int>(glyph.width)) > static_cast<int>(m_textureWidth))
     { // no space - gotta drop to the next line (which means creating a new texture and copying it across)
       m_posX = 0;
       m_posY += GetTextureLineHeight();
-      if (bitGlyph->left < 0)
-        m_posX += -bitGlyph->left;
+      if (glyph.left < 0)
+        m_posX += -glyph.left;
 
       if(m_posY + GetTextureLineHeight() >= m_textureHeight)
       {
@@ -747,7 +844,6 @@ bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *
         if (newHeight > g_Windowing.GetMaxTextureSize())
         {
           CLog::Log(LOGDEBUG, "%s: New cache texture is too large (%u > %u pixels long)", __FUNCTION__, newHeight, g_Windowing.GetMaxTextureSize());
-          FT_Done_Glyph(glyph);
           return false;
         }
 
@@ -755,7 +851,6 @@ bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *
         newTexture = ReallocTexture(newHeight);
         if(newTexture == NULL)
         {
-          FT_Done_Glyph(glyph);
           CLog::Log(LOGDEBUG, "%s: Failed to allocate new texture of height %u", __FUNCTION__, newHeight);
           return false;
         }
@@ -765,20 +860,19 @@ bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *
 
     if(m_texture == NULL)
     {
-      FT_Done_Glyph(glyph);
       CLog::Log(LOGDEBUG, "%s: no texture to cache character to", __FUNCTION__);
       return false;
     }
   }
   // set the character in our table
-  ch->letterAndStyle = (style << 16) | letter;
-  ch->offsetX = (short)bitGlyph->left;
-  ch->offsetY = (short)m_cellBaseLine - bitGlyph->top;
+  ch->letterAndStyle = letterAndStyle;
+  ch->offsetX = (short)glyph.left;
+  ch->offsetY = (short)m_cellBaseLine - glyph.top;
   ch->left = isEmptyGlyph ? 0 : ((float)m_posX + ch->offsetX);
   ch->top = isEmptyGlyph ? 0 : ((float)m_posY + ch->offsetY);
-  ch->right = ch->left + bitmap.width;
-  ch->bottom = ch->top + bitmap.rows;
-  ch->advance = (float)MathUtils::round_int( (float)m_face->glyph->advance.x / 64 );
+  ch->right = ch->left + glyph.width;
+  ch->bottom = ch->top + glyph.rows;
+  ch->advance = glyph.advance;
 
   // we need only render if we actually have some pixels
   if (!isEmptyGlyph)
@@ -786,17 +880,14 @@ bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *
     // ensure our rect will stay inside the texture (it *should* but we need to be certain)
     unsigned int x1 = std::max(m_posX + ch->offsetX, 0);
     unsigned int y1 = std::max(m_posY + ch->offsetY, 0);
-    unsigned int x2 = std::min(x1 + bitmap.width, m_textureWidth);
-    unsigned int y2 = std::min(y1 + bitmap.rows, m_textureHeight);
-    CopyCharToTexture(bitGlyph, x1, y1, x2, y2);
+    unsigned int x2 = std::min(x1 + glyph.width, m_textureWidth);
+    unsigned int y2 = std::min(y1 + glyph.rows, m_textureHeight);
+    CopyCharToTexture(pixels.data(), glyph.width, x1, y1, x2, y2);
   
     m_posX += spacing_between_characters_in_texture + (unsigned short)std::max(ch->right - ch->left + ch->offsetX, ch->advance);
   }
   m_numChars++;
 
-  // free the glyph
-  FT_Done_Glyph(glyph);
-
   return true;
 }
 
@@ -978,8 +1069,8 @@ void CGUIFontTTFBase::SetGlyphStrength(FT_GlyphSlot slot, int glyphStrength)
     return;
 
   /* some reasonable strength */
-  FT_Pos strength = FT_MulFix( m_face->units_per_EM,
-                    m_face->size->metrics.y_scale ) / glyphStrength;
+  FT_Pos strength = FT_MulFix( slot->face->units_per_EM,
+                    slot->face->size->metrics.y_scale ) / glyphStrength;
 
   FT_BBox bbox_before, bbox_after;
   FT_Outline_Get_CBox( &slot->outline, &bbox_before );
@@ -33,6 +33,7 @@
 
 #include "utils/auto_buffer.h"
 #include "Geometry.h"
+#include "GlyphAtlas.h"
 
 #ifdef HAS_DX
 #include "DirectXMath.h"
@@ -104,6 +105,15 @@ public:
 
   const std::string& GetFileName() const { return m_strFileName; };
 
+  /*! \brief Rasterizes glyphs of a font into the atlas ahead of their first use.
+   Opens its own FreeType face, so it may run on any thread. Stops when the atlas is full.
+   \param styles the font styles (FONT_STYLE_BOLD, ..) to rasterize the characters in
+   \return the number of glyphs added to the atlas
+   */
+  static unsigned int PrewarmGlyphs(const std::string& strFilename, float height, float aspect, bool border,
+                                    const std::vector<uint32_t> &styles, const std::wstring &characters, CGlyphAtlas &atlas);
+  static std::string GetAtlasKey(const std::string& strFilename, float height, float aspect, bool border);
+
 protected:
   struct Character
   {
@@ -135,14 +145,16 @@ protected:
   void ClearCharacterCache();
 
   virtual CBaseTexture* ReallocTexture(unsigned int& newHeight) = 0;
-  virtual bool CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) = 0;
+  virtual bool CopyCharToTexture(const unsigned char *pixels, unsigned int pitch, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) = 0;
   virtual void DeleteHardwareTexture() = 0;
 
   // modifying glyphs
-  void SetGlyphStrength(FT_GlyphSlot slot, int glyphStrength);
+  static void SetGlyphStrength(FT_GlyphSlot slot, int glyphStrength);
   static void ObliqueGlyph(FT_GlyphSlot slot);
+  static bool RasterizeGlyph(FT_Face face, FT_Stroker stroker, wchar_t letter, uint32_t style, CGlyphAtlas::Glyph &glyph, std::vector<unsigned char> &pixels);
 
   CBaseTexture* m_texture;        // texture that holds our rendered characters (8bit alpha only)
+  unsigned int m_atlasFont;       // id of our glyphs in CGlyphAtlas
 
   unsigned int m_textureWidth;       // width of our texture
   unsigned int m_textureHeight;      // heigth of our texture
@@ -198,7 +198,7 @@ const std::string &CGUIInfoLabel::CacheLabel(bool rebuild) const
   {
     m_label.clear();
     for (std::vector<CInfoPortion>::const_iterator portion = m_info.begin(); portion != m_info.end(); ++portion)
-      m_label += portion->Get();
+      portion->Append(m_label);
     m_dirty = false;
   }
   if (m_label.empty())  // empty label, use the fallback
@@ -386,6 +386,18 @@ void CGUIInfoLabel::Parse(const std::string &label, int context)
 
   if (!work.empty())
     m_info.push_back(CInfoPortion(0, work, ""));
+
+  // fold adjacent constant portions, e.g. around empty info blocks
+  for (size_t i = 1; i < m_info.size(); )
+  {
+    if (m_info[i - 1].m_info == 0 && m_info[i].m_info == 0)
+    {
+      m_info[i - 1].Merge(m_info[i]);
+      m_info.erase(m_info.begin() + i);
+    }
+    else
+      i++;
+  }
 }
 
 CGUIInfoLabel::CInfoPortion::CInfoPortion(int info, const std::string &prefix, const std::string &postfix, bool escaped /*= false */):
@@ -411,20 +423,27 @@ bool CGUIInfoLabel::CInfoPortion::NeedsUpdate(const std::string &label) const
   return false;
 }
 
-std::string CGUIInfoLabel::CInfoPortion::Get() const
+void CGUIInfoLabel::CInfoPortion::Append(std::string &label) const
 {
   if (!m_info)
-    return m_prefix;
+    label += m_prefix;
   else if (m_label.empty())
-    return "";
-  std::string label = m_prefix + m_label + m_postfix;
-  if (m_escaped) // escape all quotes and backslashes, then quote
+    return;
+  else if (m_escaped) // escape all quotes and backslashes, then quote
+  {
+    std::string escaped = m_prefix + m_label + m_postfix;
+    StringUtils::Replace(escaped, "\\", "\\\\");
+    StringUtils::Replace(escaped, "\"", "\\\"");
+    label += '"';
+    label += escaped;
+    label += '"';
+  }
+  else
   {
-    StringUtils::Replace(label, "\\", "\\\\");
-    StringUtils::Replace(label, "\"", "\\\"");
-    return "\"" + label + "\"";
+    label += m_prefix;
+    label += m_label;
+    label += m_postfix;
   }
-  return label;
 }
 
 std::string CGUIInfoLabel::GetLabel(const std::string &label, int contextWindow /*= 0*/, bool preferImage /*= false */)
@@ -162,7 +162,10 @@ private:
   public:
     CInfoPortion(int info, const std::string &prefix, const std::string &postfix, bool escaped = false);
     bool NeedsUpdate(const std::string &label) const;
-    std::string Get() const;
+    void Append(std::string &label) const;
+    /*! \brief Merge a following constant portion into this constant portion
+     */
+    void Merge(const CInfoPortion &portion) { m_prefix += portion.m_prefix; }
     int m_info;
   private:
     bool m_escaped;
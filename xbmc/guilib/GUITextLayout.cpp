@@ -22,6 +22,8 @@
 #include "GUIFont.h"
 #include "GUIControl.h"
 #include "GUIColorManager.h"
+#include "GUITextLayoutCache.h"
+#include "GraphicContext.h"
 #include "utils/CharsetConverter.h"
 #include "utils/StringUtils.h"
 
@@ -219,9 +221,37 @@ bool CGUITextLayout::Update(const std::string &text, float maxWidth, bool forceU
 
   m_lastUtf8Text = text;
   m_lastUpdateW = false;
+
+  // texts shown before are laid out already
+  CGUITextLayoutCache::Key key;
+  key.font = m_font;
+  key.text = text;
+  key.maxWidth = m_wrap ? maxWidth : 0;
+  key.maxHeight = m_maxHeight;
+  key.textColor = m_textColor;
+  key.forceLTRReadingOrder = forceLTRReadingOrder;
+  key.scaleX = g_graphicsContext.GetGUIScaleX();
+  key.scaleY = g_graphicsContext.GetGUIScaleY();
+  CGUITextLayoutCache::LayoutPtr cached = CGUITextLayoutCache::GetInstance().Get(key);
+  if (cached)
+  {
+    m_lines = cached->lines;
+    m_colors = cached->colors;
+    m_textWidth = cached->width;
+    m_textHeight = cached->height;
+    return true;
+  }
+
   std::wstring utf16;
   g_charsetConverter.utf8ToW(text, utf16, false);
   UpdateCommon(utf16, maxWidth, forceLTRReadingOrder);
+
+  std::shared_ptr<CGUITextLayoutCache::Layout> layout(new CGUITextLayoutCache::Layout);
+  layout->lines = m_lines;
+  layout->colors = m_colors;
+  layout->width = m_textWidth;
+  layout->height = m_textHeight;
+  CGUITextLayoutCache::GetInstance().Add(key, layout);
   return true;
 }
 
@@ -0,0 +1,105 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUITextLayoutCache.h"
+
+#include <functional>
+
+#include "threads/SingleLock.h"
+
+bool CGUITextLayoutCache::Key::operator==(const Key &right) const
+{
+  return font == right.font &&
+         maxWidth == right.maxWidth &&
+         maxHeight == right.maxHeight &&
+         textColor == right.textColor &&
+         forceLTRReadingOrder == right.forceLTRReadingOrder &&
+         scaleX == right.scaleX &&
+         scaleY == right.scaleY &&
+         text == right.text;
+}
+
+size_t CGUITextLayoutCache::KeyHash::operator()(const Key &key) const
+{
+  size_t hash = std::hash<std::string>()(key.text);
+  hash ^= std::hash<const CGUIFont*>()(key.font) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+  hash ^= std::hash<float>()(key.maxWidth) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+  return hash;
+}
+
+CGUITextLayoutCache::CGUITextLayoutCache(size_t capacity)
+  : m_capacity(capacity),
+    m_hits(0)
+{
+}
+
+CGUITextLayoutCache& CGUITextLayoutCache::GetInstance()
+{
+  static CGUITextLayoutCache sTextLayoutCache;
+  return sTextLayoutCache;
+}
+
+CGUITextLayoutCache::LayoutPtr CGUITextLayoutCache::Get(const Key &key)
+{
+  CSingleLock lock(m_section);
+  auto layout = m_index.find(key);
+  if (layout == m_index.end())
+    return LayoutPtr();
+
+  m_layouts.splice(m_layouts.begin(), m_layouts, layout->second);
+  m_hits++;
+  return layout->second->second;
+}
+
+void CGUITextLayoutCache::Add(const Key &key, const LayoutPtr &layout)
+{
+  if (m_capacity == 0 || !layout)
+    return;
+
+  CSingleLock lock(m_section);
+  auto existing = m_index.find(key);
+  if (existing != m_index.end())
+  {
+    existing->second->second = layout;
+    m_layouts.splice(m_layouts.begin(), m_layouts, existing->second);
+    return;
+  }
+
+  if (m_layouts.size() >= m_capacity)
+  {
+    m_index.erase(m_layouts.back().first);
+    m_layouts.pop_back();
+  }
+  m_layouts.push_front(std::make_pair(key, layout));
+  m_index.insert(std::make_pair(key, m_layouts.begin()));
+}
+
+void CGUITextLayoutCache::Clear()
+{
+  CSingleLock lock(m_section);
+  m_index.clear();
+  m_layouts.clear();
+}
+
+size_t CGUITextLayoutCache::GetSize() const
+{
+  CSingleLock lock(m_section);
+  return m_layouts.size();
+}
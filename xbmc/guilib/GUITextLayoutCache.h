@@ -0,0 +1,94 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "GUITextLayout.h"
+#include "threads/CriticalSection.h"
+
+/*!
+ \ingroup textures
+ \brief Layouts of recently shown texts, shared by all CGUITextLayouts.
+
+ Labels that come back to a text they showed before (list items scrolled back
+ into view, info labels toggling between values) take the wrapped and bidi
+ flipped lines from here instead of converting and measuring the text again.
+ As the lines are the same, the vertices cached by CGUIFontCache are reused too.
+ The cache must be cleared whenever fonts are unloaded or reloaded.
+ */
+class CGUITextLayoutCache
+{
+public:
+  struct Key
+  {
+    const CGUIFont *font;
+    std::string text;
+    float maxWidth;        // 0 if the text isn't wrapped
+    float maxHeight;
+    color_t textColor;
+    bool forceLTRReadingOrder;
+    float scaleX;          // the gui scale the text was measured at
+    float scaleY;
+
+    bool operator==(const Key &right) const;
+  };
+
+  struct Layout
+  {
+    std::vector<CGUIString> lines;
+    vecColors colors;
+    float width;
+    float height;
+  };
+  typedef std::shared_ptr<const Layout> LayoutPtr;
+
+  explicit CGUITextLayoutCache(size_t capacity = 2048);
+
+  static CGUITextLayoutCache& GetInstance();
+
+  LayoutPtr Get(const Key &key);
+  void Add(const Key &key, const LayoutPtr &layout);
+  void Clear();
+
+  size_t GetSize() const;
+  unsigned int GetHits() const { return m_hits; }
+
+private:
+  CGUITextLayoutCache(const CGUITextLayoutCache&);
+  CGUITextLayoutCache const& operator=(CGUITextLayoutCache const&);
+
+  struct KeyHash
+  {
+    size_t operator()(const Key &key) const;
+  };
+
+  typedef std::list<std::pair<Key, LayoutPtr> > LayoutList;
+
+  size_t m_capacity;
+  LayoutList m_layouts;    // most recently used first
+  std::unordered_map<Key, LayoutList::iterator, KeyHash> m_index;
+  unsigned int m_hits;
+  mutable CCriticalSection m_section;
+};
@@ -24,7 +24,6 @@
 #include "input/Key.h"
 #include "GUIControlFactory.h"
 #include "GUIControlGroup.h"
-#include "GUIControlProfiler.h"
 
 #include "addons/Skin.h"
 #include "GUIInfoManager.h"
@@ -34,6 +33,7 @@
 #include "input/ButtonTranslator.h"
 #include "utils/XMLUtils.h"
 #include "GUIAudioManager.h"
+#include "TextureManager.h"
 #include "Application.h"
 #include "messaging/ApplicationMessenger.h"
 #include "utils/Variant.h"
@@ -349,8 +349,6 @@ void CGUIWindow::DoRender()
   g_graphicsContext.AddGUITransform();
   CGUIControlGroup::DoRender();
   g_graphicsContext.RemoveTransform();
-
-  if (CGUIControlProfiler::IsRunning()) CGUIControlProfiler::Instance().EndFrame();
 }
 
 void CGUIWindow::AfterRender()
@@ -382,6 +380,7 @@ void CGUIWindow::Close_Internal(bool forceClose /*= false*/, int nextWindowID /*
       // Perform the window out effect
       QueueAnimation(ANIM_TYPE_WINDOW_CLOSE);
       m_closing = true;
+      g_infoManager.ResetCache(INFO::DEPENDS_WINDOW);
     }
     return;
   }
@@ -773,8 +772,10 @@ void CGUIWindow::AllocResources(bool forceLoad /*= FALSE */)
   slend = CurrentHostCounter();
 #endif
 
-  // and now allocate resources
+  // and now allocate resources, remembering the textures so they can be preloaded next time
+  g_TextureManager.StartRecording(GetID());
   CGUIControlGroup::AllocResources();
+  g_TextureManager.StopRecording();
 
 #ifdef _DEBUG
   int64_t end, freq;
@@ -19,6 +19,10 @@
  */
 
 #include "GUIWindowManager.h"
+
+#include <algorithm>
+#include <functional>
+
 #include "GUIAudioManager.h"
 #include "GUIDialog.h"
 #include "Application.h"
@@ -32,6 +36,8 @@
 #include "settings/Settings.h"
 #include "addons/Skin.h"
 #include "GUITexture.h"
+#include "GUIControlProfiler.h"
+#include "TextureManager.h"
 #include "utils/Variant.h"
 #include "input/Key.h"
 #include "utils/log.h"
@@ -156,6 +162,9 @@ using namespace PVR;
 using namespace PERIPHERALS;
 using namespace KODI::MESSAGING;
 
+// windows whose textures are preloaded when another window opens
+#define MAX_PRELOAD_WINDOWS 2
+
 CGUIWindowManager::CGUIWindowManager(void)
 {
   m_pCallback = NULL;
@@ -592,7 +601,10 @@ void CGUIWindowManager::RegisterDialog(CGUIWindow* dialog)
     if (activeDialog->GetID() == dialog->GetID())
       return;
   }
+  int topWindow = m_activeDialogs.empty() ? GetActiveWindow() : m_activeDialogs.back()->GetID();
   m_activeDialogs.push_back(dialog);
+  g_infoManager.ResetCache(INFO::DEPENDS_WINDOW);
+  PreloadNextWindows(topWindow, dialog->GetID());
 }
 
 void CGUIWindowManager::Remove(int id)
@@ -605,7 +617,10 @@ void CGUIWindowManager::Remove(int id)
     for(std::vector<CGUIWindow*>::iterator it2 = m_activeDialogs.begin(); it2 != m_activeDialogs.end();)
     {
       if(*it2 == it->second)
+      {
         it2 = m_activeDialogs.erase(it2);
+        g_infoManager.ResetCache(INFO::DEPENDS_WINDOW);
+      }
       else
         ++it2;
     }
@@ -702,6 +717,7 @@ void CGUIWindowManager::PreviousWindow()
 
   // remove the current window off our window stack
   m_windowHistory.pop();
+  g_infoManager.ResetCache(INFO::DEPENDS_WINDOW);
 
   // ok, initialize the new window
   CLog::Log(LOGDEBUG,"CGUIWindowManager::PreviousWindow: Activate new");
@@ -835,6 +851,8 @@ void CGUIWindowManager::ActivateWindow_Internal(int iWindowID, const std::vector
   msg.SetStringParams(params);
   pNewWindow->OnMessage(msg);
 //  g_infoManager.SetPreviousWindow(WINDOW_INVALID);
+
+  PreloadNextWindows(currentWindow, iWindowID);
 }
 
 void CGUIWindowManager::CloseDialogs(bool forceClose) const
@@ -1137,6 +1155,9 @@ void CGUIWindowManager::AfterRender()
 {
   m_tracker.CleanMarkedRegions();
 
+  // all windows and dialogs are processed and rendered for this frame
+  if (CGUIControlProfiler::IsRunning()) CGUIControlProfiler::Instance().EndFrame();
+
   CGUIWindow* pWindow = GetWindow(GetActiveWindow());
   if (pWindow)
     pWindow->AfterRender();
@@ -1247,6 +1268,7 @@ void CGUIWindowManager::DeInitialize()
   // clear our vectors of windows
   m_vecCustomWindows.clear();
   m_activeDialogs.clear();
+  g_infoManager.ResetCache(INFO::DEPENDS_WINDOW);
 
   m_initialized = false;
 }
@@ -1261,6 +1283,7 @@ void CGUIWindowManager::RemoveDialog(int id)
     if ((*it)->GetID() == id)
     {
       m_activeDialogs.erase(it);
+      g_infoManager.ResetCache(INFO::DEPENDS_WINDOW);
       return;
     }
   }
@@ -1526,6 +1549,25 @@ void CGUIWindowManager::UnloadNotOnDemandWindows()
   }
 }
 
+void CGUIWindowManager::PreloadNextWindows(int fromWindowID, int toWindowID)
+{
+  if (fromWindowID != WINDOW_INVALID && fromWindowID != toWindowID)
+    m_windowTransitions[fromWindowID][toWindowID]++;
+
+  WindowTransitions::const_iterator transitions = m_windowTransitions.find(toWindowID);
+  if (transitions == m_windowTransitions.end())
+    return;
+
+  // the windows most often opened next are the likely ones
+  std::vector<std::pair<unsigned int, int> > next;
+  for (std::map<int, unsigned int>::const_iterator i = transitions->second.begin(); i != transitions->second.end(); ++i)
+    next.push_back(std::make_pair(i->second, i->first));
+  std::sort(next.begin(), next.end(), std::greater<std::pair<unsigned int, int> >());
+
+  for (unsigned int i = 0; i < next.size() && i < MAX_PRELOAD_WINDOWS; i++)
+    g_TextureManager.PreloadWindow(next[i].second);
+}
+
 void CGUIWindowManager::AddToWindowHistory(int newWindowID)
 {
   // Check the window stack to see if this window is in our history,
@@ -1548,6 +1590,7 @@ void CGUIWindowManager::AddToWindowHistory(int newWindowID)
     // but do not add the splash window to history, as we never want to travel back to it
     m_windowHistory.push(newWindowID);
   }
+  g_infoManager.ResetCache(INFO::DEPENDS_WINDOW);
 }
 
 void CGUIWindowManager::GetActiveModelessWindows(std::vector<int> &ids)
@@ -1596,6 +1639,7 @@ void CGUIWindowManager::ClearWindowHistory()
 {
   while (!m_windowHistory.empty())
     m_windowHistory.pop();
+  g_infoManager.ResetCache(INFO::DEPENDS_WINDOW);
 }
 
 void CGUIWindowManager::CloseWindowSync(CGUIWindow *window, int nextWindowID /*= 0*/)
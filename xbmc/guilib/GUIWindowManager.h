@@ -107,6 +107,7 @@ public:
   /*! \brief Get the current dirty region
    */
   CDirtyRegionList GetDirty() { return m_tracker.GetDirtyRegions(); }
+  std::string GetDirtyRegionInfo() const { return m_tracker.GetDebugInfo(); }
 
   /*! \brief Rendering of the current window and any dialogs
    Render is called every frame to draw the current window and any dialogs.
@@ -168,6 +169,7 @@ public:
   bool HasModalDialog(const std::vector<DialogModalityType>& types = std::vector<DialogModalityType>(), bool ignoreClosing = true) const;
   bool HasVisibleModalDialog(const std::vector<DialogModalityType>& types = std::vector<DialogModalityType>()) const;
   bool HasDialogOnScreen() const;
+
   bool IsWindowActive(int id, bool ignoreClosing = true) const;
   bool IsWindowVisible(int id) const;
   bool IsWindowTopMost(int id) const;
@@ -195,6 +197,13 @@ private:
   void UnloadNotOnDemandWindows();
   void AddToWindowHistory(int newWindowID);
   void ClearWindowHistory();
+
+  /*! \brief Counts the switch to a window and preloads the textures of the windows usually opened from it.
+   *
+   * \param fromWindowID The window or dialog that was on top before.
+   * \param toWindowID The window or dialog that is opened.
+   */
+  void PreloadNextWindows(int fromWindowID, int toWindowID);
   void CloseWindowSync(CGUIWindow *window, int nextWindowID = 0);
   CGUIWindow *GetTopMostDialog() const;
 
@@ -222,6 +231,8 @@ private:
   typedef std::vector<CGUIWindow*>::const_reverse_iterator crDialog;
 
   std::stack<int> m_windowHistory;
+  typedef std::map<int, std::map<int, unsigned int> > WindowTransitions;
+  WindowTransitions m_windowTransitions;  ///< how often a window was opened from another one
 
   IWindowManagerCallback* m_pCallback;
   std::list < std::pair<CGUIMessage*,int> > m_vecThreadMessages;
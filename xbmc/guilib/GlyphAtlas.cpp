@@ -0,0 +1,203 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GlyphAtlas.h"
+
+#include <string.h>
+
+#include "threads/SingleLock.h"
+
+// shelf heights are rounded up to this, so glyphs of similar height share them
+#define SHELF_ROUNDING 4
+
+CGlyphAtlas::CGlyphAtlas(unsigned int width, unsigned int height)
+  : m_width(width),
+    m_height(height),
+    m_clock(0),
+    m_evictedShelves(0)
+{
+}
+
+CGlyphAtlas& CGlyphAtlas::GetInstance()
+{
+  static CGlyphAtlas sGlyphAtlas;
+  return sGlyphAtlas;
+}
+
+uint64_t CGlyphAtlas::GetKey(unsigned int font, uint32_t letterAndStyle)
+{
+  return (static_cast<uint64_t>(font) << 32) | letterAndStyle;
+}
+
+unsigned int CGlyphAtlas::GetFontId(const std::string &key)
+{
+  CSingleLock lock(m_section);
+  auto font = m_fonts.find(key);
+  if (font != m_fonts.end())
+    return font->second;
+
+  unsigned int id = static_cast<unsigned int>(m_fonts.size());
+  m_fonts.insert(std::make_pair(key, id));
+  return id;
+}
+
+void CGlyphAtlas::EvictShelf(Shelf &shelf)
+{
+  for (uint64_t key : shelf.glyphs)
+    m_glyphs.erase(key);
+  shelf.glyphs.clear();
+  shelf.used = 0;
+  m_evictedShelves++;
+}
+
+int CGlyphAtlas::FindShelf(unsigned int width, unsigned int rows, bool evict)
+{
+  // the lowest shelf with room that doesn't waste too much of its height
+  unsigned int maxHeight = rows + rows / 2 + SHELF_ROUNDING;
+  int best = -1;
+  for (size_t i = 0; i < m_shelves.size(); i++)
+  {
+    const Shelf &shelf = m_shelves[i];
+    if (shelf.height >= rows && shelf.height <= maxHeight && shelf.used + width <= m_width &&
+        (best < 0 || shelf.height < m_shelves[best].height))
+      best = static_cast<int>(i);
+  }
+  if (best >= 0)
+    return best;
+
+  // open a new shelf below the others
+  unsigned int bottom = m_shelves.empty() ? 0 : m_shelves.back().y + m_shelves.back().height;
+  if (bottom + rows <= m_height)
+  {
+    Shelf shelf;
+    shelf.y = bottom;
+    shelf.height = std::min((rows + SHELF_ROUNDING - 1) / SHELF_ROUNDING * SHELF_ROUNDING, m_height - bottom);
+    shelf.used = 0;
+    shelf.lastUsed = m_clock;
+    m_shelves.push_back(shelf);
+    return static_cast<int>(m_shelves.size() - 1);
+  }
+
+  // any shelf with room
+  for (size_t i = 0; i < m_shelves.size(); i++)
+  {
+    const Shelf &shelf = m_shelves[i];
+    if (shelf.height >= rows && shelf.used + width <= m_width &&
+        (best < 0 || shelf.height < m_shelves[best].height))
+      best = static_cast<int>(i);
+  }
+  if (best >= 0 || !evict)
+    return best;
+
+  // empty the least recently used shelf that is tall enough
+  for (size_t i = 0; i < m_shelves.size(); i++)
+  {
+    if (m_shelves[i].height >= rows && (best < 0 || m_shelves[i].lastUsed < m_shelves[best].lastUsed))
+      best = static_cast<int>(i);
+  }
+  if (best >= 0)
+    EvictShelf(m_shelves[best]);
+  return best;
+}
+
+bool CGlyphAtlas::Add(unsigned int font, uint32_t letterAndStyle, const Glyph &glyph, const unsigned char *pixels, unsigned int pitch, bool evict)
+{
+  if (glyph.width > m_width || glyph.rows > m_height)
+    return false;
+
+  CSingleLock lock(m_section);
+  uint64_t key = GetKey(font, letterAndStyle);
+  if (m_glyphs.find(key) != m_glyphs.end())
+    return true;
+
+  Entry entry;
+  entry.glyph = glyph;
+  entry.shelf = -1;
+  entry.x = 0;
+  if (glyph.width > 0 && glyph.rows > 0)
+  {
+    entry.shelf = FindShelf(glyph.width, glyph.rows, evict);
+    if (entry.shelf < 0)
+      return false;
+
+    if (m_pixels.empty())
+      m_pixels.resize(m_width * m_height);
+
+    Shelf &shelf = m_shelves[entry.shelf];
+    entry.x = shelf.used;
+    shelf.used += glyph.width;
+    shelf.lastUsed = ++m_clock;
+    shelf.glyphs.push_back(key);
+
+    unsigned char *target = &m_pixels[shelf.y * m_width + entry.x];
+    for (unsigned int y = 0; y < glyph.rows; y++)
+    {
+      memcpy(target, pixels, glyph.width);
+      pixels += pitch;
+      target += m_width;
+    }
+  }
+  m_glyphs.insert(std::make_pair(key, entry));
+  return true;
+}
+
+bool CGlyphAtlas::Get(unsigned int font, uint32_t letterAndStyle, Glyph &glyph, std::vector<unsigned char> &pixels)
+{
+  CSingleLock lock(m_section);
+  auto entry = m_glyphs.find(GetKey(font, letterAndStyle));
+  if (entry == m_glyphs.end())
+    return false;
+
+  glyph = entry->second.glyph;
+  pixels.resize(glyph.width * glyph.rows);
+  if (entry->second.shelf < 0)
+    return true;
+
+  Shelf &shelf = m_shelves[entry->second.shelf];
+  shelf.lastUsed = ++m_clock;
+  const unsigned char *source = &m_pixels[shelf.y * m_width + entry->second.x];
+  for (unsigned int y = 0; y < glyph.rows; y++)
+  {
+    memcpy(&pixels[y * glyph.width], source, glyph.width);
+    source += m_width;
+  }
+  return true;
+}
+
+bool CGlyphAtlas::Has(unsigned int font, uint32_t letterAndStyle) const
+{
+  CSingleLock lock(m_section);
+  return m_glyphs.find(GetKey(font, letterAndStyle)) != m_glyphs.end();
+}
+
+void CGlyphAtlas::Clear()
+{
+  // font ids stay valid, fonts that are loaded keep using them
+  CSingleLock lock(m_section);
+  m_glyphs.clear();
+  m_shelves.clear();
+  std::vector<unsigned char>().swap(m_pixels);
+}
+
+size_t CGlyphAtlas::GetGlyphCount() const
+{
+  CSingleLock lock(m_section);
+  return m_glyphs.size();
+}
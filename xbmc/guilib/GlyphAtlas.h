@@ -0,0 +1,115 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "threads/CriticalSection.h"
+
+/*!
+ \ingroup textures
+ \brief Rasterized glyphs of all loaded fonts, shared between threads.
+
+ Glyph bitmaps are packed into one 8bit alpha image in shelves (rows of glyphs
+ of similar height). When the image is full the least recently used shelf is
+ emptied and reused. Fonts copy glyphs from here into their own texture, so
+ glyphs rasterized in the background only cost a copy on the render thread.
+ */
+class CGlyphAtlas
+{
+public:
+  struct Glyph
+  {
+    Glyph() : left(0), top(0), width(0), rows(0), advance(0.0f) {}
+
+    int left;             // offset of the bitmap from the pen position
+    int top;              // distance from the baseline to the top row of the bitmap
+    unsigned int width;
+    unsigned int rows;
+    float advance;
+  };
+
+  CGlyphAtlas(unsigned int width = 2048, unsigned int height = 2048);
+
+  static CGlyphAtlas& GetInstance();
+
+  /*!
+   \brief Gets the id under which the glyphs of a font are stored.
+   \param key identifies the font file and everything that changes its rasterization
+   */
+  unsigned int GetFontId(const std::string &key);
+
+  /*!
+   \brief Stores a glyph.
+   \param pixels the bitmap of the glyph, rows of pitch bytes
+   \param evict whether older glyphs may be dropped to make room
+   \return false if the glyph doesn't fit
+   */
+  bool Add(unsigned int font, uint32_t letterAndStyle, const Glyph &glyph, const unsigned char *pixels, unsigned int pitch, bool evict = true);
+
+  /*!
+   \brief Gets a glyph and marks it as used.
+   \param pixels receives the bitmap of the glyph, rows of glyph.width bytes
+   */
+  bool Get(unsigned int font, uint32_t letterAndStyle, Glyph &glyph, std::vector<unsigned char> &pixels);
+  bool Has(unsigned int font, uint32_t letterAndStyle) const;
+
+  void Clear();
+  size_t GetGlyphCount() const;
+  unsigned int GetEvictedShelves() const { return m_evictedShelves; }
+
+private:
+  CGlyphAtlas(const CGlyphAtlas&);
+  CGlyphAtlas const& operator=(CGlyphAtlas const&);
+
+  struct Shelf
+  {
+    unsigned int y;
+    unsigned int height;
+    unsigned int used;    // width taken by glyphs
+    uint64_t lastUsed;
+    std::vector<uint64_t> glyphs;
+  };
+
+  struct Entry
+  {
+    Glyph glyph;
+    int shelf;            // -1 for glyphs without pixels
+    unsigned int x;
+  };
+
+  static uint64_t GetKey(unsigned int font, uint32_t letterAndStyle);
+  int FindShelf(unsigned int width, unsigned int rows, bool evict);
+  void EvictShelf(Shelf &shelf);
+
+  unsigned int m_width;
+  unsigned int m_height;
+  std::vector<unsigned char> m_pixels;
+  std::vector<Shelf> m_shelves;
+  std::unordered_map<uint64_t, Entry> m_glyphs;
+  std::map<std::string, unsigned int> m_fonts;
+  uint64_t m_clock;
+  unsigned int m_evictedShelves;
+  mutable CCriticalSection m_section;
+};
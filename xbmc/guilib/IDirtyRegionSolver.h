@@ -25,6 +25,7 @@
 #define DIRTYREGION_SOLVER_UNION 1
 #define DIRTYREGION_SOLVER_COST_REDUCTION 2
 #define DIRTYREGION_SOLVER_FILL_VIEWPORT_ON_CHANGE 3
+#define DIRTYREGION_SOLVER_COST_MODEL 4
 
 class IDirtyRegionSolver
 {
@@ -33,4 +34,7 @@ public:
 
   // Takes a number of dirty regions which will become a number of needed rendering passes.
   virtual void Solve(const CDirtyRegionList &input, CDirtyRegionList &output) = 0;
+
+  // Describes how the last solution was found, for the debug overlay.
+  virtual const char *GetDecision() const { return NULL; }
 };
@@ -31,6 +31,9 @@
 #include "threads/SingleLock.h"
 #include "utils/StringUtils.h"
 
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
 
 /*! \brief Tries to load ids and strings from a strings.xml file to the `strings` map..
  * It should only be called from the LoadStr2Mem function to try a PO file first.
@@ -264,6 +267,36 @@ const std::string& CLocalizeStrings::Get(uint32_t dwCode) const
   return i->second.strTranslated;
 }
 
+std::wstring CLocalizeStrings::GetCharacters() const
+{
+  std::unordered_map<wchar_t, unsigned int> counts;
+  {
+    CSharedLock lock(m_stringsMutex);
+    std::wstring text;
+    for (const auto& string : m_strings)
+    {
+      g_charsetConverter.utf8ToW(string.second.strTranslated, text, false);
+      for (wchar_t letter : text)
+        counts[letter]++;
+    }
+  }
+
+  std::vector<std::pair<unsigned int, wchar_t>> order;
+  order.reserve(counts.size());
+  for (const auto& count : counts)
+    order.push_back(std::make_pair(count.second, count.first));
+  std::sort(order.begin(), order.end(), [](const std::pair<unsigned int, wchar_t> &a, const std::pair<unsigned int, wchar_t> &b)
+  {
+    return a.first != b.first ? a.first > b.first : a.second < b.second;
+  });
+
+  std::wstring characters;
+  characters.reserve(order.size());
+  for (const auto& letter : order)
+    characters.push_back(letter.second);
+  return characters;
+}
+
 void CLocalizeStrings::Clear()
 {
   CExclusiveLock lock(m_stringsMutex);
@@ -63,6 +63,11 @@ public:
   std::string GetAddonString(const std::string& addonId, uint32_t code);
   void Clear();
 
+  /*!
+   \brief Gets the characters the loaded strings are made of, most frequent first.
+   */
+  std::wstring GetCharacters() const;
+
 protected:
   void Clear(uint32_t start, uint32_t end);
 
@@ -67,6 +67,16 @@ bool CTextureBundle::LoadTexture(const std::string& Filename, CBaseTexture** ppT
   return false;
 }
 
+bool CTextureBundle::GetFrame(const std::string& Filename, std::shared_ptr<CXBTFReader>& reader, CXBTFFrame& frame)
+{
+  if (m_useXBT)
+  {
+    return m_tbXBT.GetFrame(Filename, reader, frame);
+  }
+
+  return false;
+}
+
 int CTextureBundle::LoadAnim(const std::string& Filename, CBaseTexture*** ppTextures,
                               int &width, int &height, int& nLoops, int** ppDelays)
 {
@@ -37,6 +37,7 @@ public:
   static std::string Normalize(const std::string &name);
 
   bool LoadTexture(const std::string& Filename, CBaseTexture** ppTexture, int &width, int &height);
+  bool GetFrame(const std::string& Filename, std::shared_ptr<CXBTFReader>& reader, CXBTFFrame& frame);
 
   int LoadAnim(const std::string& Filename, CBaseTexture*** ppTextures, int &width, int &height, int& nLoops, int** ppDelays);
 
@@ -210,54 +210,52 @@ int CTextureBundleXBT::LoadAnim(const std::string& Filename, CBaseTexture*** ppT
   return nTextures;
 }
 
-bool CTextureBundleXBT::ConvertFrameToTexture(const std::string& name, CXBTFFrame& frame, CBaseTexture** ppTexture)
+bool CTextureBundleXBT::ConvertFrameToTexture(const std::string& name, const CXBTFFrame& frame, CBaseTexture** ppTexture)
 {
-  // found texture - allocate the necessary buffers
-  unsigned char *buffer = new unsigned char [(size_t)frame.GetPackedSize()];
-  if (buffer == NULL)
+  *ppTexture = DecodeFrame(*m_XBTFReader, frame);
+  if (*ppTexture == nullptr)
   {
-    CLog::Log(LOGERROR, "Out of memory loading texture: %s (need %" PRIu64" bytes)", name.c_str(), frame.GetPackedSize());
+    CLog::Log(LOGERROR, "Error loading texture: %s", name.c_str());
     return false;
   }
 
-  // load the compressed texture
-  if (!m_XBTFReader->Load(frame, buffer))
-  {
-    CLog::Log(LOGERROR, "Error loading texture: %s", name.c_str());
-    delete[] buffer;
+  return true;
+}
+
+bool CTextureBundleXBT::GetFrame(const std::string& Filename, std::shared_ptr<CXBTFReader>& reader, CXBTFFrame& frame)
+{
+  if (m_XBTFReader == nullptr)
     return false;
-  }
 
-  // check if it's packed with lzo
-  if (frame.IsPacked())
-  { // unpack
-    unsigned char *unpacked = new unsigned char[(size_t)frame.GetUnpackedSize()];
-    if (unpacked == NULL)
-    {
-      CLog::Log(LOGERROR, "Out of memory unpacking texture: %s (need %" PRIu64" bytes)", name.c_str(), frame.GetUnpackedSize());
-      delete[] buffer;
-      return false;
-    }
-    lzo_uint s = (lzo_uint)frame.GetUnpackedSize();
-    if (lzo1x_decompress_safe(buffer, (lzo_uint)frame.GetPackedSize(), unpacked, &s, NULL) != LZO_E_OK ||
-        s != frame.GetUnpackedSize())
-    {
-      CLog::Log(LOGERROR, "Error loading texture: %s: Decompression error", name.c_str());
-      delete[] buffer;
-      delete[] unpacked;
-      return false;
-    }
-    delete[] buffer;
-    buffer = unpacked;
+  CXBTFFile file;
+  if (!m_XBTFReader->Get(Normalize(Filename), file) || file.GetFrames().empty())
+    return false;
+
+  reader = m_XBTFReader;
+  frame = file.GetFrames().at(0);
+  return true;
+}
+
+CBaseTexture* CTextureBundleXBT::DecodeFrame(const CXBTFReader& reader, const CXBTFFrame& frame)
+{
+  // unpacked frames are copied straight from the mapped bundle into the texture
+  uint8_t* buffer = nullptr;
+  const uint8_t* pixels = frame.IsPacked() ? nullptr : reader.GetFrameData(frame);
+  if (pixels == nullptr)
+  {
+    buffer = UnpackFrame(reader, frame);
+    if (buffer == nullptr)
+      return nullptr;
+    pixels = buffer;
   }
 
   // create an xbmc texture
-  *ppTexture = new CTexture();
-  (*ppTexture)->LoadFromMemory(frame.GetWidth(), frame.GetHeight(), 0, frame.GetFormat(), frame.HasAlpha(), buffer);
+  CBaseTexture* texture = new CTexture();
+  texture->LoadFromMemory(frame.GetWidth(), frame.GetHeight(), 0, frame.GetFormat(), frame.HasAlpha(), pixels);
 
   delete[] buffer;
 
-  return true;
+  return texture;
 }
 
 void CTextureBundleXBT::SetThemeBundle(bool themeBundle)
@@ -280,38 +278,32 @@ std::string CTextureBundleXBT::Normalize(const std::string &name)
 
 uint8_t* CTextureBundleXBT::UnpackFrame(const CXBTFReader& reader, const CXBTFFrame& frame)
 {
-  uint8_t* packedBuffer = new uint8_t[static_cast<size_t>(frame.GetPackedSize())];
+  // the packed data is read in place from the mapped bundle
+  const uint8_t* packedBuffer = reader.GetFrameData(frame);
   if (packedBuffer == nullptr)
   {
-    CLog::Log(LOGERROR, "CTextureBundleXBT: out of memory loading frame with %" PRIu64" packed bytes", frame.GetPackedSize());
+    CLog::Log(LOGERROR, "CTextureBundleXBT: error loading frame");
     return nullptr;
   }
 
-  // load the compressed texture
-  if (!reader.Load(frame, packedBuffer))
+  uint8_t* unpackedBuffer = new uint8_t[static_cast<size_t>(frame.GetUnpackedSize())];
+  if (unpackedBuffer == nullptr)
   {
-    CLog::Log(LOGERROR, "CTextureBundleXBT: error loading frame");
-    delete[] packedBuffer;
+    CLog::Log(LOGERROR, "CTextureBundleXBT: out of memory loading frame with %" PRIu64" unpacked bytes", frame.GetPackedSize());
     return nullptr;
   }
 
   // if the frame isn't packed there's nothing else to be done
   if (!frame.IsPacked())
-    return packedBuffer;
-
-  uint8_t* unpackedBuffer = new uint8_t[static_cast<size_t>(frame.GetUnpackedSize())];
-  if (unpackedBuffer == nullptr)
   {
-    CLog::Log(LOGERROR, "CTextureBundleXBT: out of memory loading frame with %" PRIu64" unpacked bytes", frame.GetPackedSize());
-    delete[] packedBuffer;
-    return nullptr;
+    memcpy(unpackedBuffer, packedBuffer, static_cast<size_t>(frame.GetUnpackedSize()));
+    return unpackedBuffer;
   }
 
   // make sure lzo is initialized
   if (lzo_init() != LZO_E_OK)
   {
     CLog::Log(LOGERROR, "CTextureBundleXBT: failed to initialize lzo");
-    delete[] packedBuffer;
     delete[] unpackedBuffer;
     return nullptr;
   }
@@ -320,12 +312,9 @@ uint8_t* CTextureBundleXBT::UnpackFrame(const CXBTFReader& reader, const CXBTFFr
   if (lzo1x_decompress_safe(packedBuffer, static_cast<lzo_uint>(frame.GetPackedSize()), unpackedBuffer, &size, nullptr) != LZO_E_OK || size != frame.GetUnpackedSize())
   {
     CLog::Log(LOGERROR, "CTextureBundleXBT: failed to decompress frame with %" PRIu64" unpacked bytes to %" PRIu64" bytes", frame.GetPackedSize(), frame.GetUnpackedSize());
-    delete[] packedBuffer;
     delete[] unpackedBuffer;
     return nullptr;
   }
 
-  delete[] packedBuffer;
-
   return unpackedBuffer;
 }
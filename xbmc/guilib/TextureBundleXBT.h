@@ -25,9 +25,10 @@
 #include <string>
 #include <vector>
 
+#include "XBTF.h"
+
 class CBaseTexture;
 class CXBTFReader;
-class CXBTFFrame;
 
 class CTextureBundleXBT
 {
@@ -49,9 +50,19 @@ public:
 
   static uint8_t* UnpackFrame(const CXBTFReader& reader, const CXBTFFrame& frame);
 
+  /*!
+   \brief Gets the reader and first frame of a texture, to decode it later with DecodeFrame().
+   */
+  bool GetFrame(const std::string& Filename, std::shared_ptr<CXBTFReader>& reader, CXBTFFrame& frame);
+
+  /*!
+   \brief Loads and unpacks a frame into a new texture, can be called from any thread.
+   */
+  static CBaseTexture* DecodeFrame(const CXBTFReader& reader, const CXBTFFrame& frame);
+
 private:
   bool OpenBundle();
-  bool ConvertFrameToTexture(const std::string& name, CXBTFFrame& frame, CBaseTexture** ppTexture);
+  bool ConvertFrameToTexture(const std::string& name, const CXBTFFrame& frame, CBaseTexture** ppTexture);
 
   time_t m_TimeStamp;
 
@@ -31,6 +31,7 @@
 #include "threads/SingleLock.h"
 #include "threads/SystemClock.h"
 #include "URL.h"
+#include "utils/JobManager.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
@@ -43,6 +44,18 @@
 #endif
 #include "FFmpegImage.h"
 
+// decoded textures kept around for windows that may open next
+#define PRELOAD_MEMORY_LIMIT     (64 * 1024 * 1024)
+// preloaded textures not taken over within this time (ms) belong to a window that didn't open
+#define PRELOAD_EXPIRY_TIME      30000
+// preloaded textures uploaded to the GPU per frame, at least one is uploaded
+#define UPLOAD_BUDGET_PER_FRAME  (4 * 1024 * 1024)
+
+static unsigned int GetTextureSize(const CBaseTexture *texture)
+{
+  return texture->GetPitch() * texture->GetRows();
+}
+
 /************************************************************************/
 /*                                                                      */
 /************************************************************************/
@@ -220,10 +233,50 @@ void CTextureMap::Add(CBaseTexture* texture, int delay)
     m_memUsage += sizeof(CTexture) + (texture->GetTextureWidth() * texture->GetTextureHeight() * 4);
 }
 
+/************************************************************************/
+/*                                                                      */
+/************************************************************************/
+CTextureDecodeJob::CTextureDecodeJob(const std::string &name, const std::string &path)
+  : m_name(name),
+    m_path(path),
+    m_texture(nullptr)
+{
+}
+
+CTextureDecodeJob::CTextureDecodeJob(const std::string &name, const std::shared_ptr<CXBTFReader> &reader, const CXBTFFrame &frame)
+  : m_name(name),
+    m_reader(reader),
+    m_frame(frame),
+    m_texture(nullptr)
+{
+}
+
+CTextureDecodeJob::~CTextureDecodeJob()
+{
+  delete m_texture;
+}
+
+bool CTextureDecodeJob::DoWork()
+{
+  if (m_reader)
+    m_texture = CTextureBundleXBT::DecodeFrame(*m_reader, m_frame);
+  else
+    m_texture = CBaseTexture::LoadFromFile(m_path);
+  return m_texture != nullptr;
+}
+
+CBaseTexture *CTextureDecodeJob::TakeTexture()
+{
+  CBaseTexture *texture = m_texture;
+  m_texture = nullptr;
+  return texture;
+}
+
 /************************************************************************/
 /*                                                                      */
 /************************************************************************/
 CGUITextureManager::CGUITextureManager(void)
+  : m_preloadedSize(0)
 {
   // we set the theme bundle to be the first bundle (thus prioritizing it)
   m_TexBundle[0].SetThemeBundle(true);
@@ -305,6 +358,12 @@ const CTextureArray& CGUITextureManager::Load(const std::string& strTextureName,
   if (!HasTexture(strTextureName, &strPath, &bundle, &size))
     return emptyTexture;
 
+  {
+    CSingleLock lock(m_preloadSection);
+    if (!m_recordingWindows.empty())
+      m_windowTextures[m_recordingWindows.back()].insert(strTextureName);
+  }
+
   if (size) // we found the texture
   {
     for (int i = 0; i < (int)m_vecTextures.size(); ++i)
@@ -436,9 +495,14 @@ const CTextureArray& CGUITextureManager::Load(const std::string& strTextureName,
     return pMap->GetTexture();
   }
 
-  CBaseTexture *pTexture = NULL;
+  CBaseTexture *pTexture = TakePreloaded(strTextureName);
   int width = 0, height = 0;
-  if (bundle >= 0)
+  if (pTexture)
+  {
+    width = pTexture->GetWidth();
+    height = pTexture->GetHeight();
+  }
+  else if (bundle >= 0)
   {
     if (!m_TexBundle[bundle].LoadTexture(strTextureName, &pTexture, width, height))
     {
@@ -549,11 +613,230 @@ void CGUITextureManager::Cleanup()
     i = m_vecTextures.erase(i);
   }
 
+  ClearPreloaded();
+  {
+    CSingleLock preloadLock(m_preloadSection);
+    m_windowTextures.clear();
+  }
+
   m_TexBundle[0] = CTextureBundle(true);
   m_TexBundle[1] = CTextureBundle();
   FreeUnusedTextures();
 }
 
+void CGUITextureManager::Preload(const std::string& strTextureName, int windowID)
+{
+  // animated textures are decoded frame by frame while loading
+  if (StringUtils::EndsWithNoCase(strTextureName, ".gif") ||
+      StringUtils::EndsWithNoCase(strTextureName, ".apng"))
+    return;
+
+  std::string strPath;
+  int bundle = -1;
+  int size = 0;
+  if (!HasTexture(strTextureName, &strPath, &bundle, &size) || size)
+    return;
+
+  // the unused textures are guarded by the graphics context, see ReleaseTexture()
+  CSingleLock graphicsLock(g_graphicsContext);
+  for (ilistUnused i = m_unusedTextures.begin(); i != m_unusedTextures.end(); ++i)
+  {
+    if (i->first->GetName() == strTextureName)
+      return;
+  }
+
+  CSingleLock lock(m_preloadSection);
+  if (m_preloading.find(strTextureName) != m_preloading.end())
+    return;
+  for (std::list<PreloadedTexture>::const_iterator i = m_preloaded.begin(); i != m_preloaded.end(); ++i)
+  {
+    if (i->name == strTextureName)
+      return;
+  }
+
+  CTextureDecodeJob *job;
+  if (bundle >= 0)
+  {
+    std::shared_ptr<CXBTFReader> reader;
+    CXBTFFrame frame;
+    if (!m_TexBundle[bundle].GetFrame(strTextureName, reader, frame))
+      return;
+    job = new CTextureDecodeJob(strTextureName, reader, frame);
+  }
+  else
+    job = new CTextureDecodeJob(strTextureName, strPath);
+
+  PendingTexture pending;
+  pending.jobID = CJobManager::GetInstance().AddJob(job, this, CJob::PRIORITY_LOW);
+  pending.windowID = windowID;
+  m_preloading[strTextureName] = pending;
+}
+
+void CGUITextureManager::PreloadWindow(int windowID)
+{
+  std::set<std::string> textures;
+  {
+    CSingleLock lock(m_preloadSection);
+    std::map<int, std::set<std::string> >::const_iterator window = m_windowTextures.find(windowID);
+    if (window == m_windowTextures.end())
+      return;
+    textures = window->second;
+  }
+
+  for (std::set<std::string>::const_iterator i = textures.begin(); i != textures.end(); ++i)
+    Preload(*i, windowID);
+}
+
+void CGUITextureManager::StartRecording(int windowID)
+{
+  CSingleLock lock(m_preloadSection);
+  m_recordingWindows.push_back(windowID);
+  m_windowTextures[windowID].clear();
+}
+
+void CGUITextureManager::StopRecording()
+{
+  // textures are deleted without holding the lock, deleting takes the graphics
+  // context, which is taken before m_preloadSection everywhere else
+  std::vector<CBaseTexture*> dropped;
+  {
+    CSingleLock lock(m_preloadSection);
+    if (m_recordingWindows.empty())
+      return;
+    int windowID = m_recordingWindows.back();
+    m_recordingWindows.pop_back();
+
+    // the window is loaded, what it didn't take over of its preloaded textures isn't needed
+    for (std::map<std::string, PendingTexture>::iterator i = m_preloading.begin(); i != m_preloading.end();)
+    {
+      if (i->second.windowID == windowID)
+      {
+        CJobManager::GetInstance().CancelJob(i->second.jobID);
+        i = m_preloading.erase(i);
+      }
+      else
+        ++i;
+    }
+    for (std::list<PreloadedTexture>::iterator i = m_preloaded.begin(); i != m_preloaded.end();)
+    {
+      if (i->windowID == windowID)
+        i = DropPreloaded(i, dropped);
+      else
+        ++i;
+    }
+  }
+
+  for (std::vector<CBaseTexture*>::iterator i = dropped.begin(); i != dropped.end(); ++i)
+    delete *i;
+}
+
+void CGUITextureManager::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  CTextureDecodeJob *decodeJob = static_cast<CTextureDecodeJob*>(job);
+
+  CSingleLock lock(m_preloadSection);
+  // the job may have been cancelled after it finished decoding
+  std::map<std::string, PendingTexture>::iterator pending = m_preloading.find(decodeJob->GetName());
+  if (pending == m_preloading.end() || pending->second.jobID != jobID)
+    return;
+  int windowID = pending->second.windowID;
+  m_preloading.erase(pending);
+
+  if (!success)
+  {
+    CLog::Log(LOGDEBUG, "%s - unable to preload %s", __FUNCTION__, decodeJob->GetName().c_str());
+    return;
+  }
+
+  PreloadedTexture preloaded;
+  preloaded.name = decodeJob->GetName();
+  preloaded.texture = decodeJob->TakeTexture();
+  preloaded.windowID = windowID;
+  preloaded.time = XbmcThreads::SystemClockMillis();
+  preloaded.uploaded = false;
+  m_preloadedSize += GetTextureSize(preloaded.texture);
+  m_preloaded.push_back(preloaded);
+}
+
+void CGUITextureManager::UploadPreloaded()
+{
+  CSingleLock graphicsLock(g_graphicsContext);
+  CSingleLock lock(m_preloadSection);
+
+  // drop the textures of windows that didn't open in time, and the oldest
+  // ones if the guess was wrong too often
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  std::vector<CBaseTexture*> dropped;
+  while (!m_preloaded.empty() &&
+         (m_preloadedSize > PRELOAD_MEMORY_LIMIT || now - m_preloaded.front().time >= PRELOAD_EXPIRY_TIME))
+    DropPreloaded(m_preloaded.begin(), dropped);
+  for (std::vector<CBaseTexture*>::iterator i = dropped.begin(); i != dropped.end(); ++i)
+    delete *i;
+
+  unsigned int uploaded = 0;
+  for (std::list<PreloadedTexture>::iterator i = m_preloaded.begin(); i != m_preloaded.end(); ++i)
+  {
+    if (i->uploaded)
+      continue;
+
+    unsigned int size = GetTextureSize(i->texture);
+    if (uploaded > 0 && uploaded + size > UPLOAD_BUDGET_PER_FRAME)
+      break;
+
+    i->texture->LoadToGPU();
+    i->uploaded = true;
+    uploaded += size;
+  }
+}
+
+CBaseTexture* CGUITextureManager::TakePreloaded(const std::string& strTextureName)
+{
+  CSingleLock lock(m_preloadSection);
+  for (std::list<PreloadedTexture>::iterator i = m_preloaded.begin(); i != m_preloaded.end(); ++i)
+  {
+    if (i->name == strTextureName)
+    {
+      CBaseTexture *texture = i->texture;
+      m_preloadedSize -= GetTextureSize(texture);
+      m_preloaded.erase(i);
+      return texture;
+    }
+  }
+
+  // still decoding, the caller decodes it right away instead of waiting for the job
+  std::map<std::string, PendingTexture>::iterator pending = m_preloading.find(strTextureName);
+  if (pending != m_preloading.end())
+  {
+    CJobManager::GetInstance().CancelJob(pending->second.jobID);
+    m_preloading.erase(pending);
+  }
+  return nullptr;
+}
+
+void CGUITextureManager::ClearPreloaded()
+{
+  std::vector<CBaseTexture*> dropped;
+  {
+    CSingleLock lock(m_preloadSection);
+    for (std::map<std::string, PendingTexture>::const_iterator i = m_preloading.begin(); i != m_preloading.end(); ++i)
+      CJobManager::GetInstance().CancelJob(i->second.jobID);
+    m_preloading.clear();
+
+    while (!m_preloaded.empty())
+      DropPreloaded(m_preloaded.begin(), dropped);
+  }
+
+  for (std::vector<CBaseTexture*>::iterator i = dropped.begin(); i != dropped.end(); ++i)
+    delete *i;
+}
+
+std::list<CGUITextureManager::PreloadedTexture>::iterator CGUITextureManager::DropPreloaded(std::list<PreloadedTexture>::iterator texture, std::vector<CBaseTexture*> &dropped)
+{
+  m_preloadedSize -= GetTextureSize(texture->texture);
+  dropped.push_back(texture->texture);
+  return m_preloaded.erase(texture);
+}
+
 void CGUITextureManager::Dump() const
 {
   CLog::Log(LOGDEBUG, "%s: total texturemaps size:%" PRIuS, __FUNCTION__, m_vecTextures.size());
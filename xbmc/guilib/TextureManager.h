@@ -25,11 +25,14 @@
 #pragma once
 
 #include <list>
+#include <map>
+#include <set>
 #include <vector>
 #include <utility>
 
 #include "TextureBundle.h"
 #include "threads/CriticalSection.h"
+#include "utils/Job.h"
 
 /************************************************************************/
 /*                                                                      */
@@ -94,6 +97,34 @@ protected:
   uint32_t m_memUsage;
 };
 
+/*!
+ \ingroup textures
+ \brief Decodes a texture from a bundle or a file on a job thread, without touching the GPU.
+ */
+class CTextureDecodeJob : public CJob
+{
+public:
+  CTextureDecodeJob(const std::string &name, const std::string &path);
+  CTextureDecodeJob(const std::string &name, const std::shared_ptr<CXBTFReader> &reader, const CXBTFFrame &frame);
+  ~CTextureDecodeJob() override;
+
+  const char *GetType() const override { return "texturedecode"; }
+  bool DoWork() override;
+
+  /*!
+   \brief Hands the decoded texture over to the caller, who then owns it.
+   */
+  CBaseTexture *TakeTexture();
+  const std::string &GetName() const { return m_name; }
+
+private:
+  std::string m_name;
+  std::string m_path;
+  std::shared_ptr<CXBTFReader> m_reader;
+  CXBTFFrame m_frame;
+  CBaseTexture *m_texture;
+};
+
 /*!
  \ingroup textures
  \brief
@@ -101,7 +132,7 @@ protected:
 /************************************************************************/
 /*                                                                      */
 /************************************************************************/
-class CGUITextureManager
+class CGUITextureManager : public IJobCallback
 {
 public:
   CGUITextureManager(void);
@@ -124,7 +155,52 @@ public:
 
   void FreeUnusedTextures(unsigned int timeDelay = 0); ///< Free textures (called from app thread only)
   void ReleaseHwTexture(unsigned int texture);
+
+  /*!
+   \brief Decodes a texture in the background so a later Load() only has to take it over.
+   Animated textures and textures that are loaded already are skipped. What the given window
+   doesn't take over while it loads, or within a while if it doesn't open, is dropped again.
+   */
+  void Preload(const std::string& strTextureName, int windowID);
+
+  /*!
+   \brief Preloads the textures a window used the last time its resources were allocated.
+   */
+  void PreloadWindow(int windowID);
+
+  /*!
+   \brief Records the textures loaded until StopRecording() as the ones of the given window.
+   Calls nest, textures are recorded for the window started last.
+   */
+  void StartRecording(int windowID);
+  void StopRecording();
+
+  /*!
+   \brief Uploads preloaded textures to the GPU within a per frame budget, called from the render thread.
+   */
+  void UploadPreloaded();
+
+  void OnJobComplete(unsigned int jobID, bool success, CJob *job) override;
 protected:
+  struct PendingTexture
+  {
+    unsigned int jobID;
+    int windowID;          ///< the window the texture was preloaded for
+  };
+
+  struct PreloadedTexture
+  {
+    std::string name;
+    CBaseTexture *texture;
+    int windowID;
+    unsigned int time;     ///< when decoding finished
+    bool uploaded;
+  };
+
+  CBaseTexture* TakePreloaded(const std::string& strTextureName);
+  std::list<PreloadedTexture>::iterator DropPreloaded(std::list<PreloadedTexture>::iterator texture, std::vector<CBaseTexture*> &dropped);
+  void ClearPreloaded();
+
   std::vector<CTextureMap*> m_vecTextures;
   std::list<std::pair<CTextureMap*, unsigned int> > m_unusedTextures;
   std::vector<unsigned int> m_unusedHwTextures;
@@ -135,6 +211,13 @@ protected:
 
   std::vector<std::string> m_texturePaths;
   CCriticalSection m_section;
+
+  std::map<std::string, PendingTexture> m_preloading; ///< textures being decoded
+  std::list<PreloadedTexture> m_preloaded;            ///< decoded textures not taken over yet, oldest first
+  uint64_t m_preloadedSize;
+  std::map<int, std::set<std::string> > m_windowTextures;
+  std::vector<int> m_recordingWindows; ///< windows allocating their resources, innermost last
+  CCriticalSection m_preloadSection;
 };
 
 /*!
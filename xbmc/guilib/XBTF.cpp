@@ -20,9 +20,15 @@
 
 #include "XBTF.h"
 
+#include <algorithm>
 #include <cstring>
 #include <utility>
 
+static bool ComparePath(const CXBTFFile& file, const std::string& name)
+{
+  return file.GetPath() < name;
+}
+
 CXBTFFrame::CXBTFFrame()
 {
   m_width = 0;
@@ -207,48 +213,61 @@ uint64_t CXBTFBase::GetHeaderSize() const
     sizeof(uint32_t) /* number of files */;
 
   for (const auto& file : m_files)
-    result += file.second.GetHeaderSize();
+    result += file.GetHeaderSize();
 
   return result;
 }
 
+const CXBTFFile* CXBTFBase::Find(const std::string& name) const
+{
+  auto iter = std::lower_bound(m_files.begin(), m_files.end(), name, ComparePath);
+  if (iter == m_files.end() || iter->GetPath() != name)
+    return nullptr;
+
+  return &*iter;
+}
+
 bool CXBTFBase::Exists(const std::string& name) const
 {
-  CXBTFFile dummy;
-  return Get(name, dummy);
+  return Find(name) != nullptr;
 }
 
 bool CXBTFBase::Get(const std::string& name, CXBTFFile& file) const
 {
-  const auto& iter = m_files.find(name);
-  if (iter == m_files.end())
+  const CXBTFFile* found = Find(name);
+  if (found == nullptr)
     return false;
 
-  file = iter->second;
+  file = *found;
   return true;
 }
 
 std::vector<CXBTFFile> CXBTFBase::GetFiles() const
 {
-  std::vector<CXBTFFile> files;
-  files.reserve(m_files.size());
-
-  for (const auto& file : m_files)
-    files.push_back(file.second);
-
-  return files;
+  return m_files;
 }
 
 void CXBTFBase::AddFile(const CXBTFFile& file)
 {
-  m_files.insert(std::make_pair(file.GetPath(), file));
+  // bundles are written sorted, so files are usually appended
+  if (m_files.empty() || m_files.back().GetPath() < file.GetPath())
+  {
+    m_files.push_back(file);
+    return;
+  }
+
+  auto iter = std::lower_bound(m_files.begin(), m_files.end(), file.GetPath(), ComparePath);
+  if (iter != m_files.end() && iter->GetPath() == file.GetPath())
+    return;
+
+  m_files.insert(iter, file);
 }
 
 void CXBTFBase::UpdateFile(const CXBTFFile& file)
 {
-  auto&& it = m_files.find(file.GetPath());
-  if (it == m_files.end())
+  auto iter = std::lower_bound(m_files.begin(), m_files.end(), file.GetPath(), ComparePath);
+  if (iter == m_files.end() || iter->GetPath() != file.GetPath())
     return;
 
-  it->second = file;
+  *iter = file;
 }
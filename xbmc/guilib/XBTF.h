@@ -19,7 +19,6 @@
  *
  */
 
-#include <map>
 #include <string>
 #include <vector>
 
@@ -125,5 +124,11 @@ public:
 protected:
   CXBTFBase() { }
 
-  std::map<std::string, CXBTFFile> m_files;
+  /*!
+   \brief Finds a file by path with a binary search.
+   \return the file or nullptr if there's no such file.
+   */
+  const CXBTFFile* Find(const std::string& name) const;
+
+  std::vector<CXBTFFile> m_files;  ///< sorted by path
 };
@@ -31,35 +31,41 @@
 #include "filesystem/SpecialProtocol.h"
 #include "utils/CharsetConverter.h"
 #include "platform/win32/PlatformDefs.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #endif
 
-static bool ReadString(FILE* file, char* str, size_t max_length)
+static bool ReadString(const uint8_t*& pos, const uint8_t* end, char* str, size_t max_length)
 {
-  if (file == nullptr || str == nullptr || max_length <= 0)
+  if (str == nullptr || max_length <= 0 || static_cast<size_t>(end - pos) < max_length)
     return false;
 
-  return (fread(str, max_length, 1, file) == 1);
+  memcpy(str, pos, max_length);
+  pos += max_length;
+  return true;
 }
 
-static bool ReadUInt32(FILE* file, uint32_t& value)
+static bool ReadUInt32(const uint8_t*& pos, const uint8_t* end, uint32_t& value)
 {
-  if (file == nullptr)
+  if (static_cast<size_t>(end - pos) < sizeof(uint32_t))
     return false;
 
-  if (fread(&value, sizeof(uint32_t), 1, file) != 1)
-    return false;
+  memcpy(&value, pos, sizeof(uint32_t));
+  pos += sizeof(uint32_t);
 
   value = Endian_SwapLE32(value);
   return true;
 }
 
-static bool ReadUInt64(FILE* file, uint64_t& value)
+static bool ReadUInt64(const uint8_t*& pos, const uint8_t* end, uint64_t& value)
 {
-  if (file == nullptr)
+  if (static_cast<size_t>(end - pos) < sizeof(uint64_t))
     return false;
 
-  if (fread(&value, sizeof(uint64_t), 1, file) != 1)
-    return false;
+  memcpy(&value, pos, sizeof(uint64_t));
+  pos += sizeof(uint64_t);
 
   value = Endian_SwapLE64(value);
   return true;
@@ -68,7 +74,14 @@ static bool ReadUInt64(FILE* file, uint64_t& value)
 CXBTFReader::CXBTFReader()
   : CXBTFBase(),
     m_path(),
-    m_file(nullptr)
+    m_data(nullptr),
+    m_size(0),
+#ifdef TARGET_WINDOWS
+    m_file(INVALID_HANDLE_VALUE),
+    m_mapping(nullptr)
+#else
+    m_file(-1)
+#endif
 { }
 
 CXBTFReader::~CXBTFReader()
@@ -76,43 +89,111 @@ CXBTFReader::~CXBTFReader()
   Close();
 }
 
-bool CXBTFReader::Open(const std::string& path)
+bool CXBTFReader::Map()
 {
-  if (path.empty())
+#ifdef TARGET_WINDOWS
+  std::wstring strPathW;
+  g_charsetConverter.utf8ToW(CSpecialProtocol::TranslatePath(m_path), strPathW, false);
+  // no write sharing, the bundle can't be rewritten while it's mapped
+  m_file = CreateFileW(strPathW.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (m_file == INVALID_HANDLE_VALUE)
     return false;
 
-  m_path = path;
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+    return false;
+  m_size = static_cast<uint64_t>(size.QuadPart);
+
+  m_mapping = CreateFileMapping(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (m_mapping == nullptr)
+    return false;
+
+  m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+  m_file = open(m_path.c_str(), O_RDONLY);
+  if (m_file == -1)
+    return false;
+
+  struct stat fileStat;
+  if (fstat(m_file, &fileStat) == -1 || fileStat.st_size == 0)
+    return false;
+  m_size = static_cast<uint64_t>(fileStat.st_size);
 
+  void* data = mmap(nullptr, static_cast<size_t>(m_size), PROT_READ, MAP_SHARED, m_file, 0);
+  if (data == MAP_FAILED)
+    return false;
+  m_data = static_cast<const uint8_t*>(data);
+#endif
+
+  return m_data != nullptr;
+}
+
+void CXBTFReader::Unmap()
+{
 #ifdef TARGET_WINDOWS
-  std::wstring strPathW;
-  g_charsetConverter.utf8ToW(CSpecialProtocol::TranslatePath(m_path), strPathW, false);
-  m_file = _wfopen(strPathW.c_str(), L"rb");
+  if (m_data != nullptr)
+    UnmapViewOfFile(m_data);
+  if (m_mapping != nullptr)
+    CloseHandle(m_mapping);
+  if (m_file != INVALID_HANDLE_VALUE)
+    CloseHandle(m_file);
+  m_mapping = nullptr;
+  m_file = INVALID_HANDLE_VALUE;
 #else
-  m_file = fopen(m_path.c_str(), "rb");
+  if (m_data != nullptr)
+    munmap(const_cast<uint8_t*>(m_data), static_cast<size_t>(m_size));
+  if (m_file != -1)
+    close(m_file);
+  m_file = -1;
 #endif
-  if (m_file == nullptr)
+  m_data = nullptr;
+  m_size = 0;
+}
+
+bool CXBTFReader::Open(const std::string& path)
+{
+  if (path.empty())
     return false;
 
-  // read the magic word
-  char magic[4];
-  if (!ReadString(m_file, magic, sizeof(magic)))
+  Close();
+  m_path = path;
+
+  // frames are accessed in place, so the bundle is mapped instead of read
+  if (!Map())
+  {
+    Close();
     return false;
+  }
+
+  const uint8_t* pos = m_data;
+  const uint8_t* end = m_data + m_size;
 
-  if (strncmp(XBTF_MAGIC.c_str(), magic, sizeof(magic)) != 0)
+  // read the magic word
+  char magic[4];
+  if (!ReadString(pos, end, magic, sizeof(magic)) ||
+      strncmp(XBTF_MAGIC.c_str(), magic, sizeof(magic)) != 0)
+  {
+    Close();
     return false;
+  }
 
   // read the version
   char version[1];
-  if (!ReadString(m_file, version, sizeof(version)))
-    return false;
-
-  if (strncmp(XBTF_VERSION.c_str(), version, sizeof(version)) != 0)
+  if (!ReadString(pos, end, version, sizeof(version)) ||
+      strncmp(XBTF_VERSION.c_str(), version, sizeof(version)) != 0)
+  {
+    Close();
     return false;
+  }
 
   unsigned int nofFiles;
-  if (!ReadUInt32(m_file, nofFiles))
+  if (!ReadUInt32(pos, end, nofFiles))
+  {
+    Close();
     return false;
+  }
 
+  m_files.reserve(nofFiles);
   for (uint32_t i = 0; i < nofFiles; i++)
   {
     CXBTFFile xbtfFile;
@@ -121,50 +202,61 @@ bool CXBTFReader::Open(const std::string& path)
 
     char path[CXBTFFile::MaximumPathLength];
     memset(path, 0, sizeof(path));
-    if (!ReadString(m_file, path, sizeof(path)))
+    if (!ReadString(pos, end, path, sizeof(path)))
+    {
+      Close();
       return false;
+    }
+    path[sizeof(path) - 1] = '\0';
     xbtfFile.SetPath(path);
 
-    if (!ReadUInt32(m_file, u32))
+    if (!ReadUInt32(pos, end, u32))
+    {
+      Close();
       return false;
+    }
     xbtfFile.SetLoop(u32);
 
     unsigned int nofFrames;
-    if (!ReadUInt32(m_file, nofFrames))
+    if (!ReadUInt32(pos, end, nofFrames))
+    {
+      Close();
       return false;
+    }
 
     for (uint32_t j = 0; j < nofFrames; j++)
     {
       CXBTFFrame frame;
+      bool valid = true;
 
-      if (!ReadUInt32(m_file, u32))
-        return false;
+      valid &= ReadUInt32(pos, end, u32);
       frame.SetWidth(u32);
 
-      if (!ReadUInt32(m_file, u32))
-        return false;
+      valid &= ReadUInt32(pos, end, u32);
       frame.SetHeight(u32);
 
-      if (!ReadUInt32(m_file, u32))
-        return false;
+      valid &= ReadUInt32(pos, end, u32);
       frame.SetFormat(u32);
 
-      if (!ReadUInt64(m_file, u64))
-        return false;
+      valid &= ReadUInt64(pos, end, u64);
       frame.SetPackedSize(u64);
 
-      if (!ReadUInt64(m_file, u64))
-        return false;
+      valid &= ReadUInt64(pos, end, u64);
       frame.SetUnpackedSize(u64);
 
-      if (!ReadUInt32(m_file, u32))
-        return false;
+      valid &= ReadUInt32(pos, end, u32);
       frame.SetDuration(u32);
 
-      if (!ReadUInt64(m_file, u64))
-        return false;
+      valid &= ReadUInt64(pos, end, u64);
       frame.SetOffset(u64);
 
+      // frames are read in place, so they must lie within the bundle
+      if (!valid || frame.GetOffset() > m_size || frame.GetPackedSize() > m_size - frame.GetOffset())
+      {
+        Close();
+        return false;
+      }
+
       xbtfFile.GetFrames().push_back(frame);
     }
 
@@ -172,25 +264,24 @@ bool CXBTFReader::Open(const std::string& path)
   }
 
   // Sanity check
-  uint64_t pos = static_cast<uint64_t>(ftell(m_file));
-  if (pos != GetHeaderSize())
+  uint64_t headerSize = static_cast<uint64_t>(pos - m_data);
+  if (headerSize != GetHeaderSize())
+  {
+    Close();
     return false;
+  }
 
   return true;
 }
 
 bool CXBTFReader::IsOpen() const
 {
-  return m_file != nullptr;
+  return m_data != nullptr;
 }
 
 void CXBTFReader::Close()
 {
-  if (m_file != nullptr)
-  {
-    fclose(m_file);
-    m_file = nullptr;
-  }
+  Unmap();
 
   m_path.clear();
   m_files.clear();
@@ -198,30 +289,42 @@ void CXBTFReader::Close()
 
 time_t CXBTFReader::GetLastModificationTimestamp() const
 {
-  if (m_file == nullptr)
+#ifdef TARGET_WINDOWS
+  FILETIME lastWrite;
+  if (m_file == INVALID_HANDLE_VALUE || !GetFileTime(m_file, nullptr, nullptr, &lastWrite))
+    return 0;
+
+  // 100ns intervals since 1601 to seconds since 1970
+  ULARGE_INTEGER time;
+  time.LowPart = lastWrite.dwLowDateTime;
+  time.HighPart = lastWrite.dwHighDateTime;
+  return static_cast<time_t>((time.QuadPart - 116444736000000000ULL) / 10000000ULL);
+#else
+  if (m_file == -1)
     return 0;
 
   struct stat fileStat;
-  if (fstat(fileno(m_file), &fileStat) == -1)
+  if (fstat(m_file, &fileStat) == -1)
     return 0;
 
   return fileStat.st_mtime;
+#endif
 }
 
 bool CXBTFReader::Load(const CXBTFFrame& frame, unsigned char* buffer) const
 {
-  if (m_file == nullptr)
+  const uint8_t* data = GetFrameData(frame);
+  if (data == nullptr)
     return false;
 
-#if defined(TARGET_DARWIN) || defined(TARGET_FREEBSD) || defined(TARGET_ANDROID)
-  if (fseeko(m_file, static_cast<off_t>(frame.GetOffset()), SEEK_SET) == -1)
-#else
-  if (fseeko64(m_file, static_cast<off_t>(frame.GetOffset()), SEEK_SET) == -1)
-#endif
-    return false;
+  memcpy(buffer, data, static_cast<size_t>(frame.GetPackedSize()));
+  return true;
+}
 
-  if (fread(buffer, 1, static_cast<size_t>(frame.GetPackedSize()), m_file) != frame.GetPackedSize())
-    return false;
+const uint8_t* CXBTFReader::GetFrameData(const CXBTFFrame& frame) const
+{
+  if (m_data == nullptr)
+    return nullptr;
 
-  return true;
+  return m_data + frame.GetOffset();
 }
@@ -27,6 +27,15 @@
 
 #include "XBTF.h"
 
+/*!
+ \brief Reads frames of a texture bundle, which is mapped into memory while open.
+
+ The bundle must not be rewritten in place while a reader has it open, as
+ touching a truncated mapping raises SIGBUS. Updates have to write a new
+ file and rename it over the old one, the mapping keeps the old contents
+ then. On Windows the bundle is opened without write sharing, so it can't
+ be rewritten while mapped.
+ */
 class CXBTFReader : public CXBTFBase
 {
 public:
@@ -39,11 +48,31 @@ public:
 
   time_t GetLastModificationTimestamp() const;
 
+  /*!
+   \brief Copies the packed data of a frame into the given buffer.
+   */
   bool Load(const CXBTFFrame& frame, unsigned char* buffer) const;
 
+  /*!
+   \brief Gets the packed data of a frame in place, without copying it.
+   The data stays valid as long as the reader is open.
+   \return the data or nullptr if the reader isn't open.
+   */
+  const uint8_t* GetFrameData(const CXBTFFrame& frame) const;
+
 private:
+  bool Map();
+  void Unmap();
+
   std::string m_path;
-  FILE* m_file;
+  const uint8_t* m_data;  ///< the whole bundle, mapped into memory
+  uint64_t m_size;
+#ifdef TARGET_WINDOWS
+  void* m_file;
+  void* m_mapping;
+#else
+  int m_file;
+#endif
 };
 
 typedef std::shared_ptr<CXBTFReader> CXBTFReaderPtr;
@@ -0,0 +1,215 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "guilib/DirtyRegionSolvers.h"
+#include "guilib/DirtyRegionTracker.h"
+#include "test/TestUtils.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+const CRect viewport(0, 0, 1920, 1080);
+
+// traces are either the lines a kodi.log recorded with <tracedirtyregions> has
+// for every frame, or plain files with a frame per line and # comments
+std::vector<CDirtyRegionList> LoadTrace(const std::string &name)
+{
+  static const std::string marker = "DirtyRegionTrace: ";
+  bool log = name.size() > 4 && name.compare(name.size() - 4, 4, ".log") == 0;
+  std::vector<CDirtyRegionList> frames;
+  std::ifstream file(XBMC_REF_FILE_PATH("xbmc/guilib/test/data/" + name).c_str());
+  std::string line;
+  while (std::getline(file, line))
+  {
+    if (log)
+    {
+      size_t pos = line.find(marker);
+      if (pos != std::string::npos)
+        frames.push_back(CDirtyRegionTracker::ParseTrace(line.substr(pos + marker.size())));
+    }
+    else if (!line.empty() && line[0] != '#')
+      frames.push_back(CDirtyRegionTracker::ParseTrace(line));
+  }
+  return frames;
+}
+
+bool Equal(const CRect &left, const CRect &right)
+{
+  return left.x1 == right.x1 && left.y1 == right.y1 && left.x2 == right.x2 && left.y2 == right.y2;
+}
+
+bool Covers(const CDirtyRegionList &output, const CDirtyRegionList &input)
+{
+  for (unsigned int i = 0; i < input.size(); i++)
+  {
+    CRect region(input[i]);
+    region.Intersect(viewport);
+    bool covered = false;
+    for (unsigned int j = 0; j < output.size() && !covered; j++)
+      covered = output[j].x1 <= region.x1 && output[j].y1 <= region.y1 &&
+                output[j].x2 >= region.x2 && output[j].y2 >= region.y2;
+    if (!covered)
+      return false;
+  }
+  return true;
+}
+
+// what a solution costs to render, counted separately as neither can stand in for
+// the other: the pixels redrawn within the viewport and the render passes
+struct Redraw
+{
+  double pixels = 0.0;
+  unsigned int passes = 0;
+
+  void Add(const CDirtyRegionList &regions)
+  {
+    for (unsigned int i = 0; i < regions.size(); i++)
+    {
+      CRect region(regions[i]);
+      region.Intersect(viewport);
+      if (!region.IsEmpty())
+      {
+        pixels += region.Area();
+        passes++;
+      }
+    }
+  }
+};
+
+class TestDirtyRegionTrace : public testing::TestWithParam<const char*>
+{
+};
+}
+
+TEST(TestDirtyRegionSolvers, CostModel)
+{
+  CCostModelDirtyRegionSolver solver;
+  CDirtyRegionList input;
+  CDirtyRegionList output;
+
+  // far apart corners are cheaper in two passes
+  input.push_back(CDirtyRegion(0, 0, 100, 100));
+  input.push_back(CDirtyRegion(1820, 980, 1920, 1080));
+  solver.Solve(input, viewport, output);
+  EXPECT_EQ(2u, output.size());
+  EXPECT_STREQ("split", solver.GetDecision());
+
+  // neighbours and regions inside others are merged
+  CCostModelDirtyRegionSolver merging;
+  input.assign(1, CDirtyRegion(100, 100, 300, 200));
+  input.push_back(CDirtyRegion(310, 100, 500, 200));
+  input.push_back(CDirtyRegion(150, 120, 200, 150));
+  output.clear();
+  merging.Solve(input, viewport, output);
+  ASSERT_EQ(1u, output.size());
+  EXPECT_TRUE(Equal(CRect(100, 100, 500, 200), output[0]));
+
+  // the previous solution is kept while it covers everything and costs about the same
+  input.assign(1, CDirtyRegion(100, 100, 480, 200));
+  output.clear();
+  merging.Solve(input, viewport, output);
+  ASSERT_EQ(1u, output.size());
+  EXPECT_TRUE(Equal(CRect(100, 100, 500, 200), output[0]));
+  EXPECT_STREQ("kept", merging.GetDecision());
+
+  // big regions all over the screen, parts outside are clipped
+  input.assign(1, CDirtyRegion(0, 0, 1000, 600));
+  input.push_back(CDirtyRegion(900, 0, 1920, 600));
+  input.push_back(CDirtyRegion(0, 500, 1000, 1080));
+  input.push_back(CDirtyRegion(900, 500, 2000, 1100));
+  output.clear();
+  solver.Solve(input, viewport, output);
+  ASSERT_EQ(1u, output.size());
+  EXPECT_TRUE(Equal(viewport, output[0]));
+
+  // nothing to render
+  output.clear();
+  solver.Solve(CDirtyRegionList(), viewport, output);
+  EXPECT_TRUE(output.empty());
+  input.assign(1, CDirtyRegion(2000, 0, 2100, 100));
+  solver.Solve(input, viewport, output);
+  EXPECT_TRUE(output.empty());
+}
+
+TEST(TestDirtyRegionSolvers, Trace)
+{
+  CDirtyRegionList regions;
+  regions.push_back(CDirtyRegion(0, 0, 1920, 1080));
+  regions.push_back(CDirtyRegion(10.5f, 20, 30, 40.25f));
+  std::string trace = CDirtyRegionTracker::FormatTrace(regions);
+  EXPECT_EQ("0,0,1920,1080 10.5,20,30,40.25", trace);
+  CDirtyRegionList parsed = CDirtyRegionTracker::ParseTrace(trace + "\r\n");
+  ASSERT_EQ(2u, parsed.size());
+  EXPECT_TRUE(Equal(regions[0], parsed[0]));
+  EXPECT_TRUE(Equal(regions[1], parsed[1]));
+}
+
+TEST_P(TestDirtyRegionTrace, Replay)
+{
+  std::vector<CDirtyRegionList> frames = LoadTrace(GetParam());
+  ASSERT_FALSE(frames.empty());
+
+  CCostModelDirtyRegionSolver costModel;
+  CGreedyDirtyRegionSolver greedy;
+  CUnionDirtyRegionSolver unified;
+  Redraw costModelRedraw;
+  Redraw greedyRedraw;
+  Redraw unionRedraw;
+  Redraw viewportRedraw;
+  for (unsigned int i = 0; i < frames.size(); i++)
+  {
+    CDirtyRegionList output;
+    costModel.Solve(frames[i], viewport, output);
+    EXPECT_TRUE(Covers(output, frames[i])) << "frame " << i;
+    costModelRedraw.Add(output);
+
+    output.clear();
+    greedy.Solve(frames[i], output);
+    greedyRedraw.Add(output);
+
+    output.clear();
+    unified.Solve(frames[i], output);
+    unionRedraw.Add(output);
+
+    if (!frames[i].empty())
+      viewportRedraw.Add(CDirtyRegionList(1, CDirtyRegion(viewport)));
+  }
+
+  std::cout << GetParam() << ", " << frames.size() << " frames: megapixels redrawn / passes, cost model "
+            << costModelRedraw.pixels / 1e6 << " / " << costModelRedraw.passes
+            << ", greedy " << greedyRedraw.pixels / 1e6 << " / " << greedyRedraw.passes
+            << ", union " << unionRedraw.pixels / 1e6 << " / " << unionRedraw.passes
+            << ", viewport " << viewportRedraw.pixels / 1e6 << " / " << viewportRedraw.passes << std::endl;
+
+  // which trade of pixels against passes renders faster depends on the device,
+  // only what holds for any device is checked: never more of both than another solver
+  EXPECT_FALSE(costModelRedraw.pixels > greedyRedraw.pixels && costModelRedraw.passes > greedyRedraw.passes);
+  EXPECT_FALSE(costModelRedraw.pixels > unionRedraw.pixels && costModelRedraw.passes > unionRedraw.passes);
+  EXPECT_LT(costModelRedraw.pixels, viewportRedraw.pixels);
+}
+
+INSTANTIATE_TEST_CASE_P(DirtyRegionTraces, TestDirtyRegionTrace,
+                        testing::Values("dirtyregions-synthetic-home.txt", "dirtyregions-synthetic-list.txt"));
@@ -0,0 +1,72 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/GUIBenchmark.h"
+#include "guilib/GUIControlProfiler.h"
+#include "guilib/WindowIDs.h"
+#include "input/Key.h"
+
+#include "gtest/gtest.h"
+
+TEST(TestGUIBenchmark, ParseScript)
+{
+  std::vector<CGUIBenchmark::Step> steps;
+  std::string report;
+  EXPECT_TRUE(CGUIBenchmark::ParseScript("# home, then down the list\n"
+                                         "\n"
+                                         "window home\n"
+                                         "frames 50\n"
+                                         "action down 20\n"
+                                         "  action select\r\n"
+                                         "window 10025\n"
+                                         "report special://temp/bench.txt\n", steps, report));
+  ASSERT_EQ(5u, steps.size());
+  EXPECT_EQ(CGUIBenchmark::Step::WINDOW, steps[0].type);
+  EXPECT_EQ(WINDOW_HOME, steps[0].id);
+  EXPECT_EQ(1u, steps[0].count);
+  EXPECT_EQ(CGUIBenchmark::Step::FRAMES, steps[1].type);
+  EXPECT_EQ(50u, steps[1].count);
+  EXPECT_EQ(CGUIBenchmark::Step::ACTION, steps[2].type);
+  EXPECT_EQ(ACTION_MOVE_DOWN, steps[2].id);
+  EXPECT_EQ(20u, steps[2].count);
+  EXPECT_EQ(ACTION_SELECT_ITEM, steps[3].id);
+  EXPECT_EQ(1u, steps[3].count);
+  EXPECT_EQ(WINDOW_VIDEO_NAV, steps[4].id);
+  EXPECT_EQ("special://temp/bench.txt", report);
+
+  steps.clear();
+  EXPECT_FALSE(CGUIBenchmark::ParseScript("window nosuchwindow\n", steps, report));
+  EXPECT_FALSE(CGUIBenchmark::ParseScript("action nosuchaction\n", steps, report));
+  EXPECT_FALSE(CGUIBenchmark::ParseScript("action down many\n", steps, report));
+  EXPECT_FALSE(CGUIBenchmark::ParseScript("frames\n", steps, report));
+  EXPECT_FALSE(CGUIBenchmark::ParseScript("jump 10\n", steps, report));
+}
+
+TEST(TestGUIBenchmark, HistogramBucket)
+{
+  EXPECT_EQ(0u, CGUIControlProfilerItem::GetHistogramBucket(0));
+  EXPECT_EQ(1u, CGUIControlProfilerItem::GetHistogramBucket(1));
+  EXPECT_EQ(2u, CGUIControlProfilerItem::GetHistogramBucket(2));
+  EXPECT_EQ(2u, CGUIControlProfilerItem::GetHistogramBucket(3));
+  EXPECT_EQ(11u, CGUIControlProfilerItem::GetHistogramBucket(1500));
+  EXPECT_EQ(14u, CGUIControlProfilerItem::GetHistogramBucket(16383));
+  EXPECT_EQ(GUIPROFILER_HISTOGRAM_BUCKETS - 1u, CGUIControlProfilerItem::GetHistogramBucket(16384));
+  EXPECT_EQ(GUIPROFILER_HISTOGRAM_BUCKETS - 1u, CGUIControlProfilerItem::GetHistogramBucket(10000000));
+}
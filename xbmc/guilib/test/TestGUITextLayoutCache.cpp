@@ -0,0 +1,99 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/GUITextLayoutCache.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+CGUITextLayoutCache::Key MakeKey(const std::string &text, float maxWidth = 0)
+{
+  CGUITextLayoutCache::Key key;
+  key.font = NULL;
+  key.text = text;
+  key.maxWidth = maxWidth;
+  key.maxHeight = 0;
+  key.textColor = 0;
+  key.forceLTRReadingOrder = false;
+  key.scaleX = 1.0f;
+  key.scaleY = 1.0f;
+  return key;
+}
+
+CGUITextLayoutCache::LayoutPtr MakeLayout(float width)
+{
+  std::shared_ptr<CGUITextLayoutCache::Layout> layout(new CGUITextLayoutCache::Layout);
+  layout->width = width;
+  layout->height = 0;
+  return layout;
+}
+}
+
+TEST(TestGUITextLayoutCache, Lookup)
+{
+  CGUITextLayoutCache cache(2);
+  cache.Add(MakeKey("a"), MakeLayout(1));
+  cache.Add(MakeKey("a", 100), MakeLayout(2));
+  ASSERT_TRUE(cache.Get(MakeKey("a")) != nullptr);
+  EXPECT_EQ(1, cache.Get(MakeKey("a"))->width);
+  EXPECT_EQ(2, cache.Get(MakeKey("a", 100))->width);
+  EXPECT_TRUE(cache.Get(MakeKey("b")) == nullptr);
+  EXPECT_EQ(3u, cache.GetHits());
+
+  // the least recently used layout makes room
+  cache.Get(MakeKey("a"));
+  cache.Add(MakeKey("b"), MakeLayout(3));
+  EXPECT_EQ(2u, cache.GetSize());
+  EXPECT_TRUE(cache.Get(MakeKey("a")) != nullptr);
+  EXPECT_TRUE(cache.Get(MakeKey("a", 100)) == nullptr);
+  EXPECT_TRUE(cache.Get(MakeKey("b")) != nullptr);
+
+  cache.Clear();
+  EXPECT_EQ(0u, cache.GetSize());
+}
+
+TEST(TestGUITextLayoutCache, TextLayout)
+{
+  CGUITextLayoutCache &cache = CGUITextLayoutCache::GetInstance();
+  cache.Clear();
+
+  // a layout of a text seen before doesn't lay it out again
+  CGUITextLayout first(NULL, false);
+  EXPECT_TRUE(first.Update("[B]first[/B] line\nsecond line"));
+  unsigned int hits = cache.GetHits();
+  CGUITextLayout second(NULL, false);
+  EXPECT_TRUE(second.Update("[B]first[/B] line\nsecond line"));
+  EXPECT_EQ(hits + 1, cache.GetHits());
+
+  vecText firstText;
+  vecText secondText;
+  first.GetFirstText(firstText);
+  second.GetFirstText(secondText);
+  EXPECT_EQ(firstText, secondText);
+  EXPECT_EQ(first.GetTextLength(), second.GetTextLength());
+
+  // going back to an earlier text
+  EXPECT_TRUE(second.Update("other"));
+  EXPECT_TRUE(second.Update("[B]first[/B] line\nsecond line"));
+  EXPECT_EQ(hits + 2, cache.GetHits());
+  EXPECT_FALSE(second.Update("[B]first[/B] line\nsecond line"));
+  cache.Clear();
+}
@@ -0,0 +1,151 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/GlyphAtlas.h"
+#include "guilib/GUIFont.h"
+#include "guilib/GUIFontTTF.h"
+#include "test/TestUtils.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+// a glyph of the given size filled with value
+bool AddGlyph(CGlyphAtlas &atlas, unsigned int font, uint32_t letter, unsigned int width, unsigned int rows,
+              unsigned char value, bool evict = true)
+{
+  CGlyphAtlas::Glyph glyph;
+  glyph.width = width;
+  glyph.rows = rows;
+  glyph.advance = static_cast<float>(width);
+  std::vector<unsigned char> pixels(width * rows, value);
+  return atlas.Add(font, letter, glyph, pixels.data(), width, evict);
+}
+}
+
+TEST(TestGlyphAtlas, Pack)
+{
+  CGlyphAtlas atlas(128, 128);
+  unsigned int font1 = atlas.GetFontId("font1");
+  unsigned int font2 = atlas.GetFontId("font2");
+  EXPECT_NE(font1, font2);
+  EXPECT_EQ(font1, atlas.GetFontId("font1"));
+
+  // glyphs of mixed heights of two fonts, and a space
+  for (uint32_t letter = 'a'; letter <= 'z'; letter++)
+  {
+    EXPECT_TRUE(AddGlyph(atlas, font1, letter, 5 + letter % 4, 6 + letter % 7, static_cast<unsigned char>(letter)));
+    EXPECT_TRUE(AddGlyph(atlas, font2, letter, 9, 12, static_cast<unsigned char>(letter + 100)));
+  }
+  EXPECT_TRUE(AddGlyph(atlas, font1, ' ', 0, 0, 0));
+  EXPECT_EQ(53u, atlas.GetGlyphCount());
+  EXPECT_EQ(0u, atlas.GetEvictedShelves());
+
+  // nothing overwrote anything else
+  CGlyphAtlas::Glyph glyph;
+  std::vector<unsigned char> pixels;
+  for (uint32_t letter = 'a'; letter <= 'z'; letter++)
+  {
+    ASSERT_TRUE(atlas.Get(font1, letter, glyph, pixels));
+    EXPECT_EQ(5 + letter % 4, glyph.width);
+    EXPECT_EQ(6 + letter % 7, glyph.rows);
+    EXPECT_EQ(std::vector<unsigned char>(glyph.width * glyph.rows, static_cast<unsigned char>(letter)), pixels);
+
+    ASSERT_TRUE(atlas.Get(font2, letter, glyph, pixels));
+    EXPECT_EQ(std::vector<unsigned char>(9 * 12, static_cast<unsigned char>(letter + 100)), pixels);
+  }
+  ASSERT_TRUE(atlas.Get(font1, ' ', glyph, pixels));
+  EXPECT_TRUE(pixels.empty());
+  EXPECT_FALSE(atlas.Has(font2, ' '));
+
+  // bigger than the atlas
+  EXPECT_FALSE(AddGlyph(atlas, font1, 'A', 129, 8, 0));
+}
+
+TEST(TestGlyphAtlas, Evict)
+{
+  // two shelves of two glyphs each
+  CGlyphAtlas atlas(32, 16);
+  EXPECT_TRUE(AddGlyph(atlas, 0, 'a', 16, 8, 1));
+  EXPECT_TRUE(AddGlyph(atlas, 0, 'b', 16, 8, 2));
+  EXPECT_TRUE(AddGlyph(atlas, 0, 'c', 16, 8, 3));
+  EXPECT_TRUE(AddGlyph(atlas, 0, 'd', 16, 8, 4));
+
+  // the full atlas only takes more when glyphs may be dropped
+  EXPECT_FALSE(AddGlyph(atlas, 0, 'e', 16, 8, 5, false));
+  EXPECT_EQ(4u, atlas.GetGlyphCount());
+
+  // 'a' was used last, so the shelf of 'c' and 'd' goes
+  CGlyphAtlas::Glyph glyph;
+  std::vector<unsigned char> pixels;
+  EXPECT_TRUE(atlas.Get(0, 'a', glyph, pixels));
+  EXPECT_TRUE(AddGlyph(atlas, 0, 'e', 16, 8, 5));
+  EXPECT_EQ(1u, atlas.GetEvictedShelves());
+  EXPECT_TRUE(atlas.Has(0, 'a'));
+  EXPECT_TRUE(atlas.Has(0, 'b'));
+  EXPECT_FALSE(atlas.Has(0, 'c'));
+  EXPECT_FALSE(atlas.Has(0, 'd'));
+  ASSERT_TRUE(atlas.Get(0, 'e', glyph, pixels));
+  EXPECT_EQ(std::vector<unsigned char>(16 * 8, 5), pixels);
+  ASSERT_TRUE(atlas.Get(0, 'b', glyph, pixels));
+  EXPECT_EQ(std::vector<unsigned char>(16 * 8, 2), pixels);
+
+  // a glyph taller than every shelf doesn't fit
+  EXPECT_FALSE(AddGlyph(atlas, 0, 'f', 4, 12, 6));
+
+  atlas.Clear();
+  EXPECT_EQ(0u, atlas.GetGlyphCount());
+  EXPECT_TRUE(AddGlyph(atlas, 0, 'f', 4, 12, 6));
+}
+
+TEST(TestGlyphAtlas, Prewarm)
+{
+  std::string font = XBMC_REF_FILE_PATH("addons/skin.estuary/fonts/NotoSans-Regular.ttf");
+  std::vector<uint32_t> styles;
+  styles.push_back(FONT_STYLE_NORMAL);
+  styles.push_back(FONT_STYLE_BOLD);
+
+  CGlyphAtlas atlas(256, 256);
+  EXPECT_EQ(6u, CGUIFontTTFBase::PrewarmGlyphs(font, 20.0f, 1.0f, false, styles, L"Ab ", atlas));
+  // already there
+  EXPECT_EQ(0u, CGUIFontTTFBase::PrewarmGlyphs(font, 20.0f, 1.0f, false, styles, L"Ab ", atlas));
+
+  unsigned int id = atlas.GetFontId(CGUIFontTTFBase::GetAtlasKey(font, 20.0f, 1.0f, false));
+  CGlyphAtlas::Glyph glyph;
+  CGlyphAtlas::Glyph bold;
+  std::vector<unsigned char> pixels;
+  ASSERT_TRUE(atlas.Get(id, 'A', glyph, pixels));
+  EXPECT_GT(glyph.width, 0u);
+  EXPECT_GT(glyph.rows, 0u);
+  EXPECT_GT(glyph.top, 0);
+  EXPECT_GT(glyph.advance, 0.0f);
+  EXPECT_EQ(glyph.width * glyph.rows, pixels.size());
+  ASSERT_TRUE(atlas.Get(id, (FONT_STYLE_BOLD << 16) | 'A', bold, pixels));
+  EXPECT_GE(bold.width, glyph.width);
+  ASSERT_TRUE(atlas.Get(id, ' ', glyph, pixels));
+  EXPECT_EQ(0u, glyph.width);
+  EXPECT_GT(glyph.advance, 0.0f);
+
+  // the border makes glyphs bigger and they're kept apart
+  EXPECT_EQ(1u, CGUIFontTTFBase::PrewarmGlyphs(font, 20.0f, 1.0f, true, std::vector<uint32_t>(1, FONT_STYLE_NORMAL), L"A", atlas));
+  ASSERT_TRUE(atlas.Get(atlas.GetFontId(CGUIFontTTFBase::GetAtlasKey(font, 20.0f, 1.0f, true)), 'A', bold, pixels));
+  ASSERT_TRUE(atlas.Get(id, 'A', glyph, pixels));
+  EXPECT_GT(bold.width, glyph.width);
+}
@@ -0,0 +1,194 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <string.h>
+#include <vector>
+
+#include <lzo/lzo1x.h>
+
+#include "filesystem/File.h"
+#include "guilib/Texture.h"
+#include "guilib/TextureBundleXBT.h"
+#include "guilib/TextureManager.h"
+#include "guilib/XBTFReader.h"
+#include "test/TestUtils.h"
+#include "threads/SystemClock.h"
+#include "utils/EndianSwap.h"
+#include "utils/JobManager.h"
+#include "utils/StringUtils.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+const unsigned int textureCount = 32;
+const unsigned int textureSize = 256;
+
+uint8_t GetPixel(unsigned int texture, unsigned int x, unsigned int y)
+{
+  return static_cast<uint8_t>((texture * 7 + x / 4 + y / 8) & 0xff);
+}
+
+void WriteUInt32(std::string &data, uint32_t value)
+{
+  value = Endian_SwapLE32(value);
+  data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void WriteUInt64(std::string &data, uint64_t value)
+{
+  value = Endian_SwapLE64(value);
+  data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// writes a bundle of lzo packed A8R8G8B8 textures as TexturePacker would
+std::string CreateBundle()
+{
+  const unsigned int unpackedSize = textureSize * textureSize * 4;
+  std::vector<std::string> packed;
+  std::vector<unsigned char> pixels(unpackedSize);
+  std::vector<unsigned char> buffer(unpackedSize + unpackedSize / 16 + 64 + 3);
+  std::vector<unsigned char> workMem(LZO1X_1_MEM_COMPRESS);
+  EXPECT_EQ(LZO_E_OK, lzo_init());
+  for (unsigned int i = 0; i < textureCount; i++)
+  {
+    for (unsigned int y = 0; y < textureSize; y++)
+      for (unsigned int x = 0; x < textureSize; x++)
+        memset(&pixels[(y * textureSize + x) * 4], GetPixel(i, x, y), 4);
+
+    lzo_uint size = buffer.size();
+    EXPECT_EQ(LZO_E_OK, lzo1x_1_compress(pixels.data(), unpackedSize, buffer.data(), &size, workMem.data()));
+    packed.push_back(std::string(reinterpret_cast<const char*>(buffer.data()), size));
+  }
+
+  CXBTFFrame frame;
+  uint64_t offset = XBTF_MAGIC.size() + XBTF_VERSION.size() + sizeof(uint32_t) +
+                    textureCount * (CXBTFFile::MaximumPathLength + 2 * sizeof(uint32_t) + frame.GetHeaderSize());
+
+  std::string data = XBTF_MAGIC + XBTF_VERSION;
+  WriteUInt32(data, textureCount);
+  for (unsigned int i = 0; i < textureCount; i++)
+  {
+    std::string path = StringUtils::Format("texture%u.png", i);
+    path.resize(CXBTFFile::MaximumPathLength, '\0');
+    data += path;
+    WriteUInt32(data, 0);  // loop
+    WriteUInt32(data, 1);  // frames
+    WriteUInt32(data, textureSize);
+    WriteUInt32(data, textureSize);
+    WriteUInt32(data, XB_FMT_A8R8G8B8);
+    WriteUInt64(data, packed[i].size());
+    WriteUInt64(data, unpackedSize);
+    WriteUInt32(data, 0);  // duration
+    WriteUInt64(data, offset);
+    offset += packed[i].size();
+  }
+  for (unsigned int i = 0; i < textureCount; i++)
+    data += packed[i];
+  return data;
+}
+
+bool CheckTexture(CBaseTexture *texture, unsigned int index)
+{
+  if (texture == nullptr || texture->GetWidth() != textureSize || texture->GetHeight() != textureSize)
+    return false;
+
+  const unsigned char *pixels = texture->GetPixels();
+  for (unsigned int y = 0; y < textureSize; y++)
+  {
+    const unsigned char *row = pixels + y * texture->GetPitch();
+    for (unsigned int x = 0; x < textureSize * 4; x++)
+    {
+      if (row[x] != GetPixel(index, x / 4, y))
+        return false;
+    }
+  }
+  return true;
+}
+
+class DecodeCallback : public IJobCallback
+{
+public:
+  DecodeCallback() : m_done(0), m_correct(0) {}
+
+  void OnJobComplete(unsigned int jobID, bool success, CJob *job) override
+  {
+    CTextureDecodeJob *decodeJob = static_cast<CTextureDecodeJob*>(job);
+    std::unique_ptr<CBaseTexture> texture(decodeJob->TakeTexture());
+    unsigned int index = strtoul(decodeJob->GetName().c_str() + 7, NULL, 10);
+    if (success && CheckTexture(texture.get(), index))
+      m_correct++;
+    m_done++;
+  }
+
+  std::atomic<unsigned int> m_done;
+  std::atomic<unsigned int> m_correct;
+};
+
+double GetThroughput(unsigned int elapsed)
+{
+  double bytes = textureCount * textureSize * textureSize * 4.0;
+  return bytes / (1024 * 1024) * 1000 / (elapsed ? elapsed : 1);
+}
+}
+
+TEST(TestTextureDecode, DecodeThroughput)
+{
+  XFILE::CFile *file = XBMC_CREATETEMPFILE(".xbt");
+  ASSERT_NE(nullptr, file);
+  std::string data = CreateBundle();
+  EXPECT_EQ(static_cast<ssize_t>(data.size()), file->Write(data.c_str(), data.size()));
+  file->Flush();
+
+  std::shared_ptr<CXBTFReader> reader(new CXBTFReader());
+  ASSERT_TRUE(reader->Open(XBMC_TEMPFILEPATH(file)));
+  std::vector<CXBTFFile> files = reader->GetFiles();
+  ASSERT_EQ(textureCount, files.size());
+
+  // decoding one after another, as the texture manager does when loading a window
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  for (unsigned int i = 0; i < textureCount; i++)
+  {
+    std::unique_ptr<CBaseTexture> texture(CTextureBundleXBT::DecodeFrame(*reader, files[i].GetFrames()[0]));
+    EXPECT_TRUE(CheckTexture(texture.get(), i)) << files[i].GetPath();
+  }
+  unsigned int serial = XbmcThreads::SystemClockMillis() - start;
+
+  // decoding on the job manager, as the texture manager does when preloading
+  DecodeCallback callback;
+  start = XbmcThreads::SystemClockMillis();
+  for (unsigned int i = 0; i < textureCount; i++)
+    CJobManager::GetInstance().AddJob(new CTextureDecodeJob(files[i].GetPath(), reader, files[i].GetFrames()[0]),
+                                      &callback, CJob::PRIORITY_LOW);
+  for (int i = 0; i < 1000 && callback.m_done < textureCount; i++)
+    XbmcThreads::ThreadSleep(10);
+  unsigned int background = XbmcThreads::SystemClockMillis() - start;
+
+  EXPECT_EQ(textureCount, callback.m_done);
+  EXPECT_EQ(textureCount, callback.m_correct);
+  std::cout << "decode MB/s: serial " << GetThroughput(serial)
+            << ", jobs " << GetThroughput(background) << std::endl;
+
+  reader.reset();
+  EXPECT_TRUE(XBMC_DELETETEMPFILE(file));
+}
@@ -0,0 +1,177 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <iostream>
+#include <stdio.h>
+#include <string>
+#include <string.h>
+#include <vector>
+
+#include "filesystem/File.h"
+#include "guilib/TextureBundleXBT.h"
+#include "guilib/XBTFReader.h"
+#include "test/TestUtils.h"
+#include "threads/SystemClock.h"
+
+#include "gtest/gtest.h"
+
+TEST(TestXBTFReader, SortedIndex)
+{
+  CXBTFReader reader;
+  const char *paths[] = { "b.png", "a.png", "c/d.png", "b.png", "aa.png" };
+  for (unsigned int i = 0; i < sizeof(paths) / sizeof(paths[0]); i++)
+  {
+    CXBTFFile file;
+    file.SetPath(paths[i]);
+    reader.AddFile(file);
+  }
+
+  std::vector<CXBTFFile> files = reader.GetFiles();
+  ASSERT_EQ(4u, files.size());
+  EXPECT_EQ("a.png", files[0].GetPath());
+  EXPECT_EQ("aa.png", files[1].GetPath());
+  EXPECT_EQ("b.png", files[2].GetPath());
+  EXPECT_EQ("c/d.png", files[3].GetPath());
+
+  EXPECT_TRUE(reader.Exists("aa.png"));
+  EXPECT_TRUE(reader.Exists("c/d.png"));
+  EXPECT_FALSE(reader.Exists("a"));
+  EXPECT_FALSE(reader.Exists("d.png"));
+}
+
+TEST(TestXBTFReader, FrameOutsideBundle)
+{
+  XFILE::CFile *file = XBMC_CREATETEMPFILE(".xbt");
+  ASSERT_NE(nullptr, file);
+
+  // one file with one frame that claims to lie past the end of the bundle
+  std::string data = XBTF_MAGIC + XBTF_VERSION;
+  data.append("\x01\0\0\0", 4);
+  data.append("a.png");
+  data.resize(data.size() + CXBTFFile::MaximumPathLength - 5, '\0');
+  data.append("\0\0\0\0" "\x01\0\0\0", 8);
+  data.append("\x01\0\0\0" "\x01\0\0\0" "\x10\0\0\0", 12);
+  data.append("\x04\0\0\0\0\0\0\0" "\x04\0\0\0\0\0\0\0", 16);
+  data.append("\0\0\0\0", 4);
+  data.append("\0\x10\0\0\0\0\0\0", 8);
+  data.append("\xff\xff\xff\xff", 4);
+  EXPECT_EQ(static_cast<ssize_t>(data.size()), file->Write(data.c_str(), data.size()));
+  file->Flush();
+
+  CXBTFReader reader;
+  EXPECT_FALSE(reader.Open(XBMC_TEMPFILEPATH(file)));
+  EXPECT_FALSE(reader.IsOpen());
+
+  EXPECT_TRUE(XBMC_DELETETEMPFILE(file));
+}
+
+#if defined(TARGET_POSIX)
+TEST(TestXBTFReader, ReplacedBundle)
+{
+  XFILE::CFile *file = XBMC_CREATETEMPFILE(".xbt");
+  ASSERT_NE(nullptr, file);
+
+  // one file with one unpacked 1x1 frame right after the header
+  std::string data = XBTF_MAGIC + XBTF_VERSION;
+  data.append("\x01\0\0\0", 4);
+  data.append("a.png");
+  data.resize(data.size() + CXBTFFile::MaximumPathLength - 5, '\0');
+  data.append("\0\0\0\0" "\x01\0\0\0", 8);
+  data.append("\x01\0\0\0" "\x01\0\0\0" "\x10\0\0\0", 12);
+  data.append("\x04\0\0\0\0\0\0\0" "\x04\0\0\0\0\0\0\0", 16);
+  data.append("\0\0\0\0", 4);
+  data.append("\x39\x01\0\0\0\0\0\0", 8);
+  size_t headerSize = data.size();
+  data.append("\x11\x22\x33\x44", 4);
+  EXPECT_EQ(static_cast<ssize_t>(data.size()), file->Write(data.c_str(), data.size()));
+  file->Flush();
+
+  CXBTFReader reader;
+  ASSERT_TRUE(reader.Open(XBMC_TEMPFILEPATH(file)));
+  ASSERT_EQ(headerSize, reader.GetHeaderSize());
+  const CXBTFFrame frame = reader.GetFiles()[0].GetFrames()[0];
+  const uint8_t *pixels = reader.GetFrameData(frame);
+  ASSERT_NE(nullptr, pixels);
+  EXPECT_EQ(0, memcmp(pixels, "\x11\x22\x33\x44", 4));
+
+  // an update writes a new bundle and renames it over the mapped one, the
+  // reader keeps seeing the old contents until it's opened again
+  std::string path = XBMC_TEMPFILEPATH(file);
+  std::string update = path + ".new";
+  data.replace(headerSize, 4, "\x55\x66\x77\x88", 4);
+  FILE *out = fopen(update.c_str(), "wb");
+  ASSERT_NE(nullptr, out);
+  EXPECT_EQ(1u, fwrite(data.c_str(), data.size(), 1, out));
+  fclose(out);
+  ASSERT_EQ(0, rename(update.c_str(), path.c_str()));
+
+  EXPECT_EQ(pixels, reader.GetFrameData(frame));
+  EXPECT_EQ(0, memcmp(pixels, "\x11\x22\x33\x44", 4));
+  unsigned char buffer[4];
+  EXPECT_TRUE(reader.Load(frame, buffer));
+  EXPECT_EQ(0, memcmp(buffer, "\x11\x22\x33\x44", 4));
+
+  reader.Close();
+  ASSERT_TRUE(reader.Open(path));
+  EXPECT_EQ(0, memcmp(reader.GetFrameData(frame), "\x55\x66\x77\x88", 4));
+
+  reader.Close();
+  EXPECT_TRUE(XBMC_DELETETEMPFILE(file));
+}
+#endif
+
+TEST(TestXBTFReader, SkinBundle)
+{
+  // the bundle is packed while building, so it's only there in a build tree
+  std::string path = XBMC_REF_FILE_PATH("addons/skin.estuary/media/Textures.xbt");
+  if (!XFILE::CFile::Exists(path))
+  {
+    std::cout << "no skin bundle at " << path << ", skipping" << std::endl;
+    return;
+  }
+
+  CXBTFReader reader;
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  ASSERT_TRUE(reader.Open(path));
+  unsigned int opened = XbmcThreads::SystemClockMillis() - start;
+
+  std::vector<CXBTFFile> files = reader.GetFiles();
+  ASSERT_FALSE(files.empty());
+
+  start = XbmcThreads::SystemClockMillis();
+  uint64_t unpacked = 0;
+  for (unsigned int i = 0; i < files.size(); i++)
+  {
+    EXPECT_TRUE(reader.Exists(files[i].GetPath()));
+    const std::vector<CXBTFFrame> &frames = files[i].GetFrames();
+    for (unsigned int j = 0; j < frames.size(); j++)
+    {
+      EXPECT_NE(nullptr, reader.GetFrameData(frames[j]));
+      uint8_t *buffer = CTextureBundleXBT::UnpackFrame(reader, frames[j]);
+      EXPECT_NE(nullptr, buffer) << files[i].GetPath();
+      delete[] buffer;
+      unpacked += frames[j].GetUnpackedSize();
+    }
+  }
+  unsigned int elapsed = XbmcThreads::SystemClockMillis() - start;
+
+  std::cout << files.size() << " textures, opened in " << opened << "ms, "
+            << unpacked / (1024 * 1024) << "MB unpacked in " << elapsed << "ms" << std::endl;
+}
@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <memory>
 
@@ -27,6 +28,23 @@ class CGUIListItem;
 
 namespace INFO
 {
+/*!
+ \ingroup info
+ \brief Inputs the value of an info bool depends on.
+ Info bools are only marked dirty when one of their inputs may have changed,
+ see CGUIInfoManager::ResetCache() and CGUIInfoManager::ResetFrameCache().
+ */
+enum InfoDependency
+{
+  DEPENDS_NONE          = 0x00, ///< constant for the session, e.g. the platform
+  DEPENDS_SKIN_SETTINGS = 0x01, ///< skin settings, marked dirty when they are set
+  DEPENDS_FRAME         = 0x02, ///< everything else (controls, list items, time, ...), polled every frame
+  DEPENDS_PLAYER        = 0x04, ///< whether and how media is played, marked dirty by the playback callbacks of CApplication
+  DEPENDS_WINDOW        = 0x08, ///< the active window and the open dialogs, marked dirty by CGUIWindowManager when they change
+  DEPENDS_LIBRARY       = 0x10, ///< whether the library has content, marked dirty when the cached counts are reset
+  DEPENDS_ALL           = DEPENDS_SKIN_SETTINGS | DEPENDS_FRAME | DEPENDS_PLAYER | DEPENDS_WINDOW | DEPENDS_LIBRARY
+};
+
 /*!
  \ingroup info
  \brief Base class, wrapping boolean conditions and expressions
@@ -38,7 +56,7 @@ public:
   virtual ~InfoBool() {};
 
   /*! \brief Set the info bool dirty.
-   Will cause the info bool to be re-evaluated next call to Get()
+   Will cause the info bool to be re-evaluated next call to Get(). May be called from any thread.
    */
   void SetDirty()
   {
@@ -52,10 +70,11 @@ public:
   {
     if (item && m_listItemDependent)
       Update(item);
-    else if (m_dirty)
+    else if (m_dirty && m_dirty.exchange(false))
     {
+      // cleared first, so a change during the update is not lost
       Update(NULL);
-      m_dirty = false;
+      m_evaluations.fetch_add(1, std::memory_order_relaxed);
     }
     return m_value;
   }
@@ -73,15 +92,27 @@ public:
 
   const std::string &GetExpression() const { return m_expression; }
   bool ListItemDependent() const { return m_listItemDependent; }
+
+  /*! \brief Get the inputs the value of this info bool depends on
+   \return a combination of InfoDependency flags
+   */
+  unsigned int GetDependencies() const { return m_dependencies; }
+
+  /*! \brief Get the number of cached values of all info bools that were updated since the last call
+   */
+  static unsigned int ResetEvaluationCount() { return m_evaluations.exchange(0, std::memory_order_relaxed); }
 protected:
 
   bool m_value;                ///< current value
   int m_context;               ///< contextual information to go with the condition
   bool m_listItemDependent;    ///< do not cache if a listitem pointer is given
+  unsigned int m_dependencies; ///< InfoDependency flags of the inputs of the condition
 
 private:
   std::string  m_expression;   ///< original expression
-  bool         m_dirty;        ///< whether we need an update
+  std::atomic<bool> m_dirty;   ///< whether we need an update
+
+  static std::atomic<unsigned int> m_evaluations;
 };
 
 typedef std::shared_ptr<InfoBool> InfoPtr;
@@ -24,6 +24,7 @@
 #include "GUIInfoManager.h"
 #include <list>
 #include <memory>
+#include <utility>
 
 using namespace INFO;
 
@@ -31,6 +32,7 @@ InfoSingle::InfoSingle(const std::string &expression, int context)
 : InfoBool(expression, context)
 {
   m_condition = g_infoManager.TranslateSingleString(expression, m_listItemDependent);
+  m_dependencies = g_infoManager.GetDependencies(m_condition);
 }
 
 void InfoSingle::Update(const CGUIListItem *item)
@@ -39,28 +41,40 @@ void InfoSingle::Update(const CGUIListItem *item)
 }
 
 InfoExpression::InfoExpression(const std::string &expression, int context)
-: InfoBool(expression, context)
+: InfoBool(expression, context),
+  m_constant(false)
 {
   if (!Parse(expression))
   {
     CLog::Log(LOGERROR, "Error parsing boolean expression %s", expression.c_str());
-    m_expression_tree = std::make_shared<InfoLeaf>(g_infoManager.Register("false", 0), false);
+    Compile(std::make_shared<InfoLeaf>(g_infoManager.Register("false", 0), false));
   }
 }
 
 void InfoExpression::Update(const CGUIListItem *item)
 {
-  m_value = m_expression_tree->Evaluate(item);
+  if (m_program.empty())
+  {
+    m_value = m_constant;
+    return;
+  }
+
+  int next = 0;
+  do
+  {
+    const Instruction &instruction = m_program[next];
+    next = instruction.info->Get(item) ? instruction.onTrue : instruction.onFalse;
+  } while (next >= 0);
+  m_value = next == RESULT_TRUE;
 }
 
 /* Expressions are rewritten at parse time into a form which favours the
- * formation of groups of associative nodes. These groups are then reordered at
- * evaluation time such that nodes whose value renders the evaluation of the
- * remainder of the group unnecessary tend to be evaluated first (these are
- * true nodes for OR subexpressions, or false nodes for AND subexpressions).
- * The end effect is to minimise the number of leaf nodes that need to be
- * evaluated in order to determine the value of the expression. The runtime
- * adaptability has the advantage of not being customised for any particular skin.
+ * formation of groups of associative nodes. The tree is then compiled into a
+ * program with one instruction per leaf, which jumps past the remainder of a
+ * group as soon as its value is known (on true for OR groups, on false for
+ * AND groups). Leaves whose value can't change are folded into the jumps of
+ * the instructions leading to them, so an expression may be reduced to a
+ * constant.
  *
  * The modifications to the expression at parse time fall into two groups:
  * 1) Moving logical NOTs so that they are only applied to leaf nodes.
@@ -71,9 +85,22 @@ void InfoExpression::Update(const CGUIListItem *item)
  *    operations. So [A|B]|[C|D+[[E|F]|G] becomes A|B|C|[D+[E|F|G]].
  */
 
-bool InfoExpression::InfoLeaf::Evaluate(const CGUIListItem *item)
+int InfoExpression::InfoLeaf::Compile(Program &program, int onTrue, int onFalse) const
 {
-  return m_invert ^ m_info->Get(item);
+  if (m_invert)
+    std::swap(onTrue, onFalse);
+
+  // fold operands that are constant for the session
+  if (m_info->GetDependencies() == DEPENDS_NONE && !m_info->ListItemDependent())
+    return m_info->Get() ? onTrue : onFalse;
+  // the result doesn't depend on this operand
+  if (onTrue == onFalse)
+    return onTrue;
+
+  Instruction instruction = { m_info.get(), onTrue, onFalse };
+  program.instructions.push_back(instruction);
+  program.operands.push_back(m_info);
+  return static_cast<int>(program.instructions.size()) - 1;
 }
 
 InfoExpression::InfoAssociativeGroup::InfoAssociativeGroup(
@@ -96,27 +123,70 @@ void InfoExpression::InfoAssociativeGroup::Merge(std::shared_ptr<InfoAssociative
   m_children.splice(m_children.end(), other->m_children);
 }
 
-bool InfoExpression::InfoAssociativeGroup::Evaluate(const CGUIListItem *item)
+int InfoExpression::InfoAssociativeGroup::Compile(Program &program, int onTrue, int onFalse) const
 {
-  /* Handle either AND or OR by using the relation
-   * A AND B == !(!A OR !B)
-   * to convert ANDs into ORs
+  /* Children are emitted from last to first, so every child knows where to
+   * continue: with the next child while the value of the group is undecided,
+   * or with the continuation of the group once it is.
    */
-  std::list<InfoSubexpressionPtr>::iterator last = m_children.end();
-  std::list<InfoSubexpressionPtr>::iterator it = m_children.begin();
   bool use_and = (m_type == NODE_AND);
-  bool result = use_and ^ (*it)->Evaluate(item);
-  while (!result && ++it != last)
+  int next = use_and ? onTrue : onFalse;
+  for (std::list<InfoSubexpressionPtr>::const_reverse_iterator it = m_children.rbegin(); it != m_children.rend(); ++it)
   {
-    result = use_and ^ (*it)->Evaluate(item);
-    if (result)
-    {
-      /* Move this child to the head of the list so we evaluate faster next time */
-      m_children.push_front(*it);
-      m_children.erase(it);
-    }
+    if (use_and)
+      next = (*it)->Compile(program, next, onFalse);
+    else
+      next = (*it)->Compile(program, onTrue, next);
+  }
+  return next;
+}
+
+void InfoExpression::Compile(const InfoSubexpressionPtr &expression_tree)
+{
+  Program program;
+  int start = expression_tree->Compile(program, RESULT_TRUE, RESULT_FALSE);
+
+  m_program.clear();
+  m_operands.clear();
+  m_constant = start == RESULT_TRUE;
+  m_dependencies = DEPENDS_NONE;
+  m_listItemDependent = false;
+  if (start < 0)
+    return;
+
+  /* Instructions only jump to instructions emitted before them. Keep the ones
+   * reachable from the start in reverse order of emission, so the program
+   * starts at 0 and always jumps forward.
+   */
+  std::vector<int> index(program.instructions.size(), -1);
+  index[start] = 0;
+  for (int i = start; i >= 0; i--)
+  {
+    if (index[i] < 0)
+      continue;
+    index[i] = static_cast<int>(m_program.size());
+    const Instruction &instruction = program.instructions[i];
+    if (instruction.onTrue >= 0)
+      index[instruction.onTrue] = 0;
+    if (instruction.onFalse >= 0)
+      index[instruction.onFalse] = 0;
+    m_program.push_back(instruction);
+    m_operands.push_back(program.operands[i]);
+  }
+  for (auto &instruction : m_program)
+  {
+    if (instruction.onTrue >= 0)
+      instruction.onTrue = index[instruction.onTrue];
+    if (instruction.onFalse >= 0)
+      instruction.onFalse = index[instruction.onFalse];
+  }
+
+  // the expression depends on whatever its remaining operands depend on
+  for (const auto &operand : m_operands)
+  {
+    m_dependencies |= operand->GetDependencies();
+    m_listItemDependent |= operand->ListItemDependent();
   }
-  return use_and ^ result;
 }
 
 /* Expressions are parsed using the shunting-yard algorithm. Binary operators
@@ -306,6 +376,6 @@ bool InfoExpression::Parse(const std::string &expression)
   while (!operator_stack.empty())
     OperatorPop(operator_stack, invert, nodes);
 
-  m_expression_tree = nodes.top();
+  Compile(nodes.top());
   return true;
 }
@@ -43,6 +43,10 @@ private:
 };
 
 /*! \brief Class to wrap active boolean expressions
+
+ Expressions are parsed into a tree which is then compiled into a flat program
+ of operand tests. Every instruction evaluates one operand and jumps to the next
+ instruction to run or to the result, depending on the value of the operand.
  */
 class InfoExpression : public InfoBool
 {
@@ -51,7 +55,31 @@ public:
   virtual ~InfoExpression() {};
 
   virtual void Update(const CGUIListItem *item);
+
+  /*! \brief Get the number of operands tested by the compiled expression,
+   operands whose value is constant are folded at compile time.
+   */
+  size_t GetProgramSize() const { return m_program.size(); }
 private:
+  enum
+  {
+    RESULT_FALSE = -1,
+    RESULT_TRUE = -2
+  };
+
+  struct Instruction
+  {
+    InfoBool *info;
+    int onTrue;  ///< next instruction if the operand is true, or RESULT_TRUE/RESULT_FALSE
+    int onFalse; ///< next instruction if the operand is false, or RESULT_TRUE/RESULT_FALSE
+  };
+
+  struct Program
+  {
+    std::vector<Instruction> instructions;
+    std::vector<InfoPtr> operands;
+  };
+
   typedef enum
   {
     OPERATOR_NONE  = 0,
@@ -74,7 +102,10 @@ private:
   {
   public:
     virtual ~InfoSubexpression(void) {}; // so we can destruct derived classes using a pointer to their base class
-    virtual bool Evaluate(const CGUIListItem *item) = 0;
+    /*! \brief Emit the instructions of the node in reverse order
+     \return the instruction to start with, or the result if the node is constant
+     */
+    virtual int Compile(Program &program, int onTrue, int onFalse) const = 0;
     virtual node_type_t Type() const=0;
   };
 
@@ -85,7 +116,7 @@ private:
   {
   public:
     InfoLeaf(InfoPtr info, bool invert) : m_info(info), m_invert(invert) {};
-    virtual bool Evaluate(const CGUIListItem *item);
+    virtual int Compile(Program &program, int onTrue, int onFalse) const;
     virtual node_type_t Type() const { return NODE_LEAF; };
   private:
     InfoPtr m_info;
@@ -99,7 +130,7 @@ private:
     InfoAssociativeGroup(node_type_t type, const InfoSubexpressionPtr &left, const InfoSubexpressionPtr &right);
     void AddChild(const InfoSubexpressionPtr &child);
     void Merge(std::shared_ptr<InfoAssociativeGroup> other);
-    virtual bool Evaluate(const CGUIListItem *item);
+    virtual int Compile(Program &program, int onTrue, int onFalse) const;
     virtual node_type_t Type() const { return m_type; };
   private:
     node_type_t m_type;
@@ -109,7 +140,11 @@ private:
   static operator_t GetOperator(char ch);
   static void OperatorPop(std::stack<operator_t> &operator_stack, bool &invert, std::stack<InfoSubexpressionPtr> &nodes);
   bool Parse(const std::string &expression);
-  InfoSubexpressionPtr m_expression_tree;
+  void Compile(const InfoSubexpressionPtr &expression_tree);
+
+  std::vector<Instruction> m_program;
+  std::vector<InfoPtr> m_operands; ///< keeps the operands of the program alive
+  bool m_constant;                 ///< value if every operand was folded
 };
 
 };
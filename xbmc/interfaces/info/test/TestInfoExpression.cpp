@@ -0,0 +1,379 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUIInfoManager.h"
+#include "guiinfo/GUIInfoLabels.h"
+#include "guilib/GUIInfoTypes.h"
+#include "guilib/WindowIDs.h"
+#include "interfaces/info/InfoExpression.h"
+#include "test/TestUtils.h"
+#include "utils/StringUtils.h"
+#include "utils/XBMCTinyXML.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+using namespace INFO;
+
+namespace
+{
+const char *IncludeFiles[] =
+{
+  "addons/skin.estuary/xml/Includes.xml",
+  "addons/skin.estuary/xml/Includes_Buttons.xml",
+  "addons/skin.estuary/xml/Includes_Home.xml",
+  "addons/skin.estuary/xml/Includes_MediaMenu.xml",
+  "addons/skin.estuary/xml/Includes_PVR.xml",
+  "addons/skin.estouchy/xml/Includes.xml",
+  "addons/skin.estouchy/xml/IncludesCodecFlagging.xml",
+  "addons/skin.estouchy/xml/IncludesHomeRecentlyAdded.xml",
+  "addons/skin.estouchy/xml/IncludesPlayerControls.xml",
+};
+
+// conditions and labels that don't need a loaded skin or include parameters
+bool IsUsable(const std::string &text)
+{
+  std::string lower(text);
+  StringUtils::ToLower(lower);
+  return lower.find("skin.") == std::string::npos && lower.find("$param") == std::string::npos &&
+         lower.find("$exp") == std::string::npos && lower.find("$var") == std::string::npos;
+}
+
+void GetConditions(const TiXmlElement *element, std::vector<std::string> &conditions, std::vector<std::string> &labels)
+{
+  for (; element; element = element->NextSiblingElement())
+  {
+    const char *condition = element->Attribute("condition");
+    if (condition && IsUsable(condition))
+      conditions.push_back(condition);
+
+    const TiXmlNode *text = element->FirstChild();
+    if (text && text->Type() == TiXmlNode::TINYXML_TEXT && IsUsable(text->ValueStr()))
+    {
+      if (element->ValueStr() == "visible" || element->ValueStr() == "enable")
+        conditions.push_back(text->ValueStr());
+      else if (element->ValueStr() == "label" && text->ValueStr().find("$INFO[") != std::string::npos)
+        labels.push_back(text->ValueStr());
+    }
+    GetConditions(element->FirstChildElement(), conditions, labels);
+  }
+}
+
+/* The tree walking evaluator expressions used before they were compiled, as
+ * the reference for the compiled program. NOTs are pushed down to the leaves,
+ * nested groups of the same type are merged and a child deciding the value of
+ * its group is moved to the front, so it is tested first the next time.
+ */
+class TreeNode
+{
+public:
+  virtual ~TreeNode() {}
+  virtual bool Evaluate(const CGUIListItem *item) = 0;
+};
+
+typedef std::shared_ptr<TreeNode> TreeNodePtr;
+
+class TreeLeaf : public TreeNode
+{
+public:
+  TreeLeaf(const InfoPtr &info, bool invert) : m_info(info), m_invert(invert) {}
+  bool Evaluate(const CGUIListItem *item) override { return m_invert ^ m_info->Get(item); }
+private:
+  InfoPtr m_info;
+  bool m_invert;
+};
+
+class TreeGroup : public TreeNode
+{
+public:
+  explicit TreeGroup(bool isAnd) : m_and(isAnd) {}
+  bool IsAnd() const { return m_and; }
+  void Add(const TreeNodePtr &child)
+  {
+    std::shared_ptr<TreeGroup> group = std::dynamic_pointer_cast<TreeGroup>(child);
+    if (group && group->m_and == m_and)
+      m_children.splice(m_children.end(), group->m_children);
+    else
+      m_children.push_back(child);
+  }
+  bool Evaluate(const CGUIListItem *item) override
+  {
+    for (auto it = m_children.begin(); it != m_children.end(); ++it)
+    {
+      if ((*it)->Evaluate(item) != m_and)
+      {
+        if (it != m_children.begin())
+          m_children.splice(m_children.begin(), m_children, it);
+        return !m_and;
+      }
+    }
+    return m_and;
+  }
+private:
+  bool m_and;
+  std::list<TreeNodePtr> m_children;
+};
+
+// recursive descent over the grammar of boolean expressions, + binds tighter than |
+class TreeParser
+{
+public:
+  explicit TreeParser(const std::string &expression) : m_s(expression.c_str()) {}
+
+  TreeNodePtr Parse()
+  {
+    TreeNodePtr tree = ParseGroup(false, false);
+    SkipSpace();
+    return *m_s ? TreeNodePtr() : tree;
+  }
+
+private:
+  void SkipSpace()
+  {
+    while (isspace(static_cast<unsigned char>(*m_s)))
+      m_s++;
+  }
+
+  // an OR of ANDs, or an AND of operands with andLevel, inverted by De Morgan
+  TreeNodePtr ParseGroup(bool invert, bool andLevel)
+  {
+    const char op = andLevel ? '+' : '|';
+    TreeNodePtr first = andLevel ? ParseOperand(invert) : ParseGroup(invert, true);
+    if (!first)
+      return first;
+    SkipSpace();
+    if (*m_s != op)
+      return first;
+
+    std::shared_ptr<TreeGroup> group = std::make_shared<TreeGroup>(andLevel != invert);
+    group->Add(first);
+    while (*m_s == op)
+    {
+      m_s++;
+      TreeNodePtr next = andLevel ? ParseOperand(invert) : ParseGroup(invert, true);
+      if (!next)
+        return next;
+      group->Add(next);
+      SkipSpace();
+    }
+    return group;
+  }
+
+  TreeNodePtr ParseOperand(bool invert)
+  {
+    SkipSpace();
+    if (*m_s == '!')
+    {
+      m_s++;
+      return ParseOperand(!invert);
+    }
+    if (*m_s == '[')
+    {
+      m_s++;
+      TreeNodePtr node = ParseGroup(invert, false);
+      SkipSpace();
+      if (!node || *m_s != ']')
+        return TreeNodePtr();
+      m_s++;
+      return node;
+    }
+    std::string operand;
+    while (*m_s && !strchr("[]!+|", *m_s))
+      operand += *m_s++;
+    InfoPtr info = operand.empty() ? InfoPtr() : g_infoManager.Register(operand, 0);
+    return info ? std::make_shared<TreeLeaf>(info, invert) : TreeNodePtr();
+  }
+
+  const char *m_s;
+};
+}
+
+TEST(TestInfoExpression, ConstantFolding)
+{
+  InfoPtr info = g_infoManager.Register("true + !false", 0);
+  ASSERT_TRUE(info);
+  EXPECT_EQ(0u, std::static_pointer_cast<InfoExpression>(info)->GetProgramSize());
+  EXPECT_EQ(DEPENDS_NONE, info->GetDependencies());
+  EXPECT_TRUE(info->Get());
+
+  info = g_infoManager.Register("false + player.hasmedia", 0);
+  EXPECT_EQ(0u, std::static_pointer_cast<InfoExpression>(info)->GetProgramSize());
+  EXPECT_FALSE(info->Get());
+
+  info = g_infoManager.Register("[false | player.hasmedia] + [true | player.paused]", 0);
+  EXPECT_EQ(1u, std::static_pointer_cast<InfoExpression>(info)->GetProgramSize());
+  EXPECT_EQ(DEPENDS_PLAYER, info->GetDependencies());
+  EXPECT_FALSE(info->Get());
+}
+
+TEST(TestInfoExpression, Evaluate)
+{
+  // nothing is playing, so every player condition is false
+  const struct
+  {
+    const char *expression;
+    bool value;
+  } expressions[] =
+  {
+    { "player.hasmedia | player.paused", false },
+    { "!player.hasmedia + !player.paused", true },
+    { "![player.hasmedia | player.paused]", true },
+    { "player.hasmedia | [!player.paused + !player.hasvideo]", true },
+    { "!player.hasmedia + [player.paused | player.hasvideo]", false },
+  };
+  for (const auto &expression : expressions)
+    EXPECT_EQ(expression.value, g_infoManager.Register(expression.expression, 0)->Get()) << expression.expression;
+}
+
+TEST(TestInfoExpression, Dependencies)
+{
+  InfoPtr player = g_infoManager.Register("player.hasmedia | player.paused", 0);
+  InfoPtr window = g_infoManager.Register("window.next(settings)", 0);
+  InfoPtr library = g_infoManager.Register("library.hascontent(movies)", 0);
+  InfoPtr frame = g_infoManager.Register("system.hasalarm(shutdowntimer)", 0);
+  InfoPtr mixed = g_infoManager.Register("player.hasmedia + system.hasalarm(shutdowntimer)", 0);
+  EXPECT_EQ(DEPENDS_PLAYER, player->GetDependencies());
+  EXPECT_EQ(DEPENDS_WINDOW, window->GetDependencies());
+  EXPECT_EQ(DEPENDS_LIBRARY, library->GetDependencies());
+  EXPECT_EQ(DEPENDS_FRAME, frame->GetDependencies());
+  EXPECT_EQ(DEPENDS_PLAYER | DEPENDS_FRAME, mixed->GetDependencies());
+
+  InfoPtr infos[] = { player, window, library, frame, mixed };
+  auto render = [&infos]()
+  {
+    for (const InfoPtr &info : infos)
+      info->Get();
+    g_infoManager.ResetFrameCache();
+    return g_infoManager.GetBoolEvaluations();
+  };
+
+  // the library state is set, so no database is needed
+  g_infoManager.SetLibraryBool(LIBRARY_HAS_MOVIES, true);
+  render();
+  render();
+
+  // as long as nothing changes only what is polled every frame is evaluated again
+  for (int i = 0; i < 10; i++)
+    EXPECT_EQ(2u, render());
+  EXPECT_FALSE(player->Get());
+  EXPECT_FALSE(window->Get());
+  EXPECT_TRUE(library->Get());
+
+  g_infoManager.SetLibraryBool(LIBRARY_HAS_MOVIES, false);
+  EXPECT_FALSE(library->Get());
+  EXPECT_EQ(3u, render());
+  EXPECT_EQ(2u, render());
+
+  // the scanners change the library state from their own threads
+  std::thread scanner([]() { g_infoManager.SetLibraryBool(LIBRARY_HAS_MOVIES, true); });
+  scanner.join();
+  EXPECT_TRUE(library->Get());
+  EXPECT_EQ(3u, render());
+
+  // a window change is picked up within the same frame
+  g_infoManager.SetNextWindow(WINDOW_SETTINGS_MENU);
+  EXPECT_TRUE(window->Get());
+  EXPECT_EQ(3u, render());
+  EXPECT_EQ(2u, render());
+  g_infoManager.SetNextWindow(WINDOW_INVALID);
+  EXPECT_FALSE(window->Get());
+
+  g_infoManager.ResetLibraryBools();
+}
+
+TEST(TestInfoExpression, SkinIncludes)
+{
+  std::vector<std::string> conditions;
+  std::vector<std::string> labels;
+  for (const char *file : IncludeFiles)
+  {
+    CXBMCTinyXML doc;
+    ASSERT_TRUE(doc.LoadFile(XBMC_REF_FILE_PATH(file))) << file;
+    GetConditions(doc.RootElement(), conditions, labels);
+  }
+  ASSERT_FALSE(conditions.empty());
+
+  std::vector<std::shared_ptr<InfoExpression> > expressions;
+  std::vector<TreeNodePtr> trees;
+  size_t operands = 0;
+  for (const auto &condition : conditions)
+  {
+    InfoPtr info = g_infoManager.Register(condition, 0);
+    std::shared_ptr<InfoExpression> expression = std::dynamic_pointer_cast<InfoExpression>(info);
+    if (!expression)
+      continue;
+    TreeNodePtr tree = TreeParser(condition).Parse();
+    ASSERT_TRUE(tree) << condition;
+    expressions.push_back(expression);
+    trees.push_back(tree);
+    operands += expression->GetProgramSize();
+    // both evaluators agree on the skin's conditions
+    EXPECT_EQ(tree->Evaluate(NULL), expression->Get()) << condition;
+  }
+
+  std::vector<CGUIInfoLabel> infoLabels;
+  for (const auto &label : labels)
+    infoLabels.push_back(CGUIInfoLabel(label));
+
+  // operands stay cached, so only the expressions themselves are evaluated,
+  // by the compiled program and by the former tree walk on the same conditions
+  const int frames = 1000;
+  auto start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < frames; frame++)
+  {
+    for (const auto &expression : expressions)
+      expression->Update(NULL);
+  }
+  auto programTime = std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < frames; frame++)
+  {
+    for (const auto &tree : trees)
+      tree->Evaluate(NULL);
+  }
+  auto treeTime = std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < frames; frame++)
+  {
+    for (const auto &label : infoLabels)
+      label.GetLabel(0);
+  }
+  auto labelTime = std::chrono::steady_clock::now() - start;
+
+  long long evaluations = frames * std::max<long long>(expressions.size(), 1);
+  long long programNs = std::chrono::duration_cast<std::chrono::nanoseconds>(programTime).count();
+  long long treeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(treeTime).count();
+  std::cout << expressions.size() << " expressions of the estuary and estouchy includes with "
+            << operands << " operands after folding: program " << programNs / evaluations
+            << " ns, tree " << treeNs / evaluations << " ns per evaluation, "
+            << "the program is " << static_cast<double>(treeNs) / std::max(programNs, 1LL) << "x as fast" << std::endl;
+  std::cout << infoLabels.size() << " labels: "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(labelTime).count() / (frames * std::max<size_t>(infoLabels.size(), 1))
+            << " ns per label" << std::endl;
+}
@@ -20,6 +20,9 @@
 
 #include "MusicDatabase.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "addons/Addon.h"
 #include "addons/AddonManager.h"
 #include "addons/AddonSystemSettings.h"
@@ -45,6 +48,7 @@
 #include "guilib/LocalizeStrings.h"
 #include "interfaces/AnnouncementManager.h"
 #include "messaging/helpers/DialogHelper.h"
+#include "music/MusicSongPager.h"
 #include "music/tags/MusicInfoTag.h"
 #include "network/cddb.h"
 #include "network/Network.h"
@@ -108,6 +112,7 @@ static void AnnounceUpdate(const std::string& content, int id)
 CMusicDatabase::CMusicDatabase(void)
 {
   m_translateBlankArtist = true;
+  m_linksFailed = false;
 }
 
 CMusicDatabase::~CMusicDatabase(void)
@@ -158,6 +163,8 @@ void CMusicDatabase::CreateTables()
   m_pDS->exec("CREATE TABLE genre (idGenre integer primary key, strGenre varchar(256))");
   CLog::Log(LOGINFO, "create path table");
   m_pDS->exec("CREATE TABLE path (idPath integer primary key, strPath varchar(512), strHash text)");
+  CLog::Log(LOGINFO, "create pathfingerprint table");
+  m_pDS->exec("CREATE TABLE pathfingerprint (strPath varchar(512), iMTime bigint, iSize bigint)");
   CLog::Log(LOGINFO, "create song table");
   m_pDS->exec("CREATE TABLE song (idSong integer primary key, "
               " idAlbum integer, idPath integer, "
@@ -213,6 +220,7 @@ void CMusicDatabase::CreateAnalytics()
   m_pDS->exec("CREATE UNIQUE INDEX idxArtist1 ON artist(strMusicBrainzArtistID(36))");
 
   m_pDS->exec("CREATE INDEX idxPath ON path(strPath(255))");
+  m_pDS->exec("CREATE INDEX idxPathFingerprint ON pathfingerprint(strPath(255))");
 
   m_pDS->exec("CREATE INDEX idxSong ON song(strTitle(255))");
   m_pDS->exec("CREATE INDEX idxSong1 ON song(iTimesPlayed)");
@@ -547,8 +555,9 @@ bool CMusicDatabase::AddAlbum(CAlbum& album)
   for (const auto &albumArt : album.art)
     SetArtForItem(album.idAlbum, MediaTypeAlbum, albumArt.first, albumArt.second);
 
+  bool linked = FlushLinks();
   CommitTransaction();
-  return true;
+  return linked;
 }
 
 bool CMusicDatabase::UpdateAlbum(CAlbum& album, bool OverrideTagData /* = true*/)
@@ -658,49 +667,50 @@ int CMusicDatabase::AddSong(const int idAlbum,
     URIUtils::Split(strPathAndFileName, strPath, strFileName);
     int idPath = AddPath(strPath);
 
+    // the statements are prepared once and reused for every song of a scan
+    bool found;
     if (!strMusicBrainzTrackID.empty())
-      strSQL = PrepareSQL("SELECT * FROM song WHERE idAlbum = %i AND strMusicBrainzTrackID = '%s'",
-                          idAlbum,
-                          strMusicBrainzTrackID.c_str());
+    {
+      strSQL = "SELECT * FROM song WHERE idAlbum = ? AND strMusicBrainzTrackID = ?";
+      found = m_pDS->query(strSQL, { idAlbum, strMusicBrainzTrackID });
+    }
     else
-      strSQL = PrepareSQL("SELECT * FROM song WHERE idAlbum=%i AND strFileName='%s' AND strTitle='%s' AND iTrack=%i AND strMusicBrainzTrackID IS NULL",
-                          idAlbum,
-                          strFileName.c_str(),
-                          strTitle.c_str(),
-                          iTrack);
-
-    if (!m_pDS->query(strSQL))
+    {
+      strSQL = "SELECT * FROM song WHERE idAlbum = ? AND strFileName = ? AND strTitle = ? AND iTrack = ? AND strMusicBrainzTrackID IS NULL";
+      found = m_pDS->query(strSQL, { idAlbum, strFileName, strTitle, iTrack });
+    }
+    if (!found)
       return -1;
 
     if (m_pDS->num_rows() == 0)
     {
       m_pDS->close();
-      strSQL=PrepareSQL("INSERT INTO song ("
-                                          "idSong,idAlbum,idPath,strArtists,strGenres,"
-                                          "strTitle,iTrack,iDuration,iYear,strFileName,"
-                                          "strMusicBrainzTrackID,iTimesPlayed,iStartOffset,"
-                                          "iEndOffset,lastplayed,rating,userrating,votes,comment,mood"
-                        ") values (NULL, %i, %i, '%s', '%s', '%s', %i, %i, %i, '%s'",
-                    idAlbum,
-                    idPath,
-                    artistString.c_str(),
-                    StringUtils::Join(genres, g_advancedSettings.m_musicItemSeparator).c_str(),
-                    strTitle.c_str(),
-                    iTrack, iDuration, iYear,
-                    strFileName.c_str());
-
+      dbiplus::field_value musicBrainzTrackID(strMusicBrainzTrackID);
       if (strMusicBrainzTrackID.empty())
-        strSQL += PrepareSQL(",NULL");
-      else
-        strSQL += PrepareSQL(",'%s'", strMusicBrainzTrackID.c_str());
-
-      if (dtLastPlayed.IsValid())
-        strSQL += PrepareSQL(",%i,%i,%i,'%s', %.1f, %i, %i, '%s','%s')",
-                      iTimesPlayed, iStartOffset, iEndOffset, dtLastPlayed.GetAsDBDateTime().c_str(), rating, userrating, votes, strComment.c_str(), strMood.c_str());
-      else
-        strSQL += PrepareSQL(",%i,%i,%i,NULL, %.1f, %i, %i,'%s', '%s')",
-                      iTimesPlayed, iStartOffset, iEndOffset, rating, userrating, votes, strComment.c_str(), strMood.c_str());
-      m_pDS->exec(strSQL);
+        musicBrainzTrackID.set_isNull();
+      dbiplus::field_value lastPlayed(dtLastPlayed.IsValid() ? dtLastPlayed.GetAsDBDateTime() : "");
+      if (!dtLastPlayed.IsValid())
+        lastPlayed.set_isNull();
+
+      strSQL = "INSERT INTO song ("
+                                 "idSong,idAlbum,idPath,strArtists,strGenres,"
+                                 "strTitle,iTrack,iDuration,iYear,strFileName,"
+                                 "strMusicBrainzTrackID,iTimesPlayed,iStartOffset,"
+                                 "iEndOffset,lastplayed,rating,userrating,votes,comment,mood"
+               ") values (NULL, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+      m_pDS->exec(strSQL, { idAlbum,
+                            idPath,
+                            artistString,
+                            StringUtils::Join(genres, g_advancedSettings.m_musicItemSeparator),
+                            strTitle,
+                            iTrack, iDuration, iYear,
+                            strFileName,
+                            musicBrainzTrackID,
+                            iTimesPlayed, iStartOffset, iEndOffset,
+                            lastPlayed,
+                            std::round(rating * 10.0) / 10.0, // stored with one decimal
+                            userrating, votes,
+                            strComment, strMood });
       idSong = (int)m_pDS->lastinsertid();
     }
     else
@@ -1453,10 +1463,8 @@ bool CMusicDatabase::AddSongArtist(int idArtist, int idSong, const std::string&
 
 bool CMusicDatabase::AddSongArtist(int idArtist, int idSong, int idRole, const std::string& strArtist, int iOrder)
 {
-  std::string strSQL;
-  strSQL = PrepareSQL("replace into song_artist (idArtist, idSong, idRole, strArtist, iOrder) values(%i,%i,%i,'%s',%i)",
-    idArtist, idSong, idRole, strArtist.c_str(), iOrder);
-  return ExecuteQuery(strSQL);
+  return AddLink("replace into song_artist (idArtist, idSong, idRole, strArtist, iOrder) values",
+          PrepareSQL("(%i,%i,%i,'%s',%i)", idArtist, idSong, idRole, strArtist.c_str(), iOrder));
 }
 
 int CMusicDatabase::AddSongContributor(int idSong, const std::string& strRole, const std::string& strArtist)
@@ -1470,6 +1478,9 @@ int CMusicDatabase::AddSongContributor(int idSong, const std::string& strRole, c
     if (NULL == m_pDB.get()) return -1;
     if (NULL == m_pDS.get()) return -1;
 
+    // staged artists of the song have to be written before looking them up
+    FlushLinks();
+
     int idArtist = -1;
     // Add artist. As we only have name (no MBID) first try to identify artist from song 
     // as they may have already been added with a different role (including MBID).
@@ -1568,19 +1579,21 @@ bool CMusicDatabase::GetRolesByArtist(int idArtist, CFileItem* item)
 
 bool CMusicDatabase::DeleteSongArtistsBySong(int idSong)
 {
+  if (!FlushLinks())
+    return false;
   return ExecuteQuery(PrepareSQL("DELETE FROM song_artist WHERE idSong = %i", idSong));
 }
 
 bool CMusicDatabase::AddAlbumArtist(int idArtist, int idAlbum, std::string strArtist, int iOrder)
 {
-  std::string strSQL;
-  strSQL = PrepareSQL("replace into album_artist (idArtist, idAlbum, strArtist, iOrder) values(%i,%i,'%s',%i)",
-    idArtist, idAlbum, strArtist.c_str(), iOrder);
-  return ExecuteQuery(strSQL);
+  return AddLink("replace into album_artist (idArtist, idAlbum, strArtist, iOrder) values",
+          PrepareSQL("(%i,%i,'%s',%i)", idArtist, idAlbum, strArtist.c_str(), iOrder));
 }
 
 bool CMusicDatabase::DeleteAlbumArtistsByAlbum(int idAlbum)
 {
+  if (!FlushLinks())
+    return false;
   return ExecuteQuery(PrepareSQL("DELETE FROM album_artist WHERE idAlbum = %i", idAlbum));
 }
 
@@ -1589,14 +1602,14 @@ bool CMusicDatabase::AddSongGenre(int idGenre, int idSong, int iOrder)
   if (idGenre == -1 || idSong == -1)
     return true;
 
-  std::string strSQL;
-  strSQL=PrepareSQL("replace into song_genre (idGenre, idSong, iOrder) values(%i,%i,%i)",
-                    idGenre, idSong, iOrder);
-  return ExecuteQuery(strSQL);
+  return AddLink("replace into song_genre (idGenre, idSong, iOrder) values",
+          PrepareSQL("(%i,%i,%i)", idGenre, idSong, iOrder));
 };
 
 bool CMusicDatabase::DeleteSongGenresBySong(int idSong)
 {
+  if (!FlushLinks())
+    return false;
   return ExecuteQuery(PrepareSQL("DELETE FROM song_genre WHERE idSong = %i", idSong));
 }
 
@@ -1605,17 +1618,64 @@ bool CMusicDatabase::AddAlbumGenre(int idGenre, int idAlbum, int iOrder)
   if (idGenre == -1 || idAlbum == -1)
     return true;
   
-  std::string strSQL;
-  strSQL=PrepareSQL("replace into album_genre (idGenre, idAlbum, iOrder) values(%i,%i,%i)",
-                    idGenre, idAlbum, iOrder);
-  return ExecuteQuery(strSQL);
+  return AddLink("replace into album_genre (idGenre, idAlbum, iOrder) values",
+          PrepareSQL("(%i,%i,%i)", idGenre, idAlbum, iOrder));
 };
 
 bool CMusicDatabase::DeleteAlbumGenresByAlbum(int idAlbum)
 {
+  if (!FlushLinks())
+    return false;
   return ExecuteQuery(PrepareSQL("DELETE FROM album_genre WHERE idAlbum = %i", idAlbum));
 }
 
+bool CMusicDatabase::AddLink(const std::string &insert, const std::string &row)
+{
+  if (!InBatch())
+    return ExecuteQuery(insert + row);
+
+  m_pendingLinks[insert].push_back(row);
+  return true;
+}
+
+bool CMusicDatabase::FlushLinks()
+{
+  // multi-row inserts are limited to 500 rows by older versions of SQLite
+  static const size_t maxRows = 500;
+
+  bool flushed = true;
+  for (const auto &table : m_pendingLinks)
+  {
+    const std::vector<std::string> &rows = table.second;
+    for (size_t first = 0; first < rows.size(); first += maxRows)
+    {
+      size_t last = std::min(first + maxRows, rows.size());
+      if (!ExecuteQuery(table.first + StringUtils::Join(std::vector<std::string>(rows.begin() + first, rows.begin() + last), ",")))
+        flushed = false;
+    }
+  }
+  m_pendingLinks.clear();
+
+  if (!flushed)
+  {
+    CLog::Log(LOGERROR, "%s - failed to write staged rows", __FUNCTION__);
+    m_linksFailed = true;
+  }
+  return flushed;
+}
+
+bool CMusicDatabase::CommitBatch()
+{
+  bool linked = FlushLinks() && !m_linksFailed;
+  m_linksFailed = false;
+  if (!linked)
+  {
+    RollbackBatch();
+    return false;
+  }
+  return CDatabase::CommitBatch();
+}
+
 bool CMusicDatabase::GetAlbumsByArtist(int idArtist, std::vector<int> &albums)
 {
   try 
@@ -4377,6 +4437,104 @@ bool CMusicDatabase::GetSongsFullByWhere(const std::string &baseDir, const Filte
   return false;
 }
 
+bool CMusicDatabase::GetSongsPaged(const std::string &baseDir, const Filter &filter, CFileItemList &items)
+{
+  if (m_pDB.get() == NULL || m_pDS.get() == NULL)
+    return false;
+
+  try
+  {
+    unsigned int time = XbmcThreads::SystemClockMillis();
+
+    Filter extFilter = filter;
+    CMusicDbUrl musicUrl;
+    SortDescription sorting;
+    if (!musicUrl.FromString(baseDir) || !GetFilter(musicUrl, extFilter, sorting))
+      return false;
+
+    if (extFilter.where.find("albumview") != std::string::npos)
+    {
+      extFilter.AppendJoin("JOIN albumview ON albumview.idAlbum = songview.idAlbum");
+      extFilter.AppendGroup("songview.idSong");
+    }
+
+    std::string strSQLExtra;
+    if (!BuildSQL(strSQLExtra, extFilter, strSQLExtra))
+      return false;
+
+    // small listings and smart playlists with their own order or limit are loaded in full
+    int total = (int)strtol(GetSingleValue("SELECT COUNT(1) FROM songview " + strSQLExtra, m_pDS).c_str(), NULL, 10);
+    if (g_advancedSettings.m_iMusicLibraryPagedListSize <= 0 || total < g_advancedSettings.m_iMusicLibraryPagedListSize ||
+        !extFilter.limit.empty() || !extFilter.order.empty() || sorting.sortBy != SortByNone)
+      return GetSongsFullByWhere(baseDir, filter, items, SortDescription(), true);
+
+    std::string strSQL = "SELECT songview.idSong, songview.strTitle, songview.strFileName FROM songview " + strSQLExtra;
+    CLog::Log(LOGDEBUG, "%s query = %s", __FUNCTION__, strSQL.c_str());
+    if (!m_pDS->query(strSQL))
+      return false;
+
+    std::shared_ptr<CMusicSongPager> pager(new CMusicSongPager(baseDir, strSQLExtra));
+    items.Reserve(m_pDS->num_rows());
+    int count = 0;
+    while (!m_pDS->eof())
+    {
+      int idSong = m_pDS->fv(0).get_asInt();
+      std::string strExt = URIUtils::GetExtension(m_pDS->fv(2).get_asString());
+      CMusicDbUrl itemUrl = musicUrl;
+      itemUrl.AppendPath(StringUtils::Format("%i%s", idSong, strExt.c_str()));
+
+      CFileItemPtr item(new CFileItem);
+      CMusicSongPager::SetPlaceholder(*item, itemUrl.ToString(), m_pDS->fv(1).get_asString());
+      // HACK for sorting by database returned order
+      item->m_iprogramCount = ++count;
+      pager->AddSong(item->GetPath(), idSong);
+      items.Add(item);
+      m_pDS->next();
+    }
+    m_pDS->close();
+
+    items.SetProperty("total", total);
+    items.SetPager(pager);
+    CLog::Log(LOGDEBUG, "%s(%s) - %i placeholders took %d ms", __FUNCTION__, filter.where.c_str(), count, XbmcThreads::SystemClockMillis() - time);
+    return true;
+  }
+  catch (...)
+  {
+    m_pDS->close();
+    CLog::Log(LOGERROR, "%s(%s) failed", __FUNCTION__, filter.where.c_str());
+  }
+  return false;
+}
+
+bool CMusicDatabase::GetSongIds(const std::string &strSQLExtra, const std::string &orderBy, std::vector<int> &songIds)
+{
+  if (m_pDB.get() == NULL || m_pDS.get() == NULL)
+    return false;
+
+  try
+  {
+    songIds.clear();
+    std::string strSQL = "SELECT songview.idSong FROM songview " + strSQLExtra + " ORDER BY " + orderBy;
+    if (!m_pDS->query(strSQL))
+      return false;
+
+    songIds.reserve(m_pDS->num_rows());
+    while (!m_pDS->eof())
+    {
+      songIds.push_back(m_pDS->fv(0).get_asInt());
+      m_pDS->next();
+    }
+    m_pDS->close();
+    return true;
+  }
+  catch (...)
+  {
+    m_pDS->close();
+    CLog::Log(LOGERROR, "%s(%s) failed", __FUNCTION__, orderBy.c_str());
+  }
+  return false;
+}
+
 bool CMusicDatabase::GetSongsByWhere(const std::string &baseDir, const Filter &filter, CFileItemList &items, const SortDescription &sortDescription /* = SortDescription() */)
 {
   if (m_pDB.get() == NULL || m_pDS.get() == NULL)
@@ -4497,7 +4655,7 @@ bool CMusicDatabase::GetSongsByYear(const std::string& baseDir, CFileItemList& i
   return GetSongsFullByWhere(baseDir, filter, items, SortDescription(), true);
 }
 
-bool CMusicDatabase::GetSongsNav(const std::string& strBaseDir, CFileItemList& items, int idGenre, int idArtist, int idAlbum, const SortDescription &sortDescription /* = SortDescription() */)
+bool CMusicDatabase::GetSongsNav(const std::string& strBaseDir, CFileItemList& items, int idGenre, int idArtist, int idAlbum, const SortDescription &sortDescription /* = SortDescription() */, bool paged /* = false */)
 {
   CMusicDbUrl musicUrl;
   if (!musicUrl.FromString(strBaseDir))
@@ -4513,6 +4671,8 @@ bool CMusicDatabase::GetSongsNav(const std::string& strBaseDir, CFileItemList& i
     musicUrl.AddOption("artistid", idArtist);
 
   Filter filter;
+  if (paged && sortDescription.sortBy == SortByNone)
+    return GetSongsPaged(musicUrl.ToString(), filter, items);
   return GetSongsFullByWhere(musicUrl.ToString(), filter, items, sortDescription, true);
 }
 
@@ -4964,11 +5124,13 @@ void CMusicDatabase::UpdateTables(int version)
     CMediaSettings::GetInstance().SetMusicNeedsUpdate(60);
     CServiceBroker::GetSettings().Save();
   }
+  if (version < 61)
+    m_pDS->exec("CREATE TABLE pathfingerprint (strPath varchar(512), iMTime bigint, iSize bigint)");
 }
 
 int CMusicDatabase::GetSchemaVersion() const
 {
-  return 60;
+  return 61;
 }
 
 unsigned int CMusicDatabase::GetSongIDs(const Filter &filter, std::vector<std::pair<int,int> > &songIDs)
@@ -5387,6 +5549,58 @@ bool CMusicDatabase::GetPathHash(const std::string &path, std::string &hash)
   return false;
 }
 
+bool CMusicDatabase::GetPathFingerprints(DirectoryFingerprints &fingerprints)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    fingerprints.clear();
+    if (!m_pDS->query("SELECT strPath, iMTime, iSize FROM pathfingerprint"))
+      return false;
+    while (!m_pDS->eof())
+    {
+      DirectoryFingerprint &fingerprint = fingerprints[m_pDS->fv(0).get_asString()];
+      fingerprint.mtime = m_pDS->fv(1).get_asInt64();
+      fingerprint.size = m_pDS->fv(2).get_asInt64();
+      m_pDS->next();
+    }
+    m_pDS->close();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+  }
+  return false;
+}
+
+bool CMusicDatabase::SetPathFingerprint(const std::string &path, const DirectoryFingerprint &fingerprint)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    m_pDS->exec("DELETE FROM pathfingerprint WHERE strPath = ?", { path });
+    m_pDS->exec("INSERT INTO pathfingerprint (strPath, iMTime, iSize) VALUES (?, ?, ?)",
+                { path, fingerprint.mtime, fingerprint.size });
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s (%s) failed", __FUNCTION__, path.c_str());
+  }
+  return false;
+}
+
+bool CMusicDatabase::RemovePathFingerprints(const std::string &path)
+{
+  return ExecuteQuery(PrepareSQL("DELETE FROM pathfingerprint WHERE SUBSTR(strPath,1,%i)='%s'",
+                                 StringUtils::utf8_strlen(path.c_str()), path.c_str()));
+}
+
 bool CMusicDatabase::RemoveSongsFromPath(const std::string &path1, MAPSONGS& songs, bool exact)
 {
   // We need to remove all songs from this path, as their tags are going
@@ -5465,6 +5679,36 @@ bool CMusicDatabase::RemoveSongsFromPath(const std::string &path1, MAPSONGS& son
   return false;
 }
 
+bool CMusicDatabase::DeleteSongsFromPath(const std::string &path1, const MAPSONGS& songs)
+{
+  std::string path(path1);
+  try
+  {
+    URIUtils::AddSlashAtEnd(path);
+
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    if (!songs.empty())
+    {
+      std::vector<std::string> songIds;
+      for (const auto &song : songs)
+      {
+        AnnounceRemove(MediaTypeSong, song.second.idSong);
+        songIds.push_back(PrepareSQL("%i", song.second.idSong));
+      }
+      m_pDS->exec("delete from song where idSong in (" + StringUtils::Join(songIds, ",") + ")");
+    }
+    m_pDS->exec(PrepareSQL("delete from path where strPath='%s'", path.c_str()));
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s (%s) failed", __FUNCTION__, path.c_str());
+  }
+  return false;
+}
+
 bool CMusicDatabase::GetPaths(std::set<std::string> &paths)
 {
   try
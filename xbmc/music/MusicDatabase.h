@@ -28,6 +28,7 @@
 #include "addons/Scraper.h"
 #include "Album.h"
 #include "dbwrappers/Database.h"
+#include "InfoScanner.h"
 #include "MusicDbUrl.h"
 #include "utils/SortUtils.h"
 
@@ -100,6 +101,12 @@ public:
 
   virtual bool Open();
   virtual bool CommitTransaction();
+
+  /*! \brief Writes the rows staged during the batch and commits it.
+   If any of them could not be written the whole batch is rolled back.
+   \return true if the batch was committed
+   */
+  bool CommitBatch() override;
   void EmptyCache();
   void Clean();
   int  Cleanup(bool bShowProgress=true);
@@ -193,6 +200,13 @@ public:
   bool GetSongsByPath(const std::string& strPath, MAPSONGS& songs, bool bAppendToMap = false);
   bool Search(const std::string& search, CFileItemList &items);
   bool RemoveSongsFromPath(const std::string &path, MAPSONGS& songs, bool exact=true);
+  /*! \brief Deletes songs read earlier with GetSongsByPath together with their path
+   \param path the exact path the songs were read from
+   \param songs the songs to delete, keyed by filename
+   \return true if successful
+   \sa RemoveSongsFromPath
+   */
+  bool DeleteSongsFromPath(const std::string &path, const MAPSONGS& songs);
   bool SetSongUserrating(const std::string &filePath, int userrating);
   bool SetSongVotes(const std::string &filePath, int votes);
   int  GetSongByArtistAndAlbumAndTitle(const std::string& strArtist, const std::string& strAlbum, const std::string& strTitle);
@@ -304,6 +318,16 @@ public:
   bool GetPaths(std::set<std::string> &paths);
   bool SetPathHash(const std::string &path, const std::string &hash);
   bool GetPathHash(const std::string &path, std::string &hash);
+
+  /*! \brief Get the fingerprints of the folders visited by incremental scans
+   \sa CInfoScanner::IsUnchanged
+   */
+  bool GetPathFingerprints(DirectoryFingerprints &fingerprints);
+  bool SetPathFingerprint(const std::string &path, const DirectoryFingerprint &fingerprint);
+
+  /*! \brief Remove the fingerprints of a folder and all folders below it
+   */
+  bool RemovePathFingerprints(const std::string &path);
   bool GetAlbumPath(int idAlbum, std::string &path);
   bool GetArtistPath(int idArtist, std::string &path);
 
@@ -390,10 +414,21 @@ public:
   bool GetMusicLabelsNav(const std::string &strBaseDir, CFileItemList &items, const Filter &filter = Filter(), bool countOnly = false);
   bool GetAlbumsNav(const std::string& strBaseDir, CFileItemList& items, int idGenre = -1, int idArtist = -1, const Filter &filter = Filter(), const SortDescription &sortDescription = SortDescription(), bool countOnly = false);
   bool GetAlbumsByYear(const std::string &strBaseDir, CFileItemList& items, int year);
-  bool GetSongsNav(const std::string& strBaseDir, CFileItemList& items, int idGenre, int idArtist,int idAlbum, const SortDescription &sortDescription = SortDescription());
+  /*!
+   \brief Gets the songs of a musicdb:// listing
+   \param paged true to return placeholder items loaded on demand by a CMusicSongPager if the listing has at least <pagedlistsize> songs
+   */
+  bool GetSongsNav(const std::string& strBaseDir, CFileItemList& items, int idGenre, int idArtist,int idAlbum, const SortDescription &sortDescription = SortDescription(), bool paged = false);
   bool GetSongsByYear(const std::string& baseDir, CFileItemList& items, int year);
   bool GetSongsByWhere(const std::string &baseDir, const Filter &filter, CFileItemList& items, const SortDescription &sortDescription = SortDescription());
   bool GetSongsFullByWhere(const std::string &baseDir, const Filter &filter, CFileItemList& items, const SortDescription &sortDescription = SortDescription(), bool artistData = false, bool cueSheetData = true);
+  bool GetSongsPaged(const std::string &baseDir, const Filter &filter, CFileItemList& items);
+  /*!
+   \brief Gets the ids of the songs selected by the given clauses in the given order
+   \param strSQLExtra JOIN, WHERE and GROUP BY clauses on songview
+   \param orderBy the ORDER BY expression
+   */
+  bool GetSongIds(const std::string &strSQLExtra, const std::string &orderBy, std::vector<int> &songIds);
   bool GetAlbumsByWhere(const std::string &baseDir, const Filter &filter, CFileItemList &items, const SortDescription &sortDescription = SortDescription(), bool countOnly = false);
   bool GetAlbumsByWhere(const std::string &baseDir, const Filter &filter, VECALBUMS& albums, int& total, const SortDescription &sortDescription = SortDescription(), bool countOnly = false);
   bool GetArtistsByWhere(const std::string& strBaseDir, const Filter &filter, CFileItemList& items, const SortDescription &sortDescription = SortDescription(), bool countOnly = false);
@@ -550,7 +585,23 @@ private:
   bool SearchSongs(const std::string& strSearch, CFileItemList &songs);
   int GetSongIDFromPath(const std::string &filePath);
 
+  /*! \brief Runs a "replace into" of a single row, or stages it while in a batch
+   so the rows of a table are written with one multi-row statement by FlushLinks.
+   \param insert the statement up to and including "values"
+   \param row the parenthesised values of the row
+   \return false if the row couldn't be written
+   */
+  bool AddLink(const std::string &insert, const std::string &row);
+
+  /*! \brief Writes the rows staged by AddLink. A failure is remembered until
+   the batch is committed, which then rolls it back.
+   \return false if any of the rows couldn't be written
+   */
+  bool FlushLinks();
+
   bool m_translateBlankArtist;
+  std::map<std::string, std::vector<std::string> > m_pendingLinks;
+  bool m_linksFailed;
 
   // Fields should be ordered as they
   // appear in the songview
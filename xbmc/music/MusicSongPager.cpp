@@ -0,0 +1,364 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "MusicSongPager.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "music/MusicDatabase.h"
+#include "music/MusicThumbLoader.h"
+#include "music/tags/MusicInfoTag.h"
+#include "threads/SingleLock.h"
+#include "utils/JobManager.h"
+#include "utils/StringUtils.h"
+#include "utils/log.h"
+
+// songs fetched per query when loading
+#define LOAD_BATCH_SIZE 200
+
+typedef std::vector<std::pair<std::string, int> > SongList; // path, idSong
+
+// fetches full songs into new items, the placeholders are filled in by the caller
+static bool LoadSongs(const std::string &baseDir, const LABEL_MASKS &labelMasks, const SongList &songList, CFileItemList &songs)
+{
+  CMusicDatabase database;
+  if (!database.Open())
+    return false;
+
+  songs.SetFastLookup(true);
+  CLabelFormatter formatter(labelMasks.m_strLabelFile, labelMasks.m_strLabel2File);
+  CMusicThumbLoader thumbLoader;
+  thumbLoader.OnLoaderStart();
+
+  bool success = true;
+  for (size_t start = 0; start < songList.size(); start += LOAD_BATCH_SIZE)
+  {
+    size_t end = std::min(start + LOAD_BATCH_SIZE, songList.size());
+    std::vector<std::string> songIds;
+    for (size_t i = start; i < end; i++)
+      songIds.push_back(StringUtils::Format("%i", songList[i].second));
+
+    CFileItemList batch;
+    CDatabase::Filter filter("songview.idSong IN (" + StringUtils::Join(songIds, ",") + ")");
+    if (!database.GetSongsFullByWhere(baseDir, filter, batch, SortDescription(), true))
+    {
+      success = false;
+      break;
+    }
+
+    for (int i = 0; i < batch.Size(); i++)
+    {
+      if (!labelMasks.m_strLabelFile.empty())
+        formatter.FormatLabels(batch[i].get());
+      thumbLoader.LoadItemCached(batch[i].get());
+    }
+    songs.Append(batch);
+  }
+
+  thumbLoader.OnLoaderFinish();
+  database.Close();
+  return success;
+}
+
+class CMusicSongPageJob : public CJob
+{
+public:
+  CMusicSongPageJob(const std::string &baseDir, const LABEL_MASKS &labelMasks, const SongList &songList)
+    : m_baseDir(baseDir),
+      m_labelMasks(labelMasks),
+      m_songList(songList)
+  {
+  }
+
+  const char *GetType() const override { return "musicsongpage"; }
+  bool DoWork() override { return LoadSongs(m_baseDir, m_labelMasks, m_songList, m_songs); }
+
+  CFileItemList &GetSongs() { return m_songs; }
+
+private:
+  std::string m_baseDir;
+  LABEL_MASKS m_labelMasks;
+  SongList m_songList;
+  CFileItemList m_songs;
+};
+
+CMusicSongPager::CMusicSongPager(const std::string &baseDir, const std::string &strSQLExtra)
+  : m_baseDir(baseDir),
+    m_strSQLExtra(strSQLExtra)
+{
+}
+
+CMusicSongPager::~CMusicSongPager()
+{
+  CSingleLock lock(m_section);
+  for (unsigned int jobID : m_jobs)
+    CJobManager::GetInstance().CancelJob(jobID);
+}
+
+void CMusicSongPager::AddSong(const std::string &path, int idSong)
+{
+  m_songs[path] = idSong;
+}
+
+void CMusicSongPager::SetPlaceholder(CFileItem &item, const std::string &path, const std::string &title)
+{
+  item.SetPath(path);
+  item.SetLabel(title);
+  item.SetLabelPreformated(true);
+}
+
+bool CMusicSongPager::IsPlaceholder(const CFileItem &item) const
+{
+  return !item.HasMusicInfoTag() && m_songs.find(item.GetPath()) != m_songs.end();
+}
+
+void CMusicSongPager::Fill(CFileItem &placeholder, const CFileItem &song)
+{
+  // keep the database order of the placeholder
+  int order = placeholder.m_iprogramCount;
+  placeholder = song;
+  placeholder.m_iprogramCount = order;
+}
+
+void CMusicSongPager::Load(const VECFILEITEMS &items)
+{
+  VECFILEITEMS placeholders;
+  SongList songList;
+  for (const auto& item : items)
+  {
+    if (item && IsPlaceholder(*item))
+    {
+      placeholders.push_back(item);
+      songList.push_back(std::make_pair(item->GetPath(), m_songs.at(item->GetPath())));
+    }
+  }
+  if (placeholders.empty())
+    return;
+
+  LABEL_MASKS labelMasks;
+  {
+    CSingleLock lock(m_section);
+    labelMasks = m_labelMasks;
+  }
+
+  CFileItemList songs;
+  LoadSongs(m_baseDir, labelMasks, songList, songs);
+  for (const auto& placeholder : placeholders)
+  {
+    CFileItemPtr song = songs.Get(placeholder->GetPath());
+    if (song)
+      Fill(*placeholder, *song);
+  }
+}
+
+void CMusicSongPager::LoadAsync(const VECFILEITEMS &items)
+{
+  CSingleLock lock(m_section);
+  SongList songList;
+  for (const auto& item : items)
+  {
+    if (!item || !IsPlaceholder(*item))
+      continue;
+    VECFILEITEMS &waiting = m_requested[item->GetPath()];
+    if (std::find(waiting.begin(), waiting.end(), item) != waiting.end())
+      continue;
+    waiting.push_back(item);
+    // the song is fetched once for every placeholder waiting for it
+    if (waiting.size() == 1)
+      songList.push_back(std::make_pair(item->GetPath(), m_songs.at(item->GetPath())));
+  }
+  if (songList.empty())
+    return;
+
+  m_jobs.insert(CJobManager::GetInstance().AddJob(new CMusicSongPageJob(m_baseDir, m_labelMasks, songList), this));
+}
+
+bool CMusicSongPager::Update()
+{
+  std::vector<CFileItemPtr> loaded;
+  CSingleLock lock(m_section);
+  loaded.swap(m_loaded);
+
+  bool changed = false;
+  for (const auto& song : loaded)
+  {
+    // placeholders evicted in the meantime stay placeholders
+    auto waiting = m_requested.find(song->GetPath());
+    if (waiting == m_requested.end())
+      continue;
+    for (const auto& placeholder : waiting->second)
+    {
+      if (IsPlaceholder(*placeholder))
+      {
+        Fill(*placeholder, *song);
+        changed = true;
+      }
+    }
+    m_requested.erase(waiting);
+  }
+  return changed;
+}
+
+void CMusicSongPager::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  CSingleLock lock(m_section);
+  m_jobs.erase(jobID);
+
+  // songs that failed to load stay placeholders until they are evicted and requested again
+  CFileItemList &songs = static_cast<CMusicSongPageJob*>(job)->GetSongs();
+  for (int i = 0; i < songs.Size(); i++)
+    m_loaded.push_back(songs[i]);
+  if (!success)
+    CLog::Log(LOGERROR, "%s - unable to load songs of %s", __FUNCTION__, m_baseDir.c_str());
+}
+
+void CMusicSongPager::Evict(CFileItem &item)
+{
+  {
+    CSingleLock lock(m_section);
+    auto waiting = m_requested.find(item.GetPath());
+    if (waiting != m_requested.end())
+    {
+      VECFILEITEMS &items = waiting->second;
+      items.erase(std::remove_if(items.begin(), items.end(),
+                                 [&item](const CFileItemPtr &placeholder) { return placeholder.get() == &item; }),
+                  items.end());
+      if (items.empty())
+        m_requested.erase(waiting);
+    }
+  }
+  if (!item.HasMusicInfoTag() || m_songs.find(item.GetPath()) == m_songs.end())
+    return;
+
+  std::string path = item.GetPath();
+  std::string title = item.GetMusicInfoTag()->GetTitle();
+  int order = item.m_iprogramCount;
+  item.Reset();
+  SetPlaceholder(item, path, title);
+  item.m_iprogramCount = order;
+}
+
+bool CMusicSongPager::GetOrderBy(const SortDescription &sortDescription, std::string &orderBy)
+{
+  if (sortDescription.limitStart > 0 || sortDescription.limitEnd > 0)
+    return false;
+
+  // labels of songs are formatted from their tags, ordering them by title is the nearest the database gets
+  std::vector<std::string> columns;
+  switch (sortDescription.sortBy)
+  {
+  case SortByLabel:
+  case SortByTitle:
+    break;
+  case SortByTrackNumber:
+    columns.push_back("songview.iTrack");
+    break;
+  case SortByArtist:
+    columns.push_back("LOWER(songview.strArtists)");
+    break;
+  case SortByAlbum:
+    columns.push_back("LOWER(songview.strAlbum)");
+    columns.push_back("songview.iTrack");
+    break;
+  case SortByGenre:
+    columns.push_back("LOWER(songview.strGenres)");
+    break;
+  case SortByYear:
+    columns.push_back("songview.iYear");
+    break;
+  case SortByTime:
+    columns.push_back("songview.iDuration");
+    break;
+  case SortByRating:
+    columns.push_back("songview.rating");
+    break;
+  case SortByUserRating:
+    columns.push_back("songview.userrating");
+    break;
+  case SortByPlaycount:
+    columns.push_back("songview.iTimesPlayed");
+    break;
+  case SortByLastPlayed:
+    columns.push_back("songview.lastplayed");
+    break;
+  case SortByDateAdded:
+    columns.push_back("songview.dateAdded");
+    break;
+  default:
+    return false;
+  }
+  columns.push_back("LOWER(songview.strTitle)");
+
+  std::string order = sortDescription.sortOrder == SortOrderDescending ? " DESC" : " ASC";
+  orderBy = StringUtils::Join(columns, order + ", ") + order + ", songview.idSong";
+  return true;
+}
+
+bool CMusicSongPager::Sort(VECFILEITEMS &items, const SortDescription &sortDescription)
+{
+  std::string orderBy;
+  if (!GetOrderBy(sortDescription, orderBy))
+    return false;
+
+  std::vector<int> songIds;
+  CMusicDatabase database;
+  if (!database.Open() || !database.GetSongIds(m_strSQLExtra, orderBy, songIds))
+    return false;
+  database.Close();
+
+  // items that aren't songs (the parent folder) stay in front
+  VECFILEITEMS sorted;
+  sorted.reserve(items.size());
+  std::unordered_map<int, CFileItemPtr> songs;
+  for (const auto& item : items)
+  {
+    auto song = m_songs.find(item->GetPath());
+    if (song == m_songs.end())
+      sorted.push_back(item);
+    else
+      songs[song->second] = item;
+  }
+  for (int idSong : songIds)
+  {
+    auto song = songs.find(idSong);
+    if (song != songs.end())
+    {
+      sorted.push_back(song->second);
+      songs.erase(song);
+    }
+  }
+  // songs removed from the library in the meantime go last
+  for (const auto& item : items)
+  {
+    auto song = m_songs.find(item->GetPath());
+    if (song != m_songs.end() && songs.find(song->second) != songs.end())
+      sorted.push_back(item);
+  }
+
+  items.swap(sorted);
+  return true;
+}
+
+void CMusicSongPager::SetLabelMasks(const LABEL_MASKS &labelMasks)
+{
+  CSingleLock lock(m_section);
+  m_labelMasks = labelMasks;
+}
@@ -0,0 +1,75 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "IFileItemListPager.h"
+#include "threads/CriticalSection.h"
+#include "utils/Job.h"
+#include "utils/LabelFormatter.h"
+
+/*!
+ \brief Pages the songs of a musicdb:// song listing in and out of the music database.
+
+ Placeholders carry the musicdb:// path and the title of their song. Loading
+ fetches the full songs with their artists and cached art, on a job when the
+ container asks for a page, sorting is done by the database on the songview
+ columns matching the sort method.
+ */
+class CMusicSongPager : public IFileItemListPager, public IJobCallback
+{
+public:
+  /*!
+   \param baseDir the musicdb:// path of the listing
+   \param strSQLExtra the JOIN, WHERE and GROUP BY clauses selecting the songs of the listing from songview
+   */
+  CMusicSongPager(const std::string &baseDir, const std::string &strSQLExtra);
+  ~CMusicSongPager() override;
+
+  void AddSong(const std::string &path, int idSong);
+  static void SetPlaceholder(CFileItem &item, const std::string &path, const std::string &title);
+
+  void Load(const VECFILEITEMS &items) override;
+  void LoadAsync(const VECFILEITEMS &items) override;
+  bool Update() override;
+  void Evict(CFileItem &item) override;
+  bool Sort(VECFILEITEMS &items, const SortDescription &sortDescription) override;
+  void SetLabelMasks(const LABEL_MASKS &labelMasks) override;
+
+  void OnJobComplete(unsigned int jobID, bool success, CJob *job) override;
+
+private:
+  bool IsPlaceholder(const CFileItem &item) const;
+  static void Fill(CFileItem &placeholder, const CFileItem &song);
+  static bool GetOrderBy(const SortDescription &sortDescription, std::string &orderBy);
+
+  std::string m_baseDir;
+  std::string m_strSQLExtra;
+  std::unordered_map<std::string, int> m_songs; // path -> idSong
+  LABEL_MASKS m_labelMasks;
+  std::unordered_map<std::string, VECFILEITEMS> m_requested;  ///< placeholders loading in the background by path, copies of the list have their own
+  std::set<unsigned int> m_jobs;
+  std::vector<CFileItemPtr> m_loaded;                         ///< songs loaded in the background, not filled in yet
+  CCriticalSection m_section;
+};
@@ -49,6 +49,7 @@
 #include "music/tags/MusicInfoTagLoaderFactory.h"
 #include "MusicAlbumInfo.h"
 #include "MusicInfoScraper.h"
+#include "MusicTagReader.h"
 #include "NfoFile.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
@@ -81,6 +82,11 @@ CMusicInfoScanner::CMusicInfoScanner()
   m_itemCount=0;
   m_flags = 0;
   m_bClean = false;
+  m_pendingSongs = 0;
+  m_batchSize = 0;
+  m_writtenSongs = 0;
+  m_writeTime = 0;
+  m_incremental = false;
 }
 
 CMusicInfoScanner::~CMusicInfoScanner()
@@ -127,9 +133,15 @@ void CMusicInfoScanner::Process()
       m_currentItem=0;
       m_itemCount=-1;
 
+      // incremental scans only visit changed folders, counting every file would defeat them
+      m_incremental = g_advancedSettings.m_bMusicLibraryIncrementalScan && !(m_flags & SCAN_RESCAN);
+      m_fingerprints.clear();
+      if (m_incremental)
+        m_musicDatabase.GetPathFingerprints(m_fingerprints);
+
       // Create the thread to count all files to be scanned
       SetPriority( GetMinPriority() );
-      if (m_handle)
+      if (m_handle && !m_incremental)
         m_fileCountReader.Create();
 
       // Database operations should not be canceled
@@ -138,6 +150,14 @@ void CMusicInfoScanner::Process()
       m_bCanInterrupt = false;
       m_needsCleanup = false;
 
+      // folders are written in batches of songs, see FlushPendingPaths()
+      m_pendingPaths.clear();
+      m_pendingFingerprints.clear();
+      m_pendingSongs = 0;
+      m_batchSize = g_advancedSettings.m_iMusicLibraryScanBatchSize;
+      m_writtenSongs = 0;
+      m_writeTime = 0;
+
       bool commit = true;
       for (std::set<std::string>::const_iterator it = m_pathsToScan.begin(); it != m_pathsToScan.end(); ++it)
       {
@@ -160,6 +180,15 @@ void CMusicInfoScanner::Process()
         }
       }
 
+      // write what has been scanned so far, even if the scan was stopped
+      FlushPendingPaths();
+      m_batchSize = 0;
+      m_incremental = false;
+      m_fingerprints.clear();
+      if (m_writtenSongs > 0)
+        CLog::Log(LOGNOTICE, "My Music: Wrote %u songs to the database in %u ms (%.0f songs/s)",
+                  m_writtenSongs, m_writeTime, m_writeTime > 0 ? m_writtenSongs * 1000.0 / m_writeTime : 0.0);
+
       if (commit)
       {
         g_infoManager.ResetLibraryBools();
@@ -464,6 +493,24 @@ bool CMusicInfoScanner::DoScan(const std::string& strDirectory)
   if (IsExcluded(strDirectory, regexps))
     return true;
 
+  DirectoryFingerprint fingerprint;
+  if (m_incremental && IsUnchanged(strDirectory, m_fingerprints, fingerprint))
+  {
+    // only the folders below it that are known from earlier scans have to be checked
+    CLog::Log(LOGDEBUG, "%s Skipping dir '%s' as its fingerprint is unchanged", __FUNCTION__, CURL::GetRedacted(strDirectory).c_str());
+    if (m_handle)
+      OnDirectoryScanned(strDirectory);
+
+    for (const auto &subDir : GetKnownSubDirs(strDirectory, m_fingerprints))
+    {
+      if (m_bStop)
+        break;
+      if (!DoScan(subDir))
+        m_bStop = true;
+    }
+    return !m_bStop;
+  }
+
   // load subfolder
   CFileItemList items;
   CDirectory::GetDirectory(strDirectory, items, g_advancedSettings.GetMusicExtensions() + "|.jpg|.tbn|.lrc|.cdg");
@@ -475,6 +522,16 @@ bool CMusicInfoScanner::DoScan(const std::string& strDirectory)
   std::string hash;
   GetPathHash(items, hash);
 
+  if (m_incremental)
+  {
+    // forget the known folders that are gone
+    for (const auto &subDir : GetKnownSubDirs(strDirectory, m_fingerprints))
+    {
+      if (!items.Contains(subDir))
+        m_musicDatabase.RemovePathFingerprints(subDir);
+    }
+  }
+
   // check whether we need to rescan or not
   std::string dbHash;
   if ((m_flags & SCAN_RESCAN) || !m_musicDatabase.GetPathHash(strDirectory, dbHash) || dbHash != hash)
@@ -496,7 +553,15 @@ bool CMusicInfoScanner::DoScan(const std::string& strDirectory)
     }
 
     // save information about this folder
-    m_musicDatabase.SetPathHash(strDirectory, hash);
+    if (m_batchSize > 0)
+    {
+      // RetrieveMusicInfo staged the folder, the hash is written together with it
+      m_pendingPaths.back().hash = hash;
+      if (m_pendingSongs >= m_batchSize)
+        FlushPendingPaths();
+    }
+    else
+      m_musicDatabase.SetPathHash(strDirectory, hash);
   }
   else
   { // path is the same - no need to rescan
@@ -530,6 +595,16 @@ bool CMusicInfoScanner::DoScan(const std::string& strDirectory)
     }
   }
 
+  // a stored fingerprint skips the listing next time, so subfolders that were
+  // not reached would never be found
+  if (!m_bStop && fingerprint.mtime != 0)
+  {
+    if (m_batchSize > 0 && !m_pendingPaths.empty())
+      m_pendingFingerprints.push_back(std::make_pair(strDirectory, fingerprint)); // written after the songs of the folder
+    else
+      m_musicDatabase.SetPathFingerprint(strDirectory, fingerprint);
+  }
+
   return !m_bStop;
 }
 
@@ -537,11 +612,9 @@ INFO_RET CMusicInfoScanner::ScanTags(const CFileItemList& items, CFileItemList&
 {
   std::vector<std::string> regexps = g_advancedSettings.m_audioExcludeFromScanRegExps;
 
+  std::vector<CFileItemPtr> files;
   for (int i = 0; i < items.Size(); ++i)
   {
-    if (m_bStop)
-      return INFO_CANCELLED;
-
     CFileItemPtr pItem = items[i];
 
     if (CUtil::ExcludeFileOrFolder(pItem->GetPath(), regexps))
@@ -550,15 +623,23 @@ INFO_RET CMusicInfoScanner::ScanTags(const CFileItemList& items, CFileItemList&
     if (pItem->m_bIsFolder || pItem->IsPlayList() || pItem->IsPicture() || pItem->IsLyrics())
       continue;
 
+    files.push_back(pItem);
+  }
+
+  // tags are read ahead on the job workers, the files are still handled in order
+  CMusicTagReader reader(files, g_advancedSettings.m_iMusicLibraryScanReaders);
+  for (size_t i = 0; i < files.size(); ++i)
+  {
+    if (m_bStop)
+      return INFO_CANCELLED;
+
+    CFileItemPtr pItem = reader.Next(m_bStop);
+    if (!pItem)
+      return INFO_CANCELLED;
+
     m_currentItem++;
 
     CMusicInfoTag& tag = *pItem->GetMusicInfoTag();
-    if (!tag.Loaded())
-    {
-      std::unique_ptr<IMusicInfoTagLoader> pLoader (CMusicInfoTagLoaderFactory::CreateLoader(*pItem));
-      if (NULL != pLoader.get())
-        pLoader->Load(pItem->GetPath(), tag);
-    }
 
     if (m_handle && m_itemCount>0)
       m_handle->SetPercentage(m_currentItem / (float)m_itemCount * 100);
@@ -778,18 +859,46 @@ int CMusicInfoScanner::RetrieveMusicInfo(const std::string& strDirectory, CFileI
   MAPSONGS songsMap;
 
   // get all information for all files in current directory from database, and remove them
-  if (m_musicDatabase.RemoveSongsFromPath(strDirectory, songsMap))
+  if (m_batchSize > 0)
+  {
+    // the songs are only read here and removed when the folder is written
+    if (m_musicDatabase.GetSongsByPath(strDirectory, songsMap))
+    {
+      for (auto &song : songsMap)
+        song.second.strThumb = m_musicDatabase.GetArtForItem(song.second.idSong, MediaTypeSong, "thumb");
+      m_needsCleanup = true;
+    }
+  }
+  else if (m_musicDatabase.RemoveSongsFromPath(strDirectory, songsMap))
     m_needsCleanup = true;
 
-  CFileItemList scannedItems;
-  if (ScanTags(items, scannedItems) == INFO_CANCELLED || scannedItems.Size() == 0)
-    return 0;
-
   VECALBUMS albums;
-  FileItemsToAlbums(scannedItems, albums, &songsMap);
-  FindArtForAlbums(albums, items.GetPath());
+  CFileItemList scannedItems;
+  if (ScanTags(items, scannedItems) != INFO_CANCELLED && scannedItems.Size() > 0)
+  {
+    FileItemsToAlbums(scannedItems, albums, &songsMap);
+    FindArtForAlbums(albums, items.GetPath());
+  }
 
   int numAdded = 0;
+  if (m_batchSize > 0)
+  {
+    // stage the folder even without albums, so its old songs are still removed
+    for (const auto &album : albums)
+      numAdded += album.songs.size();
+    m_pendingSongs += numAdded;
+
+    PendingPath pending;
+    pending.strPath = strDirectory;
+    pending.songs.swap(songsMap);
+    pending.albums.swap(albums);
+    m_pendingPaths.push_back(std::move(pending));
+    return numAdded;
+  }
+
+  if (albums.empty())
+    return 0;
+
   ADDON::AddonPtr addon;
   ADDON::ScraperPtr albumScraper;
   ADDON::ScraperPtr artistScraper;
@@ -805,92 +914,173 @@ int CMusicInfoScanner::RetrieveMusicInfo(const std::string& strDirectory, CFileI
     if (m_bStop)
       break;
 
-    // mark albums without a title as singles
-    if (album->strAlbum.empty())
-      album->releaseType = CAlbum::Single;
-
-    album->strPath = strDirectory;
-    m_musicDatabase.AddAlbum(*album);
-
-    // Yuk - this is a kludgy way to do what we want to do, but it will work to sort
-    // out artist fanart until we can restructure the artist fanart to work more
-    // like the album fanart. This has to be done after we've added the album so
-    // we have the artist IDs to update, but before we call UpdateDatabaseArtistInfo.
-    if (albums.size() == 1 &&
-        !album->artistCredits.empty() &&
-        !StringUtils::EqualsNoCase(album->artistCredits[0].GetArtist(), "various artists") &&
-        !StringUtils::EqualsNoCase(album->artistCredits[0].GetArtist(), "various"))
-    {
-      CArtist artist;
-      if (m_musicDatabase.GetArtist(album->artistCredits[0].GetArtistId(), artist))
-      {
-        artist.strPath = URIUtils::GetParentPath(strDirectory);
-        m_musicDatabase.SetArtForItem(artist.idArtist, MediaTypeArtist, GetArtistArtwork(artist));
-      }
-    }
+    AddAlbum(*album, strDirectory, albums.size() == 1);
 
     if ((m_flags & SCAN_ONLINE))
     {
       if (!albumScraper || !artistScraper)
         continue;
 
-      bool albumartistsonly = !CServiceBroker::GetSettings().GetBool(CSettings::SETTING_MUSICLIBRARY_SHOWCOMPILATIONARTISTS);
+      ScrapeAlbum(*album, albumScraper, artistScraper);
+    }
+    numAdded += album->songs.size();
+  }
+
+  if (m_handle)
+    m_handle->SetTitle(g_localizeStrings.Get(505));
 
-      INFO_RET albumScrapeStatus = INFO_NOT_FOUND;
-      if (!m_musicDatabase.HasAlbumBeenScraped(album->idAlbum))
-        albumScrapeStatus = UpdateDatabaseAlbumInfo(*album, albumScraper, false);
+  return numAdded;
+}
 
-      if (albumScrapeStatus == INFO_ADDED)
+void CMusicInfoScanner::AddAlbum(CAlbum& album, const std::string& strDirectory, bool onlyAlbum)
+{
+  // mark albums without a title as singles
+  if (album.strAlbum.empty())
+    album.releaseType = CAlbum::Single;
+
+  album.strPath = strDirectory;
+  m_musicDatabase.AddAlbum(album);
+
+  // Yuk - this is a kludgy way to do what we want to do, but it will work to sort
+  // out artist fanart until we can restructure the artist fanart to work more
+  // like the album fanart. This has to be done after we've added the album so
+  // we have the artist IDs to update, but before we call UpdateDatabaseArtistInfo.
+  if (onlyAlbum &&
+      !album.artistCredits.empty() &&
+      !StringUtils::EqualsNoCase(album.artistCredits[0].GetArtist(), "various artists") &&
+      !StringUtils::EqualsNoCase(album.artistCredits[0].GetArtist(), "various"))
+  {
+    CArtist artist;
+    if (m_musicDatabase.GetArtist(album.artistCredits[0].GetArtistId(), artist))
+    {
+      artist.strPath = URIUtils::GetParentPath(strDirectory);
+      m_musicDatabase.SetArtForItem(artist.idArtist, MediaTypeArtist, GetArtistArtwork(artist));
+    }
+  }
+}
+
+void CMusicInfoScanner::ScrapeAlbum(CAlbum& album, const ADDON::ScraperPtr& albumScraper, const ADDON::ScraperPtr& artistScraper)
+{
+  bool albumartistsonly = !CServiceBroker::GetSettings().GetBool(CSettings::SETTING_MUSICLIBRARY_SHOWCOMPILATIONARTISTS);
+
+  INFO_RET albumScrapeStatus = INFO_NOT_FOUND;
+  if (!m_musicDatabase.HasAlbumBeenScraped(album.idAlbum))
+    albumScrapeStatus = UpdateDatabaseAlbumInfo(album, albumScraper, false);
+
+  if (albumScrapeStatus != INFO_ADDED)
+    return;
+
+  for (VECARTISTCREDITS::const_iterator artistCredit  = album.artistCredits.begin();
+                                        artistCredit != album.artistCredits.end();
+                                      ++artistCredit)
+  {
+    if (m_bStop)
+      break;
+
+    if (!m_musicDatabase.HasArtistBeenScraped(artistCredit->GetArtistId()))
+    {
+      CArtist artist;
+      m_musicDatabase.GetArtist(artistCredit->GetArtistId(), artist);
+      UpdateDatabaseArtistInfo(artist, artistScraper, false);
+    }
+  }
+  if (!albumartistsonly)
+  {
+    for (VECSONGS::iterator song = album.songs.begin();
+      song != album.songs.end();
+      ++song)
+    {
+      if (m_bStop)
+        break;
+
+      for (VECARTISTCREDITS::const_iterator artistCredit = song->artistCredits.begin();
+        artistCredit != song->artistCredits.end();
+        ++artistCredit)
       {
-        for (VECARTISTCREDITS::const_iterator artistCredit  = album->artistCredits.begin();
-                                              artistCredit != album->artistCredits.end();
-                                            ++artistCredit)
-        {
-          if (m_bStop)
-            break;
+        if (m_bStop)
+          break;
 
-          if (!m_musicDatabase.HasArtistBeenScraped(artistCredit->GetArtistId()))
-          {
-            CArtist artist;
-            m_musicDatabase.GetArtist(artistCredit->GetArtistId(), artist);
-            UpdateDatabaseArtistInfo(artist, artistScraper, false);
-          }
-        }
-        if (!albumartistsonly)
+        CMusicArtistInfo musicArtistInfo;
+        if (!m_musicDatabase.HasArtistBeenScraped(artistCredit->GetArtistId()))
         {
-          for (VECSONGS::iterator song = album->songs.begin();
-            song != album->songs.end();
-            ++song)
-          {
-            if (m_bStop)
-              break;
-
-            for (VECARTISTCREDITS::const_iterator artistCredit = song->artistCredits.begin();
-              artistCredit != song->artistCredits.end();
-              ++artistCredit)
-            {
-              if (m_bStop)
-                break;
-
-              CMusicArtistInfo musicArtistInfo;
-              if (!m_musicDatabase.HasArtistBeenScraped(artistCredit->GetArtistId()))
-              {
-                CArtist artist;
-                m_musicDatabase.GetArtist(artistCredit->GetArtistId(), artist);
-                UpdateDatabaseArtistInfo(artist, artistScraper, false);
-              }
-            }
-          }
+          CArtist artist;
+          m_musicDatabase.GetArtist(artistCredit->GetArtistId(), artist);
+          UpdateDatabaseArtistInfo(artist, artistScraper, false);
         }
       }
     }
-    numAdded += album->songs.size();
+  }
+}
+
+void CMusicInfoScanner::FlushPendingPaths()
+{
+  if (m_pendingPaths.empty() && m_pendingFingerprints.empty())
+    return;
+
+  // tags have been read beforehand, so the transaction only holds the database
+  // for as long as the writes take
+  unsigned int tick = XbmcThreads::SystemClockMillis();
+  bool committed = m_musicDatabase.BeginBatch();
+  for (auto &pending : m_pendingPaths)
+  {
+    m_musicDatabase.DeleteSongsFromPath(pending.strPath, pending.songs);
+    for (auto &album : pending.albums)
+      AddAlbum(album, pending.strPath, pending.albums.size() == 1);
+    m_musicDatabase.SetPathHash(pending.strPath, pending.hash);
+  }
+  for (const auto &fingerprint : m_pendingFingerprints)
+    m_musicDatabase.SetPathFingerprint(fingerprint.first, fingerprint.second);
+  m_pendingFingerprints.clear();
+  committed = m_musicDatabase.CommitBatch() && committed;
+  tick = XbmcThreads::SystemClockMillis() - tick;
+
+  if (committed)
+  {
+    CLog::Log(LOGDEBUG, "%s - wrote %u songs of %u folders in %u ms (%.0f songs/s)", __FUNCTION__,
+              m_pendingSongs, static_cast<unsigned int>(m_pendingPaths.size()), tick,
+              tick > 0 ? m_pendingSongs * 1000.0 / tick : 0.0);
+    m_writtenSongs += m_pendingSongs;
+    m_writeTime += tick;
+  }
+  else
+  {
+    // ids cached during the batch may have been rolled back
+    CLog::Log(LOGERROR, "%s - failed to write %u songs of %u folders", __FUNCTION__,
+              m_pendingSongs, static_cast<unsigned int>(m_pendingPaths.size()));
+    m_musicDatabase.EmptyCache();
+  }
+
+  std::vector<PendingPath> written;
+  written.swap(m_pendingPaths);
+  m_pendingSongs = 0;
+
+  if (!committed || !(m_flags & SCAN_ONLINE))
+    return;
+
+  ADDON::AddonPtr addon;
+  ADDON::ScraperPtr albumScraper;
+  ADDON::ScraperPtr artistScraper;
+  if (ADDON::CAddonSystemSettings::GetInstance().GetActive(ADDON::ADDON_SCRAPER_ALBUMS, addon))
+    albumScraper = std::dynamic_pointer_cast<ADDON::CScraper>(addon);
+
+  if (ADDON::CAddonSystemSettings::GetInstance().GetActive(ADDON::ADDON_SCRAPER_ARTISTS, addon))
+    artistScraper = std::dynamic_pointer_cast<ADDON::CScraper>(addon);
+
+  if (!albumScraper || !artistScraper)
+    return;
+
+  for (auto &pending : written)
+  {
+    for (auto &album : pending.albums)
+    {
+      if (m_bStop)
+        return;
+      ScrapeAlbum(album, albumScraper, artistScraper);
+    }
   }
 
   if (m_handle)
     m_handle->SetTitle(g_localizeStrings.Get(505));
-
-  return numAdded;
 }
 
 void CMusicInfoScanner::FindArtForAlbums(VECALBUMS &albums, const std::string &path)
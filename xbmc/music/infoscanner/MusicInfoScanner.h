@@ -186,6 +186,22 @@ protected:
    \param scannedItems [in] list to populate with the scannedItems
    */
   INFO_RET ScanTags(const CFileItemList& items, CFileItemList& scannedItems);
+
+  /*! \brief Add an album read from a folder to the database
+   \param album [in/out] the album to add
+   \param strDirectory [in] the folder the album was read from
+   \param onlyAlbum [in] whether it is the only album of the folder, its artist art is then taken from the parent folder
+   */
+  void AddAlbum(CAlbum& album, const std::string& strDirectory, bool onlyAlbum);
+
+  /*! \brief Scrape an album added by the scan and its artists if they haven't been scraped yet
+   */
+  void ScrapeAlbum(CAlbum& album, const ADDON::ScraperPtr& albumScraper, const ADDON::ScraperPtr& artistScraper);
+
+  /*! \brief Write the folders staged by RetrieveMusicInfo in a single transaction
+   and scrape their albums afterwards, see <musiclibrary><scanbatchsize>.
+   */
+  void FlushPendingPaths();
   int GetPathHash(const CFileItemList &items, std::string &hash);
   void GetAlbumArtwork(long id, const CAlbum &artist);
 
@@ -219,6 +235,25 @@ protected:
   std::map<CAlbum, CAlbum> m_albumCache;
   std::map<CArtistCredit, CArtist> m_artistCache;
 
+  /*! \brief A scanned folder waiting to be written by FlushPendingPaths
+   */
+  struct PendingPath
+  {
+    std::string strPath;
+    std::string hash;
+    MAPSONGS songs;   // songs of the folder in the database, deleted when the folder is written
+    VECALBUMS albums;
+  };
+  std::vector<PendingPath> m_pendingPaths;
+  unsigned int m_pendingSongs;
+  unsigned int m_batchSize; // 0 if every folder is written as soon as it is scanned
+  unsigned int m_writtenSongs;
+  unsigned int m_writeTime;
+
+  bool m_incremental; // only list folders whose fingerprint changed, see <musiclibrary><incrementalscan>
+  DirectoryFingerprints m_fingerprints;
+  std::vector<std::pair<std::string, DirectoryFingerprint> > m_pendingFingerprints; // folders scanned with all their subfolders
+
   std::set<std::string> m_pathsToScan;
   std::set<std::string> m_seenPaths;
   int m_flags;
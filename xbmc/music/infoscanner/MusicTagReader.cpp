@@ -0,0 +1,120 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "MusicTagReader.h"
+
+#include "music/tags/MusicInfoTag.h"
+#include "music/tags/MusicInfoTagLoaderFactory.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/SingleLock.h"
+#include "utils/JobManager.h"
+
+using namespace MUSIC_INFO;
+
+// the jobs only hold on to the state, so they may outlive the reader
+class CMusicTagReader::CState
+{
+public:
+  CState(size_t count, const TagLoader &loader) : m_loader(loader), m_read(count, false), m_abandoned(false) {}
+
+  const TagLoader m_loader;
+  CCriticalSection m_section;
+  CEvent m_readEvent;
+  std::vector<bool> m_read;
+  bool m_abandoned;
+};
+
+CMusicTagReader::CMusicTagReader(const std::vector<CFileItemPtr> &items, unsigned int maxPending,
+                                 const TagLoader &loader)
+  : m_state(std::make_shared<CState>(items.size(), loader)),
+    m_items(items),
+    m_queued(0),
+    m_next(0),
+    m_maxPending(maxPending > 0 ? maxPending : 1)
+{
+  while (m_queued < m_items.size() && m_queued < m_maxPending)
+    QueueNext();
+}
+
+CMusicTagReader::~CMusicTagReader()
+{
+  CSingleLock lock(m_state->m_section);
+  m_state->m_abandoned = true;
+}
+
+void CMusicTagReader::QueueNext()
+{
+  std::shared_ptr<CState> state = m_state;
+  CFileItemPtr item = m_items[m_queued];
+  size_t index = m_queued++;
+
+  // no more than m_maxPending jobs are queued at a time, so each may get a
+  // worker of its own. The other priorities would cap the readers at the few
+  // workers they are allowed.
+  CJobManager::GetInstance().Submit([state, item, index]()
+  {
+    {
+      CSingleLock lock(state->m_section);
+      if (state->m_abandoned)
+        return;
+    }
+
+    // the item isn't touched by the consumer until it has been read
+    CMusicInfoTag& tag = *item->GetMusicInfoTag();
+    if (!tag.Loaded())
+    {
+      if (state->m_loader)
+        state->m_loader(*item);
+      else
+      {
+        std::unique_ptr<IMusicInfoTagLoader> pLoader(CMusicInfoTagLoaderFactory::CreateLoader(*item));
+        if (NULL != pLoader.get())
+          pLoader->Load(item->GetPath(), tag);
+      }
+    }
+
+    CSingleLock lock(state->m_section);
+    state->m_read[index] = true;
+    state->m_readEvent.Set();
+  }, CJob::PRIORITY_DEDICATED);
+}
+
+CFileItemPtr CMusicTagReader::Next(const std::atomic<bool> &stop)
+{
+  if (m_next >= m_items.size())
+    return CFileItemPtr();
+
+  while (true)
+  {
+    {
+      CSingleLock lock(m_state->m_section);
+      if (m_state->m_read[m_next])
+        break;
+    }
+    if (stop)
+      return CFileItemPtr();
+    m_state->m_readEvent.WaitMSec(100);
+  }
+
+  if (m_queued < m_items.size())
+    QueueNext();
+  return m_items[m_next++];
+}
@@ -0,0 +1,79 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "FileItem.h"
+
+namespace MUSIC_INFO
+{
+/*!
+ \brief Reads the tags of a list of files on the CJobManager workers.
+
+ At most maxPending files are read at the same time. Another file is only
+ queued when the consumer takes one, so a slow consumer holds the readers
+ back. Files are handed back in the order they were given.
+ */
+class CMusicTagReader
+{
+public:
+  typedef std::function<void(CFileItem &item)> TagLoader;
+
+  /*!
+   \param items the files to read.
+   \param maxPending how many files may be read at the same time.
+   \param loader reads the tag of a file, the loader of the file type from
+   CMusicInfoTagLoaderFactory if not set.
+   */
+  CMusicTagReader(const std::vector<CFileItemPtr> &items, unsigned int maxPending,
+                  const TagLoader &loader = TagLoader());
+
+  /*!
+   \brief Files that haven't been queued yet are dropped, files being read are
+   left to finish on their own.
+   */
+  ~CMusicTagReader();
+
+  /*!
+   \brief Wait for the next file to be read.
+   \param stop the wait gives up once this is set.
+   \return the file with its tag loaded if one was found, NULL when all files
+   have been taken or the wait gave up.
+   */
+  CFileItemPtr Next(const std::atomic<bool> &stop);
+
+private:
+  CMusicTagReader(const CMusicTagReader&) = delete;
+  CMusicTagReader& operator=(const CMusicTagReader&) = delete;
+
+  void QueueNext();
+
+  class CState;
+  std::shared_ptr<CState> m_state;
+  std::vector<CFileItemPtr> m_items;
+  size_t m_queued;
+  size_t m_next;
+  unsigned int m_maxPending;
+};
+}
@@ -0,0 +1,134 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "music/infoscanner/MusicTagReader.h"
+#include "music/tags/MusicInfoTag.h"
+#include "threads/Thread.h"
+#include "utils/URIUtils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace MUSIC_INFO;
+
+namespace
+{
+std::vector<CFileItemPtr> MakeItems(unsigned int count)
+{
+  std::vector<CFileItemPtr> items;
+  for (unsigned int i = 0; i < count; i++)
+    items.push_back(CFileItemPtr(new CFileItem("/music/" + std::to_string(i) + ".flac", false)));
+  return items;
+}
+
+// shared with the loader jobs, which may outlive the test
+struct LoaderState
+{
+  LoaderState() : started(0), running(0), maxRunning(0), release(false) {}
+  std::atomic<unsigned int> started;
+  std::atomic<unsigned int> running;
+  std::atomic<unsigned int> maxRunning;
+  std::atomic<bool> release;
+};
+
+// waits until released or until wanted loaders run at the same time
+CMusicTagReader::TagLoader SlowLoader(std::shared_ptr<LoaderState> state, unsigned int wanted)
+{
+  return [state, wanted](CFileItem &item)
+  {
+    state->started++;
+    unsigned int running = ++state->running;
+    unsigned int highest = state->maxRunning;
+    while (running > highest && !state->maxRunning.compare_exchange_weak(highest, running))
+      ;
+
+    for (int i = 0; i < 500 && !state->release && state->maxRunning < wanted; i++)
+      XbmcThreads::ThreadSleep(10);
+
+    item.GetMusicInfoTag()->SetTitle(item.GetPath());
+    item.GetMusicInfoTag()->SetLoaded();
+    state->running--;
+  };
+}
+}
+
+TEST(TestMusicTagReader, Order)
+{
+  // later files finish first
+  std::vector<CFileItemPtr> items = MakeItems(40);
+  CMusicTagReader reader(items, 8, [](CFileItem &item)
+  {
+    XbmcThreads::ThreadSleep(20 - std::stoi(URIUtils::GetFileName(item.GetPath())) % 8 * 2);
+    item.GetMusicInfoTag()->SetTitle(item.GetPath());
+    item.GetMusicInfoTag()->SetLoaded();
+  });
+
+  std::atomic<bool> stop(false);
+  for (unsigned int i = 0; i < items.size(); i++)
+  {
+    CFileItemPtr item = reader.Next(stop);
+    ASSERT_TRUE(item != NULL);
+    EXPECT_EQ(items[i], item);
+    EXPECT_TRUE(item->GetMusicInfoTag()->Loaded());
+    EXPECT_EQ(items[i]->GetPath(), item->GetMusicInfoTag()->GetTitle());
+  }
+  EXPECT_TRUE(reader.Next(stop) == NULL);
+}
+
+TEST(TestMusicTagReader, BackPressure)
+{
+  std::shared_ptr<LoaderState> state(new LoaderState);
+  std::vector<CFileItemPtr> items = MakeItems(20);
+  CMusicTagReader reader(items, 4, SlowLoader(state, 20));
+
+  // nothing is taken, so no more than four files are read
+  XbmcThreads::ThreadSleep(200);
+  EXPECT_EQ(4u, state->started);
+
+  state->release = true;
+  std::atomic<bool> stop(false);
+  CFileItemPtr item = reader.Next(stop);
+  ASSERT_TRUE(item != NULL);
+  XbmcThreads::ThreadSleep(200);
+  EXPECT_EQ(5u, state->started);
+
+  while (reader.Next(stop))
+    ;
+  EXPECT_EQ(items.size(), state->started);
+  EXPECT_LE(state->maxRunning, 4u);
+}
+
+TEST(TestMusicTagReader, Readers)
+{
+  // all readers run at once, not only the few workers a job priority allows
+  std::shared_ptr<LoaderState> state(new LoaderState);
+  std::vector<CFileItemPtr> items = MakeItems(16);
+  CMusicTagReader reader(items, 8, SlowLoader(state, 8));
+
+  std::atomic<bool> stop(false);
+  while (reader.Next(stop))
+    ;
+  EXPECT_EQ(8u, state->maxRunning);
+}
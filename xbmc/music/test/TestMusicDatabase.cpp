@@ -0,0 +1,116 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "music/Album.h"
+#include "music/MusicDatabase.h"
+#include "settings/AdvancedSettings.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace
+{
+const char *LINK_QUERIES[] =
+{
+  "SELECT group_concat(row, ';') FROM (SELECT idArtist || ',' || idSong || ',' || idRole || ',' || iOrder || ',' || strArtist AS row FROM song_artist ORDER BY idSong, idRole, iOrder, idArtist)",
+  "SELECT group_concat(row, ';') FROM (SELECT idArtist || ',' || idAlbum || ',' || iOrder || ',' || strArtist AS row FROM album_artist ORDER BY idAlbum, iOrder, idArtist)",
+  "SELECT group_concat(row, ';') FROM (SELECT idGenre || ',' || idSong || ',' || iOrder AS row FROM song_genre ORDER BY idSong, iOrder, idGenre)",
+  "SELECT group_concat(row, ';') FROM (SELECT idGenre || ',' || idAlbum || ',' || iOrder AS row FROM album_genre ORDER BY idAlbum, iOrder, idGenre)",
+};
+
+// what the scanner writes for a few folders
+bool AddAlbums(CMusicDatabase &database)
+{
+  bool added = true;
+  for (int a = 0; a < 3; a++)
+  {
+    CAlbum album;
+    album.strAlbum = "Album " + std::to_string(a);
+    album.artistCredits.push_back(CArtistCredit("Artist " + std::to_string(a)));
+    album.genre.push_back("Rock");
+    album.genre.push_back("Genre " + std::to_string(a));
+    for (int s = 0; s < 4; s++)
+    {
+      CSong song;
+      song.strTitle = "Song " + std::to_string(s);
+      song.strFileName = "/music/album" + std::to_string(a) + "/" + std::to_string(s) + ".flac";
+      song.iTrack = s + 1;
+      song.artistCredits.push_back(CArtistCredit("Artist " + std::to_string(a)));
+      song.artistCredits.push_back(CArtistCredit("Guest " + std::to_string(s)));
+      song.genre = album.genre;
+      album.songs.push_back(song);
+    }
+    added = database.AddAlbum(album) && added;
+  }
+  return added;
+}
+}
+
+class TestMusicDatabase : public testing::Test
+{
+protected:
+  void Connect(CMusicDatabase &database, const std::string &name)
+  {
+    DatabaseSettings settings;
+    settings.type = "sqlite3";
+    settings.host = CSpecialProtocol::TranslatePath("special://temp/");
+    XFILE::CFile::Delete(settings.host + name + ".db");
+    ASSERT_TRUE(database.Connect(name, settings, true));
+  }
+};
+
+TEST_F(TestMusicDatabase, BatchedLinks)
+{
+  CMusicDatabase unbatched;
+  Connect(unbatched, "TestMusicDatabaseUnbatched");
+  EXPECT_TRUE(AddAlbums(unbatched));
+
+  CMusicDatabase batched;
+  Connect(batched, "TestMusicDatabaseBatched");
+  ASSERT_TRUE(batched.BeginBatch());
+  EXPECT_TRUE(AddAlbums(batched));
+  EXPECT_TRUE(batched.CommitBatch());
+
+  for (const char *query : LINK_QUERIES)
+  {
+    std::string rows = unbatched.GetSingleValue(query);
+    EXPECT_FALSE(rows.empty()) << query;
+    EXPECT_EQ(rows, batched.GetSingleValue(query)) << query;
+  }
+}
+
+TEST_F(TestMusicDatabase, FailedLinks)
+{
+  CMusicDatabase database;
+  Connect(database, "TestMusicDatabaseFailed");
+
+  // the staged genres of the songs can't be written, so nothing of the batch is kept
+  ASSERT_TRUE(database.BeginBatch());
+  database.ExecuteQuery("DROP TABLE song_genre");
+  EXPECT_FALSE(AddAlbums(database));
+  EXPECT_FALSE(database.CommitBatch());
+  EXPECT_FALSE(database.InBatch());
+
+  EXPECT_EQ("0", database.GetSingleValue("SELECT COUNT(*) FROM album"));
+  EXPECT_EQ("0", database.GetSingleValue("SELECT COUNT(*) FROM song_genre"));
+}
@@ -82,6 +82,7 @@ CGUIWindowMusicNav::CGUIWindowMusicNav(void)
 {
   m_vecItems->SetPath("?");
   m_searchWithEdit = false;
+  m_rootDir.SetFlags(DIR_FLAG_ALLOW_PROMPT | DIR_FLAG_PAGED);
 }
 
 CGUIWindowMusicNav::~CGUIWindowMusicNav(void)
@@ -266,7 +267,9 @@ bool CGUIWindowMusicNav::Update(const std::string &strDirectory, bool updateFilt
 
   if (CGUIWindowMusicBase::Update(strDirectory, updateFilterPath))
   {
-    m_thumbLoader.Load(*m_unfilteredItems);
+    // the art of paged items is loaded together with the items
+    if (!m_unfilteredItems->GetPager())
+      m_thumbLoader.Load(*m_unfilteredItems);
     return true;
   }
 
@@ -0,0 +1,400 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#if defined(TARGET_POSIX)
+
+#include "URL.h"
+#include "filesystem/CurlFile.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
+#include "utils/HttpRangeUtils.h"
+#include "utils/StringUtils.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace XFILE;
+
+namespace
+{
+const int64_t LENGTH = 4 * 1024 * 1024;
+// what CCurlFile asks for per range request
+const int64_t SEGMENT_SIZE = 1024 * 1024;
+
+char ByteAt(int64_t position)
+{
+  return static_cast<char>(position * 7 + position / 251);
+}
+
+/*!
+ \brief HTTP server on the loopback interface that serves LENGTH generated
+ bytes. Every connection is throttled and every request delayed to make
+ it behave like a distant server.
+ */
+class CLoopbackServer : public CThread
+{
+public:
+  CLoopbackServer(unsigned int bytesPerSecond, unsigned int latency, bool closedRangesOnly = false)
+    : CThread("LoopbackServer")
+    , m_socket(-1)
+    , m_port(0)
+    , m_bytesPerSecond(bytesPerSecond)
+    , m_latency(latency)
+    , m_closedRanges(!closedRangesOnly)
+    , m_connections(0)
+  {
+  }
+
+  ~CLoopbackServer()
+  {
+    Stop();
+  }
+
+  bool Start()
+  {
+    m_socket = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t size = sizeof(addr);
+    if (m_socket < 0 ||
+        bind(m_socket, reinterpret_cast<struct sockaddr*>(&addr), size) != 0 ||
+        listen(m_socket, 16) != 0 ||
+        getsockname(m_socket, reinterpret_cast<struct sockaddr*>(&addr), &size) != 0)
+      return false;
+
+    m_port = ntohs(addr.sin_port);
+    Create();
+    return true;
+  }
+
+  void Stop()
+  {
+    StopThread();
+    for (auto& connection : m_handlers)
+      connection->StopThread();
+    m_handlers.clear();
+    if (m_socket >= 0)
+      close(m_socket);
+    m_socket = -1;
+  }
+
+  std::string GetUrl() const
+  {
+    return StringUtils::Format("http://127.0.0.1:%d/movie.mkv", m_port);
+  }
+
+  unsigned int GetConnections()
+  {
+    CSingleLock lock(m_section);
+    return m_connections;
+  }
+
+  struct Request
+  {
+    CHttpRange range;
+    bool closed;  ///< the range had an end
+  };
+
+  std::vector<Request> GetRequests()
+  {
+    CSingleLock lock(m_section);
+    return m_requests;
+  }
+
+  void ClearRequests()
+  {
+    CSingleLock lock(m_section);
+    m_requests.clear();
+  }
+
+protected:
+  class CConnection : public CThread
+  {
+  public:
+    CConnection(CLoopbackServer &server, int socket)
+      : CThread("LoopbackConnection")
+      , m_server(server)
+      , m_socket(socket)
+    {
+    }
+
+    ~CConnection()
+    {
+      close(m_socket);
+    }
+
+  protected:
+    void Process() override
+    {
+      std::string request;
+      while (!m_bStop)
+      {
+        size_t end = request.find("\r\n\r\n");
+        if (end != std::string::npos)
+        {
+          if (!Respond(request.substr(0, end)))
+            return;
+          request.erase(0, end + 4);
+          continue;
+        }
+
+        struct pollfd fd = { m_socket, POLLIN, 0 };
+        if (poll(&fd, 1, 100) <= 0)
+          continue;
+
+        char buffer[4096];
+        ssize_t size = recv(m_socket, buffer, sizeof(buffer), 0);
+        if (size <= 0)
+          return;
+        request.append(buffer, size);
+      }
+    }
+
+    bool Respond(const std::string &request)
+    {
+      CHttpRange range(0, LENGTH - 1);
+      bool partial = false;
+      bool closed = false;
+      std::vector<std::string> lines = StringUtils::Split(request, "\r\n");
+      for (const auto& line : lines)
+      {
+        if (!StringUtils::StartsWithNoCase(line, "Range:"))
+          continue;
+
+        std::string value = line.substr(6);
+        StringUtils::Trim(value);
+        CHttpRanges ranges;
+        if (!ranges.Parse(value, LENGTH) || ranges.Size() != 1 ||
+            (!m_server.m_closedRanges && !StringUtils::EndsWith(value, "-")))
+          return Send("HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n\r\n");
+
+        ranges.GetFirst(range);
+        partial = true;
+        closed = !StringUtils::EndsWith(value, "-");
+      }
+
+      {
+        CSingleLock lock(m_server.m_section);
+        Request served = { range, closed };
+        m_server.m_requests.push_back(served);
+      }
+
+      Sleep(m_server.m_latency);
+
+      std::string header = partial ? "HTTP/1.1 206 Partial Content\r\n" : "HTTP/1.1 200 OK\r\n";
+      header += "Content-Type: video/x-matroska\r\nAccept-Ranges: bytes\r\n";
+      header += StringUtils::Format("Content-Length: %" PRIu64"\r\n", range.GetLength());
+      if (partial)
+        header += "Content-Range: " + HttpRangeUtils::GenerateContentRangeHeaderValue(range.GetFirstPosition(), range.GetLastPosition(), LENGTH) + "\r\n";
+      header += "\r\n";
+      if (!Send(header))
+        return false;
+
+      // throttle to the configured rate
+      unsigned int started = XbmcThreads::SystemClockMillis();
+      const uint64_t chunk = 16384;
+      std::vector<char> data(chunk);
+      for (uint64_t sent = 0; sent < range.GetLength() && !m_bStop;)
+      {
+        uint64_t size = std::min(chunk, range.GetLength() - sent);
+        for (uint64_t i = 0; i < size; i++)
+          data[i] = ByteAt(range.GetFirstPosition() + sent + i);
+        if (!Send(std::string(data.data(), size)))
+          return false;
+        sent += size;
+
+        unsigned int due = static_cast<unsigned int>(sent * 1000 / m_server.m_bytesPerSecond);
+        unsigned int elapsed = XbmcThreads::SystemClockMillis() - started;
+        if (due > elapsed)
+          Sleep(due - elapsed);
+      }
+      return true;
+    }
+
+    bool Send(const std::string &data)
+    {
+      for (size_t sent = 0; sent < data.size();)
+      {
+        ssize_t size = send(m_socket, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (size <= 0)
+          return false;
+        sent += size;
+      }
+      return true;
+    }
+
+    CLoopbackServer &m_server;
+    int m_socket;
+  };
+
+  void Process() override
+  {
+    while (!m_bStop)
+    {
+      struct pollfd fd = { m_socket, POLLIN, 0 };
+      if (poll(&fd, 1, 100) <= 0)
+        continue;
+
+      int socket = accept(m_socket, NULL, NULL);
+      if (socket < 0)
+        continue;
+
+      CSingleLock lock(m_section);
+      m_connections++;
+      m_handlers.push_back(std::unique_ptr<CConnection>(new CConnection(*this, socket)));
+      m_handlers.back()->Create();
+    }
+  }
+
+  int m_socket;
+  int m_port;
+  unsigned int m_bytesPerSecond;
+  unsigned int m_latency;
+  bool m_closedRanges;
+  CCriticalSection m_section;
+  unsigned int m_connections;
+  std::vector<Request> m_requests;
+  std::vector<std::unique_ptr<CConnection> > m_handlers;
+};
+
+// reads up to length bytes at the current position and checks them
+void Verify(CCurlFile &file, int64_t position, int64_t length)
+{
+  std::vector<char> buffer(65536);
+  while (length > 0)
+  {
+    ssize_t size = file.Read(buffer.data(), static_cast<size_t>(std::min<int64_t>(buffer.size(), length)));
+    ASSERT_LT(0, size) << "at " << position;
+    for (ssize_t i = 0; i < size; i++)
+      ASSERT_EQ(ByteAt(position + i), buffer[i]) << "at " << position + i;
+    position += size;
+    length -= size;
+  }
+}
+
+double Download(const std::string &url)
+{
+  CCurlFile file;
+  file.SetBufferSize(65536);
+  EXPECT_TRUE(file.Open(CURL(url)));
+  EXPECT_EQ(LENGTH, file.GetLength());
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  Verify(file, 0, LENGTH);
+  double seconds = (XbmcThreads::SystemClockMillis() - start) / 1000.0;
+
+  char byte;
+  EXPECT_EQ(0, file.Read(&byte, 1));
+  file.Close();
+  return seconds;
+}
+}
+
+TEST(TestSegmentedDownload, Segments)
+{
+  CLoopbackServer server(16 * 1024 * 1024, 5);
+  ASSERT_TRUE(server.Start());
+
+  // without segments the file comes in one request
+  Download(server.GetUrl());
+  std::vector<CLoopbackServer::Request> requests = server.GetRequests();
+  ASSERT_EQ(1u, requests.size());
+  EXPECT_FALSE(requests[0].closed);
+
+  // with segments the single connection is taken over by ranges of at most
+  // a segment each, which together make up the rest of the file
+  server.ClearRequests();
+  unsigned int connections = server.GetConnections();
+  Download(server.GetUrl() + "|segments=4");
+  EXPECT_LE(connections + 4, server.GetConnections());
+
+  requests = server.GetRequests();
+  ASSERT_LT(1u, requests.size());
+  EXPECT_FALSE(requests[0].closed);
+  int64_t segmentStart = LENGTH;
+  int64_t segmentEnd = 0;
+  unsigned int segments = 0;
+  for (const auto& request : requests)
+  {
+    if (!request.closed)
+      continue;
+    EXPECT_LE(request.range.GetLength(), static_cast<uint64_t>(SEGMENT_SIZE));
+    segmentStart = std::min<int64_t>(segmentStart, request.range.GetFirstPosition());
+    segmentEnd = std::max<int64_t>(segmentEnd, request.range.GetLastPosition() + 1);
+    segments++;
+  }
+  EXPECT_EQ(LENGTH, segmentEnd);
+  EXPECT_LE((segmentEnd - segmentStart + SEGMENT_SIZE - 1) / SEGMENT_SIZE, segments);
+  EXPECT_LE(4u, segments);
+}
+
+TEST(TestSegmentedDownload, Benchmark)
+{
+  // one connection gets 2 MB/s, like a long distance link would
+  CLoopbackServer server(2 * 1024 * 1024, 20);
+  ASSERT_TRUE(server.Start());
+
+  double single = Download(server.GetUrl());
+  double segmented = Download(server.GetUrl() + "|segments=4");
+  std::cout << "single connection: " << LENGTH / single / (1024 * 1024) << " MB/s, "
+            << "4 connections: " << LENGTH / segmented / (1024 * 1024) << " MB/s" << std::endl;
+}
+
+TEST(TestSegmentedDownload, Seek)
+{
+  CLoopbackServer server(16 * 1024 * 1024, 5);
+  ASSERT_TRUE(server.Start());
+
+  CCurlFile file;
+  ASSERT_TRUE(file.Open(CURL(server.GetUrl() + "|segments=3")));
+  Verify(file, 0, 100000);
+
+  EXPECT_EQ(LENGTH / 2, file.Seek(LENGTH / 2, SEEK_SET));
+  Verify(file, LENGTH / 2, 3 * 1024 * 1024 / 2);
+
+  EXPECT_EQ(10, file.Seek(10, SEEK_SET));
+  Verify(file, 10, 100000);
+
+  EXPECT_EQ(LENGTH - 1000, file.Seek(-1000, SEEK_END));
+  Verify(file, LENGTH - 1000, 1000);
+}
+
+TEST(TestSegmentedDownload, FallBack)
+{
+  // ranges with an end are refused, the download continues over one connection
+  CLoopbackServer server(16 * 1024 * 1024, 5, true);
+  ASSERT_TRUE(server.Start());
+
+  Download(server.GetUrl() + "|segments=4");
+}
+
+#endif
@@ -53,6 +53,7 @@
 #include "utils/URIUtils.h"
 #include "utils/Variant.h"
 #include "utils/XMLUtils.h"
+#include "video/VideoLibraryIndex.h"
 
 //! @todo
 //! eventually the profile should dictate where special://masterprofile/ is
@@ -272,6 +273,8 @@ bool CProfilesManager::LoadProfile(size_t index)
 
   g_infoManager.ResetCache();
   g_infoManager.ResetLibraryBools();
+  if (CVideoLibraryIndex::IsEnabled())
+    CVideoLibraryIndex::GetInstance().Invalidate();
 
   if (m_currentProfile != 0)
   {
@@ -139,6 +139,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_audioHeadRoom;
     float m_ac3Gain;
     std::string m_audioDefaultPlayer;
+    std::string m_audioResampler;
     float m_audioPlayCountMinimumPercent;
     bool m_VideoPlayerIgnoreDTSinWAV;
     float m_limiterHold;
@@ -254,8 +255,12 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
 
     int m_iMusicLibraryRecentlyAddedItems;
     int m_iMusicLibraryDateAdded;
+    int m_iMusicLibraryScanBatchSize; ///< songs written per transaction by the music scanner, 0 to write every folder on its own
+    int m_iMusicLibraryScanReaders; ///< files the music scanner reads tags from at the same time
+    int m_iMusicLibraryPagedListSize; ///< song listings with at least this many songs are loaded page by page, 0 to always load them fully
     bool m_bMusicLibraryAllItemsOnBottom;
     bool m_bMusicLibraryCleanOnUpdate;
+    bool m_bMusicLibraryIncrementalScan;
     std::string m_strMusicLibraryAlbumFormat;
     bool m_prioritiseAPEv2tags;
     std::string m_musicItemSeparator;
@@ -267,9 +272,12 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_iVideoLibraryRecentlyAddedItems;
     bool m_bVideoLibraryCleanOnUpdate;
     bool m_bVideoLibraryUseFastHash;
+    bool m_bVideoLibraryIncrementalScan;
     bool m_bVideoLibraryExportAutoThumbs;
     bool m_bVideoLibraryImportWatchedState;
     bool m_bVideoLibraryImportResumePoint;
+    bool m_bVideoLibraryNavIndex;
+    int m_iVideoLibraryNavIndexRefresh;
 
     bool m_bVideoScannerIgnoreErrors;
     int m_iVideoLibraryDateAdded;
@@ -297,6 +305,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_curlconnecttimeout;
     int m_curllowspeedtime;
     int m_curlretries;
+    int m_curlSegments;
     bool m_curlDisableIPV6;
 
     bool m_fullScreen;
@@ -340,11 +349,13 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
 
     bool m_guiVisualizeDirtyRegions;
     int  m_guiAlgorithmDirtyRegions;
+    bool m_guiTraceDirtyRegions;
     unsigned int m_addonPackageFolderSize;
 
     unsigned int m_cacheMemSize;
     unsigned int m_cacheBufferMode;
     float m_cacheReadFactor;
+    unsigned int m_cacheBlockStoreSize; // in MB, 0 disables the persistent cache of network files
 
     bool m_jsonOutputCompact;
     unsigned int m_jsonTcpPort;
@@ -60,6 +60,7 @@ const std::string& CSkinSettings::GetString(int setting) const
 void CSkinSettings::SetString(int setting, const std::string &label)
 {
   g_SkinInfo->SetString(setting, label);
+  g_infoManager.ResetCache(INFO::DEPENDS_SKIN_SETTINGS);
 }
 
 int CSkinSettings::TranslateBool(const std::string &setting)
@@ -75,11 +76,13 @@ bool CSkinSettings::GetBool(int setting) const
 void CSkinSettings::SetBool(int setting, bool set)
 {
   g_SkinInfo->SetBool(setting, set);
+  g_infoManager.ResetCache(INFO::DEPENDS_SKIN_SETTINGS);
 }
 
 void CSkinSettings::Reset(const std::string &setting)
 {
   g_SkinInfo->Reset(setting);
+  g_infoManager.ResetCache(INFO::DEPENDS_SKIN_SETTINGS);
 }
 
 void CSkinSettings::Reset()
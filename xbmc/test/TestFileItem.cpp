@@ -18,7 +18,10 @@
  *
  */
 
+#include <algorithm>
+
 #include "FileItem.h"
+#include "IFileItemListPager.h"
 #include "URL.h"
 #include "settings/AdvancedSettings.h"
 
@@ -136,3 +139,81 @@ const TestFileData BaseMovies[] = {{ "c:\\dir\\filename.avi", false, "c:\\dir\\f
                                    { "/home/user/movies/movie_name/BDMV/index.bdmv", true, "/home/user/movies/movie_name/" }};
 
 INSTANTIATE_TEST_CASE_P(BaseNameMovies, TestFileItemBasePath, ValuesIn(BaseMovies));
+
+class TestPager : public IFileItemListPager
+{
+public:
+  explicit TestPager(bool canSort) : m_canSort(canSort), m_loaded(0) {}
+
+  void Load(const VECFILEITEMS &items) override
+  {
+    for (const auto& item : items)
+    {
+      if (item->IsLabelPreformated())
+      {
+        item->SetLabelPreformated(false);
+        m_loaded++;
+      }
+    }
+  }
+  void LoadAsync(const VECFILEITEMS &items) override { Load(items); }
+  bool Update() override { return false; }
+  void Evict(CFileItem &item) override { item.SetLabelPreformated(true); }
+  bool Sort(VECFILEITEMS &items, const SortDescription &sortDescription) override
+  {
+    if (!m_canSort)
+      return false;
+    std::reverse(items.begin(), items.end());
+    return true;
+  }
+  void SetLabelMasks(const LABEL_MASKS &labelMasks) override {}
+
+  bool m_canSort;
+  int m_loaded;
+};
+
+static void AddPlaceholders(CFileItemList &items)
+{
+  const char *labels[] = { "b", "c", "a" };
+  for (const char *label : labels)
+  {
+    CFileItemPtr item(new CFileItem(label));
+    item->SetLabelPreformated(true);
+    items.Add(item);
+  }
+}
+
+TEST(TestFileItemList, PagerSort)
+{
+  CFileItemList items;
+  AddPlaceholders(items);
+  std::shared_ptr<TestPager> pager(new TestPager(true));
+  items.SetPager(pager);
+
+  items.Sort(SortByLabel, SortOrderAscending);
+  EXPECT_EQ(0, pager->m_loaded);
+  EXPECT_EQ(pager, items.GetPager());
+  EXPECT_EQ("a", items[0]->GetLabel());
+  EXPECT_EQ("b", items[2]->GetLabel());
+
+  CFileItemList copy;
+  copy.Copy(items);
+  EXPECT_EQ(pager, copy.GetPager());
+  copy.Clear();
+  EXPECT_FALSE(copy.GetPager());
+}
+
+TEST(TestFileItemList, PagerSortFallback)
+{
+  CFileItemList items;
+  AddPlaceholders(items);
+  std::shared_ptr<TestPager> pager(new TestPager(false));
+  items.SetPager(pager);
+
+  // a sort the pager can't do loads every item and drops the pager
+  items.Sort(SortByLabel, SortOrderAscending);
+  EXPECT_EQ(3, pager->m_loaded);
+  EXPECT_FALSE(items.GetPager());
+  EXPECT_EQ("a", items[0]->GetLabel());
+  EXPECT_EQ("c", items[2]->GetLabel());
+}
@@ -0,0 +1,119 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#if defined(TARGET_POSIX)
+
+#include "InfoScanner.h"
+
+#include <stdlib.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include "gtest/gtest.h"
+
+namespace
+{
+void SetModificationTime(const std::string &path, time_t mtime)
+{
+  struct utimbuf times;
+  times.actime = mtime;
+  times.modtime = mtime;
+  ASSERT_EQ(0, utime(path.c_str(), &times));
+}
+}
+
+class TestInfoScanner : public testing::Test
+{
+protected:
+  TestInfoScanner()
+  {
+    char path[] = "/tmp/infoscannerXXXXXX";
+    m_root = std::string(mkdtemp(path)) + "/";
+    m_first = m_root + "first/";
+    m_second = m_root + "second/";
+    mkdir(m_first.c_str(), 0700);
+    mkdir(m_second.c_str(), 0700);
+    SetModificationTime(m_first, 1000000000);
+    SetModificationTime(m_second, 1000000000);
+    SetModificationTime(m_root, 1000000000);
+  }
+
+  ~TestInfoScanner()
+  {
+    rmdir(m_first.c_str());
+    rmdir(m_second.c_str());
+    rmdir(m_root.c_str());
+  }
+
+  std::string m_root;
+  std::string m_first;
+  std::string m_second;
+};
+
+TEST_F(TestInfoScanner, UnchangedModificationTime)
+{
+  DirectoryFingerprints known;
+  DirectoryFingerprint fingerprint;
+  EXPECT_FALSE(CInfoScanner::IsUnchanged(m_first, known, fingerprint));
+  ASSERT_NE(0, fingerprint.mtime);
+  known[m_first] = fingerprint;
+
+  // the next scan can skip listing the folder
+  DirectoryFingerprint current;
+  EXPECT_TRUE(CInfoScanner::IsUnchanged(m_first, known, current));
+  EXPECT_EQ(fingerprint, current);
+}
+
+TEST_F(TestInfoScanner, ChangedModificationTime)
+{
+  DirectoryFingerprints known;
+  DirectoryFingerprint fingerprint;
+  ASSERT_TRUE(CInfoScanner::GetFingerprint(m_first, fingerprint));
+  known[m_first] = fingerprint;
+
+  SetModificationTime(m_first, 1000000060);
+  DirectoryFingerprint current;
+  EXPECT_FALSE(CInfoScanner::IsUnchanged(m_first, known, current));
+  EXPECT_EQ(1000000060, current.mtime);
+}
+
+TEST_F(TestInfoScanner, InterruptedRecursion)
+{
+  // the last scan was stopped after the first subfolder, so only that one was
+  // stored and the root, whose subfolders were not all reached, was not
+  DirectoryFingerprints known;
+  DirectoryFingerprint fingerprint;
+  ASSERT_TRUE(CInfoScanner::GetFingerprint(m_first, fingerprint));
+  known[m_first] = fingerprint;
+
+  EXPECT_TRUE(CInfoScanner::IsTreeUnchanged(m_first, known));
+  EXPECT_FALSE(CInfoScanner::IsTreeUnchanged(m_root, known));
+  EXPECT_FALSE(CInfoScanner::IsUnchanged(m_root, known, fingerprint));
+
+  // once the scan finishes the root is stored and the whole tree is skipped
+  CInfoScanner::GetTreeFingerprints(m_root, known);
+  EXPECT_EQ(3u, known.size());
+  EXPECT_EQ(2u, CInfoScanner::GetKnownSubDirs(m_root, known).size());
+  EXPECT_TRUE(CInfoScanner::IsTreeUnchanged(m_root, known));
+}
+
+#endif
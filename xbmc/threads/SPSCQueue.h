@@ -0,0 +1,119 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace XbmcThreads
+{
+  /**
+   * Bounded lock-free single producer, single consumer ring.
+   *
+   * Push() must only be called by one thread at a time, and so must Pop() and
+   * ForEach(). Callers with more than one producer or consumer have to
+   * serialize each side themselves. The capacity is rounded up to a power of two.
+   */
+  template<typename T>
+  class CSPSCQueue
+  {
+  public:
+    explicit CSPSCQueue(size_t capacity)
+      : m_head(0), m_tail(0), m_cachedTail(0), m_cachedHead(0)
+    {
+      size_t size = 1;
+      while (size < capacity)
+        size <<= 1;
+      m_buffer.reset(new T[size]);
+      m_mask = size - 1;
+    }
+
+    CSPSCQueue(const CSPSCQueue&) = delete;
+    CSPSCQueue& operator=(const CSPSCQueue&) = delete;
+
+    /**
+     * Append an entry, producer side. Returns false if the ring is full.
+     */
+    bool Push(const T& item)
+    {
+      size_t head = m_head.load(std::memory_order_relaxed);
+      if (head - m_cachedTail > m_mask)
+      {
+        m_cachedTail = m_tail.load(std::memory_order_acquire);
+        if (head - m_cachedTail > m_mask)
+          return false;
+      }
+      m_buffer[head & m_mask] = item;
+      m_head.store(head + 1, std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * Take the oldest entry, consumer side. Returns false if the ring is empty.
+     */
+    bool Pop(T& item)
+    {
+      size_t tail = m_tail.load(std::memory_order_relaxed);
+      if (tail == m_cachedHead)
+      {
+        m_cachedHead = m_head.load(std::memory_order_acquire);
+        if (tail == m_cachedHead)
+          return false;
+      }
+      item = m_buffer[tail & m_mask];
+      m_tail.store(tail + 1, std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * Visit the queued entries from oldest to newest, consumer side.
+     */
+    template<typename F>
+    void ForEach(F f) const
+    {
+      size_t head = m_head.load(std::memory_order_acquire);
+      for (size_t tail = m_tail.load(std::memory_order_relaxed); tail != head; ++tail)
+        f(m_buffer[tail & m_mask]);
+    }
+
+    size_t Size() const
+    {
+      return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+    bool Empty() const { return Size() == 0; }
+    size_t Capacity() const { return m_mask + 1; }
+
+  private:
+    std::unique_ptr<T[]> m_buffer;
+    size_t m_mask;
+
+    // producer and consumer state live on separate cache lines
+    std::atomic<size_t> m_head;
+    char m_padHead[64 - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> m_tail;
+    char m_padTail[64 - sizeof(std::atomic<size_t>)];
+    size_t m_cachedTail; // producer's last view of m_tail
+    char m_padCachedTail[64 - sizeof(size_t)];
+    size_t m_cachedHead; // consumer's last view of m_head
+  };
+}
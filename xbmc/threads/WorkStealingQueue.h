@@ -0,0 +1,111 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <atomic>
+#include <cstddef>
+
+namespace XbmcThreads
+{
+  /**
+   * Bounded lock-free work stealing queue of pointers (Chase-Lev).
+   *
+   * Exactly one thread (the owner) may call Push(). Any thread, including
+   * the owner, may call Steal() which takes the oldest entry, so the queue
+   * hands out work in first in, first out order.
+   *
+   * Capacity must be a power of two. Push() returns false when the queue is
+   * full, in which case the caller is expected to place the entry elsewhere.
+   */
+  template<typename T, size_t Capacity = 256>
+  class CWorkStealingQueue
+  {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+  public:
+    CWorkStealingQueue() : m_top(0), m_bottom(0)
+    {
+      for (size_t i = 0; i < Capacity; ++i)
+        m_buffer[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    CWorkStealingQueue(const CWorkStealingQueue&) = delete;
+    CWorkStealingQueue& operator=(const CWorkStealingQueue&) = delete;
+
+    /**
+     * Append an entry. Must only be called from the owning thread.
+     */
+    bool Push(T* item)
+    {
+      long bottom = m_bottom.load(std::memory_order_relaxed);
+      long top = m_top.load(std::memory_order_acquire);
+      if (bottom - top >= static_cast<long>(Capacity))
+        return false;
+
+      m_buffer[bottom & (Capacity - 1)].store(item, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      m_bottom.store(bottom + 1, std::memory_order_relaxed);
+      return true;
+    }
+
+    /**
+     * Take the oldest entry. Safe to call from any thread.
+     * Returns nullptr if the queue is empty.
+     */
+    T* Steal()
+    {
+      while (true)
+      {
+        long top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long bottom = m_bottom.load(std::memory_order_acquire);
+        if (top >= bottom)
+          return nullptr;
+
+        T* item = m_buffer[top & (Capacity - 1)].load(std::memory_order_relaxed);
+        if (m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+          return item;
+        // lost the race against another thief, try again
+      }
+    }
+
+    /**
+     * Approximate number of queued entries, only exact when no other thread
+     * is touching the queue.
+     */
+    size_t Size() const
+    {
+      long bottom = m_bottom.load(std::memory_order_relaxed);
+      long top = m_top.load(std::memory_order_relaxed);
+      return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+    }
+
+    bool Empty() const { return Size() == 0; }
+
+  private:
+    // pad so thieves (top) and the owner (bottom) don't share a cache line
+    std::atomic<long> m_top;
+    char m_padTop[64 - sizeof(std::atomic<long>)];
+    std::atomic<long> m_bottom;
+    char m_padBottom[64 - sizeof(std::atomic<long>)];
+    std::atomic<T*> m_buffer[Capacity];
+  };
+}
@@ -0,0 +1,210 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TestHelpers.h"
+#include "threads/SystemClock.h"
+#include "threads/WorkStealingQueue.h"
+
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace XbmcThreads;
+
+namespace
+{
+struct Item
+{
+  Item() : taken(0) {}
+  std::atomic<int> taken;
+};
+
+typedef CWorkStealingQueue<Item, 256> Queue;
+
+class Thief : public IRunnable
+{
+public:
+  Thief(Queue &queue, std::atomic<bool> &done, std::atomic<long> &count)
+    : m_queue(queue), m_done(done), m_count(count) {}
+
+  void Run() override
+  {
+    while (!m_done || !m_queue.Empty())
+    {
+      Item *item = m_queue.Steal();
+      if (item)
+      {
+        item->taken++;
+        m_count++;
+      }
+    }
+  }
+
+private:
+  Queue &m_queue;
+  std::atomic<bool> &m_done;
+  std::atomic<long> &m_count;
+};
+
+/* Simulated job pool: every worker owns a queue, creates its share of the jobs
+   and steals from the others once it runs out of work of its own. */
+class BenchWorker : public IRunnable
+{
+public:
+  BenchWorker(std::vector<std::unique_ptr<Queue>> &queues, unsigned int index,
+              long jobs, long total, std::atomic<long> &processed)
+    : m_queues(queues), m_index(index), m_jobs(jobs), m_total(total), m_processed(processed) {}
+
+  void Run() override
+  {
+    Queue &own = *m_queues[m_index];
+    long created = 0;
+    while (m_processed < m_total)
+    {
+      if (created < m_jobs && own.Push(&m_item))
+      {
+        created++;
+        continue;
+      }
+
+      Item *item = own.Steal();
+      for (unsigned int i = 1; !item && i < m_queues.size(); ++i)
+        item = m_queues[(m_index + i) % m_queues.size()]->Steal();
+      if (item)
+      {
+        item->taken++;
+        m_processed++;
+      }
+    }
+  }
+
+private:
+  std::vector<std::unique_ptr<Queue>> &m_queues;
+  unsigned int m_index;
+  long m_jobs;
+  long m_total;
+  std::atomic<long> &m_processed;
+  Item m_item;
+};
+}
+
+TEST(TestWorkStealingQueue, PushSteal)
+{
+  Queue queue;
+  Item items[4];
+  EXPECT_TRUE(queue.Empty());
+  EXPECT_EQ(nullptr, queue.Steal());
+
+  for (int i = 0; i < 4; i++)
+    EXPECT_TRUE(queue.Push(&items[i]));
+  EXPECT_EQ(4u, queue.Size());
+
+  // entries come back first in, first out
+  for (int i = 0; i < 4; i++)
+    EXPECT_EQ(&items[i], queue.Steal());
+  EXPECT_TRUE(queue.Empty());
+}
+
+TEST(TestWorkStealingQueue, Full)
+{
+  Queue queue;
+  Item item;
+  for (int i = 0; i < 256; i++)
+    EXPECT_TRUE(queue.Push(&item));
+  EXPECT_FALSE(queue.Push(&item));
+  EXPECT_EQ(&item, queue.Steal());
+  EXPECT_TRUE(queue.Push(&item));
+}
+
+TEST(TestWorkStealingQueue, ConcurrentSteal)
+{
+  const long numItems = 100000;
+  const int numThieves = 4;
+
+  Queue queue;
+  std::vector<Item> items(numItems);
+  std::atomic<bool> done(false);
+  std::atomic<long> count(0);
+
+  std::vector<std::unique_ptr<Thief>> thieves;
+  std::vector<thread> threads;
+  for (int i = 0; i < numThieves; i++)
+  {
+    thieves.emplace_back(new Thief(queue, done, count));
+    threads.push_back(thread(*thieves.back()));
+  }
+
+  // the owner competes with the thieves
+  for (long i = 0; i < numItems;)
+  {
+    if (queue.Push(&items[i]))
+      i++;
+    else
+    {
+      Item *item = queue.Steal();
+      if (item)
+      {
+        item->taken++;
+        count++;
+      }
+    }
+  }
+  done = true;
+
+  for (int i = 0; i < numThieves; i++)
+    threads[i].join();
+
+  EXPECT_EQ(numItems, count);
+  for (long i = 0; i < numItems; i++)
+    EXPECT_EQ(1, items[i].taken);
+}
+
+TEST(TestWorkStealingQueue, Throughput)
+{
+  const long numJobs = 1000000;
+
+  for (unsigned int numWorkers = 1; numWorkers <= 64; numWorkers *= 2)
+  {
+    std::vector<std::unique_ptr<Queue>> queues;
+    for (unsigned int i = 0; i < numWorkers; i++)
+      queues.emplace_back(new Queue);
+
+    std::atomic<long> processed(0);
+    std::vector<std::unique_ptr<BenchWorker>> workers;
+    // the first worker creates half the jobs so the others have to steal
+    long share = numJobs / 2 / numWorkers;
+    long first = numJobs - share * (numWorkers - 1);
+    for (unsigned int i = 0; i < numWorkers; i++)
+      workers.emplace_back(new BenchWorker(queues, i, i == 0 ? first : share, numJobs, processed));
+
+    unsigned int start = SystemClockMillis();
+    std::vector<thread> threads;
+    for (unsigned int i = 0; i < numWorkers; i++)
+      threads.push_back(thread(*workers[i]));
+    for (unsigned int i = 0; i < numWorkers; i++)
+      threads[i].join();
+    unsigned int elapsed = SystemClockMillis() - start;
+
+    EXPECT_EQ(numJobs, processed);
+    std::cout << "workers: " << numWorkers << ", jobs/sec: "
+              << (elapsed ? numJobs * 1000 / elapsed : numJobs * 1000) << std::endl;
+  }
+}
@@ -37,9 +37,10 @@ bool CJob::ShouldCancel(unsigned int progress, unsigned int total) const
   return false;
 }
 
-CJobWorker::CJobWorker(CJobManager *manager) : CThread("JobWorker")
+CJobWorker::CJobWorker(CJobManager *manager, unsigned int slot) : CThread("JobWorker")
 {
   m_jobManager = manager;
+  m_slot = slot;
   Create(true); // start work immediately, and kill ourselves when we're done
 }
 
@@ -72,7 +73,7 @@ void CJobWorker::Process()
     {
       CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, job->GetType());
     }
-    m_jobManager->OnJobComplete(success, job);
+    m_jobManager->OnJobComplete(this, success, job);
   }
 }
 
@@ -180,10 +181,21 @@ CJobManager &CJobManager::GetInstance()
 }
 
 CJobManager::CJobManager()
+  : m_jobCounter(0)
+  , m_slotCount(0)
+  , m_processing(0)
+  , m_workerCount(0)
+  , m_maxWorkers(5)
+  , m_pauseJobs(false)
+  , m_running(true)
 {
-  m_jobCounter = 0;
-  m_running = true;
-  m_pauseJobs = false;
+  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_DEDICATED; ++priority)
+  {
+    m_injected[priority] = NULL;
+    m_queued[priority] = 0;
+  }
+  for (unsigned int slot = 0; slot < MAX_WORKER_SLOTS; ++slot)
+    m_slots[slot] = NULL;
 }
 
 void CJobManager::Restart()
@@ -200,16 +212,28 @@ void CJobManager::CancelJobs()
   CSingleLock lock(m_section);
   m_running = false;
 
-  // clear any pending jobs
-  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_DEDICATED; ++priority)
+  // clear any pending jobs and cancel any callbacks on jobs still processing
+  for (unsigned int shard = 0; shard < REGISTRY_SHARDS; ++shard)
   {
-    for_each(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), std::mem_fun_ref(&CWorkItem::FreeJob));
-    m_jobQueue[priority].clear();
+    CSingleLock registryLock(m_registry[shard].m_section);
+    std::map<unsigned int, CWorkItem*> &items = m_registry[shard].m_items;
+    for (std::map<unsigned int, CWorkItem*>::iterator i = items.begin(); i != items.end();)
+    {
+      CWorkItem *item = i->second;
+      int queued = CWorkItem::STATE_QUEUED;
+      if (item->m_state.compare_exchange_strong(queued, CWorkItem::STATE_CANCELLED))
+      {
+        item->FreeJob();
+        i = items.erase(i);
+      }
+      else
+      {
+        item->m_callback = NULL;
+        ++i;
+      }
+    }
   }
 
-  // cancel any callbacks on jobs still processing
-  for_each(m_processing.begin(), m_processing.end(), std::mem_fun_ref(&CWorkItem::Cancel));
-
   // tell our workers to finish
   while (m_workers.size())
   {
@@ -218,118 +242,273 @@ void CJobManager::CancelJobs()
     Sleep(0); // yield after setting the event to give the workers some time to die
     lock.Enter();
   }
+
+  // free the cancelled jobs the workers didn't get to
+  DrainQueues();
 }
 
 CJobManager::~CJobManager()
 {
+  for (unsigned int slot = 0; slot < m_slotCount; ++slot)
+    delete GetSlot(slot);
 }
 
 unsigned int CJobManager::AddJob(CJob *job, IJobCallback *callback, CJob::PRIORITY priority)
 {
-  CSingleLock lock(m_section);
-
   if (!m_running)
     return 0;
 
   // increment the job counter, ensuring 0 (invalid job) is never hit
-  m_jobCounter++;
-  if (m_jobCounter == 0)
-    m_jobCounter++;
+  unsigned int id = ++m_jobCounter;
+  if (id == 0)
+    id = ++m_jobCounter;
 
   // create a work item for this job
-  CWorkItem work(job, m_jobCounter, priority, callback);
-  m_jobQueue[priority].push_back(work);
+  CWorkItem *work = new CWorkItem(job, id, priority, callback);
+
+  {
+    CJobRegistry &registry = GetRegistry(id);
+    CSingleLock lock(registry.m_section);
+
+    // checked under the registry lock so that CancelJobs() can't miss this job
+    if (!m_running)
+    {
+      delete work;
+      return 0;
+    }
+    registry.m_items[id] = work;
+    m_queued[priority]++;
+
+    // jobs queued from one of our workers go to its own queue, everything else to the shared stack
+    CJobWorker *worker = dynamic_cast<CJobWorker*>(CThread::GetCurrentThread());
+    if (!worker || worker->m_jobManager != this || !GetSlot(worker->m_slot)->m_queue[priority].Push(work))
+      PushInjected(work);
+  }
 
   StartWorkers(priority);
-  return work.m_id;
+  return id;
 }
 
 void CJobManager::CancelJob(unsigned int jobID)
 {
-  CSingleLock lock(m_section);
+  CJobRegistry &registry = GetRegistry(jobID);
+  CSingleLock lock(registry.m_section);
 
-  // check whether we have this job in the queue
-  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_DEDICATED; ++priority)
+  std::map<unsigned int, CWorkItem*>::iterator i = registry.m_items.find(jobID);
+  if (i == registry.m_items.end())
+    return;
+
+  CWorkItem *item = i->second;
+  int queued = CWorkItem::STATE_QUEUED;
+  if (item->m_state.compare_exchange_strong(queued, CWorkItem::STATE_CANCELLED))
   {
-    JobQueue::iterator i = find(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), jobID);
-    if (i != m_jobQueue[priority].end())
-    {
-      delete i->m_job;
-      m_jobQueue[priority].erase(i);
-      return;
-    }
+    // still queued - the worker that takes it off the queue frees the work item
+    item->FreeJob();
+    registry.m_items.erase(i);
   }
-  // or if we're processing it
-  Processing::iterator it = find(m_processing.begin(), m_processing.end(), jobID);
-  if (it != m_processing.end())
-    it->m_callback = NULL; // job is in progress, so only thing to do is to remove callback
+  else
+    item->m_callback = NULL; // job is in progress, so only thing to do is to remove callback
 }
 
 void CJobManager::StartWorkers(CJob::PRIORITY priority)
 {
-  CSingleLock lock(m_section);
-
   // check how many free threads we have
-  if (m_processing.size() >= GetMaxWorkers(priority))
+  if (m_processing >= GetMaxWorkers(priority))
     return;
 
   // do we have any sleeping threads?
-  if (m_processing.size() < m_workers.size())
+  if (m_processing < m_workerCount)
+  {
+    m_jobEvent.Set();
+    return;
+  }
+
+  CSingleLock lock(m_section);
+  if (!m_running)
+    return;
+
+  // a worker may have started or gone idle while we waited for the lock
+  if (m_processing < m_workerCount)
   {
     m_jobEvent.Set();
     return;
   }
 
   // everyone is busy - we need more workers
-  m_workers.push_back(new CJobWorker(this));
+  unsigned int slot = 0;
+  unsigned int slotCount = m_slotCount;
+  while (slot < slotCount && GetSlot(slot)->m_inUse)
+    ++slot;
+  if (slot == slotCount)
+  {
+    // the job waits for a worker to free up if we're at the limit
+    if (slotCount == MAX_WORKER_SLOTS)
+      return;
+    m_slots[slot].store(new CWorkerSlot, std::memory_order_release);
+    m_slotCount.store(slotCount + 1, std::memory_order_release);
+  }
+
+  GetSlot(slot)->m_inUse = true;
+  m_workerCount++;
+  m_workers.push_back(new CJobWorker(this, slot));
 }
 
-CJob *CJobManager::PopJob()
+void CJobManager::PushInjected(CWorkItem *item)
+{
+  std::atomic<CWorkItem*> &head = m_injected[item->m_priority];
+  CWorkItem *next = head.load(std::memory_order_relaxed);
+  do
+  {
+    item->m_next = next;
+  } while (!head.compare_exchange_weak(next, item, std::memory_order_release, std::memory_order_relaxed));
+}
+
+bool CJobManager::ReserveWorker(CJob::PRIORITY priority)
+{
+  unsigned int processing = m_processing;
+  do
+  {
+    if (processing >= GetMaxWorkers(priority))
+      return false;
+  } while (!m_processing.compare_exchange_weak(processing, processing + 1));
+  return true;
+}
+
+CJobManager::CWorkItem *CJobManager::TakeJob(unsigned int slot, CJob::PRIORITY priority)
+{
+  CWorkerSlot *own = GetSlot(slot);
+
+  // our own queue first
+  CWorkItem *item = own->m_queue[priority].Steal();
+  if (item)
+    return item;
+
+  // then anything queued from outside the pool. We grab the whole stack, keep the
+  // oldest job and move the rest to our queue, where other workers can steal them.
+  item = m_injected[priority].exchange(NULL, std::memory_order_acquire);
+  if (item)
+  {
+    CWorkItem *fifo = NULL;
+    while (item)
+    {
+      CWorkItem *next = item->m_next;
+      item->m_next = fifo;
+      fifo = item;
+      item = next;
+    }
+
+    item = fifo;
+    fifo = fifo->m_next;
+    bool shared = false;
+    while (fifo)
+    {
+      CWorkItem *next = fifo->m_next;
+      if (own->m_queue[priority].Push(fifo))
+        shared = true;
+      else
+        PushInjected(fifo);
+      fifo = next;
+    }
+
+    // wake any sleeping workers so they can steal what we just queued
+    if (shared && m_processing < m_workerCount)
+      m_jobEvent.Set();
+    return item;
+  }
+
+  // finally steal from the other workers
+  unsigned int slotCount = m_slotCount.load(std::memory_order_acquire);
+  for (unsigned int i = 1; i < slotCount; ++i)
+  {
+    CWorkerSlot *victim = GetSlot((slot + i) % slotCount);
+    item = victim->m_queue[priority].Steal();
+    if (item)
+      return item;
+  }
+  return NULL;
+}
+
+CJobManager::CWorkItem *CJobManager::PopJob(unsigned int slot)
 {
-  CSingleLock lock(m_section);
   for (int priority = CJob::PRIORITY_DEDICATED; priority >= CJob::PRIORITY_LOW_PAUSABLE; --priority)
   {
     // Check whether we're pausing pausable jobs
     if (priority == CJob::PRIORITY_LOW_PAUSABLE && m_pauseJobs)
       continue;
 
-    if (m_jobQueue[priority].size() && m_processing.size() < GetMaxWorkers(CJob::PRIORITY(priority)))
+    if (m_queued[priority] == 0 || !ReserveWorker(CJob::PRIORITY(priority)))
+      continue;
+
+    CWorkItem *item;
+    while ((item = TakeJob(slot, CJob::PRIORITY(priority))) != NULL)
     {
-      // pop the job off the queue
-      CWorkItem job = m_jobQueue[priority].front();
-      m_jobQueue[priority].pop_front();
-
-      // add to the processing vector
-      m_processing.push_back(job);
-      job.m_job->m_callback = this;
-      return job.m_job;
+      m_queued[priority]--;
+
+      int queued = CWorkItem::STATE_QUEUED;
+      if (item->m_state.compare_exchange_strong(queued, CWorkItem::STATE_PROCESSING))
+      {
+        // add to the processing slot
+        CWorkerSlot *own = GetSlot(slot);
+        CSingleLock lock(own->m_section);
+        own->m_current = item;
+        item->m_job->m_callback = this;
+        return item;
+      }
+
+      // cancelled while queued - make sure CancelJob() is done with it before freeing
+      {
+        CSingleLock lock(GetRegistry(item->m_id).m_section);
+      }
+      delete item;
     }
+
+    // nothing to do at this priority, give back the reservation
+    m_processing--;
   }
   return NULL;
 }
 
+void CJobManager::DrainQueues()
+{
+  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_DEDICATED; ++priority)
+  {
+    CWorkItem *item = m_injected[priority].exchange(NULL);
+    while (item)
+    {
+      CWorkItem *next = item->m_next;
+      delete item;
+      item = next;
+    }
+
+    for (unsigned int slot = 0; slot < m_slotCount; ++slot)
+    {
+      while ((item = GetSlot(slot)->m_queue[priority].Steal()) != NULL)
+        delete item;
+    }
+    m_queued[priority] = 0;
+  }
+}
+
 void CJobManager::PauseJobs()
 {
-  CSingleLock lock(m_section);
   m_pauseJobs = true;
 }
 
 void CJobManager::UnPauseJobs()
 {
-  CSingleLock lock(m_section);
   m_pauseJobs = false;
 }
 
 bool CJobManager::IsProcessing(const CJob::PRIORITY &priority) const
 {
-  CSingleLock lock(m_section);
-
   if (m_pauseJobs)
     return false;
 
-  for(Processing::const_iterator it = m_processing.begin(); it < m_processing.end(); ++it)
+  for (unsigned int slot = 0; slot < m_slotCount; ++slot)
   {
-    if (priority == it->m_priority)
+    CWorkerSlot *worker = GetSlot(slot);
+    CSingleLock lock(worker->m_section);
+    if (worker->m_current && priority == worker->m_current->m_priority)
       return true;
   }
   return false;
@@ -338,14 +517,15 @@ bool CJobManager::IsProcessing(const CJob::PRIORITY &priority) const
 int CJobManager::IsProcessing(const std::string &type) const
 {
   int jobsMatched = 0;
-  CSingleLock lock(m_section);
 
   if (m_pauseJobs)
     return 0;
 
-  for(Processing::const_iterator it = m_processing.begin(); it < m_processing.end(); ++it)
+  for (unsigned int slot = 0; slot < m_slotCount; ++slot)
   {
-    if (type == std::string(it->m_job->GetType()))
+    CWorkerSlot *worker = GetSlot(slot);
+    CSingleLock lock(worker->m_section);
+    if (worker->m_current && type == std::string(worker->m_current->m_job->GetType()))
       jobsMatched++;
   }
   return jobsMatched;
@@ -353,25 +533,26 @@ int CJobManager::IsProcessing(const std::string &type) const
 
 CJob *CJobManager::GetNextJob(const CJobWorker *worker)
 {
-  CSingleLock lock(m_section);
   while (m_running)
   {
     // grab a job off the queue if we have one
-    CJob *job = PopJob();
-    if (job)
-      return job;
+    CWorkItem *item = PopJob(worker->m_slot);
+    if (item)
+      return item->m_job;
     // no jobs are left - sleep for 30 seconds to allow new jobs to come in
-    lock.Leave();
-    bool newJob = m_jobEvent.WaitMSec(30000);
-    lock.Enter();
-    if (!newJob)
+    if (!m_jobEvent.WaitMSec(30000))
       break;
   }
-  // ensure no jobs have come in during the period after
-  // timeout and before we held the lock
-  CJob *job = PopJob();
-  if (job)
-    return job;
+
+  // ensure no jobs have come in during the period after timeout and before we
+  // held the lock. We don't count ourselves as available while checking, so
+  // AddJob() starts a new worker rather than relying on us.
+  CSingleLock lock(m_section);
+  m_workerCount--;
+  CWorkItem *item = PopJob(worker->m_slot);
+  m_workerCount++;
+  if (item)
+    return item->m_job;
   // have no jobs
   RemoveWorker(worker);
   return NULL;
@@ -379,48 +560,63 @@ CJob *CJobManager::GetNextJob(const CJobWorker *worker)
 
 bool CJobManager::OnJobProgress(unsigned int progress, unsigned int total, const CJob *job) const
 {
-  CSingleLock lock(m_section);
-  // find the job in the processing queue, and check whether it's cancelled (no callback)
-  Processing::const_iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
+  // find the job among the ones processing, and check whether it's cancelled (no callback)
+  for (unsigned int slot = 0; slot < m_slotCount; ++slot)
   {
-    CWorkItem item(*i);
-    lock.Leave(); // leave section prior to call
-    if (item.m_callback)
+    CWorkerSlot *worker = GetSlot(slot);
+    CSingleLock lock(worker->m_section);
+    if (worker->m_current && worker->m_current->m_job == job)
     {
-      item.m_callback->OnJobProgress(item.m_id, progress, total, job);
-      return false;
+      CWorkItem *item = worker->m_current;
+      CSingleLock registryLock(GetRegistry(item->m_id).m_section);
+      unsigned int id = item->m_id;
+      IJobCallback *callback = item->m_callback;
+      registryLock.Leave();
+      lock.Leave(); // leave section prior to call
+      if (callback)
+      {
+        callback->OnJobProgress(id, progress, total, job);
+        return false;
+      }
+      break;
     }
   }
   return true; // couldn't find the job, or it's been cancelled
 }
 
-void CJobManager::OnJobComplete(bool success, CJob *job)
+void CJobManager::OnJobComplete(const CJobWorker *worker, bool success, CJob *job)
 {
-  CSingleLock lock(m_section);
-  // remove the job from the processing queue
-  Processing::iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
+  CWorkerSlot *slot = GetSlot(worker->m_slot);
+  CWorkItem *item = slot->m_current; // only ever changed by this worker
+  if (!item || item->m_job != job)
+    return;
+
+  // tell any listeners we're done with the job, then delete it
+  CJobRegistry &registry = GetRegistry(item->m_id);
+  CSingleLock lock(registry.m_section);
+  IJobCallback *callback = item->m_callback;
+  lock.Leave();
+  try
   {
-    // tell any listeners we're done with the job, then delete it
-    CWorkItem item(*i);
-    lock.Leave();
-    try
-    {
-      if (item.m_callback)
-        item.m_callback->OnJobComplete(item.m_id, success, item.m_job);
-    }
-    catch (...)
-    {
-      CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, item.m_job->GetType());
-    }
-    lock.Enter();
-    Processing::iterator j = find(m_processing.begin(), m_processing.end(), job);
-    if (j != m_processing.end())
-      m_processing.erase(j);
-    lock.Leave();
-    item.FreeJob();
+    if (callback)
+      callback->OnJobComplete(item->m_id, success, item->m_job);
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, item->m_job->GetType());
   }
+  lock.Enter();
+  registry.m_items.erase(item->m_id);
+  lock.Leave();
+
+  {
+    CSingleLock slotLock(slot->m_section);
+    slot->m_current = NULL;
+  }
+  m_processing--;
+
+  item->FreeJob();
+  delete item;
 }
 
 void CJobManager::RemoveWorker(const CJobWorker *worker)
@@ -429,13 +625,29 @@ void CJobManager::RemoveWorker(const CJobWorker *worker)
   // remove our worker
   Workers::iterator i = find(m_workers.begin(), m_workers.end(), worker);
   if (i != m_workers.end())
+  {
+    GetSlot(worker->m_slot)->m_inUse = false;
+    m_workerCount--;
     m_workers.erase(i); // workers auto-delete
+  }
+}
+
+void CJobManager::SetMaxWorkers(unsigned int workers)
+{
+  m_maxWorkers = std::min(std::max(workers, 1u), static_cast<unsigned int>(MAX_WORKER_SLOTS));
+  // let a newly allowed worker pick up what is queued
+  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority < CJob::PRIORITY_DEDICATED; ++priority)
+  {
+    if (m_queued[priority])
+      StartWorkers(static_cast<CJob::PRIORITY>(priority));
+  }
 }
 
-unsigned int CJobManager::GetMaxWorkers(CJob::PRIORITY priority)
+unsigned int CJobManager::GetMaxWorkers(CJob::PRIORITY priority) const
 {
-  static const unsigned int max_workers = 5;
   if (priority == CJob::PRIORITY_DEDICATED)
     return 10000; // A large number..
-  return max_workers - (CJob::PRIORITY_HIGH - priority);
+  unsigned int lower = CJob::PRIORITY_HIGH - priority;
+  unsigned int workers = m_maxWorkers;
+  return workers > lower ? workers - lower : 1;
 }
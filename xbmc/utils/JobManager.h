@@ -19,11 +19,14 @@
  *
  */
 
+#include <atomic>
+#include <map>
 #include <queue>
 #include <vector>
 #include <string>
 #include "threads/CriticalSection.h"
 #include "threads/Thread.h"
+#include "threads/WorkStealingQueue.h"
 #include "Job.h"
 
 class CJobManager;
@@ -31,12 +34,14 @@ class CJobManager;
 class CJobWorker : public CThread
 {
 public:
-  CJobWorker(CJobManager *manager);
+  CJobWorker(CJobManager *manager, unsigned int slot);
   virtual ~CJobWorker();
 
   void Process();
 private:
+  friend class CJobManager;
   CJobManager  *m_jobManager;
+  unsigned int  m_slot;
 };
 
 /*!
@@ -170,6 +175,11 @@ private:
  priority levels.  Lower priority jobs are executed only if there are sufficient
  spare worker threads free to allow for higher priority jobs that may arise.
 
+ Scheduling is work stealing: every worker owns a lock-free queue per priority and
+ idle workers steal from busy ones, so queueing and dequeueing jobs does not serialize
+ on a single lock. Jobs queued from a worker thread go to that worker's own queue,
+ jobs queued from any other thread are picked up by the next worker looking for work.
+
  \sa CJob and IJobCallback
  */
 class CJobManager
@@ -177,34 +187,62 @@ class CJobManager
   class CWorkItem
   {
   public:
+    enum STATE
+    {
+      STATE_QUEUED = 0,
+      STATE_PROCESSING,
+      STATE_CANCELLED
+    };
+
     CWorkItem(CJob *job, unsigned int id, CJob::PRIORITY priority, IJobCallback *callback)
+      : m_state(STATE_QUEUED)
     {
       m_job = job;
       m_id = id;
       m_callback = callback;
       m_priority = priority;
+      m_next = NULL;
     }
-    bool operator==(unsigned int jobID) const
-    {
-      return m_id == jobID;
-    };
-    bool operator==(const CJob *job) const
-    {
-      return m_job == job;
-    };
     void FreeJob()
     {
       delete m_job;
       m_job = NULL;
     };
-    void Cancel()
-    {
-      m_callback = NULL;
-    };
     CJob         *m_job;
     unsigned int  m_id;
     IJobCallback *m_callback;
     CJob::PRIORITY m_priority;
+    std::atomic<int> m_state;
+    CWorkItem    *m_next; // link in the lock-free injection stack
+  };
+
+  typedef XbmcThreads::CWorkStealingQueue<CWorkItem> WorkQueue;
+
+  /*!
+   \brief Per worker scheduling state.
+   Each worker owns one work stealing queue per priority. Only the owning worker
+   pushes into them, any worker may take from them. Slots are never freed while the
+   manager exists so other workers can safely steal from a slot whose worker just exited.
+   */
+  class CWorkerSlot
+  {
+  public:
+    CWorkerSlot() : m_current(NULL), m_inUse(false) {}
+    WorkQueue        m_queue[CJob::PRIORITY_DEDICATED + 1];
+    CCriticalSection m_section; // guards m_current
+    CWorkItem       *m_current;
+    bool             m_inUse;   // guarded by CJobManager::m_section
+  };
+
+  /*!
+   \brief One shard of the table of live (queued or processing) jobs, used for cancellation.
+   The job id selects the shard, so concurrent AddJob calls rarely contend.
+   */
+  class CJobRegistry
+  {
+  public:
+    CCriticalSection m_section;
+    std::map<unsigned int, CWorkItem*> m_items;
   };
 
   template<typename F>
@@ -297,6 +335,14 @@ public:
    */
   bool IsProcessing(const CJob::PRIORITY &priority) const;
 
+  /*!
+   \brief Sets how many workers may process jobs at the same time.
+   PRIORITY_HIGH jobs may use all of them, every lower priority one less but at least one.
+   PRIORITY_DEDICATED jobs are not limited. Defaults to 5.
+   \param workers the number of workers, capped to the size of the worker pool
+   */
+  void SetMaxWorkers(unsigned int workers);
+
 protected:
   friend class CJobWorker;
   friend class CJob;
@@ -311,11 +357,12 @@ protected:
   /*!
    \brief Callback from CJobWorker after a job has completed.
    Calls IJobCallback::OnJobComplete(), and then destroys job.
-   \param job a pointer to the calling subclassed CJob instance.
+   \param worker a pointer to the CJobWorker instance that processed the job.
    \param success the result from the DoWork call
+   \param job a pointer to the calling subclassed CJob instance.
    \sa IJobCallback, CJob
    */
-  void  OnJobComplete(bool success, CJob *job);
+  void  OnJobComplete(const CJobWorker *worker, bool success, CJob *job);
 
   /*!
    \brief Callback from CJob to report progress and check for cancellation.
@@ -335,27 +382,44 @@ private:
   CJobManager const& operator=(CJobManager const&);
   virtual ~CJobManager();
 
-  /*! \brief Pop a job off the job queue and add to the processing queue ready to process
+  /*! \brief Take the highest priority job available to the given worker and mark it as processing.
+   Looks at the worker's own queue first, then at jobs queued from outside the worker pool,
+   and finally steals from the other workers.
    \return the job to process, NULL if no jobs are available
    */
-  CJob *PopJob();
+  CWorkItem *PopJob(unsigned int slot);
+  CWorkItem *TakeJob(unsigned int slot, CJob::PRIORITY priority);
+  bool ReserveWorker(CJob::PRIORITY priority);
+
+  void PushInjected(CWorkItem *item);
+  CJobRegistry &GetRegistry(unsigned int jobID) const { return m_registry[jobID % REGISTRY_SHARDS]; }
+  CWorkerSlot *GetSlot(unsigned int slot) const { return m_slots[slot].load(std::memory_order_acquire); }
+  void DrainQueues();
 
   void StartWorkers(CJob::PRIORITY priority);
   void RemoveWorker(const CJobWorker *worker);
-  static unsigned int GetMaxWorkers(CJob::PRIORITY priority);
+  unsigned int GetMaxWorkers(CJob::PRIORITY priority) const;
+
+  static const unsigned int REGISTRY_SHARDS = 16;
+  static const unsigned int MAX_WORKER_SLOTS = 128;
 
-  unsigned int m_jobCounter;
+  std::atomic<unsigned int> m_jobCounter;
 
-  typedef std::deque<CWorkItem>    JobQueue;
-  typedef std::vector<CWorkItem>   Processing;
   typedef std::vector<CJobWorker*> Workers;
 
-  JobQueue   m_jobQueue[CJob::PRIORITY_DEDICATED + 1];
-  bool       m_pauseJobs;
-  Processing m_processing;
+  // jobs added from outside the worker pool, one lock-free LIFO stack per priority
+  std::atomic<CWorkItem*>   m_injected[CJob::PRIORITY_DEDICATED + 1];
+  std::atomic<unsigned int> m_queued[CJob::PRIORITY_DEDICATED + 1];
+  std::atomic<CWorkerSlot*> m_slots[MAX_WORKER_SLOTS];
+  std::atomic<unsigned int> m_slotCount;
+  std::atomic<unsigned int> m_processing;
+  std::atomic<unsigned int> m_workerCount;
+  std::atomic<unsigned int> m_maxWorkers;
+  std::atomic<bool>         m_pauseJobs;
+  mutable CJobRegistry      m_registry[REGISTRY_SHARDS];
   Workers    m_workers;
 
-  CCriticalSection m_section;
-  CEvent           m_jobEvent;
-  bool             m_running;
+  CCriticalSection  m_section; // guards m_workers and slot ownership
+  CEvent            m_jobEvent;
+  std::atomic<bool> m_running;
 };
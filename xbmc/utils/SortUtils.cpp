@@ -23,11 +23,18 @@
 #include "URL.h"
 #include "Util.h"
 #include "XBDateTime.h"
+#include "threads/Event.h"
 #include "utils/CharsetConverter.h"
+#include "utils/CPUInfo.h"
+#include "utils/JobManager.h"
 #include "utils/StringUtils.h"
 #include "utils/Variant.h"
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <unordered_map>
 
 std::string ArrayToString(SortAttribute attributes, const CVariant &variant, const std::string &seperator = " / ")
 {
@@ -689,73 +696,331 @@ std::map<SortBy, Fields> fillSortingFields()
 std::map<SortBy, SortUtils::SortPreparator> SortUtils::m_preparators = fillPreparators();
 std::map<SortBy, Fields> SortUtils::m_sortingFields = fillSortingFields();
 
-void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, DatabaseResults& items, int limitEnd /* = -1 */, int limitStart /* = 0 */)
+namespace
+{
+
+// lists with fewer items are sorted on the calling thread only
+const size_t ParallelSortThreshold = 10000;
+const size_t MaxParallelSortChunks = 16;
+// like StringUtils::AlphaNumericCompare, numbers are compared up to this many digits
+const size_t MaxSortDigits = 15;
+// characters below this are ranked through a table, the rest through a map
+const uint32_t RankTableSize = 0x800;
+
+/*!
+ \brief A character or a run of digits of a sort label.
+ Two numbers compare by their value, anything else by the collation rank of the
+ (first) character, which gives the same order as StringUtils::AlphaNumericCompare
+ without going through the locale for every comparison.
+ */
+struct SortToken
+{
+  uint64_t value;
+  uint32_t rank;
+  uint32_t number;
+};
+
+/*!
+ \brief The precomputed key of an item: its group (sort specials and folders)
+ and the range of its label tokens in the shared token buffer.
+ */
+struct SortKey
+{
+  enum Group { GroupTop = 0, GroupFolder, GroupFile, GroupBottom };
+
+  unsigned int group;
+  size_t start;
+  size_t length;
+};
+
+inline wchar_t FoldCase(wchar_t c)
 {
-  if (sortBy != SortByNone)
+  return c >= L'A' && c <= L'Z' ? c + (L'a' - L'A') : c;
+}
+
+inline bool InRankTable(wchar_t c)
+{
+  return static_cast<uint32_t>(c) < RankTableSize;
+}
+
+class CCollationRanks
+{
+public:
+  CCollationRanks() : m_table(RankTableSize, 0) {}
+
+  void Add(const std::wstring &label)
   {
-    // get the matching SortPreparator
-    SortPreparator preparator = getPreparator(sortBy);
-    if (preparator != NULL)
+    for (const wchar_t *c = label.c_str(); *c; c++)
     {
-      Fields sortingFields = GetFieldsForSorting(sortBy);
+      wchar_t folded = FoldCase(*c);
+      if (InRankTable(folded))
+        m_table[folded] = 1;
+      else
+        m_others[folded] = 1;
+    }
+  }
 
-      // Prepare the string used for sorting and store it under FieldSort
-      for (DatabaseResults::iterator item = items.begin(); item != items.end(); ++item)
-      {
-        // add all fields to the item that are required for sorting if they are currently missing
-        for (Fields::const_iterator field = sortingFields.begin(); field != sortingFields.end(); ++field)
-        {
-          if (item->find(*field) == item->end())
-            item->insert(std::pair<Field, CVariant>(*field, CVariant::ConstNullVariant));
-        }
-
-        std::wstring sortLabel;
-        g_charsetConverter.utf8ToW(preparator(attributes, *item), sortLabel, false);
-        item->insert(std::pair<Field, CVariant>(FieldSort, CVariant(sortLabel)));
-      }
+  void Merge(const CCollationRanks &ranks)
+  {
+    for (uint32_t c = 0; c < RankTableSize; c++)
+      m_table[c] |= ranks.m_table[c];
+    m_others.insert(ranks.m_others.begin(), ranks.m_others.end());
+  }
 
-      // Do the sorting
-      std::stable_sort(items.begin(), items.end(), getSorter(sortOrder, attributes));
+  //! Replaces the characters seen by their rank in the collation order of the system locale
+  void Rank()
+  {
+    std::vector<wchar_t> characters;
+    for (uint32_t c = 0; c < RankTableSize; c++)
+    {
+      if (m_table[c])
+        characters.push_back(c);
+    }
+    for (const auto& c : m_others)
+      characters.push_back(c.first);
+
+    const std::collate<wchar_t>& coll = std::use_facet<std::collate<wchar_t> >(g_langInfo.GetSystemLocale());
+    auto compare = [&coll](wchar_t left, wchar_t right) { return coll.compare(&left, &left + 1, &right, &right + 1); };
+    std::sort(characters.begin(), characters.end(), [&compare](wchar_t left, wchar_t right) { return compare(left, right) < 0; });
+
+    uint32_t rank = 0;
+    for (size_t i = 0; i < characters.size(); i++)
+    {
+      // characters that collate equal share their rank
+      if (i > 0 && compare(characters[i - 1], characters[i]) != 0)
+        rank++;
+      if (InRankTable(characters[i]))
+        m_table[characters[i]] = rank;
+      else
+        m_others[characters[i]] = rank;
     }
   }
 
-  if (limitStart > 0 && (size_t)limitStart < items.size())
+  inline uint32_t Get(wchar_t folded) const
   {
-    items.erase(items.begin(), items.begin() + limitStart);
-    limitEnd -= limitStart;
+    if (InRankTable(folded))
+      return m_table[folded];
+    auto it = m_others.find(folded);
+    return it != m_others.end() ? it->second : 0;
   }
-  if (limitEnd > 0 && (size_t)limitEnd < items.size())
-    items.erase(items.begin() + limitEnd, items.end());
+
+private:
+  std::vector<uint32_t> m_table;
+  std::unordered_map<wchar_t, uint32_t> m_others;
+};
+
+size_t Tokenize(const std::wstring &label, const CCollationRanks &ranks, SortToken *tokens)
+{
+  size_t count = 0;
+  const wchar_t *c = label.c_str();
+  while (*c)
+  {
+    SortToken &token = tokens[count++];
+    token.rank = ranks.Get(FoldCase(*c));
+    token.value = 0;
+    token.number = *c >= L'0' && *c <= L'9';
+    if (!token.number)
+    {
+      c++;
+      continue;
+    }
+
+    const wchar_t *start = c;
+    while (*c >= L'0' && *c <= L'9' && c < start + MaxSortDigits)
+      token.value = token.value * 10 + (*c++ - L'0');
+  }
+  return count;
 }
 
-void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, SortItems& items, int limitEnd /* = -1 */, int limitStart /* = 0 */)
+int CompareTokens(const SortToken *left, size_t leftLength, const SortToken *right, size_t rightLength)
+{
+  size_t length = std::min(leftLength, rightLength);
+  for (size_t i = 0; i < length; i++)
+  {
+    if (left[i].number && right[i].number)
+    {
+      if (left[i].value != right[i].value)
+        return left[i].value < right[i].value ? -1 : 1;
+    }
+    else if (left[i].rank != right[i].rank)
+      return left[i].rank < right[i].rank ? -1 : 1;
+  }
+  if (leftLength == rightLength)
+    return 0;
+  return leftLength < rightLength ? -1 : 1;
+}
+
+/*!
+ \brief Runs work(chunk) for every chunk, on the job workers and the calling thread.
+ The calling thread takes chunks no worker has started on, so this never waits
+ for workers that are busy with something else.
+ */
+void RunChunks(size_t chunks, const std::function<void(size_t)> &work)
 {
-  if (sortBy != SortByNone)
+  if (chunks <= 1)
   {
-    // get the matching SortPreparator
-    SortPreparator preparator = getPreparator(sortBy);
-    if (preparator != NULL)
+    if (chunks == 1)
+      work(0);
+    return;
+  }
+
+  struct State
+  {
+    const std::function<void(size_t)> *work;
+    size_t chunks;
+    std::atomic<size_t> next;
+    std::atomic<size_t> done;
+    CEvent finished;
+  };
+  std::shared_ptr<State> state(new State);
+  state->work = &work;
+  state->chunks = chunks;
+  state->next = 0;
+  state->done = 0;
+
+  auto run = [](const std::shared_ptr<State> &state)
+  {
+    size_t chunk;
+    while ((chunk = state->next++) < state->chunks)
     {
-      Fields sortingFields = GetFieldsForSorting(sortBy);
+      (*state->work)(chunk);
+      if (++state->done == state->chunks)
+        state->finished.Set();
+    }
+  };
+
+  for (size_t i = 1; i < chunks; i++)
+    CJobManager::GetInstance().Submit([state, run]() { run(state); }, CJob::PRIORITY_HIGH);
+  run(state);
+  while (state->done < chunks)
+    state->finished.Wait();
+}
 
-      // Prepare the string used for sorting and store it under FieldSort
-      for (SortItems::iterator item = items.begin(); item != items.end(); ++item)
+inline SortItem& GetSortItem(DatabaseResult &item) { return item; }
+inline SortItem& GetSortItem(SortItemPtr &item) { return *item; }
+
+/*!
+ \brief Sorts the items by the label the preparator builds for them.
+
+ Every label is turned into a key once: the character ranks are looked up in
+ the collation order of the characters found in the list, and runs of digits
+ are packed into numbers. The comparisons then only look at the keys. Large
+ lists are prepared and sorted in chunks on the job workers and merged.
+ */
+template<typename T>
+void SortByKeys(std::vector<T> &items, SortUtils::SortPreparator preparator, const Fields &sortingFields,
+                SortAttribute attributes, bool descending, bool parallel)
+{
+  size_t count = items.size();
+  size_t chunks = 1;
+  if (parallel && count >= ParallelSortThreshold)
+    chunks = std::min(std::max(static_cast<size_t>(g_cpuInfo.getCPUCount()), static_cast<size_t>(1)), MaxParallelSortChunks);
+  std::vector<size_t> bounds(chunks + 1);
+  for (size_t chunk = 0; chunk <= chunks; chunk++)
+    bounds[chunk] = count * chunk / chunks;
+
+  bool handleFolder = !(attributes & SortAttributeIgnoreFolders);
+  std::vector<std::wstring> labels(count);
+  std::vector<SortKey> keys(count);
+  std::vector<CCollationRanks> chunkRanks(chunks);
+
+  // prepare the string used for sorting and store it under FieldSort
+  RunChunks(chunks, [&](size_t chunk)
+  {
+    for (size_t i = bounds[chunk]; i < bounds[chunk + 1]; i++)
+    {
+      SortItem &item = GetSortItem(items[i]);
+      // add all fields to the item that are required for sorting if they are currently missing
+      for (Fields::const_iterator field = sortingFields.begin(); field != sortingFields.end(); ++field)
       {
-        // add all fields to the item that are required for sorting if they are currently missing
-        for (Fields::const_iterator field = sortingFields.begin(); field != sortingFields.end(); ++field)
-        {
-          if ((*item)->find(*field) == (*item)->end())
-            (*item)->insert(std::pair<Field, CVariant>(*field, CVariant::ConstNullVariant));
-        }
-
-        std::wstring sortLabel;
-        g_charsetConverter.utf8ToW(preparator(attributes, **item), sortLabel, false);
-        (*item)->insert(std::pair<Field, CVariant>(FieldSort, CVariant(sortLabel)));
+        if (item.find(*field) == item.end())
+          item.insert(std::pair<Field, CVariant>(*field, CVariant::ConstNullVariant));
       }
 
-      // Do the sorting
-      std::stable_sort(items.begin(), items.end(), getSorterIndirect(sortOrder, attributes));
+      g_charsetConverter.utf8ToW(preparator(attributes, item), labels[i], false);
+      item.insert(std::pair<Field, CVariant>(FieldSort, CVariant(labels[i])));
+      chunkRanks[chunk].Add(labels[i]);
+
+      SortItem::const_iterator special = item.find(FieldSortSpecial);
+      SortItem::const_iterator folder = item.find(FieldFolder);
+      if (special != item.end() && special->second.asInteger() == SortSpecialOnTop)
+        keys[i].group = SortKey::GroupTop;
+      else if (special != item.end() && special->second.asInteger() == SortSpecialOnBottom)
+        keys[i].group = SortKey::GroupBottom;
+      else if (handleFolder && folder != item.end() && folder->second.asBoolean())
+        keys[i].group = SortKey::GroupFolder;
+      else
+        keys[i].group = SortKey::GroupFile;
     }
+  });
+
+  CCollationRanks &ranks = chunkRanks[0];
+  for (size_t chunk = 1; chunk < chunks; chunk++)
+    ranks.Merge(chunkRanks[chunk]);
+  ranks.Rank();
+
+  // a label never has more tokens than characters
+  size_t tokenCount = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    keys[i].start = tokenCount;
+    tokenCount += labels[i].size();
+  }
+  std::vector<SortToken> tokens(tokenCount);
+
+  auto less = [&keys, &tokens, descending](uint32_t left, uint32_t right)
+  {
+    const SortKey &leftKey = keys[left];
+    const SortKey &rightKey = keys[right];
+    if (leftKey.group != rightKey.group)
+      return leftKey.group < rightKey.group;
+    // items sorted on top or bottom keep their order
+    if (leftKey.group == SortKey::GroupTop || leftKey.group == SortKey::GroupBottom)
+      return false;
+    int result = CompareTokens(tokens.data() + leftKey.start, leftKey.length, tokens.data() + rightKey.start, rightKey.length);
+    return descending ? result > 0 : result < 0;
+  };
+
+  std::vector<uint32_t> order(count);
+  RunChunks(chunks, [&](size_t chunk)
+  {
+    for (size_t i = bounds[chunk]; i < bounds[chunk + 1]; i++)
+    {
+      keys[i].length = Tokenize(labels[i], ranks, tokens.data() + keys[i].start);
+      order[i] = static_cast<uint32_t>(i);
+    }
+    std::stable_sort(order.begin() + bounds[chunk], order.begin() + bounds[chunk + 1], less);
+  });
+
+  // merge neighbouring chunks until one is left, the left chunk wins ties to stay stable
+  for (size_t width = 1; width < chunks; width *= 2)
+  {
+    size_t merges = (chunks + 2 * width - 1) / (2 * width);
+    RunChunks(merges, [&](size_t merge)
+    {
+      size_t first = merge * 2 * width;
+      size_t middle = std::min(first + width, chunks);
+      size_t last = std::min(first + 2 * width, chunks);
+      if (middle < last)
+        std::inplace_merge(order.begin() + bounds[first], order.begin() + bounds[middle], order.begin() + bounds[last], less);
+    });
+  }
+
+  std::vector<T> sorted;
+  sorted.reserve(count);
+  for (uint32_t i : order)
+    sorted.push_back(std::move(items[i]));
+  items.swap(sorted);
+}
+
+template<typename T>
+void SortAndLimit(std::vector<T> &items, SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, int limitEnd, int limitStart,
+                  SortUtils::SortPreparator preparator, const Fields &sortingFields)
+{
+  if (sortBy != SortByNone && preparator != NULL)
+  {
+    // the random preparator isn't safe to call from several threads at once
+    SortByKeys(items, preparator, sortingFields, attributes, sortOrder == SortOrderDescending, sortBy != SortByRandom);
   }
 
   if (limitStart > 0 && (size_t)limitStart < items.size())
@@ -767,6 +1032,18 @@ void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attribute
     items.erase(items.begin() + limitEnd, items.end());
 }
 
+}
+
+void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, DatabaseResults& items, int limitEnd /* = -1 */, int limitStart /* = 0 */)
+{
+  SortAndLimit(items, sortBy, sortOrder, attributes, limitEnd, limitStart, getPreparator(sortBy), GetFieldsForSorting(sortBy));
+}
+
+void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, SortItems& items, int limitEnd /* = -1 */, int limitStart /* = 0 */)
+{
+  SortAndLimit(items, sortBy, sortOrder, attributes, limitEnd, limitStart, getPreparator(sortBy), GetFieldsForSorting(sortBy));
+}
+
 void SortUtils::Sort(const SortDescription &sortDescription, DatabaseResults& items)
 {
   Sort(sortDescription.sortBy, sortDescription.sortOrder, sortDescription.sortAttributes, items, sortDescription.limitEnd, sortDescription.limitStart);
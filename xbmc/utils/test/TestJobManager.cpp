@@ -22,9 +22,14 @@
 #include "utils/JobManager.h"
 #include "settings/Settings.h"
 #include "utils/SystemInfo.h"
+#include "threads/SystemClock.h"
 
 #include "gtest/gtest.h"
 
+#include <atomic>
+#include <iostream>
+#include <memory>
+
 /* CSysInfoJob::GetInternetState() will test for network connectivity. */
 class TestJobManager : public testing::Test
 {
@@ -53,6 +58,7 @@ protected:
     /* Always cancel jobs test completion */
     CJobManager::GetInstance().CancelJobs();
     CJobManager::GetInstance().Restart();
+    CJobManager::GetInstance().SetMaxWorkers(5);
     CServiceBroker::GetSettings().Unload();
   }
 };
@@ -179,3 +185,39 @@ TEST_F(TestJobManager, IsProcessing)
 
   job->FinishAndStopBlocking();
 }
+
+namespace
+{
+// the counter is shared with the jobs, so jobs still running after a test gave up do not
+// write to its stack
+unsigned int SubmitAndWait(unsigned int numJobs)
+{
+  std::shared_ptr<std::atomic<unsigned int>> done(new std::atomic<unsigned int>(0));
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  for (unsigned int i = 0; i < numJobs; i++)
+    CJobManager::GetInstance().Submit([done]() { (*done)++; }, CJob::PRIORITY_HIGH);
+
+  // give the workers up to 10 seconds to get through the lot
+  for (int i = 0; i < 1000 && *done < numJobs; i++)
+    XbmcThreads::ThreadSleep(10);
+  unsigned int elapsed = XbmcThreads::SystemClockMillis() - start;
+
+  EXPECT_EQ(numJobs, *done);
+  return elapsed ? numJobs * 1000 / elapsed : numJobs * 1000;
+}
+}
+
+TEST_F(TestJobManager, SubmitManyJobs)
+{
+  std::cout << "jobs/sec: " << SubmitAndWait(10000) << std::endl;
+}
+
+TEST_F(TestJobManager, Throughput)
+{
+  for (unsigned int workers = 1; workers <= 64; workers *= 2)
+  {
+    CJobManager::GetInstance().SetMaxWorkers(workers);
+    std::cout << "workers: " << workers << ", jobs/sec: " << SubmitAndWait(100000) << std::endl;
+  }
+}
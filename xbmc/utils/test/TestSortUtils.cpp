@@ -19,10 +19,44 @@
  */
 
 #include "utils/SortUtils.h"
+#include "utils/StringUtils.h"
 #include "utils/Variant.h"
 
+#include <chrono>
+#include <iostream>
+
 #include "gtest/gtest.h"
 
+static SortItems MakeLabelItems(size_t count)
+{
+  // labels with numbers, mixed case, duplicates and folders
+  const char *words[] = { "Track", "track", "Album", "B-Side", "zebra", "01", "2", "(live)", "Ärger" };
+  SortItems items;
+  items.reserve(count);
+  unsigned int seed = 1;
+  for (size_t i = 0; i < count; i++)
+  {
+    seed = seed * 1103515245 + 12345;
+    SortItemPtr item(new SortItem());
+    (*item)[FieldLabel] = CVariant(StringUtils::Format("%s %u %s", words[(seed >> 8) % 9], (seed >> 12) % 200, words[(seed >> 20) % 9]));
+    (*item)[FieldFolder] = CVariant((seed >> 4) % 10 == 0);
+    (*item)[FieldId] = CVariant(static_cast<int64_t>(i));
+    items.push_back(item);
+  }
+  return items;
+}
+
+static void BenchmarkSort(size_t count)
+{
+  SortItems items = MakeLabelItems(count);
+  auto start = std::chrono::steady_clock::now();
+  SortUtils::Sort(SortByLabel, SortOrderAscending, SortAttributeNone, items);
+  std::cout << "sorting " << count << " items by label: "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count()
+            << " ms" << std::endl;
+  EXPECT_EQ(count, items.size());
+}
+
 TEST(TestSortUtils, Sort_SortBy)
 {
   SortItems items;
@@ -131,3 +165,54 @@ TEST(TestSortUtils, GetFieldsForSorting)
   EXPECT_EQ(FieldTrackNumber, *it);
   EXPECT_EQ((unsigned int)4, fields.size());
 }
+
+TEST(TestSortUtils, Sort_Order)
+{
+  // large enough to be sorted in chunks
+  for (SortOrder order : { SortOrderAscending, SortOrderDescending })
+  {
+    SortItems items = MakeLabelItems(20000);
+    SortUtils::Sort(SortByLabel, order, SortAttributeNone, items);
+    for (size_t i = 1; i < items.size(); i++)
+    {
+      const SortItem &left = *items[i - 1];
+      const SortItem &right = *items[i];
+      // folders first, then by label, equal labels keep their order
+      bool leftFolder = left.at(FieldFolder).asBoolean();
+      bool rightFolder = right.at(FieldFolder).asBoolean();
+      ASSERT_TRUE(leftFolder || !rightFolder);
+      if (leftFolder != rightFolder)
+        continue;
+      int64_t result = StringUtils::AlphaNumericCompare(left.at(FieldSort).asWideString().c_str(), right.at(FieldSort).asWideString().c_str());
+      if (order == SortOrderDescending)
+        result = -result;
+      ASSERT_LE(result, 0) << left.at(FieldLabel).asString() << " / " << right.at(FieldLabel).asString();
+      if (result == 0)
+        ASSERT_LT(left.at(FieldId).asInteger(), right.at(FieldId).asInteger());
+    }
+  }
+}
+
+TEST(TestSortUtils, Sort_Special)
+{
+  SortItems items = MakeLabelItems(100);
+  (*items[10])[FieldSortSpecial] = CVariant(static_cast<int64_t>(SortSpecialOnBottom));
+  (*items[20])[FieldSortSpecial] = CVariant(static_cast<int64_t>(SortSpecialOnTop));
+  (*items[30])[FieldSortSpecial] = CVariant(static_cast<int64_t>(SortSpecialOnTop));
+  SortUtils::Sort(SortByLabel, SortOrderDescending, SortAttributeIgnoreFolders, items);
+  EXPECT_EQ(20, (*items[0])[FieldId].asInteger());
+  EXPECT_EQ(30, (*items[1])[FieldId].asInteger());
+  EXPECT_EQ(10, (*items[99])[FieldId].asInteger());
+}
+
+TEST(TestSortUtils, Performance)
+{
+  BenchmarkSort(10000);
+  BenchmarkSort(100000);
+}
+
+// needs about a GB of memory, run with --gtest_also_run_disabled_tests
+TEST(TestSortUtils, DISABLED_PerformanceHuge)
+{
+  BenchmarkSort(1000000);
+}
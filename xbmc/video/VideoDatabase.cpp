@@ -59,6 +59,7 @@
 #include "settings/Settings.h"
 #include "storage/MediaManager.h"
 #include "TextureCache.h"
+#include "threads/SingleLock.h"
 #include "threads/SystemClock.h"
 #include "URL.h"
 #include "Util.h"
@@ -71,6 +72,8 @@
 #include "utils/Variant.h"
 #include "utils/XMLUtils.h"
 #include "video/VideoDbUrl.h"
+#include "video/VideoLibraryIndex.h"
+#include "video/VideoNavIndex.h"
 #include "video/windows/GUIWindowVideoBase.h"
 #include "VideoInfoScanner.h"
 #include "XBDateTime.h"
@@ -138,6 +141,9 @@ void CVideoDatabase::CreateTables()
   CLog::Log(LOGINFO, "create path table");
   m_pDS->exec("CREATE TABLE path ( idPath integer primary key, strPath text, strContent text, strScraper text, strHash text, scanRecursive integer, useFolderNames bool, strSettings text, noUpdate bool, exclude bool, dateAdded text, idParentPath integer)");
 
+  CLog::Log(LOGINFO, "create pathfingerprint table");
+  m_pDS->exec("CREATE TABLE pathfingerprint (strPath text, iMTime bigint, iSize bigint)");
+
   CLog::Log(LOGINFO, "create files table");
   m_pDS->exec("CREATE TABLE files ( idFile integer primary key, idPath integer, strFilename text, playCount integer, lastPlayed text, dateAdded text)");
 
@@ -242,6 +248,7 @@ void CVideoDatabase::CreateAnalytics()
   m_pDS->exec("CREATE UNIQUE INDEX ix_settings ON settings ( idFile )\n");
   m_pDS->exec("CREATE UNIQUE INDEX ix_stacktimes ON stacktimes ( idFile )\n");
   m_pDS->exec("CREATE INDEX ix_path ON path ( strPath(255) )");
+  m_pDS->exec("CREATE INDEX ix_pathfingerprint ON pathfingerprint ( strPath(255) )");
   m_pDS->exec("CREATE INDEX ix_path2 ON path ( idParentPath )");
   m_pDS->exec("CREATE INDEX ix_files ON files ( idPath, strFilename(255) )");
 
@@ -781,6 +788,58 @@ bool CVideoDatabase::GetPathHash(const std::string &path, std::string &hash)
   return false;
 }
 
+bool CVideoDatabase::GetPathFingerprints(DirectoryFingerprints &fingerprints)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    fingerprints.clear();
+    if (!m_pDS->query("SELECT strPath, iMTime, iSize FROM pathfingerprint"))
+      return false;
+    while (!m_pDS->eof())
+    {
+      DirectoryFingerprint &fingerprint = fingerprints[m_pDS->fv(0).get_asString()];
+      fingerprint.mtime = m_pDS->fv(1).get_asInt64();
+      fingerprint.size = m_pDS->fv(2).get_asInt64();
+      m_pDS->next();
+    }
+    m_pDS->close();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+  }
+  return false;
+}
+
+bool CVideoDatabase::SetPathFingerprint(const std::string &path, const DirectoryFingerprint &fingerprint)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    m_pDS->exec("DELETE FROM pathfingerprint WHERE strPath = ?", { path });
+    m_pDS->exec("INSERT INTO pathfingerprint (strPath, iMTime, iSize) VALUES (?, ?, ?)",
+                { path, fingerprint.mtime, fingerprint.size });
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s (%s) failed", __FUNCTION__, path.c_str());
+  }
+  return false;
+}
+
+bool CVideoDatabase::RemovePathFingerprints(const std::string &path)
+{
+  return ExecuteQuery(PrepareSQL("DELETE FROM pathfingerprint WHERE SUBSTR(strPath,1,%i)='%s'",
+                                 StringUtils::utf8_strlen(path.c_str()), path.c_str()));
+}
+
 bool CVideoDatabase::GetSourcePath(const std::string &path, std::string &sourcePath)
 {
   SScanSettings dummy;
@@ -1728,6 +1787,8 @@ void CVideoDatabase::AddTagToItem(int media_id, int tag_id, const std::string &t
     return;
 
   AddToLinkTable(media_id, type, "tag", tag_id);
+  if (CVideoLibraryIndex::IsEnabled())
+    CVideoLibraryIndex::GetInstance().SetUpdated(type, media_id);
 }
 
 void CVideoDatabase::RemoveTagFromItem(int media_id, int tag_id, const std::string &type)
@@ -1736,6 +1797,8 @@ void CVideoDatabase::RemoveTagFromItem(int media_id, int tag_id, const std::stri
     return;
 
   RemoveFromLinkTable(media_id, type, "tag", tag_id);
+  if (CVideoLibraryIndex::IsEnabled())
+    CVideoLibraryIndex::GetInstance().SetUpdated(type, media_id);
 }
 
 void CVideoDatabase::RemoveTagsFromItem(int media_id, const std::string &type)
@@ -1744,6 +1807,8 @@ void CVideoDatabase::RemoveTagsFromItem(int media_id, const std::string &type)
     return;
 
   m_pDS2->exec(PrepareSQL("DELETE FROM tag_link WHERE media_id=%d AND media_type='%s'", media_id, type.c_str()));
+  if (CVideoLibraryIndex::IsEnabled())
+    CVideoLibraryIndex::GetInstance().SetUpdated(type, media_id);
 }
 
 //****Actors****
@@ -2201,6 +2266,52 @@ std::string CVideoDatabase::GetValueString(const CVideoInfoTag &details, int min
   return StringUtils::Join(conditions, ",");
 }
 
+std::string CVideoDatabase::GetValuePlaceholders(const CVideoInfoTag &details, int min, int max, const SDbTableOffsets *offsets, dbiplus::ParamValues &params) const
+{
+  // values are stored as text, formatted the same as in GetValueString
+  std::vector<std::string> conditions;
+  for (int i = min + 1; i < max; ++i)
+  {
+    switch (offsets[i].type)
+    {
+    case VIDEODB_TYPE_STRING:
+      params.emplace_back(*((std::string*)(((char*)&details)+offsets[i].offset)));
+      break;
+    case VIDEODB_TYPE_INT:
+      params.emplace_back(StringUtils::Format("%i", *(int*)(((char*)&details)+offsets[i].offset)));
+      break;
+    case VIDEODB_TYPE_COUNT:
+      {
+        int value = *(int*)(((char*)&details)+offsets[i].offset);
+        params.emplace_back(value);
+        if (!value)
+          params.back().set_isNull();
+      }
+      break;
+    case VIDEODB_TYPE_BOOL:
+      params.emplace_back(*(bool*)(((char*)&details)+offsets[i].offset)?"true":"false");
+      break;
+    case VIDEODB_TYPE_FLOAT:
+      params.emplace_back(StringUtils::Format("%f", *(float*)(((char*)&details)+offsets[i].offset)));
+      break;
+    case VIDEODB_TYPE_STRINGARRAY:
+      params.emplace_back(StringUtils::Join(*((std::vector<std::string>*)(((char*)&details)+offsets[i].offset)),
+                                            g_advancedSettings.m_videoItemSeparator));
+      break;
+    case VIDEODB_TYPE_DATE:
+      params.emplace_back(((CDateTime*)(((char*)&details)+offsets[i].offset))->GetAsDBDate());
+      break;
+    case VIDEODB_TYPE_DATETIME:
+      params.emplace_back(((CDateTime*)(((char*)&details)+offsets[i].offset))->GetAsDBDateTime());
+      break;
+    case VIDEODB_TYPE_UNUSED: // Skip the unused field to avoid populating unused data
+      continue;
+    }
+    conditions.emplace_back(StringUtils::Format("c%02d=?", i));
+  }
+  return StringUtils::Join(conditions, ",");
+}
+
 //********************************************************************************************************************************
 int CVideoDatabase::SetDetailsForItem(CVideoInfoTag& details, const std::map<std::string, std::string> &artwork)
 {
@@ -2300,15 +2411,14 @@ int CVideoDatabase::SetDetailsForMovie(const std::string& strFilenameAndPath, CV
 
     if (!details.HasUniqueID() && details.HasYear())
     { // query DB for any movies matching online id and year
-      std::string strSQL = PrepareSQL("SELECT files.playCount, files.lastPlayed "
-                                      "FROM movie "
-                                      "  INNER JOIN files "
-                                      "    ON files.idFile=movie.idFile "
-                                      "  JOIN uniqueid "
-                                      "    ON movie.idMovie=uniqueid.media_id AND uniqueid.media_type='movie' AND uniqueid.value='%s'"
-                                      "WHERE movie.premiered LIKE '%i%%' AND movie.idMovie!=%i AND files.playCount > 0", 
-                                      details.GetUniqueID().c_str(), details.GetYear(), idMovie);
-      m_pDS->query(strSQL);
+      std::string strSQL = "SELECT files.playCount, files.lastPlayed "
+                           "FROM movie "
+                           "  INNER JOIN files "
+                           "    ON files.idFile=movie.idFile "
+                           "  JOIN uniqueid "
+                           "    ON movie.idMovie=uniqueid.media_id AND uniqueid.media_type='movie' AND uniqueid.value=? "
+                           "WHERE movie.premiered LIKE ? AND movie.idMovie!=? AND files.playCount > 0";
+      m_pDS->query(strSQL, { details.GetUniqueID(), StringUtils::Format("%i%%", details.GetYear()), idMovie });
 
       if (!m_pDS->eof())
       {
@@ -2320,29 +2430,28 @@ int CVideoDatabase::SetDetailsForMovie(const std::string& strFilenameAndPath, CV
         int idFile = GetFileId(strFilenameAndPath);
 
         // update with playCount and lastPlayed
-        strSQL = PrepareSQL("update files set playCount=%i,lastPlayed='%s' where idFile=%i", playCount, lastPlayed.GetAsDBDateTime().c_str(), idFile);
-        m_pDS->exec(strSQL);
+        m_pDS->exec("update files set playCount=?,lastPlayed=? where idFile=?", { playCount, lastPlayed.GetAsDBDateTime(), idFile });
       }
 
       m_pDS->close();
     }
     // update our movie table (we know it was added already above)
-    // and insert the new row
-    std::string sql = "UPDATE movie SET " + GetValueString(details, VIDEODB_ID_MIN, VIDEODB_ID_MAX, DbMovieOffsets);
-    if (idSet > 0)
-      sql += PrepareSQL(", idSet = %i", idSet);
-    else
-      sql += ", idSet = NULL";
-    if (details.m_iUserRating > 0 && details.m_iUserRating < 11)
-      sql += PrepareSQL(", userrating = %i", details.m_iUserRating);
-    else
-      sql += ", userrating = NULL";
+    // and insert the new row, the statement is the same for every movie
+    dbiplus::ParamValues params;
+    std::string sql = "UPDATE movie SET " + GetValuePlaceholders(details, VIDEODB_ID_MIN, VIDEODB_ID_MAX, DbMovieOffsets, params);
+    sql += ", idSet = ?, userrating = ?, premiered = ? where idMovie = ?";
+    params.emplace_back(idSet);
+    if (idSet <= 0)
+      params.back().set_isNull();
+    params.emplace_back(details.m_iUserRating);
+    if (details.m_iUserRating <= 0 || details.m_iUserRating >= 11)
+      params.back().set_isNull();
     if (details.HasPremiered())
-      sql += PrepareSQL(", premiered = '%s'", details.GetPremiered().GetAsDBDate().c_str());
+      params.emplace_back(details.GetPremiered().GetAsDBDate());
     else
-      sql += PrepareSQL(", premiered = '%i'", details.GetYear());
-    sql += PrepareSQL(" where idMovie=%i", idMovie);
-    m_pDS->exec(sql);
+      params.emplace_back(StringUtils::Format("%i", details.GetYear()));
+    params.emplace_back(idMovie);
+    m_pDS->exec(sql, params);
     CommitTransaction();
 
     return idMovie;
@@ -3550,6 +3659,8 @@ void CVideoDatabase::DeleteTag(int idTag, VIDEODB_CONTENT_TYPE mediaType)
 
     std::string strSQL = PrepareSQL("DELETE FROM tag_link WHERE tag_id = %i AND media_type = '%s'", idTag, type.c_str());
     m_pDS->exec(strSQL);
+    if (CVideoLibraryIndex::IsEnabled())
+      CVideoLibraryIndex::GetInstance().Invalidate();
   }
   catch (...)
   {
@@ -5155,11 +5266,14 @@ void CVideoDatabase::UpdateTables(int iVersion)
       pDS->close();
     }
   }
+
+  if (iVersion < 108)
+    m_pDS->exec("CREATE TABLE pathfingerprint (strPath text, iMTime bigint, iSize bigint)");
 }
 
 int CVideoDatabase::GetSchemaVersion() const
 {
-  return 107;
+  return 108;
 }
 
 bool CVideoDatabase::LookupByFolders(const std::string &path, bool shows)
@@ -5489,6 +5603,227 @@ bool CVideoDatabase::GetStudiosNav(const std::string& strBaseDir, CFileItemList&
   return GetNavCommon(strBaseDir, items, "studio", idContent, filter, countOnly);
 }
 
+bool CVideoDatabase::GetNavFromIndex(const std::string& strBaseDir, CFileItemList& items, const char *type, int idContent, const Filter &filter, bool countOnly)
+{
+  // locked paths and smart playlist rules need the full queries
+  if (!CVideoLibraryIndex::IsEnabled() ||
+      (CProfilesManager::GetInstance().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser) ||
+      !filter.join.empty() || !filter.where.empty() || !filter.group.empty() || !filter.limit.empty())
+    return false;
+
+  bool years = StringUtils::EqualsNoCase(type, "year");
+  bool people = false;
+  CVideoNavIndex::Column column = CVideoNavIndex::ColumnGenre;
+  if (!years)
+  {
+    if (!CVideoNavIndex::GetColumn(type, column))
+      return false;
+    people = column == CVideoNavIndex::ColumnActor || column == CVideoNavIndex::ColumnDirector || column == CVideoNavIndex::ColumnWriter;
+    // people are counted per link, not per person
+    if (people && countOnly)
+      return false;
+  }
+
+  CVideoDbUrl videoUrl;
+  if (!videoUrl.FromString(strBaseDir))
+    return false;
+
+  CVideoNavIndex::Filter indexFilter;
+  for (const auto &option : videoUrl.GetOptions())
+  {
+    if (option.first == "year")
+    {
+      indexFilter.year = static_cast<int>(option.second.asInteger());
+      continue;
+    }
+
+    std::string name = option.first == "artistid" ? "actorid" : option.first;
+    CVideoNavIndex::Column linkColumn;
+    if (!StringUtils::EndsWith(name, "id") || !CVideoNavIndex::GetColumn(name.substr(0, name.size() - 2), linkColumn))
+      return false;
+    indexFilter.links.push_back(std::make_pair(linkColumn, static_cast<int>(option.second.asInteger())));
+  }
+
+  CSingleLock lock(CVideoLibraryIndex::GetInstance().GetSection());
+  const CVideoNavIndex *index = CVideoLibraryIndex::GetInstance().GetIndex(idContent, *this);
+  if (index == NULL)
+    return false;
+
+  std::vector<CVideoNavIndex::Value> values;
+  if (years)
+    index->GetYears(indexFilter, values);
+  else
+    index->GetValues(column, indexFilter, values);
+  lock.Leave();
+
+  if (countOnly)
+  {
+    CFileItemPtr pItem(new CFileItem());
+    pItem->SetProperty("total", static_cast<int>(values.size()));
+    items.Add(pItem);
+    return true;
+  }
+
+  bool playCount = idContent == VIDEODB_CONTENT_MOVIES || idContent == VIDEODB_CONTENT_MUSICVIDEOS;
+  items.Reserve(static_cast<int>(values.size()));
+  for (const auto &value : values)
+  {
+    if (years && value.id == 0)
+      continue;
+
+    CFileItemPtr pItem(new CFileItem(years ? StringUtils::Format("%i", value.id) : value.name));
+
+    CVideoDbUrl itemUrl = videoUrl;
+    std::string path = StringUtils::Format("%i/", value.id);
+    itemUrl.AppendPath(path);
+    pItem->SetPath(itemUrl.ToString());
+
+    pItem->m_bIsFolder = true;
+    // the playcount is only set if every video has been watched
+    if (playCount)
+      pItem->GetVideoInfoTag()->m_playCount = value.watched == value.total ? 1 : 0;
+    if (!years)
+    {
+      pItem->GetVideoInfoTag()->m_iDbId = value.id;
+      pItem->GetVideoInfoTag()->m_type = type;
+    }
+    if (people)
+    {
+      pItem->GetVideoInfoTag()->m_strPictureURL.ParseString(value.art);
+      pItem->GetVideoInfoTag()->m_relevance = value.total;
+      if (idContent == VIDEODB_CONTENT_MUSICVIDEOS)
+        pItem->GetVideoInfoTag()->m_artist.emplace_back(pItem->GetLabel());
+    }
+    else if (!years)
+      pItem->SetLabelPreformated(true);
+    items.Add(pItem);
+  }
+  return true;
+}
+
+bool CVideoDatabase::LoadNavIndex(int idContent, CVideoNavIndex &index, int idItem /* = -1 */)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    std::string view, view_id, media_type, premiered;
+    if (idContent == VIDEODB_CONTENT_MOVIES)
+    {
+      view       = MediaTypeMovie;
+      view_id    = "idMovie";
+      media_type = MediaTypeMovie;
+      premiered  = "premiered";
+    }
+    else if (idContent == VIDEODB_CONTENT_TVSHOWS)
+    {
+      view       = MediaTypeTvShow;
+      view_id    = "idShow";
+      media_type = MediaTypeTvShow;
+      premiered  = PrepareSQL("c%02d", VIDEODB_ID_TV_PREMIERED);
+    }
+    else if (idContent == VIDEODB_CONTENT_MUSICVIDEOS)
+    {
+      view       = MediaTypeMusicVideo;
+      view_id    = "idMVideo";
+      media_type = MediaTypeMusicVideo;
+      premiered  = "premiered";
+    }
+    else
+      return false;
+
+    // tvshows have no playcount of their own
+    std::string strSQL;
+    if (idContent == VIDEODB_CONTENT_TVSHOWS)
+      strSQL = PrepareSQL("SELECT %s_view.%s, %s_view.%s FROM %s_view",
+                          view.c_str(), view_id.c_str(), view.c_str(), premiered.c_str(), view.c_str());
+    else
+      strSQL = PrepareSQL("SELECT %s_view.%s, %s_view.%s, files.playCount FROM %s_view JOIN files ON files.idFile = %s_view.idFile",
+                          view.c_str(), view_id.c_str(), view.c_str(), premiered.c_str(), view.c_str(), view.c_str());
+    if (idItem > 0)
+      strSQL += PrepareSQL(" WHERE %s_view.%s = %i", view.c_str(), view_id.c_str(), idItem);
+
+    if (!m_pDS->query(strSQL))
+      return false;
+    while (!m_pDS->eof())
+    {
+      int year = 0;
+      std::string dateString = m_pDS->fv(1).get_asString();
+      if (dateString.size() == 4)
+        year = m_pDS->fv(1).get_asInt();
+      else if (!dateString.empty())
+      {
+        CDateTime time;
+        time.SetFromDateString(dateString);
+        year = time.GetYear();
+      }
+      bool watched = idContent != VIDEODB_CONTENT_TVSHOWS && !m_pDS->fv(2).get_isNull() && m_pDS->fv(2).get_asInt() > 0;
+      index.AddItem(m_pDS->fv(0).get_asInt(), year, watched);
+      m_pDS->next();
+    }
+    m_pDS->close();
+
+    // an item removed in the meantime has no links to load
+    if (idItem > 0 && !index.HasItem(idItem))
+      return true;
+
+    for (int i = 0; i < CVideoNavIndex::ColumnCount; i++)
+    {
+      CVideoNavIndex::Column column = static_cast<CVideoNavIndex::Column>(i);
+      bool people = column == CVideoNavIndex::ColumnActor || column == CVideoNavIndex::ColumnDirector || column == CVideoNavIndex::ColumnWriter;
+      const char *type = NULL;
+      switch (column)
+      {
+      case CVideoNavIndex::ColumnGenre:    type = "genre";    break;
+      case CVideoNavIndex::ColumnCountry:  type = "country";  break;
+      case CVideoNavIndex::ColumnStudio:   type = "studio";   break;
+      case CVideoNavIndex::ColumnTag:      type = "tag";      break;
+      case CVideoNavIndex::ColumnActor:    type = "actor";    break;
+      case CVideoNavIndex::ColumnDirector: type = "director"; break;
+      case CVideoNavIndex::ColumnWriter:   type = "writer";   break;
+      default: continue;
+      }
+
+      if (people)
+        strSQL = PrepareSQL("SELECT %s_link.media_id, actor.actor_id, actor.name, actor.art_urls FROM %s_link "
+                            "JOIN actor ON actor.actor_id = %s_link.actor_id WHERE %s_link.media_type = '%s'",
+                            type, type, type, type, media_type.c_str());
+      else
+        strSQL = PrepareSQL("SELECT %s_link.media_id, %s.%s_id, %s.name FROM %s_link "
+                            "JOIN %s ON %s.%s_id = %s_link.%s_id WHERE %s_link.media_type = '%s'",
+                            type, type, type, type, type, type, type, type, type, type, type, media_type.c_str());
+      if (idItem > 0)
+        strSQL += PrepareSQL(" AND %s_link.media_id = %i", type, idItem);
+
+      if (!m_pDS->query(strSQL))
+        return false;
+      while (!m_pDS->eof())
+      {
+        index.AddLink(m_pDS->fv(0).get_asInt(), column, m_pDS->fv(1).get_asInt(), m_pDS->fv(2).get_asString(),
+                      people ? m_pDS->fv(3).get_asString() : "");
+        m_pDS->next();
+      }
+      m_pDS->close();
+    }
+    return true;
+  }
+  catch (...)
+  {
+    m_pDS->close();
+    CLog::Log(LOGERROR, "%s (%i, %i) failed", __FUNCTION__, idContent, idItem);
+  }
+  return false;
+}
+
+bool CVideoDatabase::GetNavIndexSource(std::string &source) const
+{
+  source.clear();
+  if (m_pDB.get())
+    source = StringUtils::Format("%s:%s/%s", m_pDB->getHostName(), m_pDB->getPort(), m_pDB->getDatabase());
+  return !m_sqlite;
+}
+
 bool CVideoDatabase::GetNavCommon(const std::string& strBaseDir, CFileItemList& items, const char *type, int idContent /* = -1 */, const Filter &filter /* = Filter() */, bool countOnly /* = false */)
 {
   try
@@ -5496,6 +5831,9 @@ bool CVideoDatabase::GetNavCommon(const std::string& strBaseDir, CFileItemList&
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS.get()) return false;
 
+    if (GetNavFromIndex(strBaseDir, items, type, idContent, filter, countOnly))
+      return true;
+
     std::string strSQL;
     Filter extFilter = filter;
     if (CProfilesManager::GetInstance().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
@@ -5892,6 +6230,9 @@ bool CVideoDatabase::GetPeopleNav(const std::string& strBaseDir, CFileItemList&
 
   try
   {
+    if (GetNavFromIndex(strBaseDir, items, type, idContent, filter, countOnly))
+      return true;
+
     //! @todo This routine (and probably others at this same level) use playcount as a reference to filter on at a later
     //!       point.  This means that we *MUST* filter these levels as you'll get double ups.  Ideally we'd allow playcount
     //!       to filter through as we normally do for tvshows to save this happening.
@@ -6134,6 +6475,9 @@ bool CVideoDatabase::GetYearsNav(const std::string& strBaseDir, CFileItemList& i
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS.get()) return false;
 
+    if (GetNavFromIndex(strBaseDir, items, "year", idContent, filter, false))
+      return true;
+
     std::string strSQL;
     Filter extFilter = filter;
     if (CProfilesManager::GetInstance().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
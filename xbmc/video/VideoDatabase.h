@@ -27,6 +27,7 @@
 #include "addons/Scraper.h"
 #include "Bookmark.h"
 #include "dbwrappers/Database.h"
+#include "InfoScanner.h"
 #include "utils/SortUtils.h"
 #include "video/VideoDbUrl.h"
 #include "VideoInfoTag.h"
@@ -34,6 +35,7 @@
 class CFileItem;
 class CFileItemList;
 class CVideoSettings;
+class CVideoNavIndex;
 class CGUIDialogProgress;
 class CGUIDialogProgressBarHandle;
 
@@ -652,6 +654,16 @@ public:
   // scanning hashes and paths scanned
   bool SetPathHash(const std::string &path, const std::string &hash);
   bool GetPathHash(const std::string &path, std::string &hash);
+
+  /*! \brief Get the fingerprints of the folders visited by incremental scans
+   \sa CInfoScanner::IsUnchanged
+   */
+  bool GetPathFingerprints(DirectoryFingerprints &fingerprints);
+  bool SetPathFingerprint(const std::string &path, const DirectoryFingerprint &fingerprint);
+
+  /*! \brief Remove the fingerprints of a folder and all folders below it
+   */
+  bool RemovePathFingerprints(const std::string &path);
   bool GetPaths(std::set<std::string> &paths);
   bool GetPathsForTvShow(int idShow, std::set<int>& paths);
 
@@ -847,6 +859,22 @@ public:
   void SetMovieSet(int idMovie, int idSet);
   bool SetVideoUserRating(int dbId, int rating, const MediaType& mediaType);
 
+  /*! \brief Load movies, tvshows or musicvideos into a navigation index.
+   \param idContent the content to load.
+   \param index the index to add the items and their links to.
+   \param idItem the item to load, -1 to load all items.
+   \return true if the items were loaded, false otherwise.
+   \sa CVideoLibraryIndex
+   */
+  bool LoadNavIndex(int idContent, CVideoNavIndex &index, int idItem = -1);
+
+  /*! \brief Identify the database that navigation indexes are loaded from.
+   \param source [out] host, port and name of the database, it changes when an other database is opened.
+   \return true if other clients may change the database as well, false for a local sqlite database.
+   \sa CVideoLibraryIndex
+   */
+  bool GetNavIndexSource(std::string &source) const;
+
 protected:
   int GetMovieId(const std::string& strFilenameAndPath);
   int GetMusicVideoId(const std::string& strFilenameAndPath);
@@ -913,6 +941,7 @@ protected:
   CVideoInfoTag GetDetailsForMusicVideo(const dbiplus::sql_record* const record, int getDetails = VideoDbDetailsNone);
   bool GetPeopleNav(const std::string& strBaseDir, CFileItemList& items, const char *type, int idContent = -1, const Filter &filter = Filter(), bool countOnly = false);
   bool GetNavCommon(const std::string& strBaseDir, CFileItemList& items, const char *type, int idContent=-1, const Filter &filter = Filter(), bool countOnly = false);
+  bool GetNavFromIndex(const std::string& strBaseDir, CFileItemList& items, const char *type, int idContent, const Filter &filter, bool countOnly);
   void GetCast(int media_id, const std::string &media_type, std::vector<SActorInfo> &cast);
   void GetTags(int media_id, const std::string &media_type, std::vector<std::string> &tags);
   void GetRatings(int media_id, const std::string &media_type, RatingMap &ratings);
@@ -921,6 +950,10 @@ protected:
   void GetDetailsFromDB(std::unique_ptr<dbiplus::Dataset> &pDS, int min, int max, const SDbTableOffsets *offsets, CVideoInfoTag &details, int idxOffset = 2);
   void GetDetailsFromDB(const dbiplus::sql_record* const record, int min, int max, const SDbTableOffsets *offsets, CVideoInfoTag &details, int idxOffset = 2);
   std::string GetValueString(const CVideoInfoTag &details, int min, int max, const SDbTableOffsets *offsets) const;
+  /*! \brief As GetValueString, with '?' placeholders for the values which are appended to params.
+   The returned string only depends on the columns, so statements using it can be cached.
+   */
+  std::string GetValuePlaceholders(const CVideoInfoTag &details, int min, int max, const SDbTableOffsets *offsets, dbiplus::ParamValues &params) const;
 
 private:
   virtual void CreateTables();
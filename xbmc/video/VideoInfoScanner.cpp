@@ -77,6 +77,7 @@ namespace VIDEO
     m_itemCount = 0;
     m_bClean = false;
     m_scanAll = false;
+    m_incremental = false;
   }
 
   CVideoInfoScanner::~CVideoInfoScanner()
@@ -125,6 +126,12 @@ namespace VIDEO
       m_currentItem = 0;
       m_itemCount = -1;
 
+      m_incremental = g_advancedSettings.m_bVideoLibraryIncrementalScan && !m_scanAll;
+      m_fingerprints.clear();
+      m_pendingFingerprints.clear();
+      if (m_incremental)
+        m_database.GetPathFingerprints(m_fingerprints);
+
       // Database operations should not be canceled
       // using Interupt() while scanning as it could
       // result in unexpected behaviour.
@@ -172,6 +179,8 @@ namespace VIDEO
 
       g_infoManager.ResetLibraryBools();
       m_database.Close();
+      m_fingerprints.clear();
+      m_pendingFingerprints.clear();
 
       tick = XbmcThreads::SystemClockMillis() - tick;
       CLog::Log(LOGNOTICE, "VideoInfoScanner: Finished scan. Scanning for video info took %s", StringUtils::SecondsToTimeString(tick / 1000).c_str());
@@ -277,6 +286,28 @@ namespace VIDEO
     if (content == CONTENT_NONE || ignoreFolder)
       return true;
 
+    DirectoryFingerprint fingerprint;
+    if (m_incremental && (content == CONTENT_MOVIES || content == CONTENT_MUSICVIDEOS) &&
+        IsUnchanged(strDirectory, m_fingerprints, fingerprint))
+    {
+      // only the folders below it that are known from earlier scans have to be checked
+      CLog::Log(LOGDEBUG, "VideoInfoScanner: Skipping dir '%s' as its fingerprint is unchanged", CURL::GetRedacted(strDirectory).c_str());
+      if (m_handle)
+        OnDirectoryScanned(strDirectory);
+
+      if (settings.recurse > 0)
+      {
+        for (const auto &subDir : GetKnownSubDirs(strDirectory, m_fingerprints))
+        {
+          if (m_bStop)
+            break;
+          if (!DoScan(subDir))
+            m_bStop = true;
+        }
+      }
+      return !m_bStop;
+    }
+
     std::string hash, dbHash;
     if (content == CONTENT_MOVIES ||content == CONTENT_MUSICVIDEOS)
     {
@@ -297,6 +328,16 @@ namespace VIDEO
       else
       { // need to fetch the folder
         CDirectory::GetDirectory(strDirectory, items, g_advancedSettings.m_videoExtensions);
+
+        if (m_incremental)
+        {
+          // forget the known folders that are gone
+          for (const auto &subDir : GetKnownSubDirs(strDirectory, m_fingerprints))
+          {
+            if (!items.Contains(subDir))
+              m_database.RemovePathFingerprints(subDir);
+          }
+        }
         items.Stack();
 
         // check whether to re-use previously computed fast hash
@@ -353,6 +394,7 @@ namespace VIDEO
       }
     }
 
+    bool hashStored = bSkip;
     if (!bSkip)
     {
       if (RetrieveVideoInfo(items, settings.parent_name_root, content))
@@ -360,6 +402,7 @@ namespace VIDEO
         if (!m_bStop && (content == CONTENT_MOVIES || content == CONTENT_MUSICVIDEOS))
         {
           m_database.SetPathHash(strDirectory, hash);
+          hashStored = true;
           if (m_bClean)
             m_pathsToClean.insert(m_database.GetPathId(strDirectory));
           CLog::Log(LOGDEBUG, "VideoInfoScanner: Finished adding information from dir %s", CURL::GetRedacted(strDirectory).c_str());
@@ -397,6 +440,12 @@ namespace VIDEO
         }
       }
     }
+
+    // a stored fingerprint skips the listing next time, so subfolders that were
+    // not reached would never be found
+    if (!m_bStop && hashStored && fingerprint.mtime != 0)
+      m_database.SetPathFingerprint(strDirectory, fingerprint);
+
     return !m_bStop;
   }
 
@@ -520,7 +569,7 @@ namespace VIDEO
     {
       INFO_RET ret = RetrieveInfoForEpisodes(pItem, idTvShow, info2, useLocal, pDlgProgress);
       if (ret == INFO_ADDED)
-        m_database.SetPathHash(pItem->GetPath(), pItem->GetProperty("hash").asString());
+        SetTvShowPathHash(pItem);
       return ret;
     }
 
@@ -547,7 +596,7 @@ namespace VIDEO
       {
         INFO_RET ret = RetrieveInfoForEpisodes(pItem, lResult, info2, useLocal, pDlgProgress);
         if (ret == INFO_ADDED)
-          m_database.SetPathHash(pItem->GetPath(), pItem->GetProperty("hash").asString());
+          SetTvShowPathHash(pItem);
         return ret;
       }
       return INFO_ADDED;
@@ -580,7 +629,7 @@ namespace VIDEO
     {
       INFO_RET ret = RetrieveInfoForEpisodes(pItem, lResult, info2, useLocal, pDlgProgress);
       if (ret == INFO_ADDED)
-        m_database.SetPathHash(pItem->GetPath(), pItem->GetProperty("hash").asString());
+        SetTvShowPathHash(pItem);
     }
     return INFO_ADDED;
   }
@@ -764,14 +813,36 @@ namespace VIDEO
         m_pathsToScan.erase(it);
 
       std::string hash, dbHash;
-      if (g_advancedSettings.m_bVideoLibraryUseFastHash)
-        hash = GetRecursiveFastHash(item->GetPath(), regexps);
-
-      if (m_database.GetPathHash(item->GetPath(), dbHash) && !hash.empty() && dbHash == hash)
+      bool hasHash = m_database.GetPathHash(item->GetPath(), dbHash);
+      if (m_incremental && hasHash && !dbHash.empty() && IsTreeUnchanged(item->GetPath(), m_fingerprints))
       {
-        // fast hashes match - no need to process anything
+        // none of the folders of the show changed since its hash was stored
         bSkip = true;
       }
+      else
+      {
+        if (m_incremental)
+        {
+          // fingerprinted before the folders are listed, so changes made while scanning are seen next time
+          DirectoryFingerprints &fingerprints = m_pendingFingerprints[item->GetPath()];
+          fingerprints.clear();
+          GetTreeFingerprints(item->GetPath(), fingerprints);
+        }
+
+        if (g_advancedSettings.m_bVideoLibraryUseFastHash)
+          hash = GetRecursiveFastHash(item->GetPath(), regexps);
+
+        if (hasHash && !hash.empty() && dbHash == hash)
+        {
+          // fast hashes match - no need to process anything
+          bSkip = true;
+          if (m_incremental)
+          {
+            item->SetProperty("hash", hash);
+            SetTvShowPathHash(item);
+          }
+        }
+      }
 
       // fast hash cannot be computed or we need to rescan. fetch the listing.
       if (!bSkip)
@@ -899,6 +970,20 @@ namespace VIDEO
     return true;
   }
 
+  void CVideoInfoScanner::SetTvShowPathHash(const CFileItem *pItem)
+  {
+    m_database.SetPathHash(pItem->GetPath(), pItem->GetProperty("hash").asString());
+
+    std::map<std::string, DirectoryFingerprints>::iterator fingerprints = m_pendingFingerprints.find(pItem->GetPath());
+    if (fingerprints == m_pendingFingerprints.end())
+      return;
+
+    m_database.RemovePathFingerprints(pItem->GetPath());
+    for (const auto &fingerprint : fingerprints->second)
+      m_database.SetPathFingerprint(fingerprint.first, fingerprint.second);
+    m_pendingFingerprints.erase(fingerprints);
+  }
+
   bool CVideoInfoScanner::ProcessItemByVideoInfoTag(const CFileItem *item, EPISODELIST &episodeList)
   {
     if (!item->HasVideoInfoTag())
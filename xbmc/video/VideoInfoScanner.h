@@ -235,6 +235,11 @@ namespace VIDEO
     INFO_RET OnProcessSeriesFolder(EPISODELIST& files, const ADDON::ScraperPtr &scraper, bool useLocal, const CVideoInfoTag& showInfo, CGUIDialogProgress* pDlgProgress = NULL);
 
     bool EnumerateSeriesFolder(CFileItem* item, EPISODELIST& episodeList);
+
+    /*! \brief Store the hash of a tvshow folder set by EnumerateSeriesFolder, together with
+     the fingerprints of the folders below it if the scan is incremental.
+     */
+    void SetTvShowPathHash(const CFileItem *pItem);
     bool ProcessItemByVideoInfoTag(const CFileItem *item, EPISODELIST &episodeList);
 
     std::string GetnfoFile(CFileItem *item, bool bGrabAny=false) const;
@@ -248,6 +253,9 @@ namespace VIDEO
     bool m_bCanInterrupt;
     bool m_bClean;
     bool m_scanAll;
+    bool m_incremental; // only list folders whose fingerprint changed, see <videolibrary><incrementalscan>
+    DirectoryFingerprints m_fingerprints;
+    std::map<std::string, DirectoryFingerprints> m_pendingFingerprints; // tvshow folder -> folders below it
     std::string m_strStartDir;
     CVideoDatabase m_database;
     std::set<std::string> m_pathsToScan;
@@ -0,0 +1,189 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "VideoLibraryIndex.h"
+
+#include <string.h>
+
+#include "interfaces/AnnouncementManager.h"
+#include "media/MediaType.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/log.h"
+#include "utils/Variant.h"
+#include "video/VideoDatabase.h"
+
+// with more pending items than this the whole index is reloaded
+#define MAX_PENDING_UPDATES 100
+
+using namespace ANNOUNCEMENT;
+
+CVideoLibraryIndex::CVideoLibraryIndex()
+{
+  CAnnouncementManager::GetInstance().AddAnnouncer(this);
+}
+
+CVideoLibraryIndex::~CVideoLibraryIndex()
+{
+  CAnnouncementManager::GetInstance().RemoveAnnouncer(this);
+}
+
+CVideoLibraryIndex& CVideoLibraryIndex::GetInstance()
+{
+  static CVideoLibraryIndex sVideoLibraryIndex;
+  return sVideoLibraryIndex;
+}
+
+bool CVideoLibraryIndex::IsEnabled()
+{
+  return g_advancedSettings.m_bVideoLibraryNavIndex;
+}
+
+CVideoLibraryIndex::Content* CVideoLibraryIndex::GetContent(int idContent)
+{
+  switch (idContent)
+  {
+  case VIDEODB_CONTENT_MOVIES:
+    return &m_movies;
+  case VIDEODB_CONTENT_TVSHOWS:
+    return &m_tvshows;
+  case VIDEODB_CONTENT_MUSICVIDEOS:
+    return &m_musicvideos;
+  default:
+    return NULL;
+  }
+}
+
+CVideoLibraryIndex::Content* CVideoLibraryIndex::GetContent(const std::string &mediaType)
+{
+  if (mediaType == MediaTypeMovie)
+    return &m_movies;
+  if (mediaType == MediaTypeTvShow)
+    return &m_tvshows;
+  if (mediaType == MediaTypeMusicVideo)
+    return &m_musicvideos;
+  return NULL;
+}
+
+void CVideoLibraryIndex::Announce(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data)
+{
+  if (flag != VideoLibrary || strcmp(sender, "xbmc"))
+    return;
+
+  if (!strcmp(message, "OnScanFinished") || !strcmp(message, "OnCleanFinished"))
+  {
+    Invalidate();
+    return;
+  }
+
+  if (strcmp(message, "OnUpdate") && strcmp(message, "OnRemove"))
+    return;
+
+  // updates of a file item carry the id below "item"
+  const CVariant &item = data["item"].isNull() ? data : data["item"];
+  std::string type = item["type"].asString();
+  int id = static_cast<int>(item["id"].asInteger());
+
+  CSingleLock lock(m_section);
+  Content *content = GetContent(type);
+  if (content == NULL || !content->loaded || id <= 0)
+    return;
+
+  if (!strcmp(message, "OnRemove"))
+  {
+    content->index.RemoveItem(id);
+    content->updated.erase(id);
+  }
+  else
+    content->updated.insert(id);
+}
+
+void CVideoLibraryIndex::SetUpdated(const std::string &mediaType, int id)
+{
+  CSingleLock lock(m_section);
+  Content *content = GetContent(mediaType);
+  if (content != NULL && content->loaded)
+    content->updated.insert(id);
+}
+
+void CVideoLibraryIndex::Invalidate()
+{
+  CSingleLock lock(m_section);
+  Content *contents[] = { &m_movies, &m_tvshows, &m_musicvideos };
+  for (Content *content : contents)
+  {
+    content->index.Clear();
+    content->loaded = false;
+    content->updated.clear();
+  }
+}
+
+const CVideoNavIndex* CVideoLibraryIndex::GetIndex(int idContent, CVideoDatabase &db)
+{
+  CSingleLock lock(m_section);
+  Content *content = GetContent(idContent);
+  if (content == NULL)
+    return NULL;
+
+  std::string source;
+  bool shared = db.GetNavIndexSource(source);
+  if (source != m_source)
+  {
+    Invalidate();
+    m_source = source;
+  }
+
+  // other clients of a shared database don't announce their changes
+  if (content->loaded && shared &&
+      XbmcThreads::SystemClockMillis() - content->loadTime > static_cast<unsigned int>(g_advancedSettings.m_iVideoLibraryNavIndexRefresh) * 1000)
+    content->loaded = false;
+
+  if (content->loaded && content->updated.size() <= MAX_PENDING_UPDATES)
+  {
+    for (int id : content->updated)
+    {
+      content->index.RemoveItem(id);
+      if (!db.LoadNavIndex(idContent, content->index, id))
+      {
+        content->loaded = false;
+        break;
+      }
+    }
+    content->updated.clear();
+    if (content->loaded)
+      return &content->index;
+  }
+
+  unsigned int time = XbmcThreads::SystemClockMillis();
+  content->index.Clear();
+  content->updated.clear();
+  content->loaded = db.LoadNavIndex(idContent, content->index);
+  if (!content->loaded)
+  {
+    content->index.Clear();
+    return NULL;
+  }
+  content->loadTime = time;
+
+  CLog::Log(LOGDEBUG, "%s - indexed %u items of content %i in %u ms", __FUNCTION__,
+            static_cast<unsigned int>(content->index.GetItemCount()), idContent, XbmcThreads::SystemClockMillis() - time);
+  return &content->index;
+}
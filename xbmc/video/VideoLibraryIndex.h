@@ -0,0 +1,89 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <set>
+#include <string>
+
+#include "interfaces/IAnnouncer.h"
+#include "threads/CriticalSection.h"
+#include "video/VideoNavIndex.h"
+
+class CVideoDatabase;
+
+/*!
+ \brief Keeps the CVideoNavIndex snapshots of movies, tvshows and musicvideos
+ used to answer navigation queries, enabled with <videolibrary><navindex>.
+
+ Snapshots are loaded on first use. Items reported by OnUpdate are reloaded
+ one by one before the next query and items reported by OnRemove are dropped
+ right away, a scan or clean reloads everything, as does loading a profile or
+ opening an other database. Snapshots of a shared database are reloaded when
+ they are older than <videolibrary><navindexrefresh> seconds, to pick up the
+ changes of other clients.
+ */
+class CVideoLibraryIndex : public ANNOUNCEMENT::IAnnouncer
+{
+public:
+  static CVideoLibraryIndex& GetInstance();
+  static bool IsEnabled();
+
+  virtual void Announce(ANNOUNCEMENT::AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data);
+
+  /*!
+   \brief Gets the index of the given content, loading it or pending changes through db.
+   The section must be held for as long as the index is used.
+   \param idContent VIDEODB_CONTENT_MOVIES, VIDEODB_CONTENT_TVSHOWS or VIDEODB_CONTENT_MUSICVIDEOS
+   \return the index or NULL if the content is not indexed or couldn't be loaded.
+   */
+  const CVideoNavIndex* GetIndex(int idContent, CVideoDatabase &db);
+  CCriticalSection& GetSection() { return m_section; }
+
+  /*!
+   \brief Marks an item as changed by a write that isn't announced.
+   */
+  void SetUpdated(const std::string &mediaType, int id);
+  void Invalidate();
+
+private:
+  CVideoLibraryIndex();
+  virtual ~CVideoLibraryIndex();
+  CVideoLibraryIndex(const CVideoLibraryIndex&);
+  CVideoLibraryIndex const& operator=(CVideoLibraryIndex const&);
+
+  struct Content
+  {
+    Content() : loaded(false), loadTime(0) {}
+
+    CVideoNavIndex index;
+    bool loaded;
+    unsigned int loadTime;
+    std::set<int> updated;
+  };
+
+  Content* GetContent(int idContent);
+  Content* GetContent(const std::string &mediaType);
+
+  CCriticalSection m_section;
+  Content m_movies;
+  Content m_tvshows;
+  Content m_musicvideos;
+  std::string m_source;   // database the snapshots were loaded from
+};
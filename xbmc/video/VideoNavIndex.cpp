@@ -0,0 +1,290 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "VideoNavIndex.h"
+
+#include <algorithm>
+#include <map>
+
+// removed rows are dropped once there are this many and they outnumber the live ones
+#define COMPACT_THRESHOLD 1024
+
+static const char *ColumnNames[] = { "genre", "country", "studio", "tag", "actor", "director", "writer" };
+
+CVideoNavIndex::CVideoNavIndex()
+{
+}
+
+bool CVideoNavIndex::GetColumn(const std::string &type, Column &column)
+{
+  for (int i = 0; i < ColumnCount; i++)
+  {
+    if (type == ColumnNames[i])
+    {
+      column = static_cast<Column>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+void CVideoNavIndex::Clear()
+{
+  m_ids.clear();
+  m_years.clear();
+  m_watched.clear();
+  m_live.clear();
+  m_items.clear();
+  for (auto& dictionary : m_columns)
+    dictionary = Dictionary();
+}
+
+void CVideoNavIndex::SetBit(Bitmap &bitmap, uint32_t row, bool set)
+{
+  if (row / 64 >= bitmap.size())
+    bitmap.resize(row / 64 + 1, 0);
+  if (set)
+    bitmap[row / 64] |= UINT64_C(1) << (row % 64);
+  else
+    bitmap[row / 64] &= ~(UINT64_C(1) << (row % 64));
+}
+
+bool CVideoNavIndex::GetBit(const Bitmap &bitmap, uint32_t row)
+{
+  return row / 64 < bitmap.size() && (bitmap[row / 64] >> (row % 64)) & 1;
+}
+
+void CVideoNavIndex::AddItem(int id, int year, bool watched)
+{
+  RemoveItem(id);
+
+  uint32_t row = static_cast<uint32_t>(m_ids.size());
+  m_ids.push_back(id);
+  m_years.push_back(year);
+  SetBit(m_watched, row, watched);
+  SetBit(m_live, row, true);
+  m_items[id] = row;
+}
+
+bool CVideoNavIndex::AddLink(int id, Column column, int valueId, const std::string &name, const std::string &art)
+{
+  auto item = m_items.find(id);
+  if (item == m_items.end() || column < 0 || column >= ColumnCount)
+    return false;
+
+  Dictionary &dictionary = m_columns[column];
+  auto value = dictionary.index.find(valueId);
+  size_t position;
+  if (value == dictionary.index.end())
+  {
+    position = dictionary.ids.size();
+    dictionary.ids.push_back(valueId);
+    dictionary.names.push_back(name);
+    dictionary.art.push_back(art);
+    dictionary.rows.push_back(std::vector<uint32_t>());
+    dictionary.index[valueId] = position;
+  }
+  else
+  {
+    position = value->second;
+    dictionary.names[position] = name;
+    dictionary.art[position] = art;
+  }
+
+  // rows are appended in order, so the list stays sorted unless an item links twice
+  std::vector<uint32_t> &rows = dictionary.rows[position];
+  if (rows.empty() || rows.back() < item->second)
+    rows.push_back(item->second);
+  else if (!std::binary_search(rows.begin(), rows.end(), item->second))
+    rows.insert(std::lower_bound(rows.begin(), rows.end(), item->second), item->second);
+  return true;
+}
+
+void CVideoNavIndex::RemoveItem(int id)
+{
+  auto item = m_items.find(id);
+  if (item == m_items.end())
+    return;
+
+  SetBit(m_live, item->second, false);
+  m_items.erase(item);
+
+  size_t removed = m_ids.size() - m_items.size();
+  if (removed >= COMPACT_THRESHOLD && removed > m_items.size())
+    Compact();
+}
+
+bool CVideoNavIndex::HasItem(int id) const
+{
+  return m_items.find(id) != m_items.end();
+}
+
+void CVideoNavIndex::Match(const Filter &filter, Bitmap &rows) const
+{
+  rows = m_live;
+
+  if (filter.year >= 0)
+  {
+    for (uint32_t row = 0; row < m_years.size(); row++)
+    {
+      if (m_years[row] != filter.year)
+        SetBit(rows, row, false);
+    }
+  }
+
+  for (const auto& link : filter.links)
+  {
+    Bitmap linked(rows.size(), 0);
+    if (link.first >= 0 && link.first < ColumnCount)
+    {
+      const Dictionary &dictionary = m_columns[link.first];
+      auto value = dictionary.index.find(link.second);
+      if (value != dictionary.index.end())
+      {
+        for (uint32_t row : dictionary.rows[value->second])
+          SetBit(linked, row, true);
+      }
+    }
+
+    for (size_t i = 0; i < rows.size(); i++)
+      rows[i] &= i < linked.size() ? linked[i] : 0;
+  }
+}
+
+void CVideoNavIndex::GetValues(Column column, const Filter &filter, std::vector<Value> &values) const
+{
+  values.clear();
+  if (column < 0 || column >= ColumnCount)
+    return;
+
+  Bitmap rows;
+  Match(filter, rows);
+
+  const Dictionary &dictionary = m_columns[column];
+  std::vector<size_t> order;
+  for (size_t i = 0; i < dictionary.ids.size(); i++)
+  {
+    unsigned int total = 0;
+    for (uint32_t row : dictionary.rows[i])
+      total += GetBit(rows, row);
+    if (total > 0)
+      order.push_back(i);
+  }
+  std::sort(order.begin(), order.end(), [&dictionary](size_t a, size_t b) { return dictionary.ids[a] < dictionary.ids[b]; });
+
+  values.reserve(order.size());
+  for (size_t i : order)
+  {
+    Value value;
+    value.id = dictionary.ids[i];
+    value.name = dictionary.names[i];
+    value.art = dictionary.art[i];
+    value.total = 0;
+    value.watched = 0;
+    for (uint32_t row : dictionary.rows[i])
+    {
+      if (GetBit(rows, row))
+      {
+        value.total++;
+        value.watched += GetBit(m_watched, row);
+      }
+    }
+    values.push_back(value);
+  }
+}
+
+void CVideoNavIndex::GetYears(const Filter &filter, std::vector<Value> &years) const
+{
+  years.clear();
+
+  Bitmap rows;
+  Match(filter, rows);
+
+  std::map<int, std::pair<unsigned int, unsigned int> > counts;
+  for (uint32_t row = 0; row < m_years.size(); row++)
+  {
+    if (!GetBit(rows, row))
+      continue;
+    std::pair<unsigned int, unsigned int> &count = counts[m_years[row]];
+    count.first++;
+    count.second += GetBit(m_watched, row);
+  }
+
+  years.reserve(counts.size());
+  for (const auto& count : counts)
+  {
+    Value value;
+    value.id = count.first;
+    value.total = count.second.first;
+    value.watched = count.second.second;
+    years.push_back(value);
+  }
+}
+
+void CVideoNavIndex::Compact()
+{
+  std::vector<uint32_t> rows(m_ids.size(), UINT32_MAX);
+  std::vector<int> ids;
+  std::vector<int> years;
+  Bitmap watched;
+  Bitmap live;
+  ids.reserve(m_items.size());
+  years.reserve(m_items.size());
+  for (uint32_t row = 0; row < m_ids.size(); row++)
+  {
+    if (!GetBit(m_live, row))
+      continue;
+    uint32_t compacted = static_cast<uint32_t>(ids.size());
+    rows[row] = compacted;
+    ids.push_back(m_ids[row]);
+    years.push_back(m_years[row]);
+    SetBit(watched, compacted, GetBit(m_watched, row));
+    SetBit(live, compacted, true);
+    m_items[m_ids[row]] = compacted;
+  }
+  m_ids.swap(ids);
+  m_years.swap(years);
+  m_watched.swap(watched);
+  m_live.swap(live);
+
+  // the order of the rows is kept, so the lists stay sorted
+  for (auto& dictionary : m_columns)
+  {
+    Dictionary compacted;
+    for (size_t i = 0; i < dictionary.ids.size(); i++)
+    {
+      std::vector<uint32_t> linked;
+      for (uint32_t row : dictionary.rows[i])
+      {
+        if (rows[row] != UINT32_MAX)
+          linked.push_back(rows[row]);
+      }
+      if (linked.empty())
+        continue;
+
+      compacted.index[dictionary.ids[i]] = compacted.ids.size();
+      compacted.ids.push_back(dictionary.ids[i]);
+      compacted.names.push_back(dictionary.names[i]);
+      compacted.art.push_back(dictionary.art[i]);
+      compacted.rows.push_back(linked);
+    }
+    dictionary = compacted;
+  }
+}
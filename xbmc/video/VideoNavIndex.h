@@ -0,0 +1,129 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*!
+ \brief Column store of the movies, tvshows or musicvideos of the video library.
+
+ Every item is a row with its database id, year and watched state. Genres,
+ countries, studios, tags and people are dictionary encoded: each distinct
+ value is stored once together with the sorted list of rows linking to it.
+ Navigation queries evaluate their filter into a bitmap over the rows and
+ count the matching rows per value, without going back to the database.
+
+ Removed rows are only marked, they are dropped once they make up a large
+ part of the index.
+ */
+class CVideoNavIndex
+{
+public:
+  enum Column
+  {
+    ColumnGenre = 0,
+    ColumnCountry,
+    ColumnStudio,
+    ColumnTag,
+    ColumnActor,
+    ColumnDirector,
+    ColumnWriter,
+    ColumnCount
+  };
+
+  struct Value
+  {
+    int id;
+    std::string name;
+    std::string art;
+    unsigned int total;   //!< matching items linked to the value
+    unsigned int watched; //!< matching items linked to the value that have been watched
+  };
+
+  struct Filter
+  {
+    Filter() : year(-1) {}
+
+    int year;                                   //!< -1 for any year
+    std::vector<std::pair<Column, int> > links; //!< items must link to all of these values
+  };
+
+  CVideoNavIndex();
+
+  /*!
+   \brief Maps the type names used by CVideoDatabase ("genre", "actor", ...) to a column.
+   */
+  static bool GetColumn(const std::string &type, Column &column);
+
+  void Clear();
+
+  /*!
+   \brief Adds an item, replacing an earlier version of it.
+   */
+  void AddItem(int id, int year, bool watched);
+
+  /*!
+   \brief Links an item to a value, the name and art of the value are updated.
+   \return false if the item is not in the index.
+   */
+  bool AddLink(int id, Column column, int valueId, const std::string &name, const std::string &art = "");
+
+  void RemoveItem(int id);
+  bool HasItem(int id) const;
+  size_t GetItemCount() const { return m_items.size(); }
+
+  /*!
+   \brief Gets the values of a column that are linked to at least one item matching the filter, ordered by id.
+   */
+  void GetValues(Column column, const Filter &filter, std::vector<Value> &values) const;
+
+  /*!
+   \brief Gets the years of the items matching the filter in ascending order, the id of every value is the year.
+   */
+  void GetYears(const Filter &filter, std::vector<Value> &years) const;
+
+private:
+  typedef std::vector<uint64_t> Bitmap;
+
+  struct Dictionary
+  {
+    std::vector<int> ids;
+    std::vector<std::string> names;
+    std::vector<std::string> art;
+    std::vector<std::vector<uint32_t> > rows;
+    std::unordered_map<int, size_t> index;
+  };
+
+  static void SetBit(Bitmap &bitmap, uint32_t row, bool set);
+  static bool GetBit(const Bitmap &bitmap, uint32_t row);
+  void Match(const Filter &filter, Bitmap &rows) const;
+  void Compact();
+
+  std::vector<int> m_ids;
+  std::vector<int> m_years;
+  Bitmap m_watched;
+  Bitmap m_live;
+  std::unordered_map<int, uint32_t> m_items; // database id -> row
+  Dictionary m_columns[ColumnCount];
+};
@@ -0,0 +1,211 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "video/VideoNavIndex.h"
+
+#include <chrono>
+#include <iostream>
+
+#include "gtest/gtest.h"
+
+class TestVideoNavIndex : public testing::Test
+{
+protected:
+  TestVideoNavIndex()
+  {
+    // 1: Action, Drama   2: Drama, watched   3: Action, Comedy   4: no genre
+    m_index.AddItem(1, 1999, false);
+    m_index.AddItem(2, 2005, true);
+    m_index.AddItem(3, 2005, false);
+    m_index.AddItem(4, 0, true);
+    m_index.AddLink(1, CVideoNavIndex::ColumnGenre, 10, "Action");
+    m_index.AddLink(1, CVideoNavIndex::ColumnGenre, 20, "Drama");
+    m_index.AddLink(2, CVideoNavIndex::ColumnGenre, 20, "Drama");
+    m_index.AddLink(3, CVideoNavIndex::ColumnGenre, 10, "Action");
+    m_index.AddLink(3, CVideoNavIndex::ColumnGenre, 30, "Comedy");
+    m_index.AddLink(1, CVideoNavIndex::ColumnActor, 100, "Actor A", "<thumb>a.jpg</thumb>");
+    m_index.AddLink(2, CVideoNavIndex::ColumnActor, 100, "Actor A", "<thumb>a.jpg</thumb>");
+    m_index.AddLink(3, CVideoNavIndex::ColumnActor, 200, "Actor B");
+  }
+
+  CVideoNavIndex m_index;
+};
+
+TEST_F(TestVideoNavIndex, GetColumn)
+{
+  CVideoNavIndex::Column column;
+  EXPECT_TRUE(CVideoNavIndex::GetColumn("studio", column));
+  EXPECT_EQ(CVideoNavIndex::ColumnStudio, column);
+  EXPECT_TRUE(CVideoNavIndex::GetColumn("writer", column));
+  EXPECT_EQ(CVideoNavIndex::ColumnWriter, column);
+  EXPECT_FALSE(CVideoNavIndex::GetColumn("set", column));
+}
+
+TEST_F(TestVideoNavIndex, Values)
+{
+  std::vector<CVideoNavIndex::Value> values;
+  m_index.GetValues(CVideoNavIndex::ColumnGenre, CVideoNavIndex::Filter(), values);
+  ASSERT_EQ(3u, values.size());
+  EXPECT_EQ(10, values[0].id);
+  EXPECT_EQ("Action", values[0].name);
+  EXPECT_EQ(2u, values[0].total);
+  EXPECT_EQ(0u, values[0].watched);
+  EXPECT_EQ(20, values[1].id);
+  EXPECT_EQ(2u, values[1].total);
+  EXPECT_EQ(1u, values[1].watched);
+  EXPECT_EQ(30, values[2].id);
+  EXPECT_EQ(1u, values[2].total);
+
+  m_index.GetValues(CVideoNavIndex::ColumnActor, CVideoNavIndex::Filter(), values);
+  ASSERT_EQ(2u, values.size());
+  EXPECT_EQ("<thumb>a.jpg</thumb>", values[0].art);
+  EXPECT_EQ(2u, values[0].total);
+
+  m_index.GetValues(CVideoNavIndex::ColumnStudio, CVideoNavIndex::Filter(), values);
+  EXPECT_TRUE(values.empty());
+
+  EXPECT_FALSE(m_index.AddLink(5, CVideoNavIndex::ColumnGenre, 10, "Action"));
+}
+
+TEST_F(TestVideoNavIndex, Filter)
+{
+  // genres of the movies with Actor A
+  CVideoNavIndex::Filter filter;
+  filter.links.push_back(std::make_pair(CVideoNavIndex::ColumnActor, 100));
+  std::vector<CVideoNavIndex::Value> values;
+  m_index.GetValues(CVideoNavIndex::ColumnGenre, filter, values);
+  ASSERT_EQ(2u, values.size());
+  EXPECT_EQ(10, values[0].id);
+  EXPECT_EQ(1u, values[0].total);
+  EXPECT_EQ(20, values[1].id);
+  EXPECT_EQ(2u, values[1].total);
+
+  // ... from 2005
+  filter.year = 2005;
+  m_index.GetValues(CVideoNavIndex::ColumnGenre, filter, values);
+  ASSERT_EQ(1u, values.size());
+  EXPECT_EQ(20, values[0].id);
+  EXPECT_EQ(1u, values[0].watched);
+
+  // unknown values match nothing
+  filter.links.push_back(std::make_pair(CVideoNavIndex::ColumnTag, 1));
+  m_index.GetValues(CVideoNavIndex::ColumnGenre, filter, values);
+  EXPECT_TRUE(values.empty());
+}
+
+TEST_F(TestVideoNavIndex, Years)
+{
+  std::vector<CVideoNavIndex::Value> years;
+  m_index.GetYears(CVideoNavIndex::Filter(), years);
+  ASSERT_EQ(3u, years.size());
+  EXPECT_EQ(0, years[0].id);
+  EXPECT_EQ(1999, years[1].id);
+  EXPECT_EQ(2005, years[2].id);
+  EXPECT_EQ(2u, years[2].total);
+  EXPECT_EQ(1u, years[2].watched);
+
+  CVideoNavIndex::Filter filter;
+  filter.links.push_back(std::make_pair(CVideoNavIndex::ColumnGenre, 10));
+  m_index.GetYears(filter, years);
+  ASSERT_EQ(2u, years.size());
+  EXPECT_EQ(1999, years[0].id);
+  EXPECT_EQ(2005, years[1].id);
+  EXPECT_EQ(1u, years[1].total);
+}
+
+TEST_F(TestVideoNavIndex, Update)
+{
+  // reloading an item replaces its row and links
+  m_index.RemoveItem(3);
+  m_index.AddItem(3, 2010, true);
+  m_index.AddLink(3, CVideoNavIndex::ColumnGenre, 20, "Drama (renamed)");
+  m_index.RemoveItem(1);
+  EXPECT_FALSE(m_index.HasItem(1));
+  EXPECT_EQ(3u, m_index.GetItemCount());
+
+  std::vector<CVideoNavIndex::Value> values;
+  m_index.GetValues(CVideoNavIndex::ColumnGenre, CVideoNavIndex::Filter(), values);
+  ASSERT_EQ(1u, values.size());
+  EXPECT_EQ(20, values[0].id);
+  EXPECT_EQ("Drama (renamed)", values[0].name);
+  EXPECT_EQ(2u, values[0].total);
+  EXPECT_EQ(2u, values[0].watched);
+
+  m_index.GetValues(CVideoNavIndex::ColumnActor, CVideoNavIndex::Filter(), values);
+  ASSERT_EQ(1u, values.size());
+  EXPECT_EQ(100, values[0].id);
+  EXPECT_EQ(1u, values[0].total);
+}
+
+TEST_F(TestVideoNavIndex, Compact)
+{
+  // replacing every item many times drops the old rows without changing the results
+  for (int round = 0; round < 5; round++)
+  {
+    for (int id = 1000; id < 2000; id++)
+    {
+      m_index.AddItem(id, 2000 + id % 10, id % 2 == 0);
+      m_index.AddLink(id, CVideoNavIndex::ColumnTag, id % 7, "tag");
+    }
+  }
+  EXPECT_EQ(1004u, m_index.GetItemCount());
+
+  std::vector<CVideoNavIndex::Value> values;
+  m_index.GetValues(CVideoNavIndex::ColumnTag, CVideoNavIndex::Filter(), values);
+  ASSERT_EQ(7u, values.size());
+  unsigned int total = 0;
+  for (const auto& value : values)
+    total += value.total;
+  EXPECT_EQ(1000u, total);
+
+  m_index.GetValues(CVideoNavIndex::ColumnGenre, CVideoNavIndex::Filter(), values);
+  EXPECT_EQ(3u, values.size());
+}
+
+TEST_F(TestVideoNavIndex, Performance)
+{
+  // a large library: 40000 movies, 25 genres, 20000 actors with 10 roles each
+  CVideoNavIndex index;
+  for (int id = 1; id <= 40000; id++)
+  {
+    index.AddItem(id, 1950 + id % 70, id % 3 == 0);
+    index.AddLink(id, CVideoNavIndex::ColumnGenre, id % 25, "genre");
+    index.AddLink(id, CVideoNavIndex::ColumnGenre, (id / 25) % 25, "genre");
+    for (int role = 0; role < 10; role++)
+      index.AddLink(id, CVideoNavIndex::ColumnActor, (id * 7 + role * 2003) % 20000, "actor");
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<CVideoNavIndex::Value> values;
+  index.GetValues(CVideoNavIndex::ColumnActor, CVideoNavIndex::Filter(), values);
+  EXPECT_EQ(20000u, values.size());
+
+  CVideoNavIndex::Filter filter;
+  filter.links.push_back(std::make_pair(CVideoNavIndex::ColumnGenre, 3));
+  filter.year = 2000;
+  index.GetValues(CVideoNavIndex::ColumnGenre, filter, values);
+  EXPECT_FALSE(values.empty());
+  index.GetYears(CVideoNavIndex::Filter(), values);
+  EXPECT_EQ(70u, values.size());
+
+  std::cout << "actors, genres and years of 40000 movies: "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count()
+            << " ms" << std::endl;
+}
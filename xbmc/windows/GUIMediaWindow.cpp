@@ -24,6 +24,7 @@
 #include "messaging/ApplicationMessenger.h"
 #include "ContextMenuManager.h"
 #include "FileItemListModification.h"
+#include "IFileItemListPager.h"
 #include "GUIPassword.h"
 #include "GUIUserMessages.h"
 #include "PartyModeManager.h"
@@ -607,6 +608,9 @@ void CGUIMediaWindow::SortItems(CFileItemList &items)
 // \brief Formats item labels based on the formatting provided by guiViewState
 void CGUIMediaWindow::FormatItemLabels(CFileItemList &items, const LABEL_MASKS &labelMasks)
 {
+  if (items.GetPager())
+    items.GetPager()->SetLabelMasks(labelMasks);
+
   CLabelFormatter fileFormatter(labelMasks.m_strLabelFile, labelMasks.m_strLabel2File);
   CLabelFormatter folderFormatter(labelMasks.m_strLabelFolder, labelMasks.m_strLabel2Folder);
   for (int i=0; i<items.Size(); ++i)
@@ -1371,6 +1375,10 @@ bool CGUIMediaWindow::OnPlayAndQueueMedia(const CFileItemPtr &item, std::string
       } 
     }
 
+    // placeholders of a paged listing are shared with the container, queue loaded copies of them
+    bool paged = m_vecItems->GetPager() != nullptr;
+    m_vecItems->LoadPaged();
+
     // now queue...
     for ( int i = 0; i < m_vecItems->Size(); i++ )
     {
@@ -1380,7 +1388,7 @@ bool CGUIMediaWindow::OnPlayAndQueueMedia(const CFileItemPtr &item, std::string
         continue;
 
       if (!nItem->IsPlayList() && !nItem->IsZIP() && !nItem->IsRAR() && (!nItem->IsDVDFile() || (URIUtils::GetFileName(nItem->GetPath()) == mainDVD)))
-        g_playlistPlayer.Add(iPlaylist, nItem);
+        g_playlistPlayer.Add(iPlaylist, paged ? CFileItemPtr(new CFileItem(*nItem)) : nItem);
 
       if (item->IsSamePath(nItem.get()))
       { // item that was clicked
@@ -1435,6 +1443,9 @@ void CGUIMediaWindow::UpdateFileList()
     g_playlistPlayer.ClearPlaylist(iPlaylist);
     g_playlistPlayer.Reset();
 
+    bool paged = m_vecItems->GetPager() != nullptr;
+    m_vecItems->LoadPaged();
+
     for (int i = 0; i < m_vecItems->Size(); i++)
     {
       CFileItemPtr pItem = m_vecItems->Get(i);
@@ -1442,7 +1453,7 @@ void CGUIMediaWindow::UpdateFileList()
         continue;
 
       if (!pItem->IsPlayList() && !pItem->IsZIP() && !pItem->IsRAR())
-        g_playlistPlayer.Add(iPlaylist, pItem);
+        g_playlistPlayer.Add(iPlaylist, paged ? CFileItemPtr(new CFileItem(*pItem)) : pItem);
 
       if (pItem->GetPath() == playlistItem.GetPath() &&
           pItem->m_lStartOffset == playlistItem.m_lStartOffset)
@@ -155,6 +155,8 @@ void CGUIWindowDebugInfo::Process(unsigned int currentTime, CDirtyRegionList &di
       if (control)
         info += StringUtils::Format("Focused: %i (%s)", control->GetID(), CGUIControlFactory::TranslateControlType(control->GetControlType()).c_str());
     }
+    info += StringUtils::Format("\nConditions: %u evaluated per frame, %u registered", g_infoManager.GetBoolEvaluations(), g_infoManager.GetBoolCount());
+    info += "\n" + g_windowManager.GetDirtyRegionInfo();
   }
 
   float w, h;